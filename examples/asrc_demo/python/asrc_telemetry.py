@@ -0,0 +1,66 @@
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+import argparse
+import os
+import re
+import struct
+
+import usb.core
+
+XMOS_VID = 0x20B1
+XCORE_VOICE_PID = 0x4001
+DEFAULT_HEADER = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "src", "asrc_telemetry.h")
+DIRECTIONS = ["i2s->usb", "usb->i2s"]
+
+def parse_header(fname):
+    with open(fname, "r") as f:
+        return {k: int(v, 0) for k, v in re.findall(r"^#define\s+(ASRC_TELEMETRY_\w+)\s+\((\w+)\)", f.read(), re.M)}
+
+def unpack(consts, data):
+    """Unpack an asrc_telemetry_t, see asrc_telemetry.h for the layout"""
+    bins = consts["ASRC_TELEMETRY_NUM_BINS"]
+    fields = struct.unpack(f"<5I{bins}IIii", data)
+    return {
+        "blocks": fields[0],
+        "deadline_misses": fields[1],
+        "deadline_ticks": fields[2],
+        "max_ticks": fields[3],
+        "worker_max_ticks": fields[4],
+        "hist": list(fields[5:5 + bins]),
+        "buffer_updates": fields[5 + bins],
+        "buffer_min": fields[6 + bins],
+        "buffer_max": fields[7 + bins],
+    }
+
+def print_telemetry(consts, name, t):
+    print(f"{name}: blocks {t['blocks']}, deadline misses {t['deadline_misses']}, max {t['max_ticks']}/{t['deadline_ticks']} ticks, "
+          f"worker max {t['worker_max_ticks']} ticks, buffer min {t['buffer_min']} max {t['buffer_max']}")
+    per_deadline = consts["ASRC_TELEMETRY_BINS_PER_DEADLINE"]
+    for i, count in enumerate(t["hist"]):
+        upper = "" if i == len(t["hist"]) - 1 else f"{(i + 1) / per_deadline:.3f}"
+        print(f"  {i / per_deadline:.3f}-{upper:<5} x deadline {count:>10}")
+
+def parse_arguments():
+    parser = argparse.ArgumentParser(description="Read the ASRC telemetry from a running asrc_demo over USB")
+    parser.add_argument("--header", default=DEFAULT_HEADER, help="Telemetry header")
+    parser.add_argument("--reset", action="store_true", help="Clear the telemetry after reading it")
+    args = parser.parse_args()
+    return args
+
+if __name__ == "__main__":
+    args = parse_arguments()
+    consts = parse_header(args.header)
+    size = 4 * (8 + consts["ASRC_TELEMETRY_NUM_BINS"])
+
+    dev = usb.core.find(idVendor=XMOS_VID, idProduct=XCORE_VOICE_PID)
+    if dev is None:
+        raise SystemExit("asrc_demo device not found")
+
+    for d, name in enumerate(DIRECTIONS):
+        data = dev.ctrl_transfer(usb.util.CTRL_IN | usb.util.CTRL_TYPE_VENDOR | usb.util.CTRL_RECIPIENT_DEVICE,
+                                 consts["ASRC_TELEMETRY_REQ_GET"], d, 0, size)
+        print_telemetry(consts, name, unpack(consts, bytes(data)))
+
+    if args.reset:
+        dev.ctrl_transfer(usb.util.CTRL_OUT | usb.util.CTRL_TYPE_VENDOR | usb.util.CTRL_RECIPIENT_DEVICE,
+                          consts["ASRC_TELEMETRY_REQ_RESET"], 0, 0)
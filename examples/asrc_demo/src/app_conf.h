@@ -75,6 +75,39 @@
 #define appconfSPI_OUTPUT_ENABLED  0
 #endif
 
+/*
+ * Number of threads, including the ASRC task itself, that the channels of
+ * each ASRC block are split between. Must be no more than
+ * ASRC_POOL_MAX_WORKERS. Extra workers beyond the channel count are unused.
+ */
+#ifndef appconfI2S_TO_USB_ASRC_WORKERS
+#define appconfI2S_TO_USB_ASRC_WORKERS  2
+#endif
+
+#ifndef appconfUSB_TO_I2S_ASRC_WORKERS
+#define appconfUSB_TO_I2S_ASRC_WORKERS  2
+#endif
+
+/*
+ * Initialise a set of ASRC instances for every supported I2S rate at startup,
+ * so an I2S rate change swaps to a ready instance instead of calling
+ * asrc_init() and dropping a block. Costs one extra ASRC state per channel
+ * per rate. When disabled the block after a rate change is dropped.
+ */
+#ifndef appconfASRC_PREPARE_ALL_RATES
+#define appconfASRC_PREPARE_ALL_RATES   1
+#endif
+
+/*
+ * Record a histogram of the ASRC block processing time, deadline misses and
+ * buffer level extremes for both directions. Read with the vendor control
+ * requests in asrc_telemetry.h and printed by a low priority task when a
+ * streaming interface closes or USB is unmounted.
+ */
+#ifndef appconfASRC_TELEMETRY_ENABLED
+#define appconfASRC_TELEMETRY_ENABLED   1
+#endif
+
 /*
  * This option sends all 6 16 KHz channels (two channels of processed audio,
  * stereo reference audio, and stereo microphone audio) out over a single
@@ -145,6 +178,7 @@
 #define appconfSPI_TASK_PRIORITY                  (configMAX_PRIORITIES/2 + 1)
 #define appconfQSPI_FLASH_TASK_PRIORITY           (configMAX_PRIORITIES/2 + 0)
 #define appconfWW_TASK_PRIORITY                   (configMAX_PRIORITIES/2 - 1)
+#define appconfASRC_TELEMETRY_TASK_PRIORITY       (configMAX_PRIORITIES/2 - 1)
 
 #ifndef MIC_ARRAY_SAMPLING_FREQ
     #define MIC_ARRAY_SAMPLING_FREQ (16000)
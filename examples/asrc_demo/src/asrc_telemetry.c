@@ -0,0 +1,116 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#include <stdint.h>
+#include <string.h>
+#include "rtos_printf.h"
+#include "asrc_telemetry.h"
+
+#define REF_CLOCK_HZ    (100000000)
+
+// Written by the task running the ASRC or owning the buffer, read by the rate server and the USB control callback.
+// Readers may see a block half recorded, which only matters for the one block being read.
+static asrc_telemetry_t telemetry[ASRC_TELEMETRY_NUM_DIRS];
+
+asrc_telemetry_t *asrc_telemetry_get(asrc_telemetry_dir_t dir)
+{
+    return &telemetry[dir];
+}
+
+void asrc_telemetry_reset(asrc_telemetry_t *t)
+{
+    uint32_t deadline_ticks = t->deadline_ticks;
+    memset(t, 0, sizeof(asrc_telemetry_t));
+    t->deadline_ticks = deadline_ticks;
+}
+
+void asrc_telemetry_set_deadline(asrc_telemetry_t *t, uint32_t block_length, uint32_t fs_in)
+{
+    t->deadline_ticks = (uint32_t)(((uint64_t)block_length * REF_CLOCK_HZ) / fs_in);
+}
+
+void asrc_telemetry_record_block(asrc_telemetry_t *t, uint32_t ticks, uint32_t worker_ticks)
+{
+    t->blocks += 1;
+    if(ticks > t->max_ticks)
+    {
+        t->max_ticks = ticks;
+    }
+    if(worker_ticks > t->worker_max_ticks)
+    {
+        t->worker_max_ticks = worker_ticks;
+    }
+    if(t->deadline_ticks == 0)
+    {
+        t->hist[0] += 1;
+        return;
+    }
+    if(ticks > t->deadline_ticks)
+    {
+        t->deadline_misses += 1;
+    }
+    uint64_t bin = ((uint64_t)ticks * ASRC_TELEMETRY_BINS_PER_DEADLINE) / t->deadline_ticks;
+    if(bin >= ASRC_TELEMETRY_NUM_BINS)
+    {
+        bin = ASRC_TELEMETRY_NUM_BINS - 1;
+    }
+    t->hist[bin] += 1;
+}
+
+void asrc_telemetry_record_buffer_level(asrc_telemetry_t *t, int32_t level)
+{
+    if((t->buffer_updates == 0) || (level < t->buffer_min))
+    {
+        t->buffer_min = level;
+    }
+    if((t->buffer_updates == 0) || (level > t->buffer_max))
+    {
+        t->buffer_max = level;
+    }
+    t->buffer_updates += 1;
+}
+
+void asrc_telemetry_merge(asrc_telemetry_t *out, const asrc_telemetry_t *a, const asrc_telemetry_t *b)
+{
+    asrc_telemetry_t m;
+    m.blocks = a->blocks + b->blocks;
+    m.deadline_misses = a->deadline_misses + b->deadline_misses;
+    m.deadline_ticks = (a->deadline_ticks != 0) ? a->deadline_ticks : b->deadline_ticks;
+    m.max_ticks = (a->max_ticks > b->max_ticks) ? a->max_ticks : b->max_ticks;
+    m.worker_max_ticks = (a->worker_max_ticks > b->worker_max_ticks) ? a->worker_max_ticks : b->worker_max_ticks;
+    for(int i = 0; i < ASRC_TELEMETRY_NUM_BINS; i++)
+    {
+        m.hist[i] = a->hist[i] + b->hist[i];
+    }
+    m.buffer_updates = a->buffer_updates + b->buffer_updates;
+    if(a->buffer_updates == 0)
+    {
+        m.buffer_min = b->buffer_min;
+        m.buffer_max = b->buffer_max;
+    }
+    else if(b->buffer_updates == 0)
+    {
+        m.buffer_min = a->buffer_min;
+        m.buffer_max = a->buffer_max;
+    }
+    else
+    {
+        m.buffer_min = (a->buffer_min < b->buffer_min) ? a->buffer_min : b->buffer_min;
+        m.buffer_max = (a->buffer_max > b->buffer_max) ? a->buffer_max : b->buffer_max;
+    }
+    *out = m;
+}
+
+void asrc_telemetry_print(asrc_telemetry_dir_t dir, const asrc_telemetry_t *t)
+{
+    rtos_printf("ASRC %s: blocks %u, deadline misses %u, deadline %u, max %u, worker max %u, buffer min %d max %d\n",
+                (dir == ASRC_TELEMETRY_I2S_TO_USB) ? "i2s->usb" : "usb->i2s",
+                t->blocks, t->deadline_misses, t->deadline_ticks, t->max_ticks, t->worker_max_ticks,
+                t->buffer_min, t->buffer_max);
+    rtos_printf("ASRC %s: hist", (dir == ASRC_TELEMETRY_I2S_TO_USB) ? "i2s->usb" : "usb->i2s");
+    for(int i = 0; i < ASRC_TELEMETRY_NUM_BINS; i++)
+    {
+        rtos_printf(" %u", t->hist[i]);
+    }
+    rtos_printf("\n");
+}
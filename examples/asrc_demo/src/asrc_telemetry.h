@@ -0,0 +1,57 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#ifndef ASRC_TELEMETRY_H
+#define ASRC_TELEMETRY_H
+
+#include <stdint.h>
+
+// Processing time histogram bins. Each bin is 1/ASRC_TELEMETRY_BINS_PER_DEADLINE of the block deadline wide,
+// so the histogram covers up to twice the deadline and the last bin also counts anything longer.
+#define ASRC_TELEMETRY_NUM_BINS             (16)
+#define ASRC_TELEMETRY_BINS_PER_DEADLINE    (8)
+
+// Vendor control requests for reading the telemetry over USB
+#define ASRC_TELEMETRY_REQ_GET              (0x01)  // Device to host, wValue is the direction. Returns an asrc_telemetry_t
+#define ASRC_TELEMETRY_REQ_RESET            (0x02)  // Host to device, clears the telemetry of both directions
+
+typedef enum {
+    ASRC_TELEMETRY_I2S_TO_USB = 0,
+    ASRC_TELEMETRY_USB_TO_I2S,
+    ASRC_TELEMETRY_NUM_DIRS
+}asrc_telemetry_dir_t;
+
+/*
+ * Telemetry of one ASRC direction. The processing time is recorded on the tile running the ASRC and the
+ * buffer level on the tile holding the buffer the ASRC output goes to, so the USB tile merges its own
+ * telemetry with a copy of the I2S tile's. All fields are 32 bit so the layout read over USB is fixed.
+ */
+typedef struct {
+    uint32_t blocks;                            // Blocks processed
+    uint32_t deadline_misses;                   // Blocks that took longer than deadline_ticks
+    uint32_t deadline_ticks;                    // Duration of a block at the input rate, 0 until the rate is known
+    uint32_t max_ticks;                         // Longest time taken for a block
+    uint32_t worker_max_ticks;                  // Longest time taken by one ASRC worker for its share of a block
+    uint32_t hist[ASRC_TELEMETRY_NUM_BINS];     // Blocks by processing time
+    uint32_t buffer_updates;                    // Buffer levels recorded
+    int32_t buffer_min;                         // Lowest and highest buffer level, in samples from half full
+    int32_t buffer_max;
+}asrc_telemetry_t;
+
+// Telemetry recorded on this tile
+asrc_telemetry_t *asrc_telemetry_get(asrc_telemetry_dir_t dir);
+
+void asrc_telemetry_reset(asrc_telemetry_t *t);
+
+// Set the deadline for blocks of block_length samples at fs_in. The histogram is relative to the deadline so it is kept.
+void asrc_telemetry_set_deadline(asrc_telemetry_t *t, uint32_t block_length, uint32_t fs_in);
+
+void asrc_telemetry_record_block(asrc_telemetry_t *t, uint32_t ticks, uint32_t worker_ticks);
+
+void asrc_telemetry_record_buffer_level(asrc_telemetry_t *t, int32_t level);
+
+// Combine the telemetry recorded on two tiles
+void asrc_telemetry_merge(asrc_telemetry_t *out, const asrc_telemetry_t *a, const asrc_telemetry_t *b);
+
+void asrc_telemetry_print(asrc_telemetry_dir_t dir, const asrc_telemetry_t *t);
+
+#endif
@@ -7,17 +7,13 @@
 
 /* FreeRTOS headers */
 #include "FreeRTOS.h"
-#include "task.h"
-#include "timers.h"
-#include "queue.h"
-#include "stream_buffer.h"
 
 /* App headers */
-#include "app_conf.h"
-#include "platform/driver_instances.h"
 #include "src.h"
 #include "asrc_utils.h"
 
+const unsigned asrc_supported_rates[ASRC_NUM_SUPPORTED_RATES] = {44100, 48000, 88200, 96000, 176400, 192000};
+
 //Helper function for converting sample to fs index value
 fs_code_t samp_rate_to_code(unsigned samp_rate){
     unsigned samp_code = 0xdead;
@@ -45,17 +41,260 @@ fs_code_t samp_rate_to_code(unsigned samp_rate){
 }
 
 
-void asrc_one_channel_task(void *args)
+static void asrc_pool_bank_init_channel(asrc_pool_t *pool, asrc_pool_bank_t *bank, unsigned ch)
+{
+    (void) asrc_init(samp_rate_to_code(bank->fs_in), samp_rate_to_code(bank->fs_out), bank->asrc_ctrl[ch], ASRC_CHANNELS_PER_INSTANCE, pool->n_in_samples, ASRC_DITHER_SETTING);
+}
+
+static void asrc_pool_bank_init(asrc_pool_t *pool, asrc_pool_bank_t *bank, unsigned fs_in, unsigned fs_out)
+{
+    bank->fs_in = fs_in;
+    bank->fs_out = fs_out;
+    for(unsigned ch = 0; ch < pool->num_channels; ch++)
+    {
+        // Every channel of a bank has the same nominal ratio
+        bank->nominal_fs_ratio = asrc_init(samp_rate_to_code(fs_in), samp_rate_to_code(fs_out), bank->asrc_ctrl[ch], ASRC_CHANNELS_PER_INSTANCE, pool->n_in_samples, ASRC_DITHER_SETTING);
+    }
+    bank->armed = 1;
+}
+
+static asrc_pool_bank_t *asrc_pool_bank_alloc(asrc_pool_t *pool)
+{
+    configASSERT(pool->num_banks < ASRC_POOL_MAX_BANKS);
+    asrc_pool_bank_t *bank = &pool->bank[pool->num_banks++];
+
+    for(unsigned ch = 0; ch < pool->num_channels; ch++)
+    {
+        asrc_ctrl_t *ctrl = rtos_osal_malloc(sizeof(asrc_ctrl_t));
+        asrc_state_t *state = rtos_osal_malloc(sizeof(asrc_state_t));
+        asrc_adfir_coefs_t *adfir_coefs = rtos_osal_malloc(sizeof(asrc_adfir_coefs_t));
+        configASSERT(ctrl != NULL && state != NULL && adfir_coefs != NULL);
+
+        ctrl->psState = state;
+        ctrl->piStack = pool->asrc_stack[ch];
+        ctrl->piADCoefs = adfir_coefs->iASRCADFIRCoefs;
+        bank->asrc_ctrl[ch] = ctrl;
+    }
+    return bank;
+}
+
+static void asrc_pool_worker_process(asrc_pool_worker_t *worker)
+{
+    asrc_pool_t *pool = worker->pool;
+    uint32_t start = get_reference_time();
+    unsigned n_samps_out = 0;
+
+    for(unsigned ch = worker->first_ch; ch < worker->first_ch + worker->num_ch; ch++)
+    {
+        int32_t *output_samples = &pool->output_samples[ch * pool->output_stride];
+
+        n_samps_out = asrc_process((int *)&pool->input_samples[ch * pool->input_stride],
+                                   (int *)output_samples,
+                                   pool->fs_ratio,
+                                   pool->active->asrc_ctrl[ch]);
+
+        // Fade in from silence after a rate switch
+        for(unsigned i = 0; i < n_samps_out && (pool->ramp_pos + i) < pool->ramp_samples; i++)
+        {
+            output_samples[i] = ((int64_t)output_samples[i] * (pool->ramp_pos + i)) / pool->ramp_samples;
+        }
+    }
+    worker->n_samps_out = n_samps_out;
+
+    worker->last_ticks = get_reference_time() - start;
+    if(worker->last_ticks > worker->max_ticks)
+    {
+        worker->max_ticks = worker->last_ticks;
+    }
+
+    // Reinitialise this worker's channels of the bank left at the last rate switch
+    if(pool->rearm != NULL)
+    {
+        for(unsigned ch = worker->first_ch; ch < worker->first_ch + worker->num_ch; ch++)
+        {
+            asrc_pool_bank_init_channel(pool, pool->rearm, ch);
+        }
+    }
+}
+
+static void asrc_pool_worker_task(void *args)
 {
-    asrc_init_t *asrc_init_ctx = args;
+    asrc_pool_worker_t *worker = args;
 
     for(;;)
     {
-        asrc_process_frame_ctx_t *asrc_ctx = NULL;
-        (void) rtos_osal_queue_receive(&asrc_init_ctx->asrc_queue, &asrc_ctx, RTOS_OSAL_WAIT_FOREVER);
+        (void) rtos_osal_semaphore_get(&worker->start_sem, RTOS_OSAL_WAIT_FOREVER);
+        asrc_pool_worker_process(worker);
+        (void) rtos_osal_semaphore_put(&worker->pool->done_sem);
+    }
+}
+
+void asrc_pool_create(asrc_pool_t *pool, unsigned num_channels, unsigned num_workers, unsigned n_in_samples, unsigned priority)
+{
+    configASSERT(num_channels > 0 && num_channels <= ASRC_POOL_MAX_CHANNELS);
+    configASSERT(num_workers > 0 && num_workers <= ASRC_POOL_MAX_WORKERS);
+
+    // No point having more workers than channels
+    if(num_workers > num_channels)
+    {
+        num_workers = num_channels;
+    }
+
+    memset(pool, 0, sizeof(asrc_pool_t));
+    pool->num_channels = num_channels;
+    pool->num_workers = num_workers;
+    pool->n_in_samples = n_in_samples;
+
+    for(unsigned ch = 0; ch < num_channels; ch++)
+    {
+        pool->asrc_stack[ch] = rtos_osal_malloc(ASRC_STACK_LENGTH_MULT * n_in_samples * sizeof(int));
+        configASSERT(pool->asrc_stack[ch] != NULL);
+    }
+
+    // Spare bank for rates that have not been prepared
+    pool->active = asrc_pool_bank_alloc(pool);
+
+    // Split the channels as evenly as possible, the first workers take any remainder
+    unsigned ch = 0;
+    for(unsigned w = 0; w < num_workers; w++)
+    {
+        asrc_pool_worker_t *worker = &pool->worker[w];
+        worker->pool = pool;
+        worker->first_ch = ch;
+        worker->num_ch = (num_channels / num_workers) + (w < (num_channels % num_workers) ? 1 : 0);
+        ch += worker->num_ch;
+    }
+
+    (void) rtos_osal_semaphore_create(&pool->done_sem, "asrc_done_sem", num_workers, 0);
+
+    // Worker 0 runs in the thread calling asrc_pool_process()
+    for(unsigned w = 1; w < num_workers; w++)
+    {
+        asrc_pool_worker_t *worker = &pool->worker[w];
+        (void) rtos_osal_semaphore_create(&worker->start_sem, "asrc_start_sem", 1, 0);
+        (void) rtos_osal_thread_create(
+            (rtos_osal_thread_t *) NULL,
+            (char *) "asrc_worker",
+            (rtos_osal_entry_function_t) asrc_pool_worker_task,
+            (void *) worker,
+            (size_t) RTOS_THREAD_STACK_SIZE(asrc_pool_worker_task),
+            priority);
+    }
+}
+
+void asrc_pool_prepare(asrc_pool_t *pool, unsigned fs_in, unsigned fs_out)
+{
+    asrc_pool_bank_t *bank = asrc_pool_bank_alloc(pool);
+    asrc_pool_bank_init(pool, bank, fs_in, fs_out);
+}
+
+uint64_t asrc_pool_init(asrc_pool_t *pool, unsigned fs_in, unsigned fs_out)
+{
+    asrc_pool_bank_t *prev = pool->active;
+    asrc_pool_bank_t *bank = NULL;
+
+    // Prepared banks first, the spare bank 0 is only used when nothing else matches
+    for(unsigned b = pool->num_banks; b-- > 1; )
+    {
+        if(pool->bank[b].fs_in == fs_in && pool->bank[b].fs_out == fs_out)
+        {
+            bank = &pool->bank[b];
+            break;
+        }
+    }
+    if(bank == NULL)
+    {
+        bank = &pool->bank[0];
+        bank->armed = 0;
+    }
+
+    // A bank that is still waiting to be rearmed, or has been used, needs initialising now
+    if(bank == pool->rearm)
+    {
+        pool->rearm = NULL;
+    }
+    if(!bank->armed)
+    {
+        asrc_pool_bank_init(pool, bank, fs_in, fs_out);
+    }
+
+    bank->armed = 0;
+    pool->active = bank;
+    pool->ramp_samples = (fs_out * ASRC_POOL_RAMP_MS) / 1000;
+    pool->ramp_pos = 0;
+
+    // The bank being left is reinitialised by the workers during the next block.
+    // The spare bank is always initialised when it is switched to so is skipped.
+    if(prev != bank && prev != &pool->bank[0] && pool->rearm == NULL)
+    {
+        pool->rearm = prev;
+    }
+
+    return bank->nominal_fs_ratio;
+}
+
+unsigned asrc_pool_process(asrc_pool_t *pool, int32_t *input_samples, unsigned input_stride, int32_t *output_samples, unsigned output_stride, uint64_t fs_ratio)
+{
+    pool->input_samples = input_samples;
+    pool->input_stride = input_stride;
+    pool->output_samples = output_samples;
+    pool->output_stride = output_stride;
+    pool->fs_ratio = fs_ratio;
+
+    for(unsigned w = 1; w < pool->num_workers; w++)
+    {
+        (void) rtos_osal_semaphore_put(&pool->worker[w].start_sem);
+    }
+
+    asrc_pool_worker_process(&pool->worker[0]);
+
+    for(unsigned w = 1; w < pool->num_workers; w++)
+    {
+        (void) rtos_osal_semaphore_get(&pool->done_sem, RTOS_OSAL_WAIT_FOREVER);
+    }
+
+    if(pool->rearm != NULL)
+    {
+        pool->rearm->armed = 1;
+        pool->rearm = NULL;
+    }
+
+    // All channels run at the same ratio so must produce the same number of samples
+    unsigned n_samps_out = pool->worker[0].n_samps_out;
+    for(unsigned w = 1; w < pool->num_workers; w++)
+    {
+        configASSERT(pool->worker[w].n_samps_out == n_samps_out);
+    }
+
+    if(pool->ramp_pos < pool->ramp_samples)
+    {
+        pool->ramp_pos += n_samps_out;
+    }
+    return n_samps_out;
+}
 
-        unsigned n_samps_out = asrc_process((int *)asrc_ctx->input_samples, (int *)asrc_ctx->output_samples, asrc_ctx->fs_ratio, asrc_init_ctx->asrc_ctrl_ptr);
+uint32_t asrc_pool_max_ticks(asrc_pool_t *pool)
+{
+    uint32_t max_ticks = 0;
+    for(unsigned w = 0; w < pool->num_workers; w++)
+    {
+        if(pool->worker[w].max_ticks > max_ticks)
+        {
+            max_ticks = pool->worker[w].max_ticks;
+        }
+    }
+    return max_ticks;
+}
 
-        (void) rtos_osal_queue_send(&asrc_init_ctx->asrc_ret_queue, &n_samps_out, RTOS_OSAL_WAIT_FOREVER);
+uint32_t asrc_pool_last_ticks(asrc_pool_t *pool)
+{
+    uint32_t last_ticks = 0;
+    for(unsigned w = 0; w < pool->num_workers; w++)
+    {
+        if(pool->worker[w].last_ticks > last_ticks)
+        {
+            last_ticks = pool->worker[w].last_ticks;
+        }
     }
+    return last_ticks;
 }
@@ -6,27 +6,82 @@
 #include <stdint.h>
 /* FreeRTOS headers */
 #include "FreeRTOS.h"
-#include "queue.h"
+#include "rtos_osal.h"
 #include "src.h"
 
-typedef struct
-{
-    /* data */
-    int32_t *input_samples;
-    int32_t *output_samples;
-    uint64_t fs_ratio;
-    unsigned i2s_sampling_rate;
-}asrc_process_frame_ctx_t;
+#ifndef ASRC_POOL_MAX_CHANNELS
+#define ASRC_POOL_MAX_CHANNELS       (8)
+#endif
+
+#ifndef ASRC_POOL_MAX_WORKERS
+#define ASRC_POOL_MAX_WORKERS        (4)
+#endif
+
+// One bank per supported rate plus a spare for rates that have not been prepared
+#ifndef ASRC_POOL_MAX_BANKS
+#define ASRC_POOL_MAX_BANKS          (ASRC_NUM_SUPPORTED_RATES + 1)
+#endif
+
+// Length of the fade in applied to the output after switching rates
+#ifndef ASRC_POOL_RAMP_MS
+#define ASRC_POOL_RAMP_MS            (5)
+#endif
+
+#define ASRC_NUM_SUPPORTED_RATES     (6)
+extern const unsigned asrc_supported_rates[ASRC_NUM_SUPPORTED_RATES];
+
+typedef struct asrc_pool asrc_pool_t;
 
+/*
+ * A set of ASRC instances, one per channel, initialised for one pair of
+ * rates. Banks that are not in use are kept initialised so switching to
+ * them is only a pointer swap.
+ */
+typedef struct {
+    unsigned fs_in;
+    unsigned fs_out;
+    uint64_t nominal_fs_ratio;
+    int armed;                      // Set when the instances are freshly initialised and unused
+    asrc_ctrl_t *asrc_ctrl[ASRC_POOL_MAX_CHANNELS];
+}asrc_pool_bank_t;
 
 typedef struct {
-    uint32_t fs_in;
-    uint32_t fs_out;
-    uint32_t n_in_samples;
-    asrc_ctrl_t *asrc_ctrl_ptr;
-    rtos_osal_queue_t asrc_queue;
-    rtos_osal_queue_t asrc_ret_queue;
-}asrc_init_t;
+    asrc_pool_t *pool;
+    unsigned first_ch;              // First channel processed by this worker
+    unsigned num_ch;                // Number of channels processed by this worker
+    unsigned n_samps_out;           // Output samples per channel for the last block
+    uint32_t last_ticks;            // Reference timer ticks taken for the last block
+    uint32_t max_ticks;             // Maximum reference timer ticks taken for any block
+    rtos_osal_semaphore_t start_sem;
+}asrc_pool_worker_t;
+
+/*
+ * A pool of workers that split the channels of each block between them.
+ * Worker 0 is the thread calling asrc_pool_process(), the remaining workers
+ * are threads created by asrc_pool_create(). asrc_pool_process() returns once
+ * every worker has finished its share of the block.
+ */
+struct asrc_pool {
+    unsigned num_channels;
+    unsigned num_workers;
+    unsigned n_in_samples;
+    int *asrc_stack[ASRC_POOL_MAX_CHANNELS];   // Shared by every bank
+    asrc_pool_bank_t bank[ASRC_POOL_MAX_BANKS];
+    unsigned num_banks;
+    asrc_pool_bank_t *active;       // Bank used by asrc_pool_process()
+    asrc_pool_bank_t *rearm;        // Bank to reinitialise during the next asrc_pool_process()
+    unsigned ramp_samples;          // Length of the fade in, in output samples
+    unsigned ramp_pos;              // Output samples processed since the last rate switch
+    asrc_pool_worker_t worker[ASRC_POOL_MAX_WORKERS];
+    rtos_osal_semaphore_t done_sem;
+
+    // Current block, valid while asrc_pool_process() is running
+    int32_t *input_samples;         // [num_channels][input_stride]
+    unsigned input_stride;
+    int32_t *output_samples;        // [num_channels][output_stride]
+    unsigned output_stride;
+    uint64_t fs_ratio;
+};
 
 #define USB_TO_I2S_ASRC_BLOCK_LENGTH (96)
 #define I2S_TO_USB_ASRC_BLOCK_LENGTH (244)  // Found out from simulation. Relatively jitter free average buffer levels seen with 244 samples block than 240 samples block size
@@ -35,6 +90,58 @@ typedef struct {
 #define ASRC_DITHER_SETTING          OFF
 
 fs_code_t samp_rate_to_code(unsigned samp_rate);
-void asrc_one_channel_task(void *args);
+
+/**
+ * Create an ASRC worker pool. Allocates the ASRC state for each channel and
+ * creates num_workers - 1 worker threads at the given priority.
+ *
+ * \param pool          Pool to initialise
+ * \param num_channels  Number of channels per block, at most ASRC_POOL_MAX_CHANNELS
+ * \param num_workers   Number of workers including the calling thread, at most ASRC_POOL_MAX_WORKERS
+ * \param n_in_samples  Number of input samples per channel per block
+ * \param priority      Priority of the worker threads
+ */
+void asrc_pool_create(asrc_pool_t *pool, unsigned num_channels, unsigned num_workers, unsigned n_in_samples, unsigned priority);
+
+/**
+ * Allocate and initialise a bank of ASRC instances for a pair of rates, so
+ * that a later switch to these rates with asrc_pool_init() does not need to
+ * call asrc_init(). Call after asrc_pool_create() and before processing starts.
+ */
+void asrc_pool_prepare(asrc_pool_t *pool, unsigned fs_in, unsigned fs_out);
+
+/**
+ * Switch the ASRC instances of every channel to a new pair of rates.
+ *
+ * If the rates have been prepared with asrc_pool_prepare() this swaps to the
+ * already initialised bank, and the bank being left is reinitialised in the
+ * background by the workers during the next block. Otherwise the instances
+ * are initialised here with asrc_init(). Either way the output of the
+ * following ASRC_POOL_RAMP_MS is faded in from silence.
+ *
+ * \returns the nominal fs ratio
+ */
+uint64_t asrc_pool_init(asrc_pool_t *pool, unsigned fs_in, unsigned fs_out);
+
+/**
+ * Run ASRC on one block of samples for every channel.
+ *
+ * \param input_samples   Deinterleaved input samples, input_stride samples apart per channel
+ * \param output_samples  Deinterleaved output samples, output_stride samples apart per channel
+ * \param fs_ratio        fs ratio passed to asrc_process()
+ *
+ * \returns the number of output samples per channel
+ */
+unsigned asrc_pool_process(asrc_pool_t *pool, int32_t *input_samples, unsigned input_stride, int32_t *output_samples, unsigned output_stride, uint64_t fs_ratio);
+
+/**
+ * \returns the longest time, in reference timer ticks, any worker has taken to process its share of a block
+ */
+uint32_t asrc_pool_max_ticks(asrc_pool_t *pool);
+
+/**
+ * \returns the longest time, in reference timer ticks, any worker took to process its share of the last block
+ */
+uint32_t asrc_pool_last_ticks(asrc_pool_t *pool);
 
 #endif
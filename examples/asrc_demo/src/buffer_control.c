@@ -0,0 +1,100 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "buffer_control.h"
+
+buffer_control_gains_t buffer_control_get_gains(buffer_control_dir_t dir, uint32_t nominal_i2s_rate)
+{
+    // The Kp constants are generated using the simulation framework empirically, to get values using which
+    // the calculated correction factor stablises the buffer level.
+    buffer_control_gains_t gains = {0, 0};
+    if((nominal_i2s_rate == 44100) || (nominal_i2s_rate == 48000))
+    {
+        gains.Kp = (dir == BUFFER_CONTROL_USB_BUF) ? KP_USB_BUF_CONTROL_FS48 : KP_I2S_BUF_CONTROL_FS48;
+        gains.Ki = (dir == BUFFER_CONTROL_USB_BUF) ? KI_USB_BUF_CONTROL_FS48 : KI_I2S_BUF_CONTROL_FS48;
+    }
+    else if((nominal_i2s_rate == 88200) || (nominal_i2s_rate == 96000))
+    {
+        gains.Kp = (dir == BUFFER_CONTROL_USB_BUF) ? KP_USB_BUF_CONTROL_FS96 : KP_I2S_BUF_CONTROL_FS96;
+        gains.Ki = (dir == BUFFER_CONTROL_USB_BUF) ? KI_USB_BUF_CONTROL_FS96 : KI_I2S_BUF_CONTROL_FS96;
+    }
+    else if((nominal_i2s_rate == 176400) || (nominal_i2s_rate == 192000))
+    {
+        gains.Kp = (dir == BUFFER_CONTROL_USB_BUF) ? KP_USB_BUF_CONTROL_FS192 : KP_I2S_BUF_CONTROL_FS192;
+        gains.Ki = (dir == BUFFER_CONTROL_USB_BUF) ? KI_USB_BUF_CONTROL_FS192 : KI_I2S_BUF_CONTROL_FS192;
+    }
+#if !BUFFER_CONTROL_ENABLE_INTEGRAL
+    gains.Ki = 0;
+#endif
+    return gains;
+}
+
+void buffer_control_init(buffer_control_state_t *state, buffer_control_gains_t gains, int64_t max_correction)
+{
+    memset(state, 0, sizeof(buffer_control_state_t));
+    state->gains = gains;
+    state->max_correction = max_correction;
+}
+
+int64_t buffer_control_update(buffer_control_state_t *state, int32_t error)
+{
+    int32_t kp_shift = 0;
+
+    if(state->fast_lock)
+    {
+        // Leave fast lock once the buffer level reaches or crosses the target
+        if((error == 0) || ((error > 0) && (state->prev_error < 0)) || ((error < 0) && (state->prev_error > 0)))
+        {
+            state->fast_lock = false;
+        }
+    }
+    else if((BUFFER_CONTROL_FAST_LOCK_BAND > 0) &&
+            ((error > BUFFER_CONTROL_FAST_LOCK_BAND) || (error < -BUFFER_CONTROL_FAST_LOCK_BAND)))
+    {
+        state->fast_lock = true;
+    }
+    if(state->fast_lock)
+    {
+        kp_shift = BUFFER_CONTROL_FAST_LOCK_KP_SHIFT;
+    }
+    state->prev_error = error;
+
+    // The integral term is accumulated in output units so changing gains when leaving fast lock doesn't cause a step
+    int64_t i_limit = state->max_correction >> 8;
+    int64_t i_term = state->i_term + (((int64_t)state->gains.Ki * (int64_t)error) << (2 * kp_shift));
+    if(i_term > i_limit)
+    {
+        i_term = i_limit;
+    }
+    else if(i_term < -i_limit)
+    {
+        i_term = -i_limit;
+    }
+
+    int64_t p_term = ((int64_t)state->gains.Kp * (int64_t)error) << kp_shift;
+    int64_t total_error = (p_term + i_term) << 8;
+
+    if(total_error > state->max_correction)
+    {
+        total_error = state->max_correction;
+        // Anti-windup, don't integrate further into saturation
+        if(error > 0)
+        {
+            i_term = state->i_term;
+        }
+    }
+    else if(total_error < -(state->max_correction))
+    {
+        total_error = -(state->max_correction);
+        if(error < 0)
+        {
+            i_term = state->i_term;
+        }
+    }
+    state->i_term = i_term;
+
+    return total_error;
+}
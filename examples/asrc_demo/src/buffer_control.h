@@ -0,0 +1,107 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#ifndef BUFFER_CONTROL_H
+#define BUFFER_CONTROL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+typedef int32_t sw_pll_q24_t; // Type for 8.24 signed fixed point
+#define SW_PLL_NUM_FRAC_BITS 24
+#define SW_PLL_Q24(val) ((sw_pll_q24_t)((double)val * (1 << SW_PLL_NUM_FRAC_BITS)))
+
+// Kp constants for I2S buffer based control for the USB -> ASRC -> (buffer) -> I2S direction.
+#define KP_I2S_BUF_CONTROL_FS48     (SW_PLL_Q24(11.542724608))      // 0.000000043 * (2**28)
+#define KP_I2S_BUF_CONTROL_FS96     (SW_PLL_Q24(5.905580032))       // 0.000000022 * (2**28)
+#define KP_I2S_BUF_CONTROL_FS192    (SW_PLL_Q24(3.2749125632))      // 0.0000000122 * (2**28)
+
+// Kp constants for USB buffer based control for the I2S -> ASRC -> (buffer) -> USB direction.
+#define KP_USB_BUF_CONTROL_FS48     (SW_PLL_Q24(4.563402752))      // 0.000000017 * (2**28)
+#define KP_USB_BUF_CONTROL_FS96     (SW_PLL_Q24(9.39524096))       // 0.000000035 * (2**28)
+#define KP_USB_BUF_CONTROL_FS192    (SW_PLL_Q24(18.79048192))      // 0.00000007* (2**28)
+
+// Ki constants, Ki = Kp / 2**BUFFER_CONTROL_KI_RATIO_LOG2. The buffer level integrates the rate error and the
+// controller is updated 128 times per average buffer level window, so 2**16 gives a damping ratio of 1 or more
+// for the Kp values above. 2**14 is underdamped and oscillates with a period of over an hour.
+#ifndef BUFFER_CONTROL_KI_RATIO_LOG2
+#define BUFFER_CONTROL_KI_RATIO_LOG2        (16)
+#endif
+#define BUFFER_CONTROL_KI(kp)               (SW_PLL_Q24((kp) / (1 << BUFFER_CONTROL_KI_RATIO_LOG2)))
+
+#define KI_I2S_BUF_CONTROL_FS48     BUFFER_CONTROL_KI(11.542724608)
+#define KI_I2S_BUF_CONTROL_FS96     BUFFER_CONTROL_KI(5.905580032)
+#define KI_I2S_BUF_CONTROL_FS192    BUFFER_CONTROL_KI(3.2749125632)
+
+#define KI_USB_BUF_CONTROL_FS48     BUFFER_CONTROL_KI(4.563402752)
+#define KI_USB_BUF_CONTROL_FS96     BUFFER_CONTROL_KI(9.39524096)
+#define KI_USB_BUF_CONTROL_FS192    BUFFER_CONTROL_KI(18.79048192)
+
+// Set to 0 for the original proportional only control
+#ifndef BUFFER_CONTROL_ENABLE_INTEGRAL
+#define BUFFER_CONTROL_ENABLE_INTEGRAL      (1)
+#endif
+
+// Fast lock is entered whenever the buffer level error is more than this many samples from the target,
+// and left when the error next reaches or crosses zero. Set to 0 to disable fast lock.
+#ifndef BUFFER_CONTROL_FAST_LOCK_BAND
+#define BUFFER_CONTROL_FAST_LOCK_BAND       (3)
+#endif
+
+// During fast lock Kp is scaled by 2**BUFFER_CONTROL_FAST_LOCK_KP_SHIFT and Ki by the square of that, to keep the same damping
+#ifndef BUFFER_CONTROL_FAST_LOCK_KP_SHIFT
+#define BUFFER_CONTROL_FAST_LOCK_KP_SHIFT   (3)
+#endif
+
+/// @brief Buffer whose level is being controlled
+typedef enum
+{
+    BUFFER_CONTROL_USB_BUF = 0, /// samples_to_host buffer, I2S -> ASRC -> USB direction
+    BUFFER_CONTROL_I2S_BUF,     /// I2S send buffer, USB -> ASRC -> I2S direction
+}buffer_control_dir_t;
+
+/// @brief Controller gains, in the same Q24 units as the original Kp constants
+typedef struct
+{
+    sw_pll_q24_t Kp;
+    sw_pll_q24_t Ki;
+}buffer_control_gains_t;
+
+/// @brief Structure containing persistant variables that make up the buffer level PI controller state
+typedef struct
+{
+    buffer_control_gains_t gains;
+    int64_t max_correction;     /// Limit on the magnitude of the returned correction
+    int64_t i_term;             /// Accumulated integral term, in units of Kp * error
+    int32_t prev_error;         /// Error passed to the last update, to detect the target being crossed
+    bool fast_lock;             /// Fast lock gains in use
+}buffer_control_state_t;
+
+/// @brief Look up the controller gains for a buffer and I2S rate
+/// @param dir                  Buffer being controlled
+/// @param nominal_i2s_rate     Nominal I2S sampling rate
+/// @return Gains for the rate. Ki is 0 if BUFFER_CONTROL_ENABLE_INTEGRAL is 0.
+buffer_control_gains_t buffer_control_get_gains(buffer_control_dir_t dir, uint32_t nominal_i2s_rate);
+
+/// @brief Initialise the controller. Clears the integral term.
+/// @param state            Pointer to the buffer_control_state_t state structure
+/// @param gains            Controller gains
+/// @param max_correction   Limit on the magnitude of the returned correction, as a fs ratio in Q28.32 format
+void buffer_control_init(buffer_control_state_t *state, buffer_control_gains_t gains, int64_t max_correction);
+
+/// @brief Calculate the fs ratio correction for the latest buffer level error.
+/// The integral term is clamped to max_correction and is not accumulated while the output is saturated
+/// in the direction of the error.
+/// @param state    Pointer to the buffer_control_state_t state structure
+/// @param error    Average buffer level minus the target level, in samples
+/// @return Correction to add to the fs ratio, in Q28.32 format
+int64_t buffer_control_update(buffer_control_state_t *state, int32_t error);
+
+#ifdef __cplusplus
+ }
+#endif
+#endif
@@ -26,6 +26,7 @@
 #include "platform/driver_instances.h"
 #include "src.h"
 #include "asrc_utils.h"
+#include "asrc_telemetry.h"
 #include "i2s_audio.h"
 #include "rate_server.h"
 #include "tusb_config.h"
@@ -46,46 +47,15 @@ static void i2s_audio_recv_task(void *args)
 {
     (void)args;
 
-    // Create the 2nd channel ASRC task
-    asrc_process_frame_ctx_t asrc_ctx;
-
-    // 1 ASRC instance per channel, so 2 for 2 channels. Each ASRC instance processes one channel
-    asrc_state_t     asrc_state[NUM_I2S_CHANS][ASRC_CHANNELS_PER_INSTANCE]; //ASRC state machine state
-    int              asrc_stack[NUM_I2S_CHANS][ASRC_CHANNELS_PER_INSTANCE][ASRC_STACK_LENGTH_MULT * I2S_TO_USB_ASRC_BLOCK_LENGTH]; //Buffer between filter stages
-    asrc_ctrl_t      asrc_ctrl[NUM_I2S_CHANS][ASRC_CHANNELS_PER_INSTANCE];  //Control structure
-    asrc_adfir_coefs_t asrc_adfir_coefs[NUM_I2S_CHANS];
-
-    for(int ch=0; ch<NUM_I2S_CHANS; ch++)
+    // Channels are split between appconfI2S_TO_USB_ASRC_WORKERS threads, including this one
+    static asrc_pool_t asrc_pool;
+    asrc_pool_create(&asrc_pool, NUM_I2S_CHANS, appconfI2S_TO_USB_ASRC_WORKERS, I2S_TO_USB_ASRC_BLOCK_LENGTH, appconfAUDIO_PIPELINE_TASK_PRIORITY);
+#if appconfASRC_PREPARE_ALL_RATES
+    for(int i=0; i<ASRC_NUM_SUPPORTED_RATES; i++)
     {
-        for(int ui = 0; ui < ASRC_CHANNELS_PER_INSTANCE; ui++)
-        {
-            //Set state, stack and coefs into ctrl structure
-            asrc_ctrl[ch][ui].psState                   = &asrc_state[ch][ui];
-            asrc_ctrl[ch][ui].piStack                   = asrc_stack[ch][ui];
-            asrc_ctrl[ch][ui].piADCoefs                 = asrc_adfir_coefs[ch].iASRCADFIRCoefs;
-        }
+        asrc_pool_prepare(&asrc_pool, asrc_supported_rates[i], appconfUSB_AUDIO_SAMPLE_RATE);
     }
-
-    //Initialise ASRC
-
-    // Create init ctx for the ch1 asrc running in another thread
-    asrc_init_t asrc_init_ctx;
-    asrc_init_ctx.fs_in = 0; // I2S rate is detected at runtime
-    asrc_init_ctx.fs_out = appconfUSB_AUDIO_SAMPLE_RATE;
-    asrc_init_ctx.n_in_samples = I2S_TO_USB_ASRC_BLOCK_LENGTH;
-    asrc_init_ctx.asrc_ctrl_ptr = &asrc_ctrl[1][0];
-    (void) rtos_osal_queue_create(&asrc_init_ctx.asrc_queue, "asrc_q", 1, sizeof(asrc_process_frame_ctx_t*));
-    (void) rtos_osal_queue_create(&asrc_init_ctx.asrc_ret_queue, "asrc_ret_q", 1, sizeof(int));
-
-    rtos_osal_thread_t asrc_ch1_thread;
-    // Create 2nd channel ASRC task
-    (void) rtos_osal_thread_create(
-        (rtos_osal_thread_t *) &asrc_ch1_thread,
-        (char *) "ASRC_1ch",
-        (rtos_osal_entry_function_t) asrc_one_channel_task,
-        (void *) (&asrc_init_ctx),
-        (size_t) RTOS_THREAD_STACK_SIZE(asrc_one_channel_task),
-        (unsigned int) appconfAUDIO_PIPELINE_TASK_PRIORITY);
+#endif
 
     // Keep receiving and discarding from I2S till we get a valid sampling rate
     int32_t input_data[I2S_TO_USB_ASRC_BLOCK_LENGTH][NUM_I2S_CHANS];
@@ -93,14 +63,10 @@ static void i2s_audio_recv_task(void *args)
     uint32_t i2s_sampling_rate = 0;
     uint32_t new_i2s_sampling_rate = 0;
 
-    // Initialise CH0 ASRC context
-    fs_code_t in_fs_code;
-    fs_code_t out_fs_code;
-
     int32_t frame_samples[NUM_I2S_CHANS][I2S_TO_USB_ASRC_BLOCK_LENGTH*2];
     int32_t frame_samples_interleaved[I2S_TO_USB_ASRC_BLOCK_LENGTH*2][NUM_I2S_CHANS];
-#if PROFILE_ASRC
-    uint32_t max_time = 0;
+#if appconfASRC_TELEMETRY_ENABLED
+    asrc_telemetry_t *telemetry = asrc_telemetry_get(ASRC_TELEMETRY_I2S_TO_USB);
 #endif
     uint64_t nominal_fs_ratio = 0;
     for(;;)
@@ -117,16 +83,17 @@ static void i2s_audio_recv_task(void *args)
             set_i2s_to_usb_rate_ratio(0); // Since this is updated only at rate monitor trigger interval, set it to 0 so
                                          //we don't end up using the wrong ratio till its updated in the rate monitor
             i2s_sampling_rate = new_i2s_sampling_rate;
-            asrc_init_ctx.fs_in = i2s_sampling_rate;
-            in_fs_code = samp_rate_to_code(asrc_init_ctx.fs_in);  //Sample rate code 0..5
-            out_fs_code = samp_rate_to_code(asrc_init_ctx.fs_out);
 
-            // Reinitialise both channel ASRCs
-            nominal_fs_ratio = asrc_init(in_fs_code, out_fs_code, &asrc_ctrl[0][0], ASRC_CHANNELS_PER_INSTANCE, asrc_init_ctx.n_in_samples, ASRC_DITHER_SETTING);
-            nominal_fs_ratio = asrc_init(in_fs_code, out_fs_code, &asrc_ctrl[1][0], ASRC_CHANNELS_PER_INSTANCE, asrc_init_ctx.n_in_samples, ASRC_DITHER_SETTING);
+            // Reinitialise all channel ASRCs
+            nominal_fs_ratio = asrc_pool_init(&asrc_pool, i2s_sampling_rate, appconfUSB_AUDIO_SAMPLE_RATE);
+#if appconfASRC_TELEMETRY_ENABLED
+            asrc_telemetry_set_deadline(telemetry, I2S_TO_USB_ASRC_BLOCK_LENGTH, i2s_sampling_rate);
+#endif
 
-            // We're too late to do the asrc_process(), skip this frame
+#if !appconfASRC_PREPARE_ALL_RATES
+            // We're too late to do the asrc_process() after asrc_init(), skip this frame
             continue;
+#endif
         }
         uint64_t current_rate_ratio = nominal_fs_ratio;
         uint64_t rate_ratio = get_i2s_to_usb_rate_ratio();
@@ -143,30 +110,13 @@ static void i2s_audio_recv_task(void *args)
             }
         }
 
-        // Send to the other channel ASRC task
-        asrc_ctx.input_samples = &input_data_deinterleaved[1][0];
-        asrc_ctx.output_samples = &frame_samples[1][0];
-        asrc_ctx.fs_ratio = current_rate_ratio;
-        asrc_ctx.i2s_sampling_rate = i2s_sampling_rate;
-        asrc_process_frame_ctx_t *ptr = &asrc_ctx;
-
-#if PROFILE_ASRC
+#if appconfASRC_TELEMETRY_ENABLED
         uint32_t start = get_reference_time();
 #endif
-        (void) rtos_osal_queue_send(&asrc_init_ctx.asrc_queue, &ptr, RTOS_OSAL_WAIT_FOREVER);
-
-        // Call asrc on this block of samples. Reuse frame_samples now that its copied into aec_reference_audio_samples
-        unsigned n_samps_out = asrc_process((int *)&input_data_deinterleaved[0][0], (int *)&frame_samples[0][0], current_rate_ratio, &asrc_ctrl[0][0]);
-
-        // Wait for 2nd channel ASRC to finish
-        unsigned n_samps_out_ch1;
-        rtos_osal_queue_receive(&asrc_init_ctx.asrc_ret_queue, &n_samps_out_ch1, RTOS_OSAL_WAIT_FOREVER);
-
-        if(n_samps_out != n_samps_out_ch1)
-        {
-            rtos_printf("Error: I2S to USB ASRC. ch0 and ch1 returned different number of samples: ch0 %u, ch1 %u\n", n_samps_out, n_samps_out_ch1);
-            xassert(0);
-        }
+        unsigned n_samps_out = asrc_pool_process(&asrc_pool,
+                                                 &input_data_deinterleaved[0][0], I2S_TO_USB_ASRC_BLOCK_LENGTH,
+                                                 &frame_samples[0][0], I2S_TO_USB_ASRC_BLOCK_LENGTH*2,
+                                                 current_rate_ratio);
 
         for(int i=0; i<n_samps_out; i++)
         {
@@ -176,14 +126,8 @@ static void i2s_audio_recv_task(void *args)
             }
         }
 
-#if PROFILE_ASRC
-        uint32_t end = get_reference_time();
-        if(max_time < (end - start))
-        {
-            max_time = end - start;
-            printchar('i');
-            printuintln(max_time);
-        }
+#if appconfASRC_TELEMETRY_ENABLED
+        asrc_telemetry_record_block(telemetry, get_reference_time() - start, asrc_pool_last_ticks(&asrc_pool));
 #endif
 
         if (n_samps_out > 0) {
@@ -226,7 +170,7 @@ static unsigned usb_audio_recv(rtos_intertile_t *intertile_ctx,
             bytes_received);
 
         *frame_buffers = &frame_samples_interleaved[0][0];
-        return bytes_received >> 3; // Return number of 32bit samples per channel. 4bytes per samples and 2 channels
+        return bytes_received / (sizeof(int32_t) * CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX); // Return number of 32bit samples per channel
     }
     else
     {
@@ -293,9 +237,16 @@ static void usb_to_i2s_intertile(void *args) {
                 portMAX_DELAY);
 
             bool okay_to_send = rtos_i2s_get_okay_to_send(i2s_ctx);
-            int32_t i2s_buffer_level_from_half = rtos_i2s_get_send_buffer_level_wrt_half(i2s_ctx) / 2; // Per channel
+            int32_t i2s_buffer_level_from_half = rtos_i2s_get_send_buffer_level_wrt_half(i2s_ctx) / NUM_I2S_CHANS; // Per channel
 
             calc_avg_i2s_send_buffer_level(i2s_buffer_level_from_half, !okay_to_send);
+#if appconfASRC_TELEMETRY_ENABLED
+            if(okay_to_send)
+            {
+                // Only once the buffer has been refilled to half, otherwise the fill after every restart is recorded
+                asrc_telemetry_record_buffer_level(asrc_telemetry_get(ASRC_TELEMETRY_USB_TO_I2S), i2s_buffer_level_from_half);
+            }
+#endif
 
             // If we're not sending and buffer has become half full start sending again so we start at a very stable point
             if((okay_to_send == false) && (i2s_buffer_level_from_half >= 0))
@@ -0,0 +1,67 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#ifndef I2S_RATE_DETECT_H_
+#define I2S_RATE_DETECT_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#define I2S_RATE_DETECT_REF_CLOCK_HZ    (100000000)
+
+// Number of frame timestamps in the sliding window. Must be a power of 2.
+#ifndef I2S_RATE_DETECT_WINDOW
+#define I2S_RATE_DETECT_WINDOW          (32)
+#endif
+
+// Frame intervals needed in the window before the first classification
+#ifndef I2S_RATE_DETECT_MIN_FRAMES
+#define I2S_RATE_DETECT_MIN_FRAMES      (8)
+#endif
+
+// A frame period within TIGHT per mille of a nominal rate scores 2, within LOOSE per mille scores 1.
+// Anything further from every nominal rate takes 1 off the score, and the candidate is dropped when it reaches 0.
+#define I2S_RATE_DETECT_TIGHT_PERMILLE  (5)
+#define I2S_RATE_DETECT_LOOSE_PERMILLE  (20)
+
+// Score needed to report the first rate after init, and to move away from a rate once reported.
+// The higher score for a change gives hysteresis so a burst of jitter can't switch the reported rate.
+#ifndef I2S_RATE_DETECT_DECIDE_SCORE
+#define I2S_RATE_DETECT_DECIDE_SCORE    (16)
+#endif
+#ifndef I2S_RATE_DETECT_CHANGE_SCORE
+#define I2S_RATE_DETECT_CHANGE_SCORE    (64)
+#endif
+
+/// @brief State of the I2S sampling rate detector
+typedef struct
+{
+    uint32_t timestamps[I2S_RATE_DETECT_WINDOW]; /// Times of the latest frames, in reference timer ticks
+    uint32_t count;         /// Valid entries in timestamps
+    uint32_t index;         /// Entry written by the next frame
+    uint32_t rate;          /// Reported rate, 0 until the first decision
+    uint32_t candidate;     /// Rate being scored, 0 if none
+    uint32_t score;         /// Confidence in the candidate
+    uint32_t glitches;      /// Frame intervals rejected as too long, each restarts the window
+}i2s_rate_detect_t;
+
+/// @brief Clear the detector, including the reported rate
+/// @param rd   Pointer to the detector state
+void i2s_rate_detect_init(i2s_rate_detect_t *rd);
+
+/// @brief Add the time of the latest frame and update the reported rate.
+/// The period is measured over a sliding window of up to I2S_RATE_DETECT_WINDOW frames and classified against
+/// the nominal rates each frame. A rate is reported as soon as its score reaches I2S_RATE_DETECT_DECIDE_SCORE, so
+/// a clean clock is detected sooner than a jittery one. The reported rate is held while the period matches no rate.
+/// @param rd           Pointer to the detector state
+/// @param timestamp    Time of the frame, in reference timer ticks
+/// @return The reported rate, 0 if no rate has been detected yet
+uint32_t i2s_rate_detect_update(i2s_rate_detect_t *rd, uint32_t timestamp);
+
+#ifdef __cplusplus
+ }
+#endif
+#endif
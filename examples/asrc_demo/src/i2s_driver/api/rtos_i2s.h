@@ -14,6 +14,7 @@
 #include <xcore/clock.h>
 #include <xcore/port.h>
 #include "i2s.h"
+#include "i2s_rate_detect.h"
 
 #include "rtos_osal.h"
 #include "rtos_driver_rpc.h"
@@ -135,6 +136,7 @@ struct rtos_i2s_struct{
     uint32_t i2s_nominal_sampling_rate;
     uint32_t i2s_rate_monitor_window_length;  // Number of samples over which to average for calculating the average I2S rate
     uint32_t i2s_rate_monitor_window_timespan; // Timespan (in reference timer ticks) over which i2s_rate_monitor_window_length samples are received
+    i2s_rate_detect_t rate_detect;             // Detects i2s_nominal_sampling_rate from the frame times
 
     // Flag that the application uses to indicate to the I2S driver if it is okay to read from I2S send buffer
     // to do a send over I2S. This is used to ensure that the I2S send buffer is filled to a stable level before we start sending
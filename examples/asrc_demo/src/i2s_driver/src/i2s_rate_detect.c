@@ -0,0 +1,120 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#include <stdint.h>
+#include <string.h>
+
+#include "i2s_rate_detect.h"
+
+#define PERIOD_FRAC_BITS    (4)
+#define PERIOD_Q4(rate)     ((((uint32_t)I2S_RATE_DETECT_REF_CLOCK_HZ << PERIOD_FRAC_BITS) + ((rate) / 2)) / (rate))
+
+#if (I2S_RATE_DETECT_WINDOW & (I2S_RATE_DETECT_WINDOW - 1)) != 0
+#error "I2S_RATE_DETECT_WINDOW must be a power of 2"
+#endif
+
+static const uint32_t nominal_rates[] = {44100, 48000, 88200, 96000, 176400, 192000};
+static const uint32_t nominal_periods_q4[] = {PERIOD_Q4(44100), PERIOD_Q4(48000), PERIOD_Q4(88200),
+                                              PERIOD_Q4(96000), PERIOD_Q4(176400), PERIOD_Q4(192000)};
+#define NUM_RATES           (sizeof(nominal_rates) / sizeof(nominal_rates[0]))
+
+// Intervals over twice the longest nominal period are clock stops. Short intervals are not rejected, as jitter on
+// a fast clock can bring consecutive frames well within half a period. Only the ends of the window set the period.
+#define MAX_INTERVAL        (PERIOD_Q4(44100) >> (PERIOD_FRAC_BITS - 1))
+
+void i2s_rate_detect_init(i2s_rate_detect_t *rd)
+{
+    memset(rd, 0, sizeof(i2s_rate_detect_t));
+}
+
+uint32_t i2s_rate_detect_update(i2s_rate_detect_t *rd, uint32_t timestamp)
+{
+    const uint32_t mask = I2S_RATE_DETECT_WINDOW - 1;
+
+    if(rd->count > 0)
+    {
+        uint32_t interval = timestamp - rd->timestamps[(rd->index - 1) & mask];
+        if(interval > MAX_INTERVAL)
+        {
+            // Start a new window from this frame. The reported rate is kept.
+            rd->glitches += 1;
+            rd->count = 0;
+            rd->candidate = 0;
+            rd->score = 0;
+        }
+    }
+
+    rd->timestamps[rd->index] = timestamp;
+    rd->index = (rd->index + 1) & mask;
+    if(rd->count < I2S_RATE_DETECT_WINDOW)
+    {
+        rd->count += 1;
+    }
+
+    uint32_t intervals = rd->count - 1;
+    if(intervals < I2S_RATE_DETECT_MIN_FRAMES)
+    {
+        return rd->rate;
+    }
+
+    // Jitter on each timestamp only affects the ends of the window, so the error falls as the window fills
+    uint32_t span = timestamp - rd->timestamps[(rd->index - rd->count) & mask];
+    uint32_t period_q4 = (span << PERIOD_FRAC_BITS) / intervals;
+
+    uint32_t best = 0;
+    uint32_t best_dev = UINT32_MAX;
+    for(unsigned i = 0; i < NUM_RATES; i++)
+    {
+        uint32_t dev = (period_q4 > nominal_periods_q4[i]) ? (period_q4 - nominal_periods_q4[i]) : (nominal_periods_q4[i] - period_q4);
+        if(dev < best_dev)
+        {
+            best_dev = dev;
+            best = i;
+        }
+    }
+
+    uint32_t points = 0;
+    if(best_dev * 1000 <= I2S_RATE_DETECT_TIGHT_PERMILLE * nominal_periods_q4[best])
+    {
+        points = 2;
+    }
+    else if(best_dev * 1000 <= I2S_RATE_DETECT_LOOSE_PERMILLE * nominal_periods_q4[best])
+    {
+        points = 1;
+    }
+
+    if(points == 0)
+    {
+        // Between rates, for example while the window spans a rate change or after a burst of jitter. Decay the
+        // score rather than clearing it, so occasional misses with a jittery clock don't restart the detection.
+        if(rd->score > 0)
+        {
+            rd->score -= 1;
+        }
+        if(rd->score == 0)
+        {
+            rd->candidate = 0;
+        }
+        return rd->rate;
+    }
+
+    if(nominal_rates[best] == rd->candidate)
+    {
+        if(rd->score < I2S_RATE_DETECT_CHANGE_SCORE)
+        {
+            rd->score += points;
+        }
+    }
+    else
+    {
+        rd->candidate = nominal_rates[best];
+        rd->score = points;
+    }
+
+    uint32_t threshold = (rd->rate == 0) ? I2S_RATE_DETECT_DECIDE_SCORE : I2S_RATE_DETECT_CHANGE_SCORE;
+    if((rd->candidate != rd->rate) && (rd->score >= threshold))
+    {
+        rd->rate = rd->candidate;
+    }
+    return rd->rate;
+}
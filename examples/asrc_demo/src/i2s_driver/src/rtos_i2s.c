@@ -37,54 +37,6 @@ DEFINE_RTOS_INTERRUPT_CALLBACK(rtos_i2s_isr, arg)
     }
 }
 
-static inline bool in_range(uint32_t ticks, uint32_t ref)
-{
-    if((ticks >= (ref-5)) && (ticks <= (ref+5)))
-    {
-        return true;
-    }
-    else
-    {
-        return false;
-    }
-}
-
-static inline uint32_t detect_i2s_sampling_rate(uint32_t average_callback_ticks)
-{
-    if(in_range(average_callback_ticks, 2267))
-    {
-        return 44100;
-    }
-    else if(in_range(average_callback_ticks, 2083))
-    {
-        return 48000;
-    }
-    else if(in_range(average_callback_ticks, 1133))
-    {
-        return 88200;
-    }
-    else if(in_range(average_callback_ticks, 1041))
-    {
-        return 96000;
-    }
-    else if(in_range(average_callback_ticks, 566))
-    {
-        return 176400;
-    }
-    else if(in_range(average_callback_ticks, 520))
-    {
-        return 192000;
-    }
-    else if(average_callback_ticks == 0)
-    {
-        xassert(0);
-    }
-    printf("ERROR: avg_callback_ticks %lu do not match any sampling rate!!\n", average_callback_ticks);
-    xassert(0);
-    return 0xffffffff;
-}
-
-
 static bool first_frame_after_restart = false;
 I2S_CALLBACK_ATTR
 static void i2s_init(rtos_i2s_t *ctx, i2s_config_t *i2s_config)
@@ -94,48 +46,24 @@ static void i2s_init(rtos_i2s_t *ctx, i2s_config_t *i2s_config)
     ctx->did_restart = true;
     ctx->i2s_nominal_sampling_rate = 0;
     ctx->i2s_rate_monitor_window_timespan = 0;
-
+    i2s_rate_detect_init(&ctx->rate_detect);
 }
 
 I2S_CALLBACK_ATTR
 static i2s_restart_t i2s_restart_check(rtos_i2s_t *ctx)
 {
-    static uint32_t frame_counter = 0;
-    static uint32_t nominal_rate_calc_timespan = 0;
-    static uint32_t i2s_callback_ticks = 0;
-    uint32_t i2s_prev_callback_ticks;
-
-    i2s_prev_callback_ticks = i2s_callback_ticks;
-    i2s_callback_ticks = get_reference_time();
+    uint32_t i2s_callback_ticks = get_reference_time();
 
     if(ctx->did_restart == true)
     {
         ctx->did_restart = false;
-        first_frame_after_restart = true;
-        frame_counter = 0;
-        nominal_rate_calc_timespan = 0;
-    }
-    else if(first_frame_after_restart == true)
-    {
-        // This is set to false in i2s_receive after it has reset averaging_window_sample_count and initialised averaging_window_start_timestamp
-    }
-    else // Start counting from the 2nd frame after restart once ctx->i2s_prev_callback_ticks also has a valid value
-    {
-        if(ctx->i2s_nominal_sampling_rate == 0) // only do it once after i2s_init
-        {
-            nominal_rate_calc_timespan += (i2s_callback_ticks - i2s_prev_callback_ticks);
-
-            frame_counter += 1;
-            if(frame_counter == 256) // Check over a 256 sample window to quickly get the nominal rate.
-            {
-                nominal_rate_calc_timespan = nominal_rate_calc_timespan >> 8;
-                ctx->i2s_nominal_sampling_rate  = detect_i2s_sampling_rate(nominal_rate_calc_timespan);
-                nominal_rate_calc_timespan = 0;
-                frame_counter = 0;
-            }
-        }
+        first_frame_after_restart = true; // Cleared in i2s_receive after it has restarted the rate monitor window
     }
 
+    // The detector keeps running after the first decision so a rate change without a restart is also picked up.
+    // The nominal rate stays 0 until the first decision.
+    ctx->i2s_nominal_sampling_rate = i2s_rate_detect_update(&ctx->rate_detect, i2s_callback_ticks);
+
     return I2S_NO_RESTART;
 }
 
@@ -187,32 +187,15 @@ static float_s32_t determine_avg_I2S_rate_from_driver()
     return result;
 }
 
-static inline sw_pll_q24_t get_Kp_for_i2s_buffer_control(int32_t nominal_i2s_rate)
-{
-    // The Kp constants are generated using the simulation framework empirically, to get values using which
-    // the calculated correction factor stablises the buffer level.
-    sw_pll_q24_t Kp = 0;
-    if(((int)nominal_i2s_rate == (int)44100) || ((int)nominal_i2s_rate == (int)48000))
-    {
-        Kp = KP_I2S_BUF_CONTROL_FS48;
-    }
-    else if(((int)nominal_i2s_rate == (int)88200) || ((int)nominal_i2s_rate == (int)96000))
-    {
-        Kp = KP_I2S_BUF_CONTROL_FS96;
-    }
-    else if(((int)nominal_i2s_rate == (int)176400) || ((int)nominal_i2s_rate == (int)192000))
-    {
-        Kp = KP_I2S_BUF_CONTROL_FS192;
-    }
-    return Kp;
-}
-
 void rate_server(void *args)
 {
     static bool prev_spkr_itf_open = false;
     uint64_t usb_to_i2s_rate_ratio = 0;
     usb_to_i2s_rate_info_t usb_rate_info;
     i2s_to_usb_rate_info_t i2s_rate_info;
+    buffer_control_state_t i2s_buf_control;
+    bool i2s_buf_control_running = false;
+    uint32_t telemetry_reset_count = 0;
 
     for(;;)
     {
@@ -238,6 +221,15 @@ void rate_server(void *args)
         }
         prev_spkr_itf_open = usb_rate_info.spkr_itf_open;
 
+        if(usb_rate_info.telemetry_reset_count != telemetry_reset_count)
+        {
+            telemetry_reset_count = usb_rate_info.telemetry_reset_count;
+            for(int dir=0; dir<ASRC_TELEMETRY_NUM_DIRS; dir++)
+            {
+                asrc_telemetry_reset(asrc_telemetry_get(dir));
+            }
+        }
+
         // Compute I2S rate
         float_s32_t i2s_rate = determine_avg_I2S_rate_from_driver();
 
@@ -265,40 +257,46 @@ void rate_server(void *args)
         // Calculate usb_to_i2s_rate_ratio only when the host is playing data to the device
         if((i2s_rate.mant != 0) && (usb_rate.mant != 0) && (usb_rate_info.spkr_itf_open))
         {
-            const sw_pll_q24_t Kp = get_Kp_for_i2s_buffer_control(rtos_i2s_get_nominal_sampling_rate(i2s_ctx));
-            int64_t max_allowed_correction = (int64_t)1500 << 32;
             int64_t total_error = 0;
 
             uint64_t fs_ratio64 = float_div_u64_fixed_output_q_format(usb_rate, i2s_rate, 28+32);
 
             if(g_i2s_send_buf_state.flag_stable_avg)
             {
-                int64_t error_p = ((int64_t)Kp * (int64_t)(g_i2s_send_buf_state.avg_buffer_level - g_i2s_send_buf_state.stable_avg_level));
-                total_error = (int64_t)(error_p << 8);
-                if(total_error > max_allowed_correction)
-                {
-                    total_error = max_allowed_correction;
-                }
-                else if(total_error < -(max_allowed_correction))
+                // (Re)start the controller each time a new stable average level is found
+                if(!i2s_buf_control_running)
                 {
-                    total_error = -(max_allowed_correction);
+                    buffer_control_gains_t gains = buffer_control_get_gains(BUFFER_CONTROL_I2S_BUF, rtos_i2s_get_nominal_sampling_rate(i2s_ctx));
+                    buffer_control_init(&i2s_buf_control, gains, (int64_t)1500 << 32);
+                    i2s_buf_control_running = true;
                 }
+                total_error = buffer_control_update(&i2s_buf_control, g_i2s_send_buf_state.avg_buffer_level - g_i2s_send_buf_state.stable_avg_level);
 #if LOG_USB_TO_I2S_SIDE
             printint(g_i2s_send_buf_state.avg_buffer_level);
             printchar(',');
             printintln((int32_t)(total_error >> 32)); // Print the upper 32 bits of the correction
 #endif
             }
+            else
+            {
+                i2s_buf_control_running = false;
+            }
             usb_to_i2s_rate_ratio = fs_ratio64 + total_error;
 
         }
         else
         {
             usb_to_i2s_rate_ratio = (uint64_t)0;
+            i2s_buf_control_running = false;
         }
 
         // Notify USB tile of the usb_to_i2s rate ratio
         i2s_rate_info.usb_to_i2s_rate_ratio = usb_to_i2s_rate_ratio;
+        // and of the ASRC telemetry recorded on this tile
+        for(int dir=0; dir<ASRC_TELEMETRY_NUM_DIRS; dir++)
+        {
+            i2s_rate_info.telemetry[dir] = *asrc_telemetry_get(dir);
+        }
 
         rtos_intertile_tx(
             intertile_ctx,
@@ -3,6 +3,8 @@
 #ifndef RATE_SERVER_H
 #define RATE_SERVER_H
 #include "xmath/xmath.h"
+#include "buffer_control.h"
+#include "asrc_telemetry.h"
 
 void rate_server(void *args);
 
@@ -32,26 +34,14 @@ typedef struct
     bool mic_itf_open;
     bool spkr_itf_open;
 
+    uint32_t telemetry_reset_count;     // Incremented by the USB tile to clear the I2S tile's ASRC telemetry
 }usb_to_i2s_rate_info_t;
 
 typedef struct
 {
     /* data */
     uint64_t usb_to_i2s_rate_ratio;
+    asrc_telemetry_t telemetry[ASRC_TELEMETRY_NUM_DIRS];  // ASRC telemetry recorded on the I2S tile
 }i2s_to_usb_rate_info_t;
 
-typedef int32_t sw_pll_q24_t; // Type for 15.16 signed fixed point
-#define SW_PLL_NUM_FRAC_BITS 24
-#define SW_PLL_Q24(val) ((sw_pll_q24_t)((double)val * (1 << SW_PLL_NUM_FRAC_BITS)))
-
-// Kp constants for I2S buffer based control for the USB -> ASRC -> (buffer) -> I2S direction.
-#define KP_I2S_BUF_CONTROL_FS48     (SW_PLL_Q24(11.542724608))      // 0.000000043 * (2**28)
-#define KP_I2S_BUF_CONTROL_FS96     (SW_PLL_Q24(5.905580032))       // 0.000000022 * (2**28)
-#define KP_I2S_BUF_CONTROL_FS192    (SW_PLL_Q24(3.2749125632))      // 0.0000000122 * (2**28)
-
-// Kp constants for USB buffer based control for the I2S -> ASRC -> (buffer) -> USB direction.
-#define KP_USB_BUF_CONTROL_FS48     (SW_PLL_Q24(4.563402752))      // 0.000000017 * (2**28)
-#define KP_USB_BUF_CONTROL_FS96     (SW_PLL_Q24(9.39524096))       // 0.000000035 * (2**28)
-#define KP_USB_BUF_CONTROL_FS192    (SW_PLL_Q24(18.79048192))      // 0.00000007* (2**28)
-
 #endif
@@ -47,10 +47,12 @@
 
 #include "usb_audio.h"
 #include "asrc_utils.h"
+#include "asrc_telemetry.h"
 #include "rate_server.h"
 #include "dbcalc.h"
 #include "avg_buffer_level.h"
 #include "adaptive_rate_callback.h"
+#include "audio_frame_utils.h"
 
 // Audio controls
 // Current states
@@ -140,6 +142,87 @@ void XUD_UserResume(void)
     SetUserHostActive();
 }
 
+//--------------------------------------------------------------------+
+// ASRC telemetry
+//--------------------------------------------------------------------+
+#if appconfASRC_TELEMETRY_ENABLED
+// Copy of the telemetry recorded on the I2S tile, updated by usb_audio_send() at every rate exchange
+static asrc_telemetry_t remote_telemetry[ASRC_TELEMETRY_NUM_DIRS];
+static volatile uint32_t telemetry_reset_count = 0;
+
+static void asrc_telemetry_get_merged(asrc_telemetry_dir_t dir, asrc_telemetry_t *out)
+{
+    asrc_telemetry_merge(out, asrc_telemetry_get(dir), &remote_telemetry[dir]);
+}
+
+static void asrc_telemetry_reset_all(void)
+{
+    for(int dir = 0; dir < ASRC_TELEMETRY_NUM_DIRS; dir++)
+    {
+        asrc_telemetry_reset(asrc_telemetry_get(dir));
+        asrc_telemetry_reset(&remote_telemetry[dir]);
+    }
+    telemetry_reset_count += 1; // The I2S tile resets its copy when it sees the new count
+}
+
+static TaskHandle_t asrc_telemetry_print_handle;
+
+// Prints the telemetry when notified, so the USB callbacks don't wait for the prints
+static void asrc_telemetry_print_task(void *arg)
+{
+    (void) arg;
+    for(;;)
+    {
+        (void) ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        for(int dir = 0; dir < ASRC_TELEMETRY_NUM_DIRS; dir++)
+        {
+            asrc_telemetry_t merged;
+            asrc_telemetry_get_merged(dir, &merged);
+            asrc_telemetry_print(dir, &merged);
+        }
+    }
+}
+
+static void asrc_telemetry_dump(void)
+{
+    if(asrc_telemetry_print_handle != NULL)
+    {
+        xTaskNotifyGive(asrc_telemetry_print_handle);
+    }
+}
+
+// Invoked for vendor type control requests. ASRC_TELEMETRY_REQ_GET returns the telemetry for the direction
+// in wValue and ASRC_TELEMETRY_REQ_RESET clears both directions.
+bool tud_vendor_control_xfer_cb(uint8_t rhport, uint8_t stage, tusb_control_request_t const *request)
+{
+    // Buffer must stay valid until the data stage completes
+    static asrc_telemetry_t control_telemetry;
+
+    if (stage != CONTROL_STAGE_SETUP)
+    {
+        return true;
+    }
+    switch (request->bRequest)
+    {
+        case ASRC_TELEMETRY_REQ_GET:
+            if ((request->bmRequestType_bit.direction != TUSB_DIR_IN) || (request->wValue >= ASRC_TELEMETRY_NUM_DIRS))
+            {
+                return false;
+            }
+            asrc_telemetry_get_merged(request->wValue, &control_telemetry);
+            return tud_control_xfer(rhport, request, &control_telemetry,
+                                    TU_MIN(request->wLength, sizeof(control_telemetry)));
+
+        case ASRC_TELEMETRY_REQ_RESET:
+            asrc_telemetry_reset_all();
+            return tud_control_status(rhport, request);
+
+        default:
+            return false;
+    }
+}
+#endif
+
 //--------------------------------------------------------------------+
 // Device callbacks
 //--------------------------------------------------------------------+
@@ -156,6 +239,9 @@ void tud_umount_cb(void)
 {
     ClearUserHostActive();
     rtos_printf("USB unmounted\n");
+#if appconfASRC_TELEMETRY_ENABLED
+    asrc_telemetry_dump();
+#endif
 }
 
 // Invoked when usb bus is suspended
@@ -176,7 +262,7 @@ void tud_resume_cb(void)
 // Volume control
 //--------------------------------------------------------------------+
 // These are used by the dbtomult and fixed point volume scaling calcs
-#define USB_AUDIO_VOL_MUL_FRAC_BITS     29
+#define USB_AUDIO_VOL_MUL_FRAC_BITS     AUDIO_FRAME_GAIN_FRAC_BITS
 #define USB_AUDIO_VOLUME_FRAC_BITS      8
 
 // Volume feature unit range in decibels
@@ -238,19 +324,18 @@ static void init_volume_multipliers(void)
     }
 }
 
-static inline int32_t volume_scale(const uint32_t mul, const int32_t samp){
-    int64_t result = (int64_t)samp * (int64_t)mul;
-    return (int32_t)(result >> USB_AUDIO_VOL_MUL_FRAC_BITS);
-}
-
 //--------------------------------------------------------------------+
 // AUDIO Task
 //--------------------------------------------------------------------+
 
 #if CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_TX == 2
 typedef int16_t samp_t;
+#define usb_audio_frame_gain_interleaved    audio_frame_gain_interleaved_s16
+#define usb_audio_frame_deinterleave        audio_frame_deinterleave_s16
 #elif CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_TX == 4
 typedef int32_t samp_t;
+#define usb_audio_frame_gain_interleaved    audio_frame_gain_interleaved_s32
+#define usb_audio_frame_deinterleave        audio_frame_deinterleave_s32
 #else
 #error CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_TX must be either 2 or 4
 #endif
@@ -279,29 +364,10 @@ static inline int32_t get_avg_window_size_log2(uint32_t i2s_rate)
 }
 
 
-static inline sw_pll_q24_t get_Kp_for_usb_buffer_control(int32_t nominal_i2s_rate)
-{
-    // The Kp constants are generated using the simulation framework, largely through trial and error, to get values using which
-    // the calculated correction factor stablises the buffer level.
-    sw_pll_q24_t Kp = 0;
-    if(((int)nominal_i2s_rate == (int)44100) || ((int)nominal_i2s_rate == (int)48000))
-    {
-        Kp = KP_USB_BUF_CONTROL_FS48;
-    }
-    else if(((int)nominal_i2s_rate == (int)88200) || ((int)nominal_i2s_rate == (int)96000))
-    {
-        Kp = KP_USB_BUF_CONTROL_FS96;
-    }
-    else if(((int)nominal_i2s_rate == (int)176400) || ((int)nominal_i2s_rate == (int)192000))
-    {
-        Kp = KP_USB_BUF_CONTROL_FS192;
-    }
-    return Kp;
-}
-
 static inline int64_t calc_usb_buffer_based_correction(int32_t nominal_i2s_rate, buffer_calc_state_t *long_term_buf_state, buffer_calc_state_t *short_term_buf_state)
 {
-    sw_pll_q24_t Kp = get_Kp_for_usb_buffer_control(nominal_i2s_rate);
+    static buffer_control_state_t usb_buf_control;
+    static bool usb_buf_control_running = false;
     int64_t max_allowed_correction = (int64_t)1500 << 32;
     int64_t total_error = 0;
 
@@ -321,17 +387,17 @@ static inline int64_t calc_usb_buffer_based_correction(int32_t nominal_i2s_rate,
     }
     if(long_term_buf_state->flag_stable_avg == true)
     {
-        int64_t error_p = ((int64_t)Kp * (int64_t)(long_term_buf_state->avg_buffer_level - long_term_buf_state->stable_avg_level));
-
-        total_error = (int64_t)(error_p << 8);
-        if(total_error > max_allowed_correction)
+        // (Re)start the controller each time a new stable average level is found
+        if(!usb_buf_control_running)
         {
-            total_error = max_allowed_correction;
-        }
-        else if(total_error < -(max_allowed_correction))
-        {
-            total_error = -(max_allowed_correction);
+            buffer_control_init(&usb_buf_control, buffer_control_get_gains(BUFFER_CONTROL_USB_BUF, nominal_i2s_rate), max_allowed_correction);
+            usb_buf_control_running = true;
         }
+        total_error = buffer_control_update(&usb_buf_control, long_term_buf_state->avg_buffer_level - long_term_buf_state->stable_avg_level);
+    }
+    else
+    {
+        usb_buf_control_running = false;
     }
 
     return total_error;
@@ -353,24 +419,20 @@ void usb_audio_send(int32_t *frame_buffer_ptr, // buffer containing interleaved
 #endif
 
     samp_t usb_audio_in_frame[I2S_TO_USB_ASRC_BLOCK_LENGTH * 2][CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX];
-#if CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_TX == 2
-    const int src_32_shift = 16;
-#elif CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_TX == 4
-    const int src_32_shift = 0;
-#endif
 
     memset(usb_audio_in_frame, 0, sizeof(usb_audio_in_frame));
-    for (int i = 0; i < frame_count; i++)
-    {
-        for (int ch = 0; ch < num_chans; ch++)
-        {
-            usb_audio_in_frame[i][ch] = (volume_scale(vol_mul_d2h[ch % CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX], frame_buffer_ptr[i * 2 + ch])) >> src_32_shift;
-        }
-    }
+    usb_audio_frame_gain_interleaved(&usb_audio_in_frame[0][0], CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX,
+                                     frame_buffer_ptr, num_chans,
+                                     num_chans, frame_count, vol_mul_d2h);
     size_t usb_audio_in_size_bytes = frame_count * num_chans * sizeof(samp_t);
 
     usb_to_i2s_rate_info_t usb_rate_info;
     usb_rate_info.mic_itf_open = mic_interface_open;
+#if appconfASRC_TELEMETRY_ENABLED
+    usb_rate_info.telemetry_reset_count = telemetry_reset_count;
+#else
+    usb_rate_info.telemetry_reset_count = 0;
+#endif
     usb_rate_info.spkr_itf_open = spkr_interface_open;
     usb_rate_info.samples_to_host_buf_fill_level = 0;
     usb_rate_info.buffer_based_correction = (int64_t)0;
@@ -407,6 +469,12 @@ void usb_audio_send(int32_t *frame_buffer_ptr, // buffer containing interleaved
 
                 calc_avg_buffer_level(&long_term_buf_state, usb_buffer_level_from_half, !samples_to_host_buf_ready_to_read); // Keep resetting the buffer state till samples_to_host_buf_ready_to_read is true, i.e we start reading out of the samples_to_host buffer
                 calc_avg_buffer_level(&short_term_buf_state, usb_buffer_level_from_half, !samples_to_host_buf_ready_to_read);
+#if appconfASRC_TELEMETRY_ENABLED
+                if(samples_to_host_buf_ready_to_read)
+                {
+                    asrc_telemetry_record_buffer_level(asrc_telemetry_get(ASRC_TELEMETRY_I2S_TO_USB), usb_buffer_level_from_half);
+                }
+#endif
 
                 num_samples_to_host_buf_writes += 1;
                 if(num_samples_to_host_buf_writes % RATE_MONITOR_TRIGGER_INTERVAL == 0)
@@ -473,6 +541,13 @@ void usb_audio_send(int32_t *frame_buffer_ptr, // buffer containing interleaved
         // Update ratio only when both rates are valid
         g_usb_to_i2s_rate_ratio = i2s_rate_info.usb_to_i2s_rate_ratio;
 
+#if appconfASRC_TELEMETRY_ENABLED
+        // Drop the copy if the telemetry was reset while the exchange was in progress, it's from before the reset
+        if(usb_rate_info.telemetry_reset_count == telemetry_reset_count)
+        {
+            memcpy(remote_telemetry, i2s_rate_info.telemetry, sizeof(remote_telemetry));
+        }
+#endif
     }
 }
 
@@ -485,64 +560,29 @@ void usb_audio_send(int32_t *frame_buffer_ptr, // buffer containing interleaved
  */
 void usb_audio_out_asrc(void *arg)
 {
-
-#if CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_TX == 2
-    const int src_32_shift = 16;
-#elif CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_TX == 4
-    const int src_32_shift = 0;
-#endif
-
     rtos_intertile_t *intertile_ctx = (rtos_intertile_t *)arg;
 
-    // Initialise channel 0 ASRC instance
-    asrc_state_t asrc_state[CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX][ASRC_CHANNELS_PER_INSTANCE];                                               // ASRC state machine state
-    int asrc_stack[CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX][ASRC_CHANNELS_PER_INSTANCE][ASRC_STACK_LENGTH_MULT * USB_TO_I2S_ASRC_BLOCK_LENGTH]; // Buffer between filter stages
-    asrc_ctrl_t asrc_ctrl[CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX][ASRC_CHANNELS_PER_INSTANCE];                                                 // Control structure
-    asrc_adfir_coefs_t asrc_adfir_coefs[CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX];
-
-    for (int ch = 0; ch < CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX; ch++)
+    // Channels are split between appconfUSB_TO_I2S_ASRC_WORKERS threads, including this one
+    static asrc_pool_t asrc_pool;
+    asrc_pool_create(&asrc_pool, CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX, appconfUSB_TO_I2S_ASRC_WORKERS, USB_TO_I2S_ASRC_BLOCK_LENGTH, appconfAUDIO_PIPELINE_TASK_PRIORITY);
+#if appconfASRC_PREPARE_ALL_RATES
+    for (int i = 0; i < ASRC_NUM_SUPPORTED_RATES; i++)
     {
-        for (int ui = 0; ui < ASRC_CHANNELS_PER_INSTANCE; ui++)
-        {
-            // Set state, stack and coefs into ctrl structure
-            asrc_ctrl[ch][ui].psState = &asrc_state[ch][ui];
-            asrc_ctrl[ch][ui].piStack = asrc_stack[ch][ui];
-            asrc_ctrl[ch][ui].piADCoefs = asrc_adfir_coefs[ch].iASRCADFIRCoefs;
-        }
+        asrc_pool_prepare(&asrc_pool, appconfUSB_AUDIO_SAMPLE_RATE, asrc_supported_rates[i]);
     }
+#endif
 
-    // Initialise ASRC
-    //  Create init ctx for the ch1 asrc running in another thread
-    asrc_init_t asrc_init_ctx;
-    asrc_init_ctx.fs_in = appconfUSB_AUDIO_SAMPLE_RATE;
-    asrc_init_ctx.fs_out = 0; // Will be notified at runtime
-    asrc_init_ctx.n_in_samples = USB_TO_I2S_ASRC_BLOCK_LENGTH;
-    asrc_init_ctx.asrc_ctrl_ptr = &asrc_ctrl[1][0];
-    (void)rtos_osal_queue_create(&asrc_init_ctx.asrc_queue, "asrc_q", 1, sizeof(asrc_process_frame_ctx_t *));
-    (void)rtos_osal_queue_create(&asrc_init_ctx.asrc_ret_queue, "asrc_ret_q", 1, sizeof(int));
-
-    rtos_osal_thread_t asrc_ch1_thread;
-
-    // Create 2nd channel ASRC task
-    (void)rtos_osal_thread_create(
-        (rtos_osal_thread_t *)&asrc_ch1_thread,
-        (char *)"ASRC_1ch",
-        (rtos_osal_entry_function_t)asrc_one_channel_task,
-        (void *)(&asrc_init_ctx),
-        (size_t)RTOS_THREAD_STACK_SIZE(asrc_one_channel_task),
-        (unsigned int)appconfAUDIO_PIPELINE_TASK_PRIORITY);
-
-    fs_code_t in_fs_code;
-    fs_code_t out_fs_code;
+    uint32_t fs_out = 0; // Will be notified at runtime
     uint64_t nominal_fs_ratio;
-#if PROFILE_ASRC
-    uint32_t max_time = 0;
+#if appconfASRC_TELEMETRY_ENABLED
+    // The ASRC input is always at the USB rate so the deadline is fixed
+    asrc_telemetry_t *telemetry = asrc_telemetry_get(ASRC_TELEMETRY_USB_TO_I2S);
+    asrc_telemetry_set_deadline(telemetry, USB_TO_I2S_ASRC_BLOCK_LENGTH, appconfUSB_AUDIO_SAMPLE_RATE);
 #endif
 
     int32_t frame_samples[CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX][USB_TO_I2S_ASRC_BLOCK_LENGTH * 4 + USB_TO_I2S_ASRC_BLOCK_LENGTH];             // TODO calculate size properly
     int32_t frame_samples_interleaved[USB_TO_I2S_ASRC_BLOCK_LENGTH * 4 + USB_TO_I2S_ASRC_BLOCK_LENGTH][CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX]; // TODO calculate size properly
 
-    asrc_process_frame_ctx_t asrc_ctx;
     for (;;)
     {
         samp_t usb_audio_out_frame[USB_TO_I2S_ASRC_BLOCK_LENGTH][CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX];
@@ -561,20 +601,19 @@ void usb_audio_out_asrc(void *arg)
         {
             continue;
         }
-        if (asrc_init_ctx.fs_out != current_i2s_rate)
+        if (fs_out != current_i2s_rate)
         {
             // Time to initialise asrc
             g_usb_to_i2s_rate_ratio = (uint64_t)0;
-            asrc_init_ctx.fs_out = current_i2s_rate;
-            in_fs_code = samp_rate_to_code(asrc_init_ctx.fs_in); // Sample rate code 0..5
-            out_fs_code = samp_rate_to_code(asrc_init_ctx.fs_out);
-            rtos_printf("USB tile initialising ASRC for fs_in %lu, fs_out %lu\n", asrc_init_ctx.fs_in, asrc_init_ctx.fs_out);
-
-            // Initialise both channel ASRCs
-            nominal_fs_ratio = asrc_init(in_fs_code, out_fs_code, &asrc_ctrl[0][0], ASRC_CHANNELS_PER_INSTANCE, asrc_init_ctx.n_in_samples, ASRC_DITHER_SETTING);
-            nominal_fs_ratio = asrc_init(in_fs_code, out_fs_code, &asrc_ctrl[1][0], ASRC_CHANNELS_PER_INSTANCE, asrc_init_ctx.n_in_samples, ASRC_DITHER_SETTING);
-            // Skip this frame since we're too late anayway from 2 asrc_init() calls, each taking 12500 cycles
+            fs_out = current_i2s_rate;
+            rtos_printf("USB tile initialising ASRC for fs_in %lu, fs_out %lu\n", (uint32_t)appconfUSB_AUDIO_SAMPLE_RATE, fs_out);
+
+            // Initialise all channel ASRCs
+            nominal_fs_ratio = asrc_pool_init(&asrc_pool, appconfUSB_AUDIO_SAMPLE_RATE, fs_out);
+#if !appconfASRC_PREPARE_ALL_RATES
+            // Skip this frame since we're too late anayway from the asrc_init() calls, each taking 12500 cycles
             continue;
+#endif
         }
 
         uint64_t current_rate_ratio = nominal_fs_ratio;
@@ -583,58 +622,25 @@ void usb_audio_out_asrc(void *arg)
             current_rate_ratio = g_usb_to_i2s_rate_ratio;
         }
 
-#if PROFILE_ASRC
+#if appconfASRC_TELEMETRY_ENABLED
         uint32_t start = get_reference_time();
 #endif
 
-        for (int ch = 0; ch < CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX; ch++)
-        {
-            for (int i = 0; i < USB_TO_I2S_ASRC_BLOCK_LENGTH; i++)
-            {
-                usb_audio_out_frame_deinterleaved[ch][i] = usb_audio_out_frame[i][ch] << src_32_shift;
-                // This is taking 4 MIPS. Can be optimised if needed.
-                usb_audio_out_frame_deinterleaved[ch][i] = volume_scale(vol_mul_h2d[ch % CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX], usb_audio_out_frame_deinterleaved[ch][i]);
-            }
-        }
-
-        // Send to the other channel ASRC task
-        asrc_ctx.input_samples = &usb_audio_out_frame_deinterleaved[1][0];
-        asrc_ctx.output_samples = &frame_samples[1][0];
-        asrc_ctx.fs_ratio = current_rate_ratio;
-        asrc_process_frame_ctx_t *ptr = &asrc_ctx;
-
-
-        (void)rtos_osal_queue_send(&asrc_init_ctx.asrc_queue, &ptr, RTOS_OSAL_WAIT_FOREVER);
-
-        // Call asrc on this block of samples. Reuse frame_samples now that its copied into aec_reference_audio_samples
-
-        unsigned n_samps_out = asrc_process((int *)&usb_audio_out_frame_deinterleaved[0][0], (int *)&frame_samples[0][0], current_rate_ratio, &asrc_ctrl[0][0]);
-
-
-        unsigned n_samps_out_ch1;
-        rtos_osal_queue_receive(&asrc_init_ctx.asrc_ret_queue, &n_samps_out_ch1, RTOS_OSAL_WAIT_FOREVER);
-
-        if (n_samps_out != n_samps_out_ch1)
-        {
-            rtos_printf("Error: USB to I2S ASRC. ch0 and ch1 returned different number of samples: ch0 %u, ch1 %u\n", n_samps_out, n_samps_out_ch1);
-            xassert(0);
-        }
-
-        for (int ch = 0; ch < CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX; ch++)
-        {
-            for (int i = 0; i < n_samps_out; i++)
-            {
-                frame_samples_interleaved[i][ch] = frame_samples[ch][i];
-            }
-        }
-#if PROFILE_ASRC
-        uint32_t end = get_reference_time();
-        if(max_time < (end - start))
-        {
-            max_time = end - start;
-            printchar('u');
-            printuintln(max_time);
-        }
+        usb_audio_frame_deinterleave(&usb_audio_out_frame_deinterleaved[0][0], USB_TO_I2S_ASRC_BLOCK_LENGTH,
+                                     &usb_audio_out_frame[0][0], CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX,
+                                     CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX, USB_TO_I2S_ASRC_BLOCK_LENGTH,
+                                     vol_mul_h2d);
+
+        unsigned n_samps_out = asrc_pool_process(&asrc_pool,
+                                                 &usb_audio_out_frame_deinterleaved[0][0], USB_TO_I2S_ASRC_BLOCK_LENGTH,
+                                                 &frame_samples[0][0], USB_TO_I2S_ASRC_BLOCK_LENGTH * 4 + USB_TO_I2S_ASRC_BLOCK_LENGTH,
+                                                 current_rate_ratio);
+
+        audio_frame_interleave_s32(&frame_samples_interleaved[0][0], CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX,
+                                   &frame_samples[0][0], USB_TO_I2S_ASRC_BLOCK_LENGTH * 4 + USB_TO_I2S_ASRC_BLOCK_LENGTH,
+                                   CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX, n_samps_out, NULL);
+#if appconfASRC_TELEMETRY_ENABLED
+        asrc_telemetry_record_block(telemetry, get_reference_time() - start, asrc_pool_last_ticks(&asrc_pool));
 #endif
 
         /*
@@ -1300,6 +1306,9 @@ bool tud_audio_set_itf_close_EP_cb(uint8_t rhport,
 #endif
 
     rtos_printf("Close audio interface %d alt %d\n", itf, alt);
+#if appconfASRC_TELEMETRY_ENABLED
+    asrc_telemetry_dump();
+#endif
 
     return true;
 }
@@ -1348,7 +1357,7 @@ static void i2s_to_usb_intertile(void *args)
                     i2s_to_usb_samps_interleaved,
                     bytes_received);
 
-            usb_audio_send(&i2s_to_usb_samps_interleaved[0][0], (bytes_received >> 3), 2);
+            usb_audio_send(&i2s_to_usb_samps_interleaved[0][0], bytes_received / (sizeof(int32_t) * NUM_I2S_CHANS), NUM_I2S_CHANS);
         }
 
     }
@@ -1391,6 +1400,15 @@ void usb_audio_init(rtos_intertile_t *intertile_ctx,
 
     xTaskCreate((TaskFunction_t)usb_audio_out_asrc, "usb_audio_out_asrc", portTASK_STACK_DEPTH(usb_audio_out_asrc), intertile_ctx, priority, &usb_audio_out_asrc_handle);
 
+#if appconfASRC_TELEMETRY_ENABLED
+    xTaskCreate((TaskFunction_t) asrc_telemetry_print_task,
+            "asrc_telemetry_print",
+            RTOS_THREAD_STACK_SIZE(asrc_telemetry_print_task),
+            NULL,
+            appconfASRC_TELEMETRY_TASK_PRIORITY,
+            &asrc_telemetry_print_handle);
+#endif
+
 
     // Task for receiving audio from the i2s to usb tile
     xTaskCreate((TaskFunction_t) i2s_to_usb_intertile,
@@ -9,7 +9,7 @@ set(FFD_SRC_ROOT ${CMAKE_CURRENT_LIST_DIR})
 set(MODEL_LANGUAGE "english_usa")
 set(SENSORY_COMMAND_SEARCH_HEADER_FILE "${FFD_SRC_ROOT}/model/${MODEL_LANGUAGE}/command-pc62w-6.4.0-op10-prod-search.h")
 set(SENSORY_COMMAND_SEARCH_SOURCE_FILE "${FFD_SRC_ROOT}/model/${MODEL_LANGUAGE}/command-pc62w-6.4.0-op10-prod-search.c")
-set(SENSORY_COMMAND_NET_FILE "${FFD_SRC_ROOT}/model/${MODEL_LANGUAGE}/command-pc62w-6.4.0-op10-prod-net.bin.nibble_swapped")
+set(SENSORY_COMMAND_NET_FILE "${FFD_SRC_ROOT}/model/${MODEL_LANGUAGE}/command-pc62w-6.4.0-op10-prod-net.bin")
 
 #**********************
 # Gather Sources
@@ -52,8 +52,11 @@ math(EXPR FILESYSTEM_START_ADDRESS
     OUTPUT_FORMAT HEXADECIMAL
 )
 
+# The model partition starts on a flash sector boundary, so its aligned models
+# start on flash page boundaries
+set(MODEL_PARTITION_ALIGNMENT 0x1000)
 math(EXPR MODEL_START_ADDRESS
-    "${FILESYSTEM_START_ADDRESS} + ${FILESYSTEM_SIZE_BYTES}"
+    "((${FILESYSTEM_START_ADDRESS} + ${FILESYSTEM_SIZE_BYTES} + ${MODEL_PARTITION_ALIGNMENT} - 1) / ${MODEL_PARTITION_ALIGNMENT}) * ${MODEL_PARTITION_ALIGNMENT}"
     OUTPUT_FORMAT HEXADECIMAL
 )
 
@@ -65,7 +68,7 @@ math(EXPR FILESYSTEM_DATA_PARTITION_OFFSET
 )
 
 math(EXPR MODEL_DATA_PARTITION_OFFSET
-    "${FILESYSTEM_DATA_PARTITION_OFFSET} + ${FILESYSTEM_SIZE_BYTES}"
+    "${MODEL_START_ADDRESS} - ${CALIBRATION_PATTERN_START_ADDRESS}"
     OUTPUT_FORMAT DECIMAL
 )
 
@@ -101,6 +104,8 @@ set(APP_LINK_OPTIONS
 set(APP_COMMON_LINK_LIBRARIES
     sln_voice::app::ffd::ap
     sln_voice::app::asr::sensory
+    sln_voice::app::audio_frame_utils
+    sln_voice::app::telemetry
     sln_voice::app::ffd::xk_voice_l71
 )
 
@@ -148,9 +153,15 @@ set(FATFS_FILE ${TARGET_NAME}_fat.fs)
 set(FLASH_CAL_FILE ${LIB_QSPI_FAST_READ_ROOT_PATH}/lib_qspi_fast_read/calibration_pattern_nibble_swap.bin)
 
 add_custom_target(${MODEL_FILE} ALL
-    COMMAND ${CMAKE_COMMAND} -E copy ${SENSORY_COMMAND_NET_FILE} ${MODEL_FILE}
+    COMMAND python3 ${SOLUTION_VOICE_ROOT_PATH}/tools/model_pack/model_pack.py
+        --model net=${SENSORY_COMMAND_NET_FILE}
+        --align 256
+        --nibble-swap
+        --output ${MODEL_FILE}
+    DEPENDS
+        ${SENSORY_COMMAND_NET_FILE}
     COMMENT
-        "Copy Sensory NET file"
+        "Pack Sensory NET file into the model partition"
     VERBATIM
 )
 
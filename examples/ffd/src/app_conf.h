@@ -8,6 +8,7 @@
 #define appconfGPIO_T0_RPC_PORT                   1
 #define appconfGPIO_T1_RPC_PORT                   2
 #define appconfINTENT_MODEL_RUNNER_SAMPLES_PORT   3
+#define appconfINTENT_MODEL_RUNNER_CREDITS_PORT   6
 #define appconfI2C_MASTER_RPC_PORT                4
 #define appconfI2S_RPC_PORT                       5
 #define appconfINTENT_ENGINE_READY_SYNC_PORT      16
@@ -70,6 +71,103 @@
 #define appconfINTENT_TRANSPORT_DELAY_MS     50
 #endif
 
+/* Audio, in ms, kept to feed to the recognizer again after it finds the wake
+ * up phrase. Only the audio after the end of the phrase is re-fed. The
+ * recognizer restarts its search after each result, so without this the
+ * start of a command said straight after the wake up phrase can be lost.
+ * 0 to disable. */
+#ifndef appconfINTENT_WAKEWORD_REFEED_MS
+#define appconfINTENT_WAKEWORD_REFEED_MS    0
+#endif
+
+/* Skip ASR processing of audio that the audio pipeline's VNR estimator
+ * classifies as non-speech */
+#ifndef appconfINTENT_VNR_GATE_ENABLED
+#define appconfINTENT_VNR_GATE_ENABLED      0
+#endif
+
+/* VNR estimate, from 0 to 1, at or above which a frame is treated as speech */
+#ifndef appconfINTENT_VNR_GATE_THRESHOLD
+#define appconfINTENT_VNR_GATE_THRESHOLD    (0.25f)
+#endif
+
+/* Frames processed after the last speech frame, 34 frames is about 0.5s */
+#ifndef appconfINTENT_VNR_GATE_HANGOVER_FRAMES
+#define appconfINTENT_VNR_GATE_HANGOVER_FRAMES  34
+#endif
+
+/* Non-speech frames replayed to the ASR when speech starts, to cover the VNR estimator's onset delay */
+#ifndef appconfINTENT_VNR_GATE_LOOKBACK_FRAMES
+#define appconfINTENT_VNR_GATE_LOOKBACK_FRAMES  8
+#endif
+
+/* Frames between prints of the share of frames processed, 0 to disable */
+#ifndef appconfINTENT_VNR_GATE_STATS_FRAMES
+#define appconfINTENT_VNR_GATE_STATS_FRAMES     4000
+#endif
+
+/* What the audio pipeline to intent engine transport does when the intent
+ * engine falls behind and its frame queue is full:
+ *   0  drop the newest frame
+ *   1  drop the oldest queued frame
+ *   2  drop the oldest queued frame, then have the intent engine discard its
+ *      backlog down to appconfINTENT_TRANSPORT_CATCH_UP_FRAMES and restart
+ *      the ASR search */
+#ifndef appconfINTENT_TRANSPORT_POLICY
+#define appconfINTENT_TRANSPORT_POLICY          0
+#endif
+
+/* Frames left queued after a catch up */
+#ifndef appconfINTENT_TRANSPORT_CATCH_UP_FRAMES
+#define appconfINTENT_TRANSPORT_CATCH_UP_FRAMES 1
+#endif
+
+/* Frames the intent engine consumes before it returns their credits to the
+ * audio pipeline tile */
+#ifndef appconfINTENT_TRANSPORT_CREDIT_BATCH
+#define appconfINTENT_TRANSPORT_CREDIT_BATCH    1
+#endif
+
+/* Frames between prints of the transport statistics, 0 to disable */
+#ifndef appconfINTENT_TRANSPORT_STATS_FRAMES
+#define appconfINTENT_TRANSPORT_STATS_FRAMES    0
+#endif
+
+/* Milliseconds between prints of the model flash read statistics, 0 to disable */
+#ifndef appconfDEVMEM_FLASH_STATS_MS
+#define appconfDEVMEM_FLASH_STATS_MS            0
+#endif
+
+/* Milliseconds between samples of the queue and stream buffer occupancy
+ * reported by the telemetry service, built with MEM_ANALYSIS_ENABLED */
+#ifndef appconfTELEMETRY_SAMPLE_MS
+#define appconfTELEMETRY_SAMPLE_MS              10
+#endif
+
+/* Milliseconds between telemetry records, 0 to publish only when
+ * telemetry_publish_request() is called */
+#ifndef appconfTELEMETRY_PUBLISH_MS
+#define appconfTELEMETRY_PUBLISH_MS             5000
+#endif
+
+/* Milliseconds over which each core load reported by the telemetry service
+ * is measured */
+#ifndef appconfCPU_LOAD_WINDOW_MS
+#define appconfCPU_LOAD_WINDOW_MS               1000
+#endif
+
+/* Milliseconds the GPIO handler waits after a GPI change for contact bounce to
+ * settle before it reads the buttons */
+#ifndef appconfGPIO_DEBOUNCE_MS
+#define appconfGPIO_DEBOUNCE_MS                 20
+#endif
+
+/* Milliseconds between prints of the LED task wakeup count on tile 0 and the
+ * GPIO handler wakeup count on tile 1, 0 to disable */
+#ifndef appconfLED_WAKEUP_STATS_MS
+#define appconfLED_WAKEUP_STATS_MS              0
+#endif
+
 #ifndef appconfINTENT_I2C_OUTPUT_ENABLED
 #define appconfINTENT_I2C_OUTPUT_ENABLED   1
 #endif
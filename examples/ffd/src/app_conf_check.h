@@ -4,4 +4,20 @@
 #ifndef APP_CONF_CHECK_H_
 #define APP_CONF_CHECK_H_
 
+#if appconfINTENT_VNR_GATE_ENABLED && appconfAUDIO_PIPELINE_SKIP_IC_AND_VNR
+#error appconfINTENT_VNR_GATE_ENABLED requires the VNR estimate, appconfAUDIO_PIPELINE_SKIP_IC_AND_VNR must be 0
+#endif
+
+#if (appconfINTENT_TRANSPORT_POLICY < 0) || (appconfINTENT_TRANSPORT_POLICY > 2)
+#error appconfINTENT_TRANSPORT_POLICY must be 0, 1 or 2
+#endif
+
+#if (appconfCPU_LOAD_WINDOW_MS < 1) || (appconfCPU_LOAD_WINDOW_MS > 40000)
+#error appconfCPU_LOAD_WINDOW_MS must be from 1 to 40000
+#endif
+
+#if (appconfGPIO_DEBOUNCE_MS < 0) || (appconfGPIO_DEBOUNCE_MS > 1000)
+#error appconfGPIO_DEBOUNCE_MS must be from 0 to 1000
+#endif
+
 #endif /* APP_CONF_CHECK_H_ */
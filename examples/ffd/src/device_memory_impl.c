@@ -41,18 +41,46 @@ void devmem_free_local(void *ptr) {
     vPortFree(ptr);
 }
 
+#if appconfDEVMEM_FLASH_STATS_MS
+static struct {
+    uint32_t reads;         // devmem_read_ext calls for flash, one QSPI read each
+    uint32_t bytes;         // Bytes requested
+    uint32_t stall_ticks;   // Reference clock ticks spent in flash reads
+    uint32_t last_print;
+} flash_stats;
+
+static void flash_stats_update(size_t n, uint32_t start)
+{
+    uint32_t now = get_reference_time();
+
+    flash_stats.reads++;
+    flash_stats.bytes += n;
+    flash_stats.stall_ticks += now - start;
+    if (now - flash_stats.last_print >= appconfDEVMEM_FLASH_STATS_MS * 100000) {
+        rtos_printf("Model flash: %u reads, %u bytes, %u us stalled in %u ms\n",
+                    (unsigned) flash_stats.reads, (unsigned) flash_stats.bytes, (unsigned) (flash_stats.stall_ticks / 100),
+                    (unsigned) ((now - flash_stats.last_print) / 100000));
+        memset(&flash_stats, 0, sizeof(flash_stats));
+        flash_stats.last_print = now;
+    }
+}
+#endif
+
 __attribute__((fptrgroup("devmem_read_ext_fptr_grp")))
 void devmem_read_ext_local(void *dest, const void *src, size_t n) {
     //rtos_printf("devmem_read_ext_local  dest=0x%x    src=0x%x    size=%d\n", dest, src, n);
     if (IS_FLASH(src)) {
-        //uint32_t s = get_reference_time();
+#if appconfDEVMEM_FLASH_STATS_MS
+        uint32_t start = get_reference_time();
+#endif
         int retval = -1; 
         while (retval == -1) {
             // Need to subtract off XS1_SWMEM_BASE because qspi flash driver accounts for the offset
             retval = rtos_qspi_flash_fast_read_mode_ll(qspi_flash_ctx, (uint8_t *)dest, (unsigned)(src - XS1_SWMEM_BASE), n, qspi_fast_flash_read_transfer_raw);
         }
-        //uint32_t d = get_reference_time() - s;
-        //printf("%d, %0.01f (us), %0.04f (M/s)\n", n, d / 100.0f, (n / 1000000.0f ) / (d / 100000000.0f));
+#if appconfDEVMEM_FLASH_STATS_MS
+        flash_stats_update(n, start);
+#endif
     } else {
         memcpy(dest, src, n);
     }    
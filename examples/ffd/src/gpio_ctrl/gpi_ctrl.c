@@ -6,6 +6,7 @@
 
 #include "FreeRTOS.h"
 
+#include "app_conf.h"
 #include "platform/app_pll_ctrl.h"
 #include "gpio_ctrl/gpi_ctrl.h"
 
@@ -22,40 +23,93 @@ void gpio_gpi_toggled_cb(uint32_t gpio_val)
     }
 }
 
+/*
+ * The ISR only counts edges and wakes the handler task. The handler waits for
+ * the pins to settle for appconfGPIO_DEBOUNCE_MS and then reads the port, so
+ * the state it passes on is always the settled one. Edges during the wait
+ * are dropped, and an edge after the read starts another wait.
+ */
+typedef struct {
+    TaskHandle_t task;
+    volatile uint32_t edges;
+} gpi_isr_ctx_t;
+
+static gpi_isr_ctx_t gpi_isr_ctx;
+
 RTOS_GPIO_ISR_CALLBACK_ATTR
 static void gpio_callback(rtos_gpio_t *ctx, void *app_data, rtos_gpio_port_id_t port_id, uint32_t value)
 {
-    TaskHandle_t task = app_data;
+    gpi_isr_ctx_t *isr_ctx = app_data;
     BaseType_t yield_required = pdFALSE;
 
-    value = (~value) & GPIO_BITMASK;
-
-    xTaskNotifyFromISR(task, value, eSetValueWithOverwrite, &yield_required);
+    isr_ctx->edges++;
+    vTaskNotifyGiveFromISR(isr_ctx->task, &yield_required);
 
     portYIELD_FROM_ISR(yield_required);
 }
 
+#if appconfLED_WAKEUP_STATS_MS
+static void wakeup_stats_print(uint32_t wakeups, TickType_t elapsed)
+{
+    uint32_t edges = gpi_isr_ctx.edges;
+
+    gpi_isr_ctx.edges = 0;
+    rtos_printf("GPI wakeups over %u ms: gpio_handler %u for %u edges\n",
+                (unsigned) (elapsed * portTICK_PERIOD_MS), wakeups, edges);
+}
+#endif
+
 static void gpio_handler(rtos_gpio_t *gpio_ctx)
 {
-    uint32_t value;
     uint32_t gpio_val;
+    uint32_t last_input;
+    TickType_t timeout = portMAX_DELAY;
+#if appconfLED_WAKEUP_STATS_MS
+    /* The stats are printed from here as the LED task runs on the other tile */
+    const TickType_t stats_period = pdMS_TO_TICKS(appconfLED_WAKEUP_STATS_MS);
+    uint32_t wakeups = 0;
+    TickType_t stats_start = xTaskGetTickCount();
+#endif
 
     const rtos_gpio_port_id_t gpio_port = rtos_gpio_port(GPIO_PORT);
 
     rtos_gpio_port_enable(gpio_ctx, gpio_port);
 
-    rtos_gpio_isr_callback_set(gpio_ctx, gpio_port, gpio_callback, xTaskGetCurrentTaskHandle());
+    gpi_isr_ctx.task = xTaskGetCurrentTaskHandle();
+    last_input = (~rtos_gpio_port_in(gpio_ctx, gpio_port)) & GPIO_BITMASK;
+
+    rtos_gpio_isr_callback_set(gpio_ctx, gpio_port, gpio_callback, &gpi_isr_ctx);
     rtos_gpio_interrupt_enable(gpio_ctx, gpio_port);
 
     for (;;) {
-        xTaskNotifyWait(
-                0x00000000UL,    /* Don't clear notification bits on entry */
-                0xFFFFFFFFUL,    /* Reset full notification value on exit */
-                &value,          /* Pass out notification value into value */
-                portMAX_DELAY ); /* Wait indefinitely until next notification */
-
-        gpio_val = rtos_gpio_port_in(gpio_ctx, gpio_port);
-        gpio_gpi_toggled_cb(gpio_val);
+#if appconfLED_WAKEUP_STATS_MS
+        TickType_t stats_elapsed = xTaskGetTickCount() - stats_start;
+        timeout = (stats_elapsed < stats_period) ? stats_period - stats_elapsed : 0;
+#endif
+        /* Wait for the first edge of a change */
+        if (ulTaskNotifyTake(pdTRUE, timeout) != 0) {
+            vTaskDelay(pdMS_TO_TICKS(appconfGPIO_DEBOUNCE_MS));
+
+            /* Drop the bounce edges, then read the settled state */
+            ulTaskNotifyTake(pdTRUE, 0);
+            gpio_val = rtos_gpio_port_in(gpio_ctx, gpio_port);
+#if appconfLED_WAKEUP_STATS_MS
+            wakeups++;
+#endif
+
+            if (((~gpio_val) & GPIO_BITMASK) != last_input) {
+                last_input = (~gpio_val) & GPIO_BITMASK;
+                gpio_gpi_toggled_cb(gpio_val);
+            }
+        }
+
+#if appconfLED_WAKEUP_STATS_MS
+        if (xTaskGetTickCount() - stats_start >= stats_period) {
+            wakeup_stats_print(wakeups, xTaskGetTickCount() - stats_start);
+            wakeups = 0;
+            stats_start = xTaskGetTickCount();
+        }
+#endif
     }
 }
 
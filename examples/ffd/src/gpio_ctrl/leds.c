@@ -18,24 +18,8 @@
 
 #if ON_TILE(0)
 
-#define LED_BLINK_DELAY                 (500 / portTICK_PERIOD_MS)
-#define LED_FLICKER_DELAY               (100 / portTICK_PERIOD_MS)
-#define TASK_NOTIF_MASK_HBEAT_TIMER     0x00000010
-#define TASK_NOTIF_MASK_WAITING         0x00000080
-#define TASK_NOTIF_MASK_LISTEN          0x00000100
-#define TASK_NOTIF_MASK_END_OF_EVAL      0x00001000
-
-typedef enum led_state {
-    LED_OFF,
-    LED_ON,
-    LED_TOGGLE
-} led_state_t;
-
-typedef enum led_color {
-    LED_GREEN,
-    LED_RED,
-    LED_YELLOW, /* RED + GREEN */
-} led_color_t;
+#define LED_BLINK_MS        500
+#define LED_FLICKER_MS      100
 
 #if XK_VOICE_L71
 #define LED_GREEN_MASK      (1<<5)
@@ -60,161 +44,119 @@ typedef enum led_color {
 }
 #endif
 
-// Exclusively turn on the green LED. If the red LED is on, turn it off.
-#define green_led_xon()  {                                                  \
-    uint32_t val = rtos_gpio_port_in(gpio_ctx_t0, gpo_port);                \
-    val = (val & ~LED_GREEN_MASK) | LED_RED_MASK;                           \
-    rtos_gpio_port_out(gpio_ctx_t0, gpo_port, val);                         \
-}
-#define green_led_on()  {                                                   \
-    uint32_t val = rtos_gpio_port_in(gpio_ctx_t0, gpo_port);                \
-    rtos_gpio_port_out(gpio_ctx_t0, gpo_port, val &= ~LED_GREEN_MASK);      \
-}
-#define green_led_off()  {                                                  \
-    uint32_t val = rtos_gpio_port_in(gpio_ctx_t0, gpo_port);                \
-    rtos_gpio_port_out(gpio_ctx_t0, gpo_port, val |= LED_GREEN_MASK);       \
-}
-#define green_led_toggle() {                                                \
-    uint32_t val = rtos_gpio_port_in(gpio_ctx_t0, gpo_port);                \
-    rtos_gpio_port_out(gpio_ctx_t0, gpo_port, val ^= LED_GREEN_MASK);       \
-}
-
-// Exclusively toggle the green LED. If the red LED is on, turn it off.
-#define green_led_xtoggle()  {                                              \
-    uint32_t val = rtos_gpio_port_in(gpio_ctx_t0, gpo_port);                \
-    val = (val ^ LED_GREEN_MASK) | LED_RED_MASK;                            \
-    rtos_gpio_port_out(gpio_ctx_t0, gpo_port, val);                         \
-}
-
-// Exclusively turn on the red LED. If the green LED is on, turn it off.
-#define red_led_xon()  {                                                    \
-    uint32_t val = rtos_gpio_port_in(gpio_ctx_t0, gpo_port);                \
-    val = (val & ~LED_RED_MASK) | LED_GREEN_MASK;                           \
-    rtos_gpio_port_out(gpio_ctx_t0, gpo_port, val);                         \
-}
-#define red_led_on()  {                                                     \
-    uint32_t val = rtos_gpio_port_in(gpio_ctx_t0, gpo_port);                \
-    rtos_gpio_port_out(gpio_ctx_t0, gpo_port, val &= ~LED_RED_MASK);        \
-}
-#define red_led_off()  {                                                    \
-    uint32_t val = rtos_gpio_port_in(gpio_ctx_t0, gpo_port);                \
-    rtos_gpio_port_out(gpio_ctx_t0, gpo_port, val |= LED_RED_MASK);         \
-}
-#define red_led_toggle() {                                                  \
-    uint32_t val = rtos_gpio_port_in(gpio_ctx_t0, gpo_port);                \
-    rtos_gpio_port_out(gpio_ctx_t0, gpo_port, val ^= LED_RED_MASK);         \
-}
+/*
+ * A pattern is a list of steps, each lighting a set of LEDs for a time.
+ * The last step is followed by the first. A step with a duration of 0 is
+ * held until the next pattern is requested.
+ */
+typedef struct {
+    uint32_t on_mask;
+    uint32_t duration_ms;
+} led_step_t;
+
+typedef struct {
+    const led_step_t *steps;
+    size_t count;
+} led_pattern_t;
+
+typedef enum {
+    LED_PATTERN_WAITING,
+    LED_PATTERN_LISTENING,
+    LED_PATTERN_END_OF_EVAL,
+    LED_PATTERN_COUNT
+} led_pattern_id_t;
+
+static const led_step_t waiting_steps[] = {
+    {LED_GREEN_MASK, LED_BLINK_MS},
+    {0, LED_BLINK_MS},
+};
+static const led_step_t listening_steps[] = {
+    {LED_YELLOW_MASK, 0},
+};
+static const led_step_t end_of_eval_steps[] = {
+    {LED_RED_MASK, LED_FLICKER_MS},
+    {0, LED_FLICKER_MS},
+};
+
+static const led_pattern_t patterns[LED_PATTERN_COUNT] = {
+    [LED_PATTERN_WAITING] = {waiting_steps, sizeof(waiting_steps) / sizeof(waiting_steps[0])},
+    [LED_PATTERN_LISTENING] = {listening_steps, sizeof(listening_steps) / sizeof(listening_steps[0])},
+    [LED_PATTERN_END_OF_EVAL] = {end_of_eval_steps, sizeof(end_of_eval_steps) / sizeof(end_of_eval_steps[0])},
+};
 
-// Exclusively toggle the red LED. If the green LED is on, turn it off.
-#define red_led_xtoggle()  {                                                \
-    uint32_t val = rtos_gpio_port_in(gpio_ctx_t0, gpo_port);                \
-    val = (val ^ LED_RED_MASK) | LED_GREEN_MASK;                            \
-    rtos_gpio_port_out(gpio_ctx_t0, gpo_port, val);                         \
-}
+static TaskHandle_t ctx_led_task = NULL;
+static volatile led_pattern_id_t requested_pattern = LED_PATTERN_WAITING;
 
-#define yellow_led_on()  {                                                  \
-    uint32_t val = rtos_gpio_port_in(gpio_ctx_t0, gpo_port);                \
-    rtos_gpio_port_out(gpio_ctx_t0, gpo_port, val &= ~LED_YELLOW_MASK);     \
-}
-#define yellow_led_off()  {                                                 \
-    uint32_t val = rtos_gpio_port_in(gpio_ctx_t0, gpo_port);                \
-    rtos_gpio_port_out(gpio_ctx_t0, gpo_port, val |= LED_YELLOW_MASK);      \
-}
-#define yellow_led_toggle() {                                               \
-    uint32_t val = rtos_gpio_port_in(gpio_ctx_t0, gpo_port);                \
-    val = (val & LED_YELLOW_MASK) ? (val & ~LED_YELLOW_MASK) : (val | LED_YELLOW_MASK); \
-    rtos_gpio_port_out(gpio_ctx_t0, gpo_port, val);                         \
+static void led_pattern_request(led_pattern_id_t pattern)
+{
+    /* The pattern runs without the caller, so only a change needs a wakeup */
+    if (requested_pattern != pattern) {
+        requested_pattern = pattern;
+        xTaskNotifyGive(ctx_led_task);
+    }
 }
 
-static TaskHandle_t ctx_led_task = NULL;
-
-static void hbeat_tmr_callback(TimerHandle_t pxTimer)
+#if appconfLED_WAKEUP_STATS_MS
+static void wakeup_stats_print(uint32_t led_wakeups, TickType_t elapsed)
 {
-    xTaskNotify(ctx_led_task, TASK_NOTIF_MASK_HBEAT_TIMER, eSetBits);
+    rtos_printf("LED wakeups over %u ms: led_task %u\n",
+                (unsigned) (elapsed * portTICK_PERIOD_MS), led_wakeups);
 }
+#endif
 
 static void led_task(void *args)
 {
-    const uint32_t bits_to_clear_on_entry = 0x00000000UL;
-    const uint32_t bits_to_clear_on_exit = 0xFFFFFFFFUL;
     rtos_gpio_port_id_t gpo_port = 0;
-    led_state_t state = LED_TOGGLE;
-    led_color_t color = LED_GREEN;
-    uint32_t notif_value;
-    TimerHandle_t tmr_hbeat = xTimerCreate("tmr_hbeat",
-                                pdMS_TO_TICKS(LED_BLINK_DELAY), pdTRUE, NULL,
-                                hbeat_tmr_callback);
+    led_pattern_id_t pattern = requested_pattern;
+    size_t step = 0;
+    TickType_t step_start;
+    uint32_t port_val;
+#if appconfLED_WAKEUP_STATS_MS
+    uint32_t wakeups = 0;
+    TickType_t stats_start = xTaskGetTickCount();
+#endif
 
     gpo_setup();
-    xTimerStart(tmr_hbeat, 0);
-
-    while (1) {
-        xTaskNotifyWait(bits_to_clear_on_entry, bits_to_clear_on_exit,
-                        &notif_value, portMAX_DELAY);
-
-        /*
-         * Process the notification event data.
-         */
-        if (notif_value & TASK_NOTIF_MASK_WAITING) {
-            // Normal operation (heartbeat).
-            color = LED_GREEN;
-            state = LED_TOGGLE;
-            xTimerStart(tmr_hbeat, 0);
-        } else if (notif_value & TASK_NOTIF_MASK_LISTEN) {
-            // Wake word detected, listening for command.
-            xTimerStop(tmr_hbeat, 0);
-            color = LED_YELLOW;
-            state = LED_ON;
-        } else if (notif_value & TASK_NOTIF_MASK_END_OF_EVAL) {
-            color = LED_RED;
-            state = LED_TOGGLE;
-            xTimerChangePeriod(tmr_hbeat, pdMS_TO_TICKS(LED_FLICKER_DELAY), 0);
-            xTimerStart(tmr_hbeat, 0);
+
+    /* LEDs are active low. Other pins on the port keep their value. */
+    port_val = rtos_gpio_port_in(gpio_ctx_t0, gpo_port) | LED_YELLOW_MASK;
+    rtos_gpio_port_out(gpio_ctx_t0, gpo_port, port_val & ~patterns[pattern].steps[0].on_mask);
+    step_start = xTaskGetTickCount();
+
+    for (;;) {
+        const TickType_t duration = pdMS_TO_TICKS(patterns[pattern].steps[step].duration_ms);
+        TickType_t timeout = portMAX_DELAY;
+        uint32_t notified;
+
+        /* Sleep until the step ends, or a new pattern is requested */
+        if (duration > 0) {
+            TickType_t elapsed = xTaskGetTickCount() - step_start;
+            timeout = (elapsed < duration) ? duration - elapsed : 0;
         }
+        notified = ulTaskNotifyTake(pdTRUE, timeout);
+#if appconfLED_WAKEUP_STATS_MS
+        wakeups++;
+#endif
 
-        /*
-         * Update the LED indication.
-         */
-        if (color == LED_GREEN) {
-            switch (state) {
-            case LED_ON:
-                green_led_xon();
-                break;
-            case LED_TOGGLE:
-                green_led_xtoggle();
-                break;
-            case LED_OFF:
-            default:
-                green_led_off();
-                break;
-            }
-        } else if (color == LED_RED) {
-            switch (state) {
-            case LED_ON:
-                red_led_xon();
-                break;
-            case LED_TOGGLE:
-                red_led_xtoggle();
-                break;
-            case LED_OFF:
-            default:
-                red_led_off();
-                break;
-            }
-        } else if (color == LED_YELLOW) {
-            switch (state) {
-            case LED_ON:
-                yellow_led_on();
-                break;
-            case LED_TOGGLE:
-                yellow_led_toggle();
-                break;
-            case LED_OFF:
-            default:
-                yellow_led_off();
-                break;
-            }
+        if (notified && requested_pattern != pattern) {
+            pattern = requested_pattern;
+            step = 0;
+            step_start = xTaskGetTickCount();
+        } else if (duration > 0 && xTaskGetTickCount() - step_start >= duration) {
+            step = (step + 1) % patterns[pattern].count;
+            step_start += duration;
+        } else {
+            continue;
         }
+        rtos_gpio_port_out(gpio_ctx_t0, gpo_port, port_val & ~patterns[pattern].steps[step].on_mask);
+
+#if appconfLED_WAKEUP_STATS_MS
+        if (xTaskGetTickCount() - stats_start >= pdMS_TO_TICKS(appconfLED_WAKEUP_STATS_MS)) {
+            wakeup_stats_print(wakeups, xTaskGetTickCount() - stats_start);
+            wakeups = 0;
+            stats_start = xTaskGetTickCount();
+        }
+#endif
     }
 }
 
@@ -230,17 +172,17 @@ void led_task_create(unsigned priority, void *args)
 
 void led_indicate_waiting(void)
 {
-    xTaskNotify(ctx_led_task, TASK_NOTIF_MASK_WAITING, eSetBits);
+    led_pattern_request(LED_PATTERN_WAITING);
 }
 
 void led_indicate_listening(void)
 {
-    xTaskNotify(ctx_led_task, TASK_NOTIF_MASK_LISTEN, eSetBits);
+    led_pattern_request(LED_PATTERN_LISTENING);
 }
 
 void led_indicate_end_of_eval(void)
 {
-    xTaskNotify(ctx_led_task, TASK_NOTIF_MASK_END_OF_EVAL, eSetBits);
+    led_pattern_request(LED_PATTERN_END_OF_EVAL);
 }
 
 #endif /* ON_TILE(0) */
\ No newline at end of file
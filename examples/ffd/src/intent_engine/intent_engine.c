@@ -9,7 +9,7 @@
 /* FreeRTOS headers */
 #include "FreeRTOS.h"
 #include "task.h"
-#include "stream_buffer.h"
+#include "queue.h"
 
 /* App headers */
 #include "app_conf.h"
@@ -17,11 +17,18 @@
 #include "intent_engine/intent_engine.h"
 #include "intent_handler/intent_handler.h"
 #include "asr.h"
+#include "asr_history.h"
+#include "asr_model_partition.h"
+#include "asr_vnr_gate.h"
 #include "device_memory_impl.h"
 #include "gpio_ctrl/leds.h"
 
 #if ON_TILE(ASR_TILE_NO)
 
+#if appconfINTENT_SAMPLE_BLOCK_LENGTH != appconfAUDIO_PIPELINE_FRAME_ADVANCE
+#error The intent engine processes one audio pipeline frame per ASR brick
+#endif
+
 #define IS_KEYWORD(id)    (id == 17)
 #define IS_COMMAND(id)    (id > 0 && id != 17)
 
@@ -32,10 +39,12 @@
 extern const unsigned short gs_grammarLabel[];
 void* grammar = (void*)gs_grammarLabel;
 
-// Model file is in flash at the offset specified in the CMakeLists
+// Model partition is in flash at the offset specified in the CMakeLists
 // QSPI_FLASH_MODEL_START_ADDRESS variable.  The XS1_SWMEM_BASE value needs
-// to be added so the address in in the SwMem range.  
-uint16_t *model = (uint16_t *) (XS1_SWMEM_BASE + QSPI_FLASH_MODEL_START_ADDRESS);
+// to be added so the address in in the SwMem range.
+// The partition is packed by tools/model_pack/model_pack.py.
+#define MODEL_PARTITION     ((const void *) (XS1_SWMEM_BASE + QSPI_FLASH_MODEL_START_ADDRESS))
+#define MODEL_NET_NAME      "net"
 
 typedef enum intent_state {
     STATE_EXPECTING_WAKEWORD,
@@ -52,12 +61,23 @@ static intent_state_t intent_state;
 static asr_port_t asr_ctx; 
 static devmem_manager_t devmem_ctx;
 
+#if INTENT_ENGINE_REFEED_FRAMES
+// The last bricks passed to the recognizer, and the number of samples passed to it so far
+static asr_history_t history;
+static asr_sample_t history_buf[INTENT_ENGINE_REFEED_FRAMES * SAMPLES_PER_ASR];
+static uint32_t asr_index;
+#endif
+
+#if appconfINTENT_VNR_GATE_ENABLED
+static asr_vnr_gate_t vnr_gate;
+static asr_sample_t vnr_gate_lookback[appconfINTENT_VNR_GATE_LOOKBACK_FRAMES * SAMPLES_PER_ASR];
+#endif
+
 static uint32_t timeout_event = TIMEOUT_EVENT_NONE;
 
 static void vIntentTimerCallback(TimerHandle_t pxTimer);
-static void receive_audio_frames(StreamBufferHandle_t input_queue, int32_t *buf,
-                                 int16_t *buf_short, size_t *buf_short_index);
 static void timeout_event_handler(TimerHandle_t pxTimer);
+static void process_word(int word_id, TimerHandle_t pxTimer);
 
 static void vIntentTimerCallback(TimerHandle_t pxTimer)
 {
@@ -71,26 +91,6 @@ static void vIntentTimerCallback(TimerHandle_t pxTimer)
     }
 }
 
-static void receive_audio_frames(StreamBufferHandle_t input_queue, int32_t *buf,
-                                 int16_t *buf_short, size_t *buf_short_index)
-{
-    uint8_t *buf_ptr = (uint8_t*)buf;
-    size_t buf_len = appconfINTENT_SAMPLE_BLOCK_LENGTH * sizeof(int32_t);
-
-    do {
-        size_t bytes_rxed = xStreamBufferReceive(input_queue,
-                                                 buf_ptr,
-                                                 buf_len,
-                                                 portMAX_DELAY);
-        buf_len -= bytes_rxed;
-        buf_ptr += bytes_rxed;
-    } while (buf_len > 0);
-
-    for (int i = 0; i < appconfINTENT_SAMPLE_BLOCK_LENGTH; i++) {
-        buf_short[(*buf_short_index)++] = buf[i] >> 16;
-    }
-}
-
 static void timeout_event_handler(TimerHandle_t pxTimer)
 {
     if (timeout_event & TIMEOUT_EVENT_INTENT) {
@@ -101,12 +101,42 @@ static void timeout_event_handler(TimerHandle_t pxTimer)
     }
 }
 
+static void process_word(int word_id, TimerHandle_t pxTimer)
+{
+#if appconfINTENT_RAW_OUTPUT
+    intent_engine_process_asr_result(word_id);
+#else
+    if (intent_state == STATE_EXPECTING_WAKEWORD && IS_KEYWORD(word_id)) {
+        led_indicate_listening();
+        xTimerStart(pxTimer, 0);
+        intent_engine_process_asr_result(word_id);
+        intent_state = STATE_EXPECTING_COMMAND;
+    } else if (intent_state == STATE_EXPECTING_COMMAND && IS_COMMAND(word_id)) {
+        xTimerReset(pxTimer, 0);
+        intent_engine_process_asr_result(word_id);
+        intent_state = STATE_PROCESSING_COMMAND;
+    } else if (intent_state == STATE_EXPECTING_COMMAND && IS_KEYWORD(word_id)) {
+        xTimerReset(pxTimer, 0);
+        intent_engine_process_asr_result(word_id);
+        // remain in STATE_EXPECTING_COMMAND state
+    } else if (intent_state == STATE_PROCESSING_COMMAND && IS_KEYWORD(word_id)) {
+        xTimerReset(pxTimer, 0);
+        intent_engine_process_asr_result(word_id);
+        intent_state = STATE_EXPECTING_COMMAND;
+    } else if (intent_state == STATE_PROCESSING_COMMAND && IS_COMMAND(word_id)) {
+        xTimerReset(pxTimer, 0);
+        intent_engine_process_asr_result(word_id);
+        // remain in STATE_PROCESSING_COMMAND state
+    }
+#endif
+}
+
 #pragma stackfunction 1000
 void intent_engine_task(void *args)
 {
     intent_state = STATE_EXPECTING_WAKEWORD;
 
-    StreamBufferHandle_t input_queue = (StreamBufferHandle_t)args;
+    void *frame_queue = args;
     TimerHandle_t int_eng_tmr = xTimerCreate(
         "int_eng_tmr",
         pdMS_TO_TICKS(appconfINTENT_RESET_DELAY_MS),
@@ -115,12 +145,20 @@ void intent_engine_task(void *args)
         vIntentTimerCallback);
 
     devmem_init(&devmem_ctx);
+    void *model = asr_model_partition_find(&devmem_ctx, MODEL_PARTITION, MODEL_NET_NAME, NULL);
+    xassert(model);
     asr_ctx = asr_init((int32_t *)model, (int32_t *)grammar, &devmem_ctx);
 
-    int32_t buf[appconfINTENT_SAMPLE_BLOCK_LENGTH] = {0};
-    int16_t buf_short[SAMPLES_PER_ASR] = {0};
+    intent_engine_frame_t frame;
 
     asr_reset(asr_ctx);
+#if INTENT_ENGINE_REFEED_FRAMES
+    asr_history_init(&history, history_buf, INTENT_ENGINE_REFEED_FRAMES, SAMPLES_PER_ASR);
+#endif
+#if appconfINTENT_VNR_GATE_ENABLED
+    asr_vnr_gate_init(&vnr_gate, appconfINTENT_VNR_GATE_THRESHOLD, appconfINTENT_VNR_GATE_HANGOVER_FRAMES,
+                      appconfINTENT_VNR_GATE_LOOKBACK_FRAMES, vnr_gate_lookback, SAMPLES_PER_ASR);
+#endif
 
     /* Alert other tile to start the audio pipeline */
     intent_engine_ready_sync();
@@ -129,26 +167,63 @@ void intent_engine_task(void *args)
     asr_result_t asr_result;
     int word_id;
 
-    size_t buf_short_index = 0;
-
     while (1)
     {
         timeout_event_handler(int_eng_tmr);
-        receive_audio_frames(input_queue, buf, buf_short, &buf_short_index);
-
-        if (buf_short_index < SAMPLES_PER_ASR)
-            continue;
-
-        buf_short_index = 0; // reset the offset into the buffer of int16s.
-                             // Note, we do not need to overlap the window of samples.
-                             // This is handled in the ASR ports.
+        // Each frame is one brick, already in the ASR's sample format, so it is processed in place.
+        // Note, we do not need to overlap the window of samples.
+        // This is handled in the ASR ports.
+        if (intent_engine_frame_receive(frame_queue, &frame)) {
+            // Frames were dropped to catch up, so start a new search rather than continuing across the gap
+            asr_reset(asr_ctx);
+#if INTENT_ENGINE_REFEED_FRAMES
+            asr_history_clear(&history);
+#endif
+        }
 
         // this application does not support barge-in
         //   so, we need to check if an audio response is playing and skip to the next
         //   audio frame because the playback may trigger the ASR.  
         if (intent_handler_response_playing()) continue;
 
-        asr_error = asr_process(asr_ctx, buf_short, SAMPLES_PER_ASR);
+#if appconfINTENT_VNR_GATE_ENABLED
+        bool processed;
+        bool lookback_found;
+#if INTENT_ENGINE_REFEED_FRAMES
+        uint32_t gate_processed = vnr_gate.bricks_processed;
+#endif
+        asr_error = asr_vnr_gate_process(&vnr_gate, asr_ctx, frame.samples, SAMPLES_PER_ASR, frame.vnr_pred, &processed,
+                                         &asr_result, &lookback_found);
+#if INTENT_ENGINE_REFEED_FRAMES
+        gate_processed = vnr_gate.bricks_processed - gate_processed;
+        asr_index += gate_processed * SAMPLES_PER_ASR;
+        if (gate_processed > (processed ? 1 : 0)) {
+            // The lookback bricks were replayed, which the history doesn't hold, so it no longer ends with the
+            // bricks the recognizer was fed
+            asr_history_clear(&history);
+        }
+        // Only a brick the gate fed to the recognizer is held, so the history stays in step with asr_index
+        if (processed) {
+            asr_history_push(&history, frame.samples);
+        }
+#endif
+#if appconfINTENT_VNR_GATE_STATS_FRAMES
+        if (vnr_gate.bricks >= appconfINTENT_VNR_GATE_STATS_FRAMES) {
+            asr_vnr_gate_print_stats(&vnr_gate, "Intent engine");
+        }
+#endif
+        // The onset replayed when the gate opened may hold the end of an utterance. The brick was processed after it.
+        if (lookback_found && (IS_KEYWORD(asr_result.id) || IS_COMMAND(asr_result.id))) {
+            process_word(asr_result.id, int_eng_tmr);
+        }
+        if (!processed) continue;
+#else
+        asr_error = asr_process(asr_ctx, frame.samples, SAMPLES_PER_ASR);
+#if INTENT_ENGINE_REFEED_FRAMES
+        asr_index += SAMPLES_PER_ASR;
+        asr_history_push(&history, frame.samples);
+#endif
+#endif
 
         if (asr_error == ASR_EVALUATION_EXPIRED) {
             led_indicate_end_of_eval();
@@ -163,33 +238,23 @@ void intent_engine_task(void *args)
 
         if (!IS_KEYWORD(word_id) && !IS_COMMAND(word_id)) continue; 
 
-
-    #if appconfINTENT_RAW_OUTPUT
-        intent_engine_process_asr_result(word_id);
-    #else
-        if (intent_state == STATE_EXPECTING_WAKEWORD && IS_KEYWORD(word_id)) {
-            led_indicate_listening();
-            xTimerStart(int_eng_tmr, 0);
-            intent_engine_process_asr_result(word_id);
-            intent_state = STATE_EXPECTING_COMMAND;
-        } else if (intent_state == STATE_EXPECTING_COMMAND && IS_COMMAND(word_id)) {
-            xTimerReset(int_eng_tmr, 0);
-            intent_engine_process_asr_result(word_id);
-            intent_state = STATE_PROCESSING_COMMAND;
-        } else if (intent_state == STATE_EXPECTING_COMMAND && IS_KEYWORD(word_id)) {
-            xTimerReset(int_eng_tmr, 0);
-            intent_engine_process_asr_result(word_id);
-            // remain in STATE_EXPECTING_COMMAND state
-        } else if (intent_state == STATE_PROCESSING_COMMAND && IS_KEYWORD(word_id)) {
-            xTimerReset(int_eng_tmr, 0);
-            intent_engine_process_asr_result(word_id);
-            intent_state = STATE_EXPECTING_COMMAND;
-        } else if (intent_state == STATE_PROCESSING_COMMAND && IS_COMMAND(word_id)) {
-            xTimerReset(int_eng_tmr, 0);
-            intent_engine_process_asr_result(word_id);
-            // remain in STATE_PROCESSING_COMMAND state
+        process_word(word_id, int_eng_tmr);
+
+#if INTENT_ENGINE_REFEED_FRAMES
+        if (IS_KEYWORD(word_id)) {
+            // The recognizer has restarted its search, so feed it the audio since the end of the wake up
+            // phrase again, in case a command followed straight on. The phrase itself is not re-fed, and if
+            // it is found again the search carries on for a command.
+            uint32_t refeed = asr_history_bricks_after(&history, &asr_result, asr_index);
+            uint32_t fed;
+            bool found;
+            asr_error = asr_history_refeed(&history, asr_ctx, refeed, word_id, &fed, &found);
+            asr_index += fed * SAMPLES_PER_ASR;
+            if ((asr_error == ASR_OK) && found && (asr_get_result(asr_ctx, &asr_result) == ASR_OK) && IS_COMMAND(asr_result.id)) {
+                process_word(asr_result.id, int_eng_tmr);
+            }
         }
-    #endif
+#endif
     }
 }
 
@@ -199,6 +264,9 @@ void intent_engine_ready_sync(void)
 {
     int sync = 0;
 #if ON_TILE(AUDIO_PIPELINE_TILE_NO)
+#if ASR_TILE_NO != AUDIO_PIPELINE_TILE_NO
+    intent_engine_credit_task_create(appconfINTENT_MODEL_RUNNER_TASK_PRIORITY);
+#endif
     size_t len = rtos_intertile_rx_len(intertile_ctx, appconfINTENT_ENGINE_READY_SYNC_PORT, RTOS_OSAL_WAIT_FOREVER);
     xassert(len == sizeof(sync));
     rtos_intertile_rx_data(intertile_ctx, &sync, sizeof(sync));
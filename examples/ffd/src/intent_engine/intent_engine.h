@@ -8,27 +8,60 @@
 #include <stdint.h>
 #include <stddef.h>
 
+#include "app_conf.h"
 #include "asr.h"
 #include "rtos_intertile.h"
 
+/* Frame passed from the audio pipeline to the intent engine. The samples are
+ * converted to the ASR's 16 bit format before they are sent, so the engine
+ * passes them to the ASR in place. */
+typedef struct {
+    asr_sample_t samples[appconfAUDIO_PIPELINE_FRAME_ADVANCE];
+    float vnr_pred;     /* Output VNR estimate of the frame, from 0 to 1 */
+    uint32_t seq;       /* Counts every pipeline output frame, so gaps show frames lost in transport */
+    uint32_t flags;     /* INTENT_ENGINE_FRAME_* */
+} intent_engine_frame_t;
+
+/* Sent without a credit, the ASR tile drops its oldest queued frame if there is no room */
+#define INTENT_ENGINE_FRAME_OVERWRITE   (1 << 0)
+
+/* appconfINTENT_TRANSPORT_POLICY values */
+#define INTENT_TRANSPORT_DROP_NEWEST    0
+#define INTENT_TRANSPORT_DROP_OLDEST    1
+#define INTENT_TRANSPORT_CATCH_UP       2
+
+/* Frames fed to the recognizer again after the wake up phrase is found */
+#define INTENT_ENGINE_REFEED_FRAMES \
+    ((appconfINTENT_WAKEWORD_REFEED_MS * (appconfAUDIO_PIPELINE_SAMPLE_RATE / 1000) + appconfAUDIO_PIPELINE_FRAME_ADVANCE - 1) / \
+     appconfAUDIO_PIPELINE_FRAME_ADVANCE)
+
+/* Depth of the intent engine's frame queue, which is also the number of
+ * credits the audio pipeline tile starts with. It covers the frames that
+ * arrive while the engine feeds INTENT_ENGINE_REFEED_FRAMES frames again. */
+#define INTENT_ENGINE_QUEUE_FRAMES  (appconfINTENT_FRAME_BUFFER_MULT / 4 + INTENT_ENGINE_REFEED_FRAMES)
+
 int32_t intent_engine_create(uint32_t priority, void *args);
 void intent_engine_ready_sync(void);
 
 void intent_engine_task(void *args);
 void intent_engine_task_create(unsigned priority);
 void intent_engine_intertile_task_create(uint32_t priority);
+void intent_engine_credit_task_create(uint32_t priority);
+bool intent_engine_frame_receive(void *frame_queue, intent_engine_frame_t *frame);
 
-int32_t intent_engine_sample_push(int32_t *buf, size_t frames);
+int32_t intent_engine_sample_push(int32_t *buf, size_t frames, float vnr_pred);
 void intent_engine_samples_send_local(
         size_t frame_count,
-        int32_t *processed_audio_frame);
+        int32_t *processed_audio_frame,
+        float vnr_pred);
 void intent_engine_samples_send_remote(
         rtos_intertile_t *intertile,
         size_t frame_count,
-        int32_t *processed_audio_frame);
+        int32_t *processed_audio_frame,
+        float vnr_pred);
 
 
-void intent_engine_stream_buf_reset(void);
+void intent_engine_frame_queue_reset(void);
 void intent_engine_play_response(int wav_id);
 void intent_engine_process_asr_result(int word_id);
 
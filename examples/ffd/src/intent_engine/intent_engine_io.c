@@ -87,18 +87,20 @@ int32_t intent_engine_create(uint32_t priority, void *args)
 }
 #endif /* appconfINTENT_ENABLED && ON_TILE(ASR_TILE_NO) */
 
-int32_t intent_engine_sample_push(int32_t *buf, size_t frames)
+int32_t intent_engine_sample_push(int32_t *buf, size_t frames, float vnr_pred)
 {
 #if appconfINTENT_ENABLED && ON_TILE(AUDIO_PIPELINE_TILE_NO)
 #if ASR_TILE_NO == AUDIO_PIPELINE_TILE_NO
     intent_engine_samples_send_local(
             frames,
-            buf);
+            buf,
+            vnr_pred);
 #else
     intent_engine_samples_send_remote(
             intertile_ap_ctx,
             frames,
-            buf);
+            buf,
+            vnr_pred);
 #endif
 #endif
     return 0;
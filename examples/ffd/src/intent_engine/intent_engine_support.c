@@ -2,6 +2,7 @@
 // XMOS Public License: Version 1
 
 /* STD headers */
+#include <string.h>
 #include <platform.h>
 #include <xs1.h>
 #include <xcore/hwtimer.h>
@@ -9,22 +10,173 @@
 /* FreeRTOS headers */
 #include "FreeRTOS.h"
 #include "task.h"
-#include "stream_buffer.h"
+#include "queue.h"
 
 /* App headers */
 #include "app_conf.h"
 #include "platform/driver_instances.h"
 #include "intent_engine/intent_engine.h"
+#include "audio_frame_utils.h"
+#include "telemetry.h"
+
+/*
+ * Frames are passed to the intent engine through a queue of
+ * INTENT_ENGINE_QUEUE_FRAMES frames on the ASR tile.
+ *
+ * When the audio pipeline is on the other tile, it holds one credit per free
+ * queue slot and spends one for each frame it sends. The intent engine
+ * returns the credits as it consumes frames. With no credits left the
+ * pipeline tile either drops the frame, or sends it flagged
+ * INTENT_ENGINE_FRAME_OVERWRITE so the ASR tile makes room by dropping its
+ * oldest frame. Either way the queue never overflows, and nothing blocks the
+ * audio pipeline.
+ */
+
+#if (appconfINTENT_TRANSPORT_CREDIT_BATCH < 1) || (appconfINTENT_TRANSPORT_CREDIT_BATCH > INTENT_ENGINE_QUEUE_FRAMES)
+#error appconfINTENT_TRANSPORT_CREDIT_BATCH must be from 1 to INTENT_ENGINE_QUEUE_FRAMES
+#endif
 
 #if ON_TILE(ASR_TILE_NO)
 
-static StreamBufferHandle_t samples_to_engine_stream_buf = 0;
+typedef struct {
+    uint32_t frames;            // Frames received by the intent engine
+    uint32_t lost;              // Frames missing from the sequence, dropped on either tile
+    uint32_t dropped;           // Frames dropped on this tile
+    uint32_t catch_ups;
+    uint32_t occupancy_sum;     // Frames queued behind each received frame
+    uint32_t occupancy_max;
+} engine_transport_stats_t;
+
+static QueueHandle_t frame_queue = 0;
+static engine_transport_stats_t stats;
+static uint32_t next_seq;
+static volatile bool catch_up_pending;
 
-void intent_engine_stream_buf_reset(void)
+#if ASR_TILE_NO != AUDIO_PIPELINE_TILE_NO
+// Frames queued with an OVERWRITE flag into a free slot whose credit is
+// already on its way back to the pipeline tile. That many returned credits
+// are withheld, so the pipeline tile never sends more frames than fit.
+static uint32_t credit_debt;
+static uint32_t credits_pending;
+#endif
+
+static void frame_queue_push(const intent_engine_frame_t *frame, bool overwrite)
 {
-    if (samples_to_engine_stream_buf)
-        while (xStreamBufferReset(samples_to_engine_stream_buf) == pdFAIL)
-            vTaskDelay(pdMS_TO_TICKS(1));
+    if (xQueueSend(frame_queue, frame, 0) == pdPASS) {
+#if ASR_TILE_NO != AUDIO_PIPELINE_TILE_NO
+        if (frame->flags & INTENT_ENGINE_FRAME_OVERWRITE) {
+            taskENTER_CRITICAL();
+            credit_debt++;
+            taskEXIT_CRITICAL();
+        }
+#endif
+        return;
+    }
+
+    if (overwrite) {
+        intent_engine_frame_t oldest;
+
+        // The dropped frame's slot is reused, so its credit is not returned
+        if (xQueueReceive(frame_queue, &oldest, 0) == pdPASS) {
+            stats.dropped++;
+        }
+        if (appconfINTENT_TRANSPORT_POLICY == INTENT_TRANSPORT_CATCH_UP) {
+            catch_up_pending = true;
+        }
+        if (xQueueSend(frame_queue, frame, 0) == pdPASS) {
+            return;
+        }
+    }
+    stats.dropped++;
+    rtos_printf("lost output samples for intent\n");
+}
+
+static void frame_consumed(void)
+{
+#if ASR_TILE_NO != AUDIO_PIPELINE_TILE_NO
+    if (++credits_pending >= appconfINTENT_TRANSPORT_CREDIT_BATCH) {
+        uint32_t credits;
+
+        taskENTER_CRITICAL();
+        uint32_t absorbed = (credit_debt < credits_pending) ? credit_debt : credits_pending;
+        credit_debt -= absorbed;
+        credits = credits_pending - absorbed;
+        taskEXIT_CRITICAL();
+
+        credits_pending = 0;
+        if (credits > 0) {
+            rtos_intertile_tx(intertile_ap_ctx,
+                              appconfINTENT_MODEL_RUNNER_CREDITS_PORT,
+                              &credits,
+                              sizeof(credits));
+        }
+    }
+#endif
+}
+
+/*
+ * Discards the queued frames. They are received rather than cleared with
+ * xQueueReset(), so their credits go back to the pipeline tile. Call from the
+ * task that receives the frames, as the credits are batched there.
+ */
+void intent_engine_frame_queue_reset(void)
+{
+    intent_engine_frame_t frame;
+
+    if (frame_queue) {
+        while (xQueueReceive(frame_queue, &frame, 0) == pdPASS) {
+            frame_consumed();
+            stats.dropped++;
+        }
+    }
+}
+
+bool intent_engine_frame_receive(void *frame_queue_handle, intent_engine_frame_t *frame)
+{
+    QueueHandle_t queue = (QueueHandle_t) frame_queue_handle;
+    bool caught_up = false;
+
+    xQueueReceive(queue, frame, portMAX_DELAY);
+    frame_consumed();
+
+    if (catch_up_pending) {
+        catch_up_pending = false;
+        // Each receive drops the frame received before it
+        while ((uxQueueMessagesWaiting(queue) > appconfINTENT_TRANSPORT_CATCH_UP_FRAMES) &&
+               (xQueueReceive(queue, frame, 0) == pdPASS)) {
+            frame_consumed();
+            stats.dropped++;
+        }
+        stats.catch_ups++;
+        caught_up = true;
+    }
+
+    uint32_t occupancy = uxQueueMessagesWaiting(queue);
+    stats.frames++;
+    stats.occupancy_sum += occupancy;
+    if (occupancy > stats.occupancy_max) {
+        stats.occupancy_max = occupancy;
+    }
+    stats.lost += frame->seq - next_seq;
+    next_seq = frame->seq + 1;
+
+#if appconfINTENT_TRANSPORT_STATS_FRAMES
+    if (stats.frames >= appconfINTENT_TRANSPORT_STATS_FRAMES) {
+        rtos_printf("Intent transport: %u frames, %u lost, %u dropped on ASR tile, %u catch ups, queue mean %u.%02u max %u of %u\n",
+                    (unsigned) stats.frames, (unsigned) stats.lost, (unsigned) stats.dropped, (unsigned) stats.catch_ups,
+                    (unsigned) (stats.occupancy_sum / stats.frames),
+                    (unsigned) (((100ull * stats.occupancy_sum) / stats.frames) % 100),
+                    (unsigned) stats.occupancy_max, (unsigned) INTENT_ENGINE_QUEUE_FRAMES);
+        memset(&stats, 0, sizeof(stats));
+    }
+#endif
+    return caught_up;
+}
+
+static void frame_queue_create(void)
+{
+    frame_queue = xQueueCreate(INTENT_ENGINE_QUEUE_FRAMES, sizeof(intent_engine_frame_t));
+    telemetry_queue_register("intent_queue", frame_queue);
 }
 
 #endif /* ON_TILE(ASR_TILE_NO) */
@@ -32,17 +184,99 @@ void intent_engine_stream_buf_reset(void)
 #if ASR_TILE_NO != AUDIO_PIPELINE_TILE_NO
 #if ON_TILE(AUDIO_PIPELINE_TILE_NO)
 
+typedef struct {
+    uint32_t sent;
+    uint32_t no_credit;         // Frames that found no credit
+    uint32_t dropped;           // Frames dropped on this tile
+} pipeline_transport_stats_t;
+
+static volatile uint32_t credits = INTENT_ENGINE_QUEUE_FRAMES;
+static pipeline_transport_stats_t pipeline_stats;
+static uint32_t seq;
+
 void intent_engine_samples_send_remote(
         rtos_intertile_t *intertile,
         size_t frame_count,
-        int32_t *processed_audio_frame)
+        int32_t *processed_audio_frame,
+        float vnr_pred)
 {
+    intent_engine_frame_t frame;
+    bool have_credit = false;
+
     configASSERT(frame_count == appconfAUDIO_PIPELINE_FRAME_ADVANCE);
 
+    frame.seq = seq++;
+    frame.flags = 0;
+
+    taskENTER_CRITICAL();
+    if (credits > 0) {
+        credits--;
+        have_credit = true;
+    }
+    taskEXIT_CRITICAL();
+
+    if (!have_credit) {
+        pipeline_stats.no_credit++;
+        if (appconfINTENT_TRANSPORT_POLICY == INTENT_TRANSPORT_DROP_NEWEST) {
+            pipeline_stats.dropped++;
+            return;
+        }
+        frame.flags |= INTENT_ENGINE_FRAME_OVERWRITE;
+    }
+
+    audio_frame_s32_to_s16(frame.samples, processed_audio_frame, appconfAUDIO_PIPELINE_FRAME_ADVANCE);
+    frame.vnr_pred = vnr_pred;
+
     rtos_intertile_tx(intertile,
                       appconfINTENT_MODEL_RUNNER_SAMPLES_PORT,
-                      processed_audio_frame,
-                      sizeof(int32_t) * frame_count);
+                      &frame,
+                      sizeof(frame));
+    pipeline_stats.sent++;
+}
+
+static void intent_engine_credits_in_task(void *arg)
+{
+    (void) arg;
+
+    for (;;) {
+        uint32_t returned;
+        size_t bytes_received;
+
+        bytes_received = rtos_intertile_rx_len(
+                intertile_ap_ctx,
+                appconfINTENT_MODEL_RUNNER_CREDITS_PORT,
+                portMAX_DELAY);
+
+        xassert(bytes_received == sizeof(returned));
+
+        rtos_intertile_rx_data(
+                intertile_ap_ctx,
+                &returned,
+                bytes_received);
+
+        taskENTER_CRITICAL();
+        credits += returned;
+        taskEXIT_CRITICAL();
+        configASSERT(credits <= INTENT_ENGINE_QUEUE_FRAMES);
+
+#if appconfINTENT_TRANSPORT_STATS_FRAMES
+        if (pipeline_stats.sent + pipeline_stats.dropped >= appconfINTENT_TRANSPORT_STATS_FRAMES) {
+            rtos_printf("Intent transport: %u frames sent, %u without credit, %u dropped on audio pipeline tile\n",
+                        (unsigned) pipeline_stats.sent, (unsigned) pipeline_stats.no_credit, (unsigned) pipeline_stats.dropped);
+            memset(&pipeline_stats, 0, sizeof(pipeline_stats));
+        }
+#endif
+    }
+}
+
+void intent_engine_credit_task_create(uint32_t priority)
+{
+    xTaskCreate((TaskFunction_t)intent_engine_credits_in_task,
+                "int_credits_rx",
+                RTOS_THREAD_STACK_SIZE(intent_engine_credits_in_task),
+                NULL,
+                priority,
+                NULL);
 }
 
 #else /* ON_TILE(AUDIO_PIPELINE_TILE_NO) */
@@ -52,7 +286,7 @@ static void intent_engine_intertile_samples_in_task(void *arg)
     (void) arg;
 
     for (;;) {
-        int32_t samples[appconfAUDIO_PIPELINE_FRAME_ADVANCE];
+        intent_engine_frame_t frame;
         size_t bytes_received;
 
         bytes_received = rtos_intertile_rx_len(
@@ -60,24 +294,20 @@ static void intent_engine_intertile_samples_in_task(void *arg)
                 appconfINTENT_MODEL_RUNNER_SAMPLES_PORT,
                 portMAX_DELAY);
 
-        xassert(bytes_received == sizeof(samples));
+        xassert(bytes_received == sizeof(frame));
 
         rtos_intertile_rx_data(
                 intertile_ap_ctx,
-                samples,
+                &frame,
                 bytes_received);
 
-        if (xStreamBufferSend(samples_to_engine_stream_buf, samples, sizeof(samples), 0) != sizeof(samples)) {
-            rtos_printf("lost output samples for intent\n");
-        }
+        frame_queue_push(&frame, (frame.flags & INTENT_ENGINE_FRAME_OVERWRITE) != 0);
     }
 }
 
 void intent_engine_intertile_task_create(uint32_t priority)
 {
-    samples_to_engine_stream_buf = xStreamBufferCreate(
-                                           appconfINTENT_FRAME_BUFFER_MULT * appconfAUDIO_PIPELINE_FRAME_ADVANCE,
-                                           appconfINTENT_SAMPLE_BLOCK_LENGTH);
+    frame_queue_create();
 
     xTaskCreate((TaskFunction_t)intent_engine_intertile_samples_in_task,
                 "int_intertile_rx",
@@ -88,7 +318,7 @@ void intent_engine_intertile_task_create(uint32_t priority)
     xTaskCreate((TaskFunction_t)intent_engine_task,
                 "intent_eng",
                 RTOS_THREAD_STACK_SIZE(intent_engine_task),
-                samples_to_engine_stream_buf,
+                frame_queue,
                 uxTaskPriorityGet(NULL),
                 NULL);
 }
@@ -99,32 +329,37 @@ void intent_engine_intertile_task_create(uint32_t priority)
 #if ASR_TILE_NO == AUDIO_PIPELINE_TILE_NO
 #if ON_TILE(ASR_TILE_NO)
 
+static uint32_t seq;
+
 void intent_engine_samples_send_local(
         size_t frame_count,
-        int32_t *processed_audio_frame)
+        int32_t *processed_audio_frame,
+        float vnr_pred)
 {
     configASSERT(frame_count == appconfAUDIO_PIPELINE_FRAME_ADVANCE);
 
-    if(samples_to_engine_stream_buf != NULL) {
-        size_t bytes_to_send = sizeof(int32_t) * frame_count;
-        if (xStreamBufferSend(samples_to_engine_stream_buf, processed_audio_frame, bytes_to_send, 0) != bytes_to_send) {
-            rtos_printf("lost local output samples for intent\n");
-        }
+    if(frame_queue != NULL) {
+        intent_engine_frame_t frame;
+
+        // On one tile the free queue slots are the credits
+        audio_frame_s32_to_s16(frame.samples, processed_audio_frame, appconfAUDIO_PIPELINE_FRAME_ADVANCE);
+        frame.vnr_pred = vnr_pred;
+        frame.seq = seq++;
+        frame.flags = 0;
+        frame_queue_push(&frame, appconfINTENT_TRANSPORT_POLICY != INTENT_TRANSPORT_DROP_NEWEST);
     } else {
-        rtos_printf("intent engine streambuffer not ready\n");
+        rtos_printf("intent engine queue not ready\n");
     }
 }
 
 void intent_engine_task_create(unsigned priority)
 {
-    samples_to_engine_stream_buf = xStreamBufferCreate(
-                                           appconfINTENT_FRAME_BUFFER_MULT * appconfAUDIO_PIPELINE_FRAME_ADVANCE,
-                                           appconfINTENT_SAMPLE_BLOCK_LENGTH);
+    frame_queue_create();
 
     xTaskCreate((TaskFunction_t)intent_engine_task,
                 "intent_eng",
                 RTOS_THREAD_STACK_SIZE(intent_engine_task),
-                samples_to_engine_stream_buf,
+                frame_queue,
                 uxTaskPriorityGet(NULL),
                 NULL);
 }
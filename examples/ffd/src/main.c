@@ -27,11 +27,18 @@
 #include "gpio_ctrl/gpi_ctrl.h"
 #include "gpio_ctrl/leds.h"
 #include "intent_handler/intent_handler.h"
+#include "cpu_load.h"
+#include "telemetry.h"
 
 #ifndef MEM_ANALYSIS_ENABLED
 #define MEM_ANALYSIS_ENABLED 0
 #endif
 
+#if ON_TILE(AUDIO_PIPELINE_TILE_NO)
+/* Filled in by the audio pipeline with the VNR estimate of each output frame */
+static trace_data_t pipeline_output_data;
+#endif
+
 void audio_pipeline_input(void *input_app_data,
                           int32_t **input_audio_frames,
                           size_t ch_count,
@@ -67,7 +74,9 @@ int audio_pipeline_output(void *output_app_data,
                           size_t frame_count)
 {
 #if ON_TILE(AUDIO_PIPELINE_TILE_NO) && appconfINTENT_ENABLED
-    intent_engine_sample_push((int32_t *)output_audio_frames, frame_count);
+    trace_data_t *output_data = (trace_data_t *)output_app_data;
+
+    intent_engine_sample_push((int32_t *)output_audio_frames, frame_count, output_data->output_vnr_pred);
 #endif // ON_TILE(AUDIO_PIPELINE_TILE_NO) && appconfINTENT_ENABLED
 
     return AUDIO_PIPELINE_FREE_FRAME;
@@ -80,16 +89,6 @@ void vApplicationMallocFailedHook(void)
     for(;;);
 }
 
-#if MEM_ANALYSIS_ENABLED
-static void mem_analysis(void)
-{
-    for (;;) {
-        rtos_printf("Tile[%d]:\n\tMinimum heap free: %d\n\tCurrent heap free: %d\n", THIS_XCORE_TILE, xPortGetMinimumEverFreeHeapSize(), xPortGetFreeHeapSize());
-        vTaskDelay(pdMS_TO_TICKS(5000));
-    }
-}
-#endif
-
 void startup_task(void *arg)
 {
     rtos_printf("Startup task running from tile %d on core %d\n", THIS_XCORE_TILE, portGET_CORE_ID());
@@ -113,6 +112,7 @@ void startup_task(void *arg)
 
 #if appconfINTENT_ENABLED && ON_TILE(ASR_TILE_NO)
     QueueHandle_t q_intent = xQueueCreate(appconfINTENT_QUEUE_LEN, sizeof(int32_t));
+    telemetry_queue_register("intent", q_intent);
     intent_handler_create(appconfINTENT_MODEL_RUNNER_TASK_PRIORITY, q_intent);
     intent_engine_create(appconfINTENT_MODEL_RUNNER_TASK_PRIORITY, q_intent);
 #endif
@@ -123,11 +123,12 @@ void startup_task(void *arg)
     // audio pipeline.
     intent_engine_ready_sync();
 #endif
-    audio_pipeline_init(NULL, NULL);
+    audio_pipeline_init(NULL, &pipeline_output_data);
 #endif
 
 #if MEM_ANALYSIS_ENABLED
-    mem_analysis();
+    cpu_load_init(appconfCPU_LOAD_WINDOW_MS);
+    telemetry_run(appconfTELEMETRY_SAMPLE_MS, appconfTELEMETRY_PUBLISH_MS);
 #else
     vTaskSuspend(NULL);
     while(1){;} /* Trap */
@@ -137,6 +138,9 @@ void startup_task(void *arg)
 void vApplicationMinimalIdleHook(void)
 {
     rtos_printf("idle hook on tile %d core %d\n", THIS_XCORE_TILE, rtos_core_id_get());
+#if MEM_ANALYSIS_ENABLED
+    cpu_load_idle_hook();
+#endif
     asm volatile("waiteu");
 }
 
@@ -43,6 +43,7 @@ set(APP_COMMON_LINK_LIBRARIES
     inferencing_tflite_micro
     rtos::freertos_usb
     lib_src
+    sln_voice::app::audio_frame_utils
 )
 
 #**********************
@@ -2,6 +2,7 @@
 option(DEBUG_FFVA_USB_MIC_INPUT        "Enable ffva usb mic input"  OFF)
 option(DEBUG_FFVA_USB_MIC_INPUT_PIPELINE_BYPASS  "Enable ffva usb mic input and audio pipeline bypass"  OFF)
 option(DEBUG_FFVA_USB_VERBOSE_OUTPUT        "Enable ffva usb with mic, ref, and proc output"  OFF)
+option(DEBUG_FFVA_USB_LOW_LATENCY  "Enable ffva low latency usb mode with usb mic input and audio pipeline bypass"  OFF)
 
 set(FFVA_UA_COMPILE_DEFINITIONS
     ${APP_COMPILE_DEFINITIONS}
@@ -30,6 +31,14 @@ if(DEBUG_FFVA_USB_VERBOSE_OUTPUT)
     list(APPEND FFVA_UA_COMPILE_DEFINITIONS appconfUSB_AUDIO_MODE=appconfUSB_AUDIO_TESTING)
 endif()
 
+# a usb mic enabled build without the pipeline for usb audio latency testing
+if(DEBUG_FFVA_USB_LOW_LATENCY)
+    list(APPEND FFVA_UA_COMPILE_DEFINITIONS appconfMIC_SRC_DEFAULT=appconfMIC_SRC_USB)
+    list(APPEND FFVA_UA_COMPILE_DEFINITIONS appconfUSB_AUDIO_MODE=appconfUSB_AUDIO_TESTING)
+    list(APPEND FFVA_UA_COMPILE_DEFINITIONS appconfPIPELINE_BYPASS=1)
+    list(APPEND FFVA_UA_COMPILE_DEFINITIONS appconfUSB_AUDIO_LOW_LATENCY=1)
+endif()
+
 query_tools_version()
 foreach(FFVA_AP ${FFVA_PIPELINES_UA})
     #**********************
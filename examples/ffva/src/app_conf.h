@@ -78,6 +78,56 @@
 #define appconfUSB_AUDIO_SAMPLE_RATE appconfAUDIO_PIPELINE_SAMPLE_RATE
 #endif
 
+/*
+ * Low latency USB audio mode. Audio received from the host is forwarded
+ * to the audio pipeline tile in blocks of appconfUSB_AUDIO_XFER_SAMPLES
+ * as soon as each block is available, rather than in whole pipeline frames.
+ * The stream buffers in both directions are also reduced to the minimum
+ * required to absorb the pipeline frame burst.
+ */
+#ifndef appconfUSB_AUDIO_LOW_LATENCY
+#define appconfUSB_AUDIO_LOW_LATENCY 0
+#endif
+
+/*
+ * Number of samples per channel, at the audio pipeline sample rate, in each
+ * intertile transfer of USB audio received from the host. Must be a multiple
+ * of the number of samples in one USB frame and must evenly divide
+ * appconfAUDIO_PIPELINE_FRAME_ADVANCE.
+ */
+#ifndef appconfUSB_AUDIO_XFER_SAMPLES
+#if appconfUSB_AUDIO_LOW_LATENCY
+#define appconfUSB_AUDIO_XFER_SAMPLES (3 * (appconfAUDIO_PIPELINE_SAMPLE_RATE / 1000))
+#else
+#define appconfUSB_AUDIO_XFER_SAMPLES appconfAUDIO_PIPELINE_FRAME_ADVANCE
+#endif
+#endif
+
+/*
+ * Number of sector sized buffers that DFU download blocks are copied into
+ * while the DFU writer task programs earlier blocks, so the host sends the
+ * next block while the flash is busy. At least 1.
+ */
+#ifndef appconfUSB_DFU_BLOCK_BUFFERS
+#define appconfUSB_DFU_BLOCK_BUFFERS 2
+#endif
+
+/*
+ * When set, the DFU writer task erases the next sector of the image while it
+ * waits for the next block, so a block only has to be programmed.
+ */
+#ifndef appconfUSB_DFU_ERASE_AHEAD
+#define appconfUSB_DFU_ERASE_AHEAD 1
+#endif
+
+/*
+ * Time in milliseconds the host waits before polling the DFU status when a
+ * download block or the manifest stage waits for the flash.
+ */
+#ifndef appconfUSB_DFU_BUSY_POLL_MS
+#define appconfUSB_DFU_BUSY_POLL_MS 10
+#endif
+
 #ifndef appconfSPI_OUTPUT_ENABLED
 #define appconfSPI_OUTPUT_ENABLED  0
 #endif
@@ -161,6 +211,7 @@
 #define appconfUSB_AUDIO_TASK_PRIORITY            (configMAX_PRIORITIES/2 + 1)
 #define appconfSPI_TASK_PRIORITY                  (configMAX_PRIORITIES/2 + 1)
 #define appconfQSPI_FLASH_TASK_PRIORITY           (configMAX_PRIORITIES/2 + 0)
+#define appconfUSB_DFU_TASK_PRIORITY              (configMAX_PRIORITIES/2 + 0)
 #define appconfWW_TASK_PRIORITY                   (configMAX_PRIORITIES/2 - 1)
 
 #endif /* APP_CONF_H_ */
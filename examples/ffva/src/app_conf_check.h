@@ -16,6 +16,22 @@
 #error appconfI2S_AUDIO_SAMPLE_RATE must be 48000 to use I2S TDM
 #endif
 
+#if (appconfAUDIO_PIPELINE_FRAME_ADVANCE % appconfUSB_AUDIO_XFER_SAMPLES) != 0
+#error appconfUSB_AUDIO_XFER_SAMPLES must evenly divide appconfAUDIO_PIPELINE_FRAME_ADVANCE
+#endif
+
+#if !appconfUSB_AUDIO_LOW_LATENCY && appconfUSB_AUDIO_XFER_SAMPLES != appconfAUDIO_PIPELINE_FRAME_ADVANCE
+#error appconfUSB_AUDIO_XFER_SAMPLES must equal appconfAUDIO_PIPELINE_FRAME_ADVANCE unless appconfUSB_AUDIO_LOW_LATENCY is set
+#endif
+
+#if (appconfUSB_AUDIO_XFER_SAMPLES % (appconfAUDIO_PIPELINE_SAMPLE_RATE / 1000)) != 0
+#error appconfUSB_AUDIO_XFER_SAMPLES must be a multiple of the samples in one USB frame
+#endif
+
+#if appconfUSB_DFU_BLOCK_BUFFERS < 1
+#error appconfUSB_DFU_BLOCK_BUFFERS must be at least 1
+#endif
+
 #if XK_VOICE_L71
 #if appconfSPI_OUTPUT_ENABLED
 #error SPI audio output not currently supported on XVF3610 board
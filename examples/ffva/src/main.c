@@ -21,6 +21,7 @@
 #include "platform/driver_instances.h"
 #include "usb_support.h"
 #include "usb_audio.h"
+#include "usb_dfu.h"
 #include "audio_pipeline.h"
 #include "ww_model_runner/ww_model_runner.h"
 #include "fs_support.h"
@@ -309,10 +310,28 @@ void vApplicationMallocFailedHook(void)
     for(;;);
 }
 
+#if appconfUSB_ENABLED
+static void usb_audio_buffer_stats_print(const char *name, const usb_audio_buffer_stats_t *stats)
+{
+	if (stats->level_min > stats->level_max) {
+		return; /* not on this tile, or not used since the last print */
+	}
+	rtos_printf("\tUSB audio %s buffer: level %u-%u samples, %u underruns, %u overruns\n",
+	            name, stats->level_min, stats->level_max, stats->underruns, stats->overruns);
+}
+#endif
+
 static void mem_analysis(void)
 {
 	for (;;) {
 		rtos_printf("Tile[%d]:\n\tMinimum heap free: %d\n\tCurrent heap free: %d\n", THIS_XCORE_TILE, xPortGetMinimumEverFreeHeapSize(), xPortGetFreeHeapSize());
+#if appconfUSB_ENABLED
+		usb_audio_stats_t usb_stats;
+		usb_audio_stats_get(&usb_stats, true);
+		usb_audio_buffer_stats_print("to host", &usb_stats.to_host);
+		usb_audio_buffer_stats_print("from host", &usb_stats.from_host);
+		usb_audio_buffer_stats_print("ref", &usb_stats.ref);
+#endif
 		vTaskDelay(pdMS_TO_TICKS(5000));
 	}
 }
@@ -366,6 +385,11 @@ static void tile_common_init(chanend_t c)
 
 #if appconfUSB_ENABLED && ON_TILE(USB_TILE_NO)
     usb_audio_init(intertile_usb_audio_ctx, appconfUSB_AUDIO_TASK_PRIORITY);
+    usb_dfu_init(appconfUSB_DFU_TASK_PRIORITY);
+#endif
+
+#if appconfUSB_ENABLED && appconfUSB_AUDIO_LOW_LATENCY && ON_TILE(AUDIO_PIPELINE_TILE_NO)
+    usb_audio_recv_init(intertile_usb_audio_ctx, appconfUSB_AUDIO_TASK_PRIORITY);
 #endif
 
     xTaskCreate((TaskFunction_t) startup_task,
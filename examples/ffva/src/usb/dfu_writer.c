@@ -0,0 +1,92 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#include <string.h>
+
+#include "dfu_writer.h"
+
+static void restore_erased(dfu_writer_t *writer)
+{
+    if (writer->erased_addr != DFU_WRITER_NO_SECTOR) {
+        writer->flash.write(writer->flash.ctx, writer->spare, writer->erased_addr, writer->sector_size);
+        writer->erased_addr = DFU_WRITER_NO_SECTOR;
+        writer->stats.restores++;
+    }
+}
+
+void dfu_writer_init(dfu_writer_t *writer,
+                     const dfu_writer_flash_t *flash,
+                     size_t sector_size,
+                     uint8_t *spare,
+                     bool erase_ahead)
+{
+    memset(writer, 0, sizeof(*writer));
+    writer->flash = *flash;
+    writer->sector_size = sector_size;
+    writer->spare = spare;
+    writer->erase_ahead = erase_ahead;
+    writer->erased_addr = DFU_WRITER_NO_SECTOR;
+}
+
+void dfu_writer_start(dfu_writer_t *writer, unsigned base, unsigned end)
+{
+    restore_erased(writer);
+    memset(&writer->stats, 0, sizeof(writer->stats));
+    writer->active = true;
+    writer->end = end;
+    writer->next_addr = base;
+    writer->last_block = false;
+}
+
+void dfu_writer_program(dfu_writer_t *writer, unsigned addr, const uint8_t *data, size_t len)
+{
+    const uint8_t *sector = data;
+
+    if (writer->erased_addr == addr) {
+        writer->stats.erase_ahead_hits++;
+        if (len < writer->sector_size) {
+            /* The spare buffer holds the sector's previous contents */
+            memcpy(writer->spare, data, len);
+            sector = writer->spare;
+        }
+    } else {
+        /* Blocks normally arrive in order, this one skipped or repeated a sector */
+        restore_erased(writer);
+        if (len < writer->sector_size) {
+            writer->flash.read(writer->flash.ctx, writer->spare, addr, writer->sector_size);
+            memcpy(writer->spare, data, len);
+            sector = writer->spare;
+            writer->stats.reads++;
+        }
+        writer->flash.erase(writer->flash.ctx, addr, writer->sector_size);
+    }
+
+    writer->flash.write(writer->flash.ctx, sector, addr, writer->sector_size);
+    writer->erased_addr = DFU_WRITER_NO_SECTOR;
+    writer->next_addr = addr + writer->sector_size;
+    writer->last_block = (len < writer->sector_size);
+    writer->stats.sectors++;
+}
+
+bool dfu_writer_erase_ahead(dfu_writer_t *writer)
+{
+    unsigned addr = writer->next_addr;
+
+    if (!writer->erase_ahead || !writer->active || writer->last_block ||
+        writer->erased_addr != DFU_WRITER_NO_SECTOR ||
+        addr + writer->sector_size > writer->end) {
+        return false;
+    }
+
+    writer->flash.read(writer->flash.ctx, writer->spare, addr, writer->sector_size);
+    writer->flash.erase(writer->flash.ctx, addr, writer->sector_size);
+    writer->erased_addr = addr;
+    writer->stats.erase_aheads++;
+    return true;
+}
+
+void dfu_writer_finish(dfu_writer_t *writer)
+{
+    restore_erased(writer);
+    writer->active = false;
+}
@@ -0,0 +1,96 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#ifndef DFU_WRITER_H_
+#define DFU_WRITER_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#define DFU_WRITER_NO_SECTOR    0xFFFFFFFF
+
+/*
+ * Flash operations used by the writer. The firmware uses the QSPI flash
+ * driver. The host simulation in test/device_firmware_update/sim uses a
+ * model of the flash timing.
+ */
+typedef struct {
+    void (*read)(void *ctx, uint8_t *data, unsigned addr, size_t len);
+    void (*erase)(void *ctx, unsigned addr, size_t len);
+    void (*write)(void *ctx, const uint8_t *data, unsigned addr, size_t len);
+    void *ctx;
+} dfu_writer_flash_t;
+
+typedef struct {
+    uint32_t sectors;           /* Sectors programmed */
+    uint32_t reads;             /* Sectors read back to keep the bytes after a partial block */
+    uint32_t erase_aheads;      /* Sectors erased ahead */
+    uint32_t erase_ahead_hits;  /* Sectors programmed that had been erased ahead */
+    uint32_t restores;          /* Sectors erased ahead, not programmed, and restored */
+} dfu_writer_stats_t;
+
+/*
+ * Writes a DFU image one sector sized block at a time. Full sectors are
+ * erased and programmed without reading them back first. When idle the
+ * writer erases the sector after the last one programmed, so the next block
+ * only has to be programmed. The erased sector's contents are kept in the
+ * spare buffer first, to fill in the end of a partial last block or to
+ * restore the sector if the image ends before it. A block shorter than a
+ * sector is the last of the image, so nothing is erased after it.
+ */
+typedef struct {
+    dfu_writer_flash_t flash;
+    size_t sector_size;
+    uint8_t *spare;             /* sector_size bytes */
+    bool erase_ahead;           /* Erase the next sector when idle */
+    bool active;                /* Between dfu_writer_start() and dfu_writer_finish() */
+    unsigned end;               /* End of the region being written */
+    unsigned next_addr;         /* Sector after the last one programmed */
+    unsigned erased_addr;       /* Sector erased ahead, or DFU_WRITER_NO_SECTOR */
+    bool last_block;            /* The last block programmed was short, so ended the image */
+    dfu_writer_stats_t stats;
+} dfu_writer_t;
+
+/*
+ * spare must hold sector_size bytes and be kept for the life of the writer.
+ */
+void dfu_writer_init(dfu_writer_t *writer,
+                     const dfu_writer_flash_t *flash,
+                     size_t sector_size,
+                     uint8_t *spare,
+                     bool erase_ahead);
+
+/*
+ * Starts writing an image to the sector aligned region from base up to end.
+ * Clears the statistics.
+ */
+void dfu_writer_start(dfu_writer_t *writer, unsigned base, unsigned end);
+
+/*
+ * Programs one block of up to sector_size bytes at the sector aligned addr.
+ * The rest of the sector is kept.
+ */
+void dfu_writer_program(dfu_writer_t *writer, unsigned addr, const uint8_t *data, size_t len);
+
+/*
+ * Erases the next sector ahead, if there is one to erase. Call when there
+ * are no blocks waiting. Returns true if a sector was erased.
+ */
+bool dfu_writer_erase_ahead(dfu_writer_t *writer);
+
+/*
+ * Ends the image. Restores a sector erased ahead that was not programmed.
+ * Also call when the download is abandoned, for example on a USB reset.
+ */
+void dfu_writer_finish(dfu_writer_t *writer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DFU_WRITER_H_ */
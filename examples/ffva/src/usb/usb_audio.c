@@ -27,6 +27,7 @@
 #define DEBUG_PRINT_ENABLE_USB_AUDIO 1
 
 #include <stdlib.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 #include <rtos_printf.h>
@@ -44,6 +45,9 @@
 #include "audio_pipeline.h"
 
 #include "app_conf.h"
+#include "usb_audio.h"
+#include "usb_dfu.h"
+#include "audio_frame_utils.h"
 
 // Audio controls
 // Current states
@@ -66,10 +70,29 @@ static StreamBufferHandle_t samples_to_host_stream_buf;
 static StreamBufferHandle_t samples_from_host_stream_buf;
 static StreamBufferHandle_t rx_buffer;
 static TaskHandle_t usb_audio_out_task_handle;
+#if appconfUSB_AUDIO_LOW_LATENCY
+static StreamBufferHandle_t ref_stream_buf;
+#endif
+
+static usb_audio_stats_t usb_audio_stats;
 
 #define RATE_MULTIPLIER (appconfUSB_AUDIO_SAMPLE_RATE / appconfAUDIO_PIPELINE_SAMPLE_RATE)
 
-#define USB_FRAMES_PER_VFE_FRAME (appconfAUDIO_PIPELINE_FRAME_ADVANCE / (appconfAUDIO_PIPELINE_SAMPLE_RATE / 1000))
+#define PIPELINE_SAMPLES_PER_USB_FRAME (appconfAUDIO_PIPELINE_SAMPLE_RATE / 1000)
+#define USB_FRAMES_PER_XFER (appconfUSB_AUDIO_XFER_SAMPLES / PIPELINE_SAMPLES_PER_USB_FRAME)
+
+/*
+ * Sending to the host begins once one pipeline frame plus a margin is
+ * buffered. The margin absorbs jitter between the pipeline output, which
+ * arrives one frame at a time, and the USB frames that drain it.
+ */
+#if appconfUSB_AUDIO_LOW_LATENCY
+#define USB_AUDIO_TX_MARGIN_SAMPLES (2 * PIPELINE_SAMPLES_PER_USB_FRAME)
+#else
+#define USB_AUDIO_TX_MARGIN_SAMPLES appconfAUDIO_PIPELINE_FRAME_ADVANCE
+#endif
+#define USB_AUDIO_TX_START_SAMPLES (appconfAUDIO_PIPELINE_FRAME_ADVANCE + USB_AUDIO_TX_MARGIN_SAMPLES)
+#define USB_AUDIO_TX_BUFFER_SAMPLES (USB_AUDIO_TX_START_SAMPLES + appconfAUDIO_PIPELINE_FRAME_ADVANCE)
 
 //--------------------------------------------------------------------+
 // Device callbacks
@@ -79,12 +102,15 @@ static TaskHandle_t usb_audio_out_task_handle;
 void tud_mount_cb(void)
 {
     rtos_printf("USB mounted\n");
+    /* A bus reset ends any download in progress, the host mounts the device again after it */
+    usb_dfu_reset();
 }
 
 // Invoked when device is unmounted
 void tud_umount_cb(void)
 {
     rtos_printf("USB unmounted\n");
+    usb_dfu_reset();
 }
 
 // Invoked when usb bus is suspended
@@ -108,12 +134,64 @@ void tud_resume_cb(void)
 
 #if CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_TX == 2
 typedef int16_t samp_t;
+#define usb_audio_frame_interleave      audio_frame_interleave_s16
+#define usb_audio_frame_deinterleave    audio_frame_deinterleave_s16
 #elif CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_TX == 4
 typedef int32_t samp_t;
+#define usb_audio_frame_interleave      audio_frame_interleave_s32
+#define usb_audio_frame_deinterleave    audio_frame_deinterleave_s32
 #else
 #error CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_TX must be either 2 or 4
 #endif
 
+#define TX_BYTES_PER_SAMPLE (sizeof(samp_t) * CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX)
+#define RX_BYTES_PER_SAMPLE (sizeof(samp_t) * CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX)
+
+static void buffer_stats_reset(usb_audio_buffer_stats_t *stats)
+{
+    stats->level_min = SIZE_MAX;
+    stats->level_max = 0;
+    stats->underruns = 0;
+    stats->overruns = 0;
+}
+
+static void buffer_stats_level_update(usb_audio_buffer_stats_t *stats, size_t level)
+{
+    if (level < stats->level_min) {
+        stats->level_min = level;
+    }
+    if (level > stats->level_max) {
+        stats->level_max = level;
+    }
+}
+
+static void buffer_stats_print(const char *name, const usb_audio_buffer_stats_t *stats)
+{
+    if (stats->level_min > stats->level_max) {
+        return; /* never updated on this tile */
+    }
+    rtos_printf("USB audio %s buffer: level %u-%u samples (%u-%u us), %u underruns, %u overruns\n",
+                name,
+                stats->level_min,
+                stats->level_max,
+                (stats->level_min * 1000000) / appconfAUDIO_PIPELINE_SAMPLE_RATE,
+                (stats->level_max * 1000000) / appconfAUDIO_PIPELINE_SAMPLE_RATE,
+                stats->underruns,
+                stats->overruns);
+}
+
+void usb_audio_stats_get(usb_audio_stats_t *stats, bool reset)
+{
+    taskENTER_CRITICAL();
+    *stats = usb_audio_stats;
+    if (reset) {
+        buffer_stats_reset(&usb_audio_stats.to_host);
+        buffer_stats_reset(&usb_audio_stats.from_host);
+        buffer_stats_reset(&usb_audio_stats.ref);
+    }
+    taskEXIT_CRITICAL();
+}
+
 void usb_audio_send(rtos_intertile_t *intertile_ctx,
                     size_t frame_count,
                     int32_t **frame_buffers,
@@ -122,33 +200,58 @@ void usb_audio_send(rtos_intertile_t *intertile_ctx,
     samp_t usb_audio_in_frame[appconfAUDIO_PIPELINE_FRAME_ADVANCE][CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX];
     int32_t *frame_buf_ptr = (int32_t *) frame_buffers;
 
-#if CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_TX == 2
-    const int src_32_shift = 16;
-#elif CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_TX == 4
-    const int src_32_shift = 0;
-#endif
-
     memset(usb_audio_in_frame, 0, sizeof(samp_t) * appconfAUDIO_PIPELINE_FRAME_ADVANCE * CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX);
 
     xassert(frame_count == appconfAUDIO_PIPELINE_FRAME_ADVANCE);
 
-    for(int ch=0; ch<CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX; ch++) {
-        for (int i=0; i<appconfAUDIO_PIPELINE_FRAME_ADVANCE; i++) {
-            if (ch < num_chans) {
-                usb_audio_in_frame[i][ch] = frame_buf_ptr[i+(appconfAUDIO_PIPELINE_FRAME_ADVANCE*ch)] >> src_32_shift;
-            }
-        }
-    }
+    usb_audio_frame_interleave(&usb_audio_in_frame[0][0], CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX,
+                               frame_buf_ptr, appconfAUDIO_PIPELINE_FRAME_ADVANCE,
+                               TU_MIN(num_chans, CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX), appconfAUDIO_PIPELINE_FRAME_ADVANCE,
+                               NULL);
 
     if (mic_interface_open) {
         if (xStreamBufferSpacesAvailable(samples_to_host_stream_buf) >= sizeof(usb_audio_in_frame)) {
             xStreamBufferSend(samples_to_host_stream_buf, usb_audio_in_frame, sizeof(usb_audio_in_frame), 0);
         } else {
+            usb_audio_stats.to_host.overruns++;
             rtos_printf("lost VFE output samples\n");
         }
+        buffer_stats_level_update(&usb_audio_stats.to_host,
+                                  xStreamBufferBytesAvailable(samples_to_host_stream_buf) / TX_BYTES_PER_SAMPLE);
+    }
+}
+
+#if appconfUSB_AUDIO_LOW_LATENCY
+static size_t ref_stream_buf_receive(void *frame, size_t frame_bytes)
+{
+    static bool streaming;
+    size_t bytes_available = xStreamBufferBytesAvailable(ref_stream_buf);
+    size_t bytes_received = 0;
+
+    buffer_stats_level_update(&usb_audio_stats.ref, bytes_available / RX_BYTES_PER_SAMPLE);
+
+    if (USB_AUDIO_RECV_DELAY != 0 || bytes_available >= frame_bytes) {
+        /*
+         * The trigger level of the stream buffer is one whole frame, so
+         * this only returns early if it times out.
+         */
+        bytes_received = xStreamBufferReceive(ref_stream_buf, frame, frame_bytes, USB_AUDIO_RECV_DELAY);
+    }
 
+    if (bytes_received == frame_bytes) {
+        streaming = true;
+    } else {
+        /* Only count an underrun if the host was streaming previously */
+        if (streaming) {
+            usb_audio_stats.ref.underruns++;
+        }
+        streaming = false;
+        bytes_received = 0;
     }
+
+    return bytes_received;
 }
+#endif
 
 void usb_audio_recv(rtos_intertile_t *intertile_ctx,
                     size_t frame_count,
@@ -159,13 +262,11 @@ void usb_audio_recv(rtos_intertile_t *intertile_ctx,
     size_t bytes_received;
     int32_t *frame_buf_ptr = (int32_t *) frame_buffers;
 
-#if CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_RX == 2
-    const int src_32_shift = 16;
-#elif CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_RX == 4
-    const int src_32_shift = 0;
-#endif
     xassert(frame_count == appconfAUDIO_PIPELINE_FRAME_ADVANCE);
 
+#if appconfUSB_AUDIO_LOW_LATENCY
+    bytes_received = ref_stream_buf_receive(usb_audio_out_frame, sizeof(usb_audio_out_frame));
+#else
     bytes_received = rtos_intertile_rx_len(
             intertile_ctx,
             appconfUSB_AUDIO_PORT,
@@ -178,18 +279,18 @@ void usb_audio_recv(rtos_intertile_t *intertile_ctx,
                 intertile_ctx,
                 usb_audio_out_frame,
                 bytes_received);
-    } else {
+    }
+#endif
+
+    if (bytes_received == 0) {
         memset(usb_audio_out_frame, 0, sizeof(usb_audio_out_frame));
     }
 
     if (frame_buf_ptr != NULL) {
-        for(int ch=0; ch<CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX; ch++) {
-            for (int i=0; i<appconfAUDIO_PIPELINE_FRAME_ADVANCE; i++) {
-                if (ch < num_chans) {
-                    frame_buf_ptr[i+(appconfAUDIO_PIPELINE_FRAME_ADVANCE*ch)] = usb_audio_out_frame[i][ch] << src_32_shift;
-                }
-            }
-        }
+        usb_audio_frame_deinterleave(frame_buf_ptr, appconfAUDIO_PIPELINE_FRAME_ADVANCE,
+                                     &usb_audio_out_frame[0][0], CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX,
+                                     TU_MIN(num_chans, CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX), appconfAUDIO_PIPELINE_FRAME_ADVANCE,
+                                     NULL);
     }
 }
 
@@ -199,12 +300,12 @@ void usb_audio_out_task(void *arg)
 
 
     for (;;) {
-        samp_t usb_audio_out_frame[appconfAUDIO_PIPELINE_FRAME_ADVANCE][CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX];
+        samp_t usb_audio_out_frame[appconfUSB_AUDIO_XFER_SAMPLES][CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX];
         size_t bytes_received = 0;
 
         /*
-         * Only wake up when the stream buffer contains a whole audio
-         * pipeline frame.
+         * Only wake up when the stream buffer contains a whole
+         * intertile transfer.
          */
         (void) ulTaskNotifyTake(pdFALSE, portMAX_DELAY);
 
@@ -226,6 +327,37 @@ void usb_audio_out_task(void *arg)
     }
 }
 
+#if appconfUSB_AUDIO_LOW_LATENCY
+static void usb_audio_recv_task(void *arg)
+{
+    rtos_intertile_t *intertile_ctx = (rtos_intertile_t*) arg;
+
+    for (;;) {
+        samp_t usb_audio_out_xfer[appconfUSB_AUDIO_XFER_SAMPLES][CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX];
+        size_t bytes_received;
+
+        bytes_received = rtos_intertile_rx_len(
+                intertile_ctx,
+                appconfUSB_AUDIO_PORT,
+                portMAX_DELAY);
+
+        xassert(bytes_received == sizeof(usb_audio_out_xfer));
+
+        rtos_intertile_rx_data(
+                intertile_ctx,
+                usb_audio_out_xfer,
+                bytes_received);
+
+        if (xStreamBufferSpacesAvailable(ref_stream_buf) >= bytes_received) {
+            xStreamBufferSend(ref_stream_buf, usb_audio_out_xfer, bytes_received, 0);
+        } else {
+            usb_audio_stats.ref.overruns++;
+            rtos_printf("lost USB input samples\n");
+        }
+    }
+}
+#endif
+
 //--------------------------------------------------------------------+
 // Application Callback API Implementations
 //--------------------------------------------------------------------+
@@ -580,16 +712,19 @@ bool tud_audio_rx_done_post_read_cb(uint8_t rhport,
             xStreamBufferSend(samples_from_host_stream_buf, usb_audio_frames, stream_buffer_send_byte_count, 0);
         }
 
+        buffer_stats_level_update(&usb_audio_stats.from_host,
+                                  xStreamBufferBytesAvailable(samples_from_host_stream_buf) / RX_BYTES_PER_SAMPLE);
+
         /*
          * Wake up the task waiting on this buffer whenever there is one more
          * USB frame worth of audio data than the amount of data required to
-         * be input into the pipeline.
+         * be sent in one intertile transfer.
          *
          * This way the task will not wake up each time this task puts another
          * milliseconds of audio into the stream buffer, but rather once every
-         * pipeline frame time.
+         * transfer time.
          */
-        const size_t buffer_notify_level = stream_buffer_send_byte_count * (1 + USB_FRAMES_PER_VFE_FRAME);
+        const size_t buffer_notify_level = stream_buffer_send_byte_count * (1 + USB_FRAMES_PER_XFER);
 
         /*
          * TODO: If the above is modified such that not exactly AUDIO_FRAMES_PER_USB_FRAME / RATE_MULTIPLIER
@@ -600,6 +735,7 @@ bool tud_audio_rx_done_post_read_cb(uint8_t rhport,
             xTaskNotifyGive(usb_audio_out_task_handle);
         }
     } else {
+        usb_audio_stats.from_host.overruns++;
         rtos_printf("lost USB output samples\n");
     }
 
@@ -661,14 +797,15 @@ bool tud_audio_tx_done_pre_load_cb(uint8_t rhport,
     if (xStreamBufferIsFull(samples_to_host_stream_buf)) {
         xStreamBufferReset(samples_to_host_stream_buf);
         ready = 0;
+        usb_audio_stats.to_host.overruns++;
         rtos_printf("Oops buffer is full\n");
         return true;
     }
 
     bytes_available = xStreamBufferBytesAvailable(samples_to_host_stream_buf);
 
-    if (bytes_available >= 2 * sizeof(samp_t) * appconfAUDIO_PIPELINE_FRAME_ADVANCE * CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX) {
-        /* wait until we have 2 full audio pipeline output frames in the buffer */
+    if (bytes_available >= USB_AUDIO_TX_START_SAMPLES * TX_BYTES_PER_SAMPLE) {
+        /* wait until we have a full audio pipeline output frame plus margin in the buffer */
         ready = 1;
     }
 
@@ -696,6 +833,7 @@ bool tud_audio_tx_done_pre_load_cb(uint8_t rhport,
         } else {
             memset(stream_buffer_audio_frames, 0, tx_size_bytes);
         }
+        usb_audio_stats.to_host.underruns++;
         rtos_printf("Oops tx buffer underflowed!\n");
     }
 
@@ -705,6 +843,9 @@ bool tud_audio_tx_done_pre_load_cb(uint8_t rhport,
         num_rx_total += num_rx;
     }
 
+    buffer_stats_level_update(&usb_audio_stats.to_host,
+                              xStreamBufferBytesAvailable(samples_to_host_stream_buf) / TX_BYTES_PER_SAMPLE);
+
     if (RATE_MULTIPLIER == 3) {
         static int32_t __attribute__((aligned (8))) src_data[CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX][SRC_FF3V_FIR_TAPS_PER_PHASE];
 
@@ -777,11 +918,13 @@ bool tud_audio_set_itf_close_EP_cb(uint8_t rhport,
 #if AUDIO_OUTPUT_ENABLED
     if (itf == ITF_NUM_AUDIO_STREAMING_SPK) {
         spkr_interface_open = false;
+        buffer_stats_print("from host", &usb_audio_stats.from_host);
     }
 #endif
 #if AUDIO_INPUT_ENABLED
     if (itf == ITF_NUM_AUDIO_STREAMING_MIC) {
         mic_interface_open = false;
+        buffer_stats_print("to host", &usb_audio_stats.to_host);
     }
 #endif
 
@@ -802,22 +945,46 @@ void usb_audio_init(rtos_intertile_t *intertile_ctx,
     sampleFreqRng.subrange[0].bMax = appconfUSB_AUDIO_SAMPLE_RATE;
     sampleFreqRng.subrange[0].bRes = 0;
 
+    buffer_stats_reset(&usb_audio_stats.to_host);
+    buffer_stats_reset(&usb_audio_stats.from_host);
+
     rx_buffer = xStreamBufferCreate(2 * CFG_TUD_AUDIO_FUNC_1_EP_OUT_SW_BUF_SZ, 0);
 
     /*
      * Note: Given the way that the USB callback notifies usb_audio_out_task,
-     * the size of this buffer MUST NOT be greater than 2 VFE frames.
+     * the size of this buffer MUST NOT be greater than 2 intertile transfers.
      */
-    samples_from_host_stream_buf = xStreamBufferCreate(2 * sizeof(samp_t) * appconfAUDIO_PIPELINE_FRAME_ADVANCE * CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX,
+    samples_from_host_stream_buf = xStreamBufferCreate(2 * appconfUSB_AUDIO_XFER_SAMPLES * RX_BYTES_PER_SAMPLE,
                                             0);
 
     /*
-     * Note: The USB callback waits until there are at least 2 VFE frames
-     * in this buffer before starting to send to the host, so the size of
-     * this buffer MUST be AT LEAST 2 VFE frames.
+     * Note: The USB callback waits until there are at least
+     * USB_AUDIO_TX_START_SAMPLES in this buffer before starting to send
+     * to the host, so this buffer MUST also have room for the next VFE
+     * frame on top of that.
      */
-    samples_to_host_stream_buf = xStreamBufferCreate(3 * sizeof(samp_t) * appconfAUDIO_PIPELINE_FRAME_ADVANCE * CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX,
+    samples_to_host_stream_buf = xStreamBufferCreate(USB_AUDIO_TX_BUFFER_SAMPLES * TX_BYTES_PER_SAMPLE,
                                             0);
 
     xTaskCreate((TaskFunction_t) usb_audio_out_task, "usb_audio_out_task", portTASK_STACK_DEPTH(usb_audio_out_task), intertile_ctx, priority, &usb_audio_out_task_handle);
 }
+
+void usb_audio_recv_init(rtos_intertile_t *intertile_ctx,
+                         unsigned priority)
+{
+#if appconfUSB_AUDIO_LOW_LATENCY
+    buffer_stats_reset(&usb_audio_stats.ref);
+
+    /*
+     * Holds up to two VFE frames. The trigger level is one VFE frame so that
+     * usb_audio_recv() only returns whole frames.
+     */
+    ref_stream_buf = xStreamBufferCreate(2 * appconfAUDIO_PIPELINE_FRAME_ADVANCE * RX_BYTES_PER_SAMPLE,
+                                         appconfAUDIO_PIPELINE_FRAME_ADVANCE * RX_BYTES_PER_SAMPLE);
+
+    xTaskCreate((TaskFunction_t) usb_audio_recv_task, "usb_audio_recv_task", portTASK_STACK_DEPTH(usb_audio_recv_task), intertile_ctx, priority, NULL);
+#else
+    (void) intertile_ctx;
+    (void) priority;
+#endif
+}
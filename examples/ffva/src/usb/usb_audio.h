@@ -4,6 +4,10 @@
 #ifndef USB_AUDIO_H_
 #define USB_AUDIO_H_
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
 /*
  * frame_buffers format assumes:
  *   processed_audio_frame
@@ -27,5 +31,32 @@ void usb_audio_recv(rtos_intertile_t *intertile_ctx,
 
 void usb_audio_init(rtos_intertile_t *intertile_ctx, unsigned priority);
 
+/*
+ * Creates the task that receives USB audio from the USB tile and buffers
+ * it for usb_audio_recv(). Only required when appconfUSB_AUDIO_LOW_LATENCY
+ * is enabled, and must be called on the audio pipeline tile.
+ */
+void usb_audio_recv_init(rtos_intertile_t *intertile_ctx, unsigned priority);
+
+typedef struct {
+    size_t level_min;   /* Minimum fill level, in samples per channel */
+    size_t level_max;   /* Maximum fill level, in samples per channel */
+    uint32_t underruns; /* Times the buffer had too few samples to read */
+    uint32_t overruns;  /* Times the buffer had too little space to write */
+} usb_audio_buffer_stats_t;
+
+typedef struct {
+    usb_audio_buffer_stats_t to_host;   /* Pipeline output to USB, USB tile */
+    usb_audio_buffer_stats_t from_host; /* USB to intertile transfer, USB tile */
+    usb_audio_buffer_stats_t ref;       /* Intertile transfer to pipeline input, pipeline tile */
+} usb_audio_stats_t;
+
+/*
+ * Copies the USB audio buffer statistics into stats. Only the buffers that
+ * reside on the calling tile are populated. If reset is true, the
+ * statistics are cleared after they are copied.
+ */
+void usb_audio_stats_get(usb_audio_stats_t *stats, bool reset);
+
 
 #endif /* USB_AUDIO_H_ */
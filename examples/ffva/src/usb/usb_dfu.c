@@ -28,17 +28,164 @@
 #include <stdio.h>
 #include <string.h>
 #include <quadflashlib.h>
+#include <xcore/hwtimer.h>
 
 #include "FreeRTOS.h"
+#include "queue.h"
 #include "timers.h"
+#include "app_conf.h"
 #include "platform/driver_instances.h"
 #include "tusb.h"
+#include "dfu_writer.h"
+#include "usb_dfu.h"
 
 //--------------------------------------------------------------------+
 // MACRO CONSTANT TYPEDEF PROTYPES
 //--------------------------------------------------------------------+
 static void reboot(void);
 
+typedef enum {
+    DFU_MSG_START,      /* Start an image at addr, up to end */
+    DFU_MSG_BLOCK,      /* Program a block */
+    DFU_MSG_MANIFEST,   /* Finish the image, then finish the manifest stage */
+    DFU_MSG_ABORT,      /* Finish the image */
+} dfu_msg_type_t;
+
+typedef struct {
+    dfu_msg_type_t type;
+    unsigned addr;
+    unsigned end;
+    const uint8_t *data;    /* A block buffer, or the TinyUSB transfer buffer when deferred */
+    uint16_t length;
+    bool deferred;          /* The writer task finishes the download request after programming */
+} dfu_msg_t;
+
+/*
+ * Blocks are copied into one of the block buffers and the download request is
+ * finished at once, so the host sends the next block while the writer task
+ * programs this one. When every buffer is in use, the block is left in the
+ * TinyUSB transfer buffer and the writer task finishes the request once the
+ * block is programmed. The block buffers and the writer's spare sector are
+ * allocated by usb_dfu_init(), so they only take RAM on the USB tile.
+ */
+static QueueHandle_t free_bufs;
+static QueueHandle_t writer_queue;
+static dfu_writer_t writer;
+static uint32_t download_cb_max_ticks;
+
+static void flash_read(void *ctx, uint8_t *data, unsigned addr, size_t len)
+{
+    rtos_qspi_flash_read(ctx, data, addr, len);
+}
+
+static void flash_erase(void *ctx, unsigned addr, size_t len)
+{
+    rtos_qspi_flash_erase(ctx, addr, len);
+}
+
+static void flash_write(void *ctx, const uint8_t *data, unsigned addr, size_t len)
+{
+    rtos_qspi_flash_write(ctx, (uint8_t *) data, addr, len);
+}
+
+static void writer_msg_send(const dfu_msg_t *msg)
+{
+    /* Holds every message that can be outstanding, so never blocks */
+    xQueueSend(writer_queue, msg, portMAX_DELAY);
+}
+
+static void dfu_writer_task(void *arg)
+{
+    (void) arg;
+    dfu_msg_t msg;
+
+    for (;;) {
+        /* Erase ahead while there is nothing to program */
+        while (xQueueReceive(writer_queue, &msg, 0) != pdTRUE) {
+            rtos_qspi_flash_lock(qspi_flash_ctx);
+            bool erased = dfu_writer_erase_ahead(&writer);
+            rtos_qspi_flash_unlock(qspi_flash_ctx);
+            if (!erased) {
+                xQueueReceive(writer_queue, &msg, portMAX_DELAY);
+                break;
+            }
+        }
+
+        switch (msg.type) {
+        case DFU_MSG_START:
+            xassert(CFG_TUD_DFU_XFER_BUFSIZE == rtos_qspi_flash_sector_size_get(qspi_flash_ctx));
+            dfu_writer_start(&writer, msg.addr, msg.end);
+            download_cb_max_ticks = 0;
+            break;
+
+        case DFU_MSG_BLOCK:
+            rtos_printf("write %d at 0x%x\n", msg.length, msg.addr);
+            rtos_qspi_flash_lock(qspi_flash_ctx);
+            dfu_writer_program(&writer, msg.addr, msg.data, msg.length);
+            rtos_qspi_flash_unlock(qspi_flash_ctx);
+            if (msg.deferred) {
+                tud_dfu_finish_flashing(DFU_STATUS_OK);
+            } else {
+                xQueueSend(free_bufs, &msg.data, 0);
+            }
+            break;
+
+        case DFU_MSG_MANIFEST:
+        case DFU_MSG_ABORT:
+            rtos_qspi_flash_lock(qspi_flash_ctx);
+            dfu_writer_finish(&writer);
+            rtos_qspi_flash_unlock(qspi_flash_ctx);
+            rtos_printf("DFU: %u sectors, %u read back, %u of %u erased ahead used, %u restored, longest download callback %u us\n",
+                        (unsigned) writer.stats.sectors, (unsigned) writer.stats.reads, (unsigned) writer.stats.erase_ahead_hits,
+                        (unsigned) writer.stats.erase_aheads, (unsigned) writer.stats.restores, (unsigned) (download_cb_max_ticks / 100));
+            if (msg.type == DFU_MSG_MANIFEST) {
+                /* Perform a read to ensure all writes have been flushed */
+                uint32_t dummy = 0;
+                rtos_qspi_flash_read(
+                        qspi_flash_ctx,
+                        (uint8_t *)&dummy,
+                        0,
+                        sizeof(dummy));
+
+                // flashing op for manifest is complete without error
+                // Application can perform checksum, should it fail, use appropriate status such as errVERIFY.
+                tud_dfu_finish_flashing(DFU_STATUS_OK);
+            }
+            break;
+        }
+    }
+}
+
+void usb_dfu_init(unsigned priority)
+{
+    dfu_writer_flash_t flash = {
+        .read = flash_read,
+        .erase = flash_erase,
+        .write = flash_write,
+        .ctx = qspi_flash_ctx,
+    };
+    /* The spare sector, followed by the block buffers */
+    uint8_t *bufs = pvPortMalloc((appconfUSB_DFU_BLOCK_BUFFERS + 1) * CFG_TUD_DFU_XFER_BUFSIZE);
+
+    configASSERT(bufs);
+    dfu_writer_init(&writer, &flash, CFG_TUD_DFU_XFER_BUFSIZE, bufs, appconfUSB_DFU_ERASE_AHEAD);
+
+    free_bufs = xQueueCreate(appconfUSB_DFU_BLOCK_BUFFERS, sizeof(uint8_t *));
+    /* A start, every buffered block, a deferred block and a manifest or abort */
+    writer_queue = xQueueCreate(appconfUSB_DFU_BLOCK_BUFFERS + 3, sizeof(dfu_msg_t));
+    for (int i = 0; i < appconfUSB_DFU_BLOCK_BUFFERS; i++) {
+        uint8_t *buf = &bufs[(i + 1) * CFG_TUD_DFU_XFER_BUFSIZE];
+        xQueueSend(free_bufs, &buf, 0);
+    }
+
+    xTaskCreate((TaskFunction_t) dfu_writer_task,
+                "dfu_writer",
+                RTOS_THREAD_STACK_SIZE(dfu_writer_task),
+                NULL,
+                priority,
+                NULL);
+}
+
 //--------------------------------------------------------------------+
 // DFU callbacks
 // Note: alt is used as the partition number, in order to support multiple partitions like FLASH, EEPROM, etc.
@@ -54,10 +201,11 @@ static uint32_t dn_base_addr = 0;
 uint32_t tud_dfu_get_timeout_cb(uint8_t alt, uint8_t state)
 {
     if ( state == DFU_DNBUSY ) {
-        return 10;  // 10 ms
+        // A free block buffer means the block will be accepted at once
+        return (uxQueueMessagesWaiting(free_bufs) > 0) ? 0 : appconfUSB_DFU_BUSY_POLL_MS;
     } else if (state == DFU_MANIFEST) {
-        // since we don't buffer entire image and do any flashing in manifest stage
-        return 0;
+        // the writer task finishes programming the buffered blocks in the manifest stage
+        return appconfUSB_DFU_BUSY_POLL_MS;
     }
   
     return 0;
@@ -68,6 +216,7 @@ uint32_t tud_dfu_get_timeout_cb(uint8_t alt, uint8_t state)
 // Once finished flashing, application must call tud_dfu_finish_flashing()
 void tud_dfu_download_cb(uint8_t alt, uint16_t block_num, uint8_t const* data, uint16_t length)
 {
+    uint32_t start = get_reference_time();
     rtos_printf("Received Alt %d BlockNum %d of length %d\n", alt, block_num, length);
 
     unsigned data_partition_base_addr = rtos_dfu_image_get_data_partition_addr(dfu_image_ctx);
@@ -81,6 +230,8 @@ void tud_dfu_download_cb(uint8_t alt, uint16_t block_num, uint8_t const* data, u
                 total_len = 0;
                 dn_base_addr = rtos_dfu_image_get_upgrade_addr(dfu_image_ctx);
                 bytes_avail = data_partition_base_addr - dn_base_addr;    
+                writer_msg_send(&(dfu_msg_t) { .type = DFU_MSG_START, .addr = dn_base_addr, .end = data_partition_base_addr });
+                rtos_printf("Using addr 0x%x\nsize %u\n", dn_base_addr, bytes_avail);
             }
             /* fallthrough */
         case 2:
@@ -88,47 +239,41 @@ void tud_dfu_download_cb(uint8_t alt, uint16_t block_num, uint8_t const* data, u
                 total_len = 0;
                 dn_base_addr = data_partition_base_addr;
                 bytes_avail = rtos_qspi_flash_size_get(qspi_flash_ctx) - dn_base_addr;    
+                writer_msg_send(&(dfu_msg_t) { .type = DFU_MSG_START, .addr = dn_base_addr, .end = dn_base_addr + bytes_avail });
+                rtos_printf("Using addr 0x%x\nsize %u\n", dn_base_addr, bytes_avail);
             }
-            rtos_printf("Using addr 0x%x\nsize %u\n", dn_base_addr, bytes_avail);
-            if(length > 0) {
-                unsigned cur_addr = dn_base_addr + (block_num * CFG_TUD_DFU_XFER_BUFSIZE);
-                if((bytes_avail - total_len) >= length) {
-                    rtos_printf("write %d at 0x%x\n", length, cur_addr);
-
-                    size_t sector_size = rtos_qspi_flash_sector_size_get(qspi_flash_ctx);
-                    xassert(CFG_TUD_DFU_XFER_BUFSIZE == sector_size);
-
-                    uint8_t *tmp_buf = rtos_osal_malloc( sizeof(uint8_t) * sector_size);
-                    rtos_qspi_flash_lock(qspi_flash_ctx);
-                    {
-                        rtos_qspi_flash_read(
-                                qspi_flash_ctx,
-                                tmp_buf,
-                                cur_addr,
-                                sector_size);
-                        memcpy(tmp_buf, data, length);
-                        rtos_qspi_flash_erase(
-                                qspi_flash_ctx,
-                                cur_addr,
-                                sector_size);
-                        rtos_qspi_flash_write(
-                                qspi_flash_ctx,
-                                (uint8_t *) tmp_buf,
-                                cur_addr,
-                                sector_size);
-                    }
-                    rtos_qspi_flash_unlock(qspi_flash_ctx);
-                    rtos_osal_free(tmp_buf);
-                    total_len += length;
+            if (length == 0) {
+                tud_dfu_finish_flashing(DFU_STATUS_OK);
+            } else if ((bytes_avail - total_len) >= length) {
+                dfu_msg_t msg = {
+                    .type = DFU_MSG_BLOCK,
+                    .addr = dn_base_addr + (block_num * CFG_TUD_DFU_XFER_BUFSIZE),
+                    .length = length,
+                };
+                uint8_t *buf;
+
+                total_len += length;
+                if (xQueueReceive(free_bufs, &buf, 0) == pdTRUE) {
+                    memcpy(buf, data, length);
+                    msg.data = buf;
+                    writer_msg_send(&msg);
+                    tud_dfu_finish_flashing(DFU_STATUS_OK);
                 } else {
-                    rtos_printf("Insufficient space\n");
-                    tud_dfu_finish_flashing(DFU_STATUS_ERR_ADDRESS);
+                    msg.data = data;
+                    msg.deferred = true;
+                    writer_msg_send(&msg);
                 }
+            } else {
+                rtos_printf("Insufficient space\n");
+                tud_dfu_finish_flashing(DFU_STATUS_ERR_ADDRESS);
             }
-
-            tud_dfu_finish_flashing(DFU_STATUS_OK);
             break;
     }
+
+    uint32_t ticks = get_reference_time() - start;
+    if (ticks > download_cb_max_ticks) {
+        download_cb_max_ticks = ticks;
+    }
 }
 
 // Invoked when download process is complete, received DFU_DNLOAD (wLength=0) following by DFU_GETSTATUS (state=Manifest)
@@ -139,20 +284,11 @@ void tud_dfu_manifest_cb(uint8_t alt)
     (void) alt;
     rtos_printf("Download completed, enter manifestation\n");
 
-    /* Perform a read to ensure all writes have been flushed */
-    uint32_t dummy = 0;
-    rtos_qspi_flash_read(
-            qspi_flash_ctx,
-            (uint8_t *)&dummy,
-            0,
-            sizeof(dummy));
-    
     /* Reset download */
     dn_base_addr = 0;
 
-    // flashing op for manifest is complete without error
-    // Application can perform checksum, should it fail, use appropriate status such as errVERIFY.
-    tud_dfu_finish_flashing(DFU_STATUS_OK);
+    /* The writer task finishes flashing after the blocks queued before this */
+    writer_msg_send(&(dfu_msg_t) { .type = DFU_MSG_MANIFEST });
 }
 
 // Invoked when received DFU_UPLOAD request
@@ -201,6 +337,20 @@ void tud_dfu_abort_cb(uint8_t alt)
 {
     (void) alt;
     rtos_printf("Host aborted transfer\n");
+
+    if (dn_base_addr != 0) {
+        dn_base_addr = 0;
+        writer_msg_send(&(dfu_msg_t) { .type = DFU_MSG_ABORT });
+    }
+}
+
+void usb_dfu_reset(void)
+{
+    if (dn_base_addr != 0) {
+        rtos_printf("DFU download abandoned\n");
+        dn_base_addr = 0;
+        writer_msg_send(&(dfu_msg_t) { .type = DFU_MSG_ABORT });
+    }
 }
 
 // Invoked when a DFU_DETACH request is received
@@ -0,0 +1,20 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#ifndef USB_DFU_H_
+#define USB_DFU_H_
+
+/*
+ * Creates the task that programs DFU download blocks into flash, so the
+ * download callback returns without waiting for the flash. Must be called
+ * on the USB tile before the DFU callbacks run.
+ */
+void usb_dfu_init(unsigned priority);
+
+/*
+ * Abandons any download in progress, restoring a sector the writer task
+ * erased ahead. Call when the device is mounted or unmounted.
+ */
+void usb_dfu_reset(void);
+
+#endif /* USB_DFU_H_ */
@@ -102,6 +102,8 @@ set(APP_LINK_OPTIONS
 set(APP_COMMON_LINK_LIBRARIES
     sln_voice::app::ffd::ap
     sln_voice::app::asr::sensory
+    sln_voice::app::audio_frame_utils
+    sln_voice::app::telemetry
     rtos::drivers::clock_control
 )
 
@@ -67,6 +67,32 @@
 #define appconfINTENT_TRANSPORT_DELAY_MS        50
 #endif
 
+/* Skip wake word processing of audio that the audio pipeline's VNR estimator
+ * classifies as non-speech */
+#ifndef appconfWAKEWORD_VNR_GATE_ENABLED
+#define appconfWAKEWORD_VNR_GATE_ENABLED        0
+#endif
+
+/* VNR estimate, from 0 to 1, at or above which a frame is treated as speech */
+#ifndef appconfWAKEWORD_VNR_GATE_THRESHOLD
+#define appconfWAKEWORD_VNR_GATE_THRESHOLD      (0.25f)
+#endif
+
+/* Frames processed after the last speech frame, 34 frames is about 0.5s */
+#ifndef appconfWAKEWORD_VNR_GATE_HANGOVER_FRAMES
+#define appconfWAKEWORD_VNR_GATE_HANGOVER_FRAMES    34
+#endif
+
+/* Non-speech frames replayed to the ASR when speech starts, to cover the VNR estimator's onset delay */
+#ifndef appconfWAKEWORD_VNR_GATE_LOOKBACK_FRAMES
+#define appconfWAKEWORD_VNR_GATE_LOOKBACK_FRAMES    8
+#endif
+
+/* Frames between prints of the share of frames processed, 0 to disable */
+#ifndef appconfWAKEWORD_VNR_GATE_STATS_FRAMES
+#define appconfWAKEWORD_VNR_GATE_STATS_FRAMES       4000
+#endif
+
 #ifndef appconfINTENT_I2C_OUTPUT_ENABLED
 #define appconfINTENT_I2C_OUTPUT_ENABLED        1
 #endif
@@ -130,6 +156,24 @@
 #define appconfLOW_POWER_INHIBIT_MS             1000
 #endif
 
+/* Milliseconds between samples of the queue and stream buffer occupancy
+ * reported by the telemetry service, built with MEM_ANALYSIS_ENABLED */
+#ifndef appconfTELEMETRY_SAMPLE_MS
+#define appconfTELEMETRY_SAMPLE_MS              10
+#endif
+
+/* Milliseconds between telemetry records, 0 to publish only when
+ * telemetry_publish_request() is called */
+#ifndef appconfTELEMETRY_PUBLISH_MS
+#define appconfTELEMETRY_PUBLISH_MS             5000
+#endif
+
+/* Milliseconds over which each core load reported by the telemetry service
+ * is measured */
+#ifndef appconfCPU_LOAD_WINDOW_MS
+#define appconfCPU_LOAD_WINDOW_MS               1000
+#endif
+
 #ifndef appconfAUDIO_PIPELINE_SKIP_IC_AND_VNR
 #define appconfAUDIO_PIPELINE_SKIP_IC_AND_VNR   0
 #endif
@@ -8,4 +8,12 @@
 #error "This application currently expects the ASR and audio pipeline to be on separate tiles."
 #endif
 
+#if appconfWAKEWORD_VNR_GATE_ENABLED && appconfAUDIO_PIPELINE_SKIP_IC_AND_VNR
+#error appconfWAKEWORD_VNR_GATE_ENABLED requires the VNR estimate, appconfAUDIO_PIPELINE_SKIP_IC_AND_VNR must be 0
+#endif
+
+#if (appconfCPU_LOAD_WINDOW_MS < 1) || (appconfCPU_LOAD_WINDOW_MS > 40000)
+#error appconfCPU_LOAD_WINDOW_MS must be from 1 to 40000
+#endif
+
 #endif /* APP_CONF_CHECK_H_ */
@@ -15,6 +15,7 @@
 #include "app_conf.h"
 #include "platform/driver_instances.h"
 #include "intent_engine/intent_engine.h"
+#include "telemetry.h"
 
 #if ON_TILE(ASR_TILE_NO)
 
@@ -77,6 +78,7 @@ void intent_engine_intertile_task_create(uint32_t priority)
     samples_to_engine_stream_buf = xStreamBufferCreate(
                                            appconfINTENT_FRAME_BUFFER_MULT * appconfAUDIO_PIPELINE_FRAME_ADVANCE,
                                            appconfINTENT_SAMPLE_BLOCK_LENGTH);
+    telemetry_stream_buffer_register("intent_samps", samples_to_engine_stream_buf);
 
     xTaskCreate((TaskFunction_t)intent_engine_intertile_samples_in_task,
                 "int_intertile_rx",
@@ -23,6 +23,7 @@
 #include "platform/platform_init.h"
 #include "platform/driver_instances.h"
 #include "audio_pipeline.h"
+#include "audio_frame_utils.h"
 #include "intent_engine/intent_engine.h"
 #include "wakeword/wakeword.h"
 #include "fs_support.h"
@@ -32,11 +33,18 @@
 #include "power/power_state.h"
 #include "power/power_control.h"
 #include "power/low_power_audio_buffer.h"
+#include "cpu_load.h"
+#include "telemetry.h"
 
 #ifndef MEM_ANALYSIS_ENABLED
 #define MEM_ANALYSIS_ENABLED 0
 #endif
 
+#if ON_TILE(AUDIO_PIPELINE_TILE_NO)
+/* Filled in by the audio pipeline with the VNR estimate of each output frame */
+static trace_data_t pipeline_output_data;
+#endif
+
 void startup_task(void *arg);
 void tile_common_init(chanend_t c);
 
@@ -104,14 +112,14 @@ int audio_pipeline_output(void *output_app_data,
 {
 #if ON_TILE(AUDIO_PIPELINE_TILE_NO)
 
-    asr_sample_t asr_buf[appconfAUDIO_PIPELINE_FRAME_ADVANCE] = {0};
+    asr_sample_t asr_buf[appconfAUDIO_PIPELINE_FRAME_ADVANCE] __attribute__((aligned(4)));
 
-    for (int i = 0; i < frame_count; i++) {
-        asr_buf[i] = ((int32_t *)output_audio_frames)[i] >> 16;
-    }
+    xassert(frame_count == appconfAUDIO_PIPELINE_FRAME_ADVANCE);
+    audio_frame_s32_to_s16(asr_buf, (int32_t *)output_audio_frames, frame_count);
     vPortFree(output_audio_frames);
 
-    wakeword_result_t ww_res = wakeword_handler((asr_sample_t *)asr_buf, frame_count);
+    trace_data_t *output_data = (trace_data_t *)output_app_data;
+    wakeword_result_t ww_res = wakeword_handler((asr_sample_t *)asr_buf, frame_count, output_data->output_vnr_pred);
 
     switch (ww_res) {
         case WAKEWORD_ERROR:
@@ -163,16 +171,6 @@ void vApplicationMallocFailedHook(void)
     for(;;);
 }
 
-#if MEM_ANALYSIS_ENABLED
-static void mem_analysis(void)
-{
-    for (;;) {
-        rtos_printf("Tile[%d]:\n\tMinimum heap free: %d\n\tCurrent heap free: %d\n", THIS_XCORE_TILE, xPortGetMinimumEverFreeHeapSize(), xPortGetFreeHeapSize());
-        vTaskDelay(pdMS_TO_TICKS(5000));
-    }
-}
-#endif
-
 void startup_task(void *arg)
 {
     rtos_printf("Startup task running from tile %d on core %d\n", THIS_XCORE_TILE, portGET_CORE_ID());
@@ -207,6 +205,7 @@ void startup_task(void *arg)
 
 #if ON_TILE(ASR_TILE_NO)
     QueueHandle_t q_intent = xQueueCreate(appconfINTENT_QUEUE_LEN, sizeof(int32_t));
+    telemetry_queue_register("intent", q_intent);
     intent_handler_create(appconfINTENT_MODEL_RUNNER_TASK_PRIORITY, q_intent);
     intent_engine_create(appconfINTENT_MODEL_RUNNER_TASK_PRIORITY, q_intent);
 #endif
@@ -215,7 +214,7 @@ void startup_task(void *arg)
     // Wait until the intent engine is initialized before starting the
     // audio pipeline.
     intent_engine_ready_sync();
-    audio_pipeline_init(NULL, NULL);
+    audio_pipeline_init(NULL, &pipeline_output_data);
 
     set_local_tile_processor_clk_div(1);
     enable_local_tile_processor_clock_divider();
@@ -223,7 +222,8 @@ void startup_task(void *arg)
 #endif
 
 #if MEM_ANALYSIS_ENABLED
-    mem_analysis();
+    cpu_load_init(appconfCPU_LOAD_WINDOW_MS);
+    telemetry_run(appconfTELEMETRY_SAMPLE_MS, appconfTELEMETRY_PUBLISH_MS);
 #else
     vTaskSuspend(NULL);
     while(1){;} /* Trap */
@@ -233,6 +233,9 @@ void startup_task(void *arg)
 void vApplicationMinimalIdleHook(void)
 {
     rtos_printf("idle hook on tile %d core %d\n", THIS_XCORE_TILE, rtos_core_id_get());
+#if MEM_ANALYSIS_ENABLED
+    cpu_load_idle_hook();
+#endif
     asm volatile("waiteu");
 }
 
@@ -60,9 +60,13 @@ your application. */
 #define configUSE_DAEMON_TASK_STARTUP_HOOK      0
 #define configUSE_CORE_INIT_HOOK                0
 
-/* Run time and task stats gathering related definitions. */
-#define configGENERATE_RUN_TIME_STATS           0
-#define configUSE_TRACE_FACILITY                0
+/* Run time and task stats gathering related definitions.
+ * Enabled for the telemetry service built with MEM_ANALYSIS_ENABLED. */
+#ifndef MEM_ANALYSIS_ENABLED
+#define MEM_ANALYSIS_ENABLED                    0
+#endif
+#define configGENERATE_RUN_TIME_STATS           MEM_ANALYSIS_ENABLED
+#define configUSE_TRACE_FACILITY                MEM_ANALYSIS_ENABLED
 #define configUSE_STATS_FORMATTING_FUNCTIONS    2 /* Setting to 2 does not include <stdio.h> in tasks.c */
 
 /* Co-routine related definitions. */
@@ -120,5 +124,10 @@ your application. */
 #define INCLUDE_xQueueGetMutexHolder            1
 
 /* A header file that defines trace macro can be included here. */
+#if MEM_ANALYSIS_ENABLED
+#include "cpu_load.h"
+#define traceTASK_SWITCHED_IN()                 cpu_load_task_switched_in()
+#define traceTASK_SWITCHED_OUT()                cpu_load_task_switched_out()
+#endif
 
 #endif /* FREERTOS_CONFIG_H */
@@ -12,6 +12,7 @@
 /* App headers */
 #include "app_conf.h"
 #include "asr.h"
+#include "asr_vnr_gate.h"
 #include "device_memory_impl.h"
 #include "wakeword/wakeword.h"
 #include "platform/driver_instances.h"
@@ -49,20 +50,50 @@ extern const unsigned short WAKEWORD_SEARCH_VAR[];
 static asr_port_t asr_ctx;
 static devmem_manager_t devmem_ctx;
 
+#if appconfWAKEWORD_VNR_GATE_ENABLED
+static asr_vnr_gate_t vnr_gate;
+static asr_sample_t vnr_gate_lookback[appconfWAKEWORD_VNR_GATE_LOOKBACK_FRAMES * SAMPLES_PER_ASR];
+#endif
+
 void wakeword_init(void)
 {
     devmem_init(&devmem_ctx);
     asr_ctx = asr_init((int32_t *)WAKEWORD_NET_VAR, (int32_t *)WAKEWORD_SEARCH_VAR, &devmem_ctx);
     asr_reset(asr_ctx);
+#if appconfWAKEWORD_VNR_GATE_ENABLED
+    asr_vnr_gate_init(&vnr_gate, appconfWAKEWORD_VNR_GATE_THRESHOLD, appconfWAKEWORD_VNR_GATE_HANGOVER_FRAMES,
+                      appconfWAKEWORD_VNR_GATE_LOOKBACK_FRAMES, vnr_gate_lookback, SAMPLES_PER_ASR);
+#endif
 }
 
-wakeword_result_t wakeword_handler(asr_sample_t *buf, size_t num_frames)
+wakeword_result_t wakeword_handler(asr_sample_t *buf, size_t num_frames, float vnr_pred)
 {
     asr_result_t asr_result;
     asr_error_t asr_error;
     wakeword_result_t retval = WAKEWORD_NOT_FOUND;
 
+#if appconfWAKEWORD_VNR_GATE_ENABLED
+    bool processed;
+    bool lookback_found;
+    asr_error = asr_vnr_gate_process(&vnr_gate, asr_ctx, buf, num_frames, vnr_pred, &processed,
+                                     &asr_result, &lookback_found);
+#if appconfWAKEWORD_VNR_GATE_STATS_FRAMES
+    if (vnr_gate.bricks >= appconfWAKEWORD_VNR_GATE_STATS_FRAMES) {
+        asr_vnr_gate_print_stats(&vnr_gate, "Wakeword");
+    }
+#endif
+    // The wake word may end in the onset replayed when the gate opened
+    if (lookback_found && IS_WAKEWORD(asr_result.id)) {
+        debug_printf("KEYWORD: " RTOS_STRINGIFY(WAKEWORD_ID) ", " WAKEWORD_PHRASE "\n");
+        return WAKEWORD_FOUND;
+    }
+    if (!processed) {
+        return retval;
+    }
+#else
+    (void) vnr_pred;
     asr_error = asr_process(asr_ctx, buf, num_frames);
+#endif
 
     if (asr_error == ASR_OK) {
         asr_error = asr_get_result(asr_ctx, &asr_result);
@@ -16,6 +16,6 @@ typedef enum {
 } wakeword_result_t;
 
 void wakeword_init(void);
-wakeword_result_t wakeword_handler(asr_sample_t *buf, size_t num_frames);
+wakeword_result_t wakeword_handler(asr_sample_t *buf, size_t num_frames, float vnr_pred);
 
 #endif /* WAKEWORD_ENGINE_H_ */
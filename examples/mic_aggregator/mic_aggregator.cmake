@@ -50,8 +50,13 @@ set( APP_INCLUDES
     ${MIC_ARRAY_DEMO_PATH}/common/src
 )
 
+set(MIC_AGGREGATOR_SAMPLES_PER_FRAME 1 CACHE STRING "Samples per channel processed by the hub each loop, 1 to 16")
+set(MIC_AGGREGATOR_MIC_COUNT 16 CACHE STRING "Number of PDM mics, 8, 16, 24 or 32. Above 16 a second mic array runs on tile 1, TDM build only")
+
 set(APP_COMPILE_DEFINITIONS
     DEBUG_PRINT_ENABLE=1
+    MIC_ARRAY_CONFIG_SAMPLES_PER_FRAME=${MIC_AGGREGATOR_SAMPLES_PER_FRAME}
+    MIC_ARRAY_CONFIG_MIC_COUNT=${MIC_AGGREGATOR_MIC_COUNT}
     __xua_conf_h_exists__=1
     XUD_SERIES_SUPPORT=4
     USB_TILE=tile[1]
@@ -70,25 +75,38 @@ set(APP_COMMON_LINK_LIBRARIES
     lib_i2c
     lib_mic_array
     lib_xud
+    lib_xcore_math
 )
 
 
 #*************************
 # Create Targets
 #*************************
-foreach(CONFIG tdm usb)
-    set(TARGET_NAME example_mic_aggregator_${CONFIG})
-    add_executable(${TARGET_NAME} EXCLUDE_FROM_ALL )
-    target_sources(${TARGET_NAME} PUBLIC ${APP_SOURCES} ${XUA_SOURCES})
-    target_include_directories(${TARGET_NAME} PUBLIC ${APP_INCLUDES})
-    string(TOUPPER ${CONFIG} CONFIG_UPPER)
-    target_compile_definitions(${TARGET_NAME} PUBLIC ${APP_COMPILE_DEFINITIONS} CONFIG_${CONFIG_UPPER}=1)
-    target_compile_options(${TARGET_NAME} PRIVATE ${APP_COMPILER_FLAGS})
-    target_link_libraries(${TARGET_NAME} PUBLIC ${APP_COMMON_LINK_LIBRARIES})
-    target_link_options(${TARGET_NAME} PRIVATE ${APP_LINK_OPTIONS})
-    unset(TARGET_NAME)
+# The _bench targets replace the mic arrays with pattern generators and report timing, see README
+# More than 16 mics needs tile 1 ports that XUD and XUA use, so there are no USB targets for those counts
+if(MIC_AGGREGATOR_MIC_COUNT GREATER 16)
+    set(MIC_AGGREGATOR_CONFIGS tdm)
+else()
+    set(MIC_AGGREGATOR_CONFIGS tdm usb)
+endif()
+foreach(CONFIG ${MIC_AGGREGATOR_CONFIGS})
+    foreach(BENCH 0 1)
+        if(BENCH)
+            set(TARGET_NAME example_mic_aggregator_${CONFIG}_bench)
+        else()
+            set(TARGET_NAME example_mic_aggregator_${CONFIG})
+        endif()
+        add_executable(${TARGET_NAME} EXCLUDE_FROM_ALL )
+        target_sources(${TARGET_NAME} PUBLIC ${APP_SOURCES} ${XUA_SOURCES})
+        target_include_directories(${TARGET_NAME} PUBLIC ${APP_INCLUDES})
+        string(TOUPPER ${CONFIG} CONFIG_UPPER)
+        target_compile_definitions(${TARGET_NAME} PUBLIC ${APP_COMPILE_DEFINITIONS} CONFIG_${CONFIG_UPPER}=1 MIC_AGGREGATOR_BENCH=${BENCH})
+        target_compile_options(${TARGET_NAME} PRIVATE ${APP_COMPILER_FLAGS})
+        target_link_libraries(${TARGET_NAME} PUBLIC ${APP_COMMON_LINK_LIBRARIES})
+        target_link_options(${TARGET_NAME} PRIVATE ${APP_LINK_OPTIONS})
 
-    # Copy output to a handy location
-    install(FILES ${CMAKE_CURRENT_BINARY_DIR}/${TARGET_NAME}.xe DESTINATION ${CMAKE_INSTALL_PREFIX}/bin)
-    unset(TARGET_NAME)
+        # Copy output to a handy location
+        install(FILES ${CMAKE_CURRENT_BINARY_DIR}/${TARGET_NAME}.xe DESTINATION ${CMAKE_INSTALL_PREFIX}/bin)
+        unset(TARGET_NAME)
+    endforeach()
 endforeach()
@@ -0,0 +1,69 @@
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+import argparse
+import os
+import re
+
+DEFAULT_HEADER = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "src", "decimator_cost.h")
+PDM_FREQ = 3072000
+THREADS_PER_TILE = 8
+
+def parse_cost_header(fname):
+    with open(fname, "r") as f:
+        return {k: int(v) for k, v in re.findall(r"^#define\s+(DECIMATOR_COST_\w+)\s+(\d+)\b", f.read(), re.M)}
+
+class DecimatorCostModel:
+    """Mirrors the macros in decimator_cost.h. The costs are estimates, test/mic_aggregator_headroom checks them against measured times"""
+    def __init__(self, consts):
+        self.c = consts
+
+    def channel_ticks(self, dec_factor, taps):
+        return dec_factor * self.c["DECIMATOR_COST_STAGE1_TICKS"] + self.c["DECIMATOR_COST_STAGE2_TICKS"] + \
+               (taps * self.c["DECIMATOR_COST_STAGE2_TAPS_PER_TICK_X4"]) // 4
+
+    def task_ticks(self, channels, dec_factor, taps):
+        return self.c["DECIMATOR_COST_TASK_TICKS"] + channels * self.channel_ticks(dec_factor, taps)
+
+    def load_percent(self, mics, tasks, dec_factor, taps, rate):
+        channels = -(-mics // tasks)
+        return (100 * self.task_ticks(channels, dec_factor, taps)) // (self.c["DECIMATOR_COST_REF_CLOCK_HZ"] // rate)
+
+    def min_tasks(self, mics, dec_factor, taps, rate, max_load):
+        for tasks in range(1, self.c["DECIMATOR_COST_MAX_TASKS"]):
+            if self.load_percent(mics, tasks, dec_factor, taps, rate) <= max_load:
+                return tasks
+        return self.c["DECIMATOR_COST_MAX_TASKS"]
+
+def partition(mics, tasks):
+    return [mics // tasks + (1 if t < mics % tasks else 0) for t in range(tasks)]
+
+def parse_arguments():
+    parser = argparse.ArgumentParser(description="Evaluate mic aggregator decimator configurations with the cost model in decimator_cost.h")
+    parser.add_argument("--header", default=DEFAULT_HEADER, help="Cost model header")
+    parser.add_argument("--mics", type=int, nargs="+", default=[8, 16, 24, 32], help="Total mic counts")
+    parser.add_argument("--rates", type=int, nargs="+", default=[16000, 32000, 48000], help="Output sample rates")
+    parser.add_argument("--taps", type=int, default=96, help="Stage 2 filter tap count")
+    parser.add_argument("--max-load", type=int, default=80, help="Maximum load per task, percent")
+    parser.add_argument("--mics-per-array", type=int, default=16, help="Mics decimated on each tile")
+    args = parser.parse_args()
+    return args
+
+if __name__ == "__main__":
+    args = parse_arguments()
+    model = DecimatorCostModel(parse_cost_header(args.header))
+
+    print(f"{'mics':>5} {'rate':>6} {'array':>5} {'tasks':>5} {'partition':<16} {'ticks':>6} {'budget':>6} {'load':>5}")
+    for rate in args.rates:
+        dec_factor = PDM_FREQ // (32 * rate)
+        for mics in args.mics:
+            arrays = []
+            while mics - sum(arrays) > 0:
+                arrays.append(min(args.mics_per_array, mics - sum(arrays)))
+            # The app uses one task count for all arrays, chosen for the largest
+            tasks = model.min_tasks(arrays[0], dec_factor, args.taps, rate, args.max_load)
+            for name, array_mics in zip("AB", arrays):
+                channels = partition(array_mics, tasks)
+                ticks = model.task_ticks(max(channels), dec_factor, args.taps)
+                load = model.load_percent(array_mics, tasks, dec_factor, args.taps, rate)
+                flag = "" if load <= args.max_load else " over"
+                print(f"{mics:>5} {rate:>6} {name:>5} {tasks:>5} {'/'.join(map(str, channels)):<16} {ticks:>6} {model.c['DECIMATOR_COST_REF_CLOCK_HZ'] // rate:>6} {load:>4}%{flag}")
@@ -5,19 +5,61 @@
 
 #pragma once
 
+#include "mic_array_48k_decimator_coeffs.h"
+#include "decimator_cost.h"
+
 #define MIC_ARRAY_CONFIG_MCLK_FREQ          24576000
 #define MIC_ARRAY_CONFIG_PDM_FREQ           3072000
 #define MIC_ARRAY_CONFIG_USE_DDR            1
 #define MIC_ARRAY_CONFIG_PORT_MCLK          XS1_PORT_1D // X0D11, J14 - Pin 15, '11'
 #define MIC_ARRAY_CONFIG_PORT_PDM_CLK       XS1_PORT_1A // X0D00, J14 - Pin 2, '00'
 #define MIC_ARRAY_CONFIG_PORT_PDM_DATA      XS1_PORT_8B // X0D14..X0D21 | J14 - Pin 3,5,12,14 and Pin 6,7,10,11
-#define MIC_ARRAY_CONFIG_MIC_COUNT          16          // Application is currently hard coded to 16
-#define MIC_ARRAY_CONFIG_SAMPLES_PER_FRAME  1           // Application is currently hard coded to 1
-#define MIC_ARRAY_NUM_DECIMATOR_TASKS       3           // Defines the number of subtasks to perform the decimation process on.
+#ifndef MIC_ARRAY_CONFIG_MIC_COUNT
+#define MIC_ARRAY_CONFIG_MIC_COUNT          16          // Total mic count. 24 and 32 add a second mic array on tile 1
+#endif
+#ifndef MIC_ARRAY_CONFIG_SAMPLES_PER_FRAME
+#define MIC_ARRAY_CONFIG_SAMPLES_PER_FRAME  1           // Samples per channel processed by the hub each loop. See README for latency impact
+#endif
 #define MIC_ARRAY_PDM_RX_OWN_THREAD         1           // Use dedicated thread for PDM Rx task
 #define MIC_ARRAY_CLK1                      XS1_CLKBLK_1
 #define MIC_ARRAY_CLK2                      XS1_CLKBLK_2
 
+// The number of decimator tasks per mic array is the smallest that keeps the modelled load of every task at or below
+// MIC_ARRAY_DECIMATOR_MAX_LOAD, see decimator_cost.h. Define MIC_ARRAY_NUM_DECIMATOR_TASKS to override it.
+#define MIC_ARRAY_CONFIG_OUT_SAMPLE_RATE    (MIC_ARRAY_CONFIG_PDM_FREQ / (32 * MIC_ARRAY_CONFIG_STG2_DEC_FACTOR))
+#define MIC_ARRAY_DECIMATOR_MAX_LOAD        80          // Percent of the sample period, leaving room for the frame output
+#ifndef MIC_ARRAY_NUM_DECIMATOR_TASKS
+#define MIC_ARRAY_NUM_DECIMATOR_TASKS       DECIMATOR_COST_MIN_TASKS(MIC_ARRAY_A_MIC_COUNT,              \
+                                                                     MIC_ARRAY_CONFIG_STG2_DEC_FACTOR,   \
+                                                                     MIC_ARRAY_STAGE_2_NUM_TAPS,         \
+                                                                     MIC_ARRAY_CONFIG_OUT_SAMPLE_RATE,   \
+                                                                     MIC_ARRAY_DECIMATOR_MAX_LOAD)
+#endif
+#define MIC_ARRAY_DECIMATOR_LOAD            DECIMATOR_COST_LOAD_PERCENT(MIC_ARRAY_A_MIC_COUNT,           \
+                                                                        MIC_ARRAY_NUM_DECIMATOR_TASKS,   \
+                                                                        MIC_ARRAY_CONFIG_STG2_DEC_FACTOR,\
+                                                                        MIC_ARRAY_STAGE_2_NUM_TAPS,      \
+                                                                        MIC_ARRAY_CONFIG_OUT_SAMPLE_RATE)
+#ifndef MIC_ARRAY_DECIMATOR_PROFILE
+#define MIC_ARRAY_DECIMATOR_PROFILE         0           // Print the measured decimator time once per second
+#endif
+
+// Mics above 16 are captured by a second mic array on tile 1, clocked from the APP PLL output on the same tile.
+// Its PDM rx runs in an ISR on the mic array thread, which leaves room for the TDM lane threads.
+// The second mic array is only supported in the TDM build. In the USB build XUD uses ports 8B and 1G on tile 1
+// internally and XUA reads port 1D as USB_MCLK_IN, and there are no threads to spare on tile 0.
+#define MIC_ARRAY_A_MIC_COUNT               (MIC_ARRAY_CONFIG_MIC_COUNT > 16 ? 16 : MIC_ARRAY_CONFIG_MIC_COUNT)
+#define MIC_ARRAY_B_MIC_COUNT               (MIC_ARRAY_CONFIG_MIC_COUNT - MIC_ARRAY_A_MIC_COUNT)
+#define MIC_ARRAY_B_PORT_MCLK               XS1_PORT_1D // X1D11, APP PLL output read back as the PDM master clock
+#define MIC_ARRAY_B_PORT_PDM_CLK            XS1_PORT_1G // X1D22
+#if MIC_ARRAY_B_MIC_COUNT > 8
+#define MIC_ARRAY_B_PORT_PDM_DATA           XS1_PORT_8B // X1D14..X1D21
+#else
+#define MIC_ARRAY_B_PORT_PDM_DATA           XS1_PORT_4C // X1D14, X1D15, X1D20, X1D21
+#endif
+#define MIC_ARRAY_B_CLK1                    XS1_CLKBLK_4
+#define MIC_ARRAY_B_CLK2                    XS1_CLKBLK_5
+
 #define TDM_SLAVEPORT_OUT                   XS1_PORT_1A // X1D00, I2S DAC OUT
 #define TDM_SLAVEPORT_FSYNCH                XS1_PORT_1B // X1D01, I2S LRCLK
 #define TDM_SLAVEPORT_BCLK                  XS1_PORT_1C // X1D10, I2S BCLK
@@ -25,32 +67,79 @@
 #define TDM_SLAVETX_OFFSET                  1           // How many BCLK cycles after FSYNCH rising edge data is driver
 #define TDM_SLAVESAMPLE_MODE                I2S_SLAVE_SAMPLE_ON_BCLK_RISING
 
+// Mics 16 to 31 are sent on a second TDM16 lane. Wire its FSYNCH and BCLK to the same signals as the first lane
+#define TDM_SLAVE_LANE_CHANS                16
+#define TDM_SLAVE_NUM_LANES                 ((MIC_ARRAY_CONFIG_MIC_COUNT + TDM_SLAVE_LANE_CHANS - 1) / TDM_SLAVE_LANE_CHANS)
+#define TDM_SLAVE_B_PORT_OUT                XS1_PORT_1E // X1D12
+#define TDM_SLAVE_B_PORT_FSYNCH             XS1_PORT_1F // X1D13
+#define TDM_SLAVE_B_PORT_BCLK               XS1_PORT_1H // X1D23
+#define TDM_SLAVE_B_PORT_CLK_BLK            XS1_CLKBLK_3
+
 #define TDM_SIMPLE_MASTER_FSYNCH            XS1_PORT_1M // X1D36, J10 - pin 2, '36'
 #define TDM_SIMPLE_MASTER_DATA              XS1_PORT_1O // X1D38, J10 - pin 15, '38'
 #define TDM_SIMPLE_MASTER_CLK_BLK           XS1_CLKBLK_2
 
 #define I2C_CONTROL_SLAVE_ADDRESS           0x3c    
-#define I2C_CONTROL_NUM_REGISTERS           (MIC_ARRAY_CONFIG_MIC_COUNT * 2) // Number of 8b registers. Each gain is 16b Little Endian (MSB @ 0, LSB @ 1)
+#define I2C_CONTROL_NUM_REGISTERS           (MIC_ARRAY_CONFIG_MIC_COUNT * 2 + 2) // Number of 8b registers, gains then commit and auto commit. See i2c_control.h
 #define I2C_CONTROL_SLAVE_SCL               XS1_PORT_1N //X0D37, SCL
 #define I2C_CONTROL_SLAVE_SDA               XS1_PORT_1O //X0D38, SDA
 
+#ifndef MIC_AGGREGATOR_BENCH
+#define MIC_AGGREGATOR_BENCH                0           // Replace the mic arrays with pattern generators and report timing. See README
+#endif
+
+#if MIC_AGGREGATOR_BENCH
+#define MIC_GAIN_INIT                       1           // Unity gain so the pattern passes through unchanged
+#else
 #define MIC_GAIN_INIT                       100         // Allowed values 0 to 65535
+#endif
+
+#ifndef HUB_VECTOR_GAIN
+#define HUB_VECTOR_GAIN                     1           // Apply gains with the VPU. 0 selects the original scalar gain for comparison
+#endif
+#define HUB_GAIN_RAMP_SAMPLES               256         // Sample periods over which a gain change is ramped, about 5ms
 
 #define USB_MCLK_COUNT_CLK_BLK              XS1_CLKBLK_3
 #define USB_MCLK_IN                         XS1_PORT_1D // X1D11, I2S MCLK
 
+#ifndef HUB_PROFILE
+#define HUB_PROFILE                         0           // Print the hub loop processing time once per second
+#endif
+
 
 // Configuration checks
 #if MIC_ARRAY_CONFIG_MIC_COUNT > 8 && MIC_ARRAY_NUM_DECIMATOR_TASKS < 2
 #error "MIC_ARRAY_NUM_DECIMATOR_TASKS: Unsupported value"
 #endif
 
-#if !(MIC_ARRAY_CONFIG_MIC_COUNT == 8 || MIC_ARRAY_CONFIG_MIC_COUNT == 16)
+#if CONFIG_USB && MIC_ARRAY_B_MIC_COUNT > 0
+#error "MIC_ARRAY_CONFIG_MIC_COUNT: More than 16 mics is only supported in the TDM build"
+#endif
+
+#if !(MIC_ARRAY_CONFIG_MIC_COUNT == 8 || MIC_ARRAY_CONFIG_MIC_COUNT == 16 || MIC_ARRAY_CONFIG_MIC_COUNT == 24 || MIC_ARRAY_CONFIG_MIC_COUNT == 32)
 #error "MIC_ARRAY_CONFIG_MIC_COUNT: Unsupported value"
 #endif
 
-#if MIC_ARRAY_NUM_DECIMATOR_TASKS > MIC_ARRAY_CONFIG_MIC_COUNT
-#error "MIC_ARRAY_NUM_DECIMATOR_TASKS must be less than or equal to MIC_ARRAY_CONFIG_MIC_COUNT"
+#if MIC_ARRAY_DECIMATOR_LOAD > 100
+#error "MIC_ARRAY_NUM_DECIMATOR_TASKS: The modelled decimator load exceeds the sample period"
+#endif
+
+// Tile 1 runs the hub and either the TDM lanes, simple TDM master and monitor or the 4 USB threads
+#if CONFIG_TDM
+#define TILE_1_APP_THREADS                  (1 + TDM_SLAVE_NUM_LANES + 2)
+#else
+#define TILE_1_APP_THREADS                  (1 + 4)
+#endif
+#if MIC_ARRAY_B_MIC_COUNT > 0 && (TILE_1_APP_THREADS + MIC_ARRAY_NUM_DECIMATOR_TASKS) > 8
+#error "MIC_ARRAY_NUM_DECIMATOR_TASKS: Not enough threads on tile 1 for the second mic array"
+#endif
+
+#if MIC_ARRAY_NUM_DECIMATOR_TASKS > MIC_ARRAY_A_MIC_COUNT || (MIC_ARRAY_B_MIC_COUNT > 0 && MIC_ARRAY_NUM_DECIMATOR_TASKS > MIC_ARRAY_B_MIC_COUNT)
+#error "MIC_ARRAY_NUM_DECIMATOR_TASKS must be less than or equal to the mic count of each mic array"
+#endif
+
+#if MIC_ARRAY_CONFIG_SAMPLES_PER_FRAME < 1 || MIC_ARRAY_CONFIG_SAMPLES_PER_FRAME > 16
+#error "MIC_ARRAY_CONFIG_SAMPLES_PER_FRAME: Unsupported value"
 #endif
 
 #if MIC_ARRAY_CONFIG_USE_DDR != 1
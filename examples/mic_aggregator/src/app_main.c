@@ -2,7 +2,7 @@
 // This Software is subject to the terms of the XMOS Public Licence: Version 1.
 
 #include <stdio.h>
-#include <limits.h>
+#include <stdbool.h>
 
 #include <xcore/channel.h>
 #include <xcore/channel_streaming.h>
@@ -18,6 +18,9 @@
 #include "tdm_slave_wrapper.h"
 #include "tdm_master_simple.h"
 #include "i2c_control.h"
+#include "hub_gain.h"
+#include "bench.h"
+#include "bench_source.h"
 
 #include "xua_wrapper.h"
 #include "xua_conf.h"
@@ -42,35 +45,104 @@ void pdm_mic_16_front_end(void) {
     }
 }
 
-static inline int32_t scalar_gain(int32_t samp, int32_t gain){
-    int64_t accum = (int64_t)samp * (int32_t)gain;
-    accum = accum > INT_MAX ? INT_MAX : accum;
-    accum = accum < INT_MIN ? INT_MIN : accum;
+#if MIC_ARRAY_B_MIC_COUNT > 0
+DECLARE_JOB(pdm_mic_b, (chanend_t));
+void pdm_mic_b(chanend_t c_mic_array_b) {
+    printf("pdm_mic_b running: %d threads total\n", MIC_ARRAY_NUM_DECIMATOR_TASKS);
 
-    return (int32_t)accum;
+    app_mic_array_b_init();
+    app_mic_array_b_task(c_mic_array_b);
 }
+#endif
 
-
-DECLARE_JOB(hub, (chanend_t, chanend_t, chanend_t, audio_frame_t **));
-void hub(chanend_t c_mic_array, chanend_t c_i2c_reg, chanend_t c_aud, audio_frame_t **read_buffer_ptr) {
+DECLARE_JOB(hub, (chanend_t, chanend_t, chanend_t, chanend_t, audio_frame_t **));
+void hub(chanend_t c_mic_array, chanend_t c_mic_array_b, chanend_t c_i2c_reg, chanend_t c_aud, audio_frame_t **read_buffer_ptr) {
     printf("hub\n");
 
     unsigned write_buffer_idx = 0;
+    mic_frame_t mic_frame;
     audio_frame_t audio_frames[NUM_AUDIO_BUFFERS] = {{{{0}}}};
+#if HUB_PROFILE
+    const uint32_t frames_per_second = MIC_ARRAY_CONFIG_OUT_SAMPLE_RATE / MIC_ARRAY_CONFIG_SAMPLES_PER_FRAME;
+    uint32_t profile_frames = 0;
+    uint32_t max_busy_ticks = 0;
+    uint32_t max_gain_ticks = 0;
+#endif
+#if MIC_AGGREGATOR_BENCH
+    const uint32_t bench_frames_per_second = MIC_ARRAY_CONFIG_OUT_SAMPLE_RATE / MIC_ARRAY_CONFIG_SAMPLES_PER_FRAME;
+    const uint32_t bench_period_ticks = (XS1_TIMER_HZ / MIC_ARRAY_CONFIG_OUT_SAMPLE_RATE) * MIC_ARRAY_CONFIG_SAMPLES_PER_FRAME;
+    bench_timing_t bench_hub;
+    bench_check_t bench_in;
+    uint32_t bench_max_usb_ticks = 0;
+    bench_timing_init(&bench_hub);
+    bench_check_init(&bench_in);
+#endif
+
+    hub_gain_t gains;
+    hub_gain_init(&gains, MIC_GAIN_INIT);
 
-    uint16_t gains[MIC_ARRAY_CONFIG_MIC_COUNT] = {MIC_GAIN_INIT, MIC_GAIN_INIT, MIC_GAIN_INIT, MIC_GAIN_INIT,
-                                                  MIC_GAIN_INIT, MIC_GAIN_INIT, MIC_GAIN_INIT, MIC_GAIN_INIT,
-                                                  MIC_GAIN_INIT, MIC_GAIN_INIT, MIC_GAIN_INIT, MIC_GAIN_INIT,
-                                                  MIC_GAIN_INIT, MIC_GAIN_INIT, MIC_GAIN_INIT, MIC_GAIN_INIT};  
     while(1){
-        ma_frame_rx((int32_t*)&audio_frames[write_buffer_idx], c_mic_array, MIC_ARRAY_CONFIG_MIC_COUNT, MIC_ARRAY_CONFIG_SAMPLES_PER_FRAME);
+        // Handle any control updates from the host while waiting for the next frame. Reading them here, rather
+        // than once per frame, keeps the I2C callbacks from waiting on a full channel when frames are long.
+        bool frame_ready = false;
+        while(!frame_ready){
+            SELECT_RES(
+                CASE_THEN(c_mic_array, mic_frame_ready),
+                CASE_THEN(c_i2c_reg, i2c_register_write)
+            )
+            {
+                mic_frame_ready:
+                {
+                    frame_ready = true;
+                }
+                break;
+
+                i2c_register_write:
+                {
+                    uint8_t channel = s_chan_in_byte(c_i2c_reg);
+                    if(channel == I2C_CONTROL_MSG_COMMIT){
+                        // The gains are applied together from the start of the next frame
+                        hub_gain_commit(&gains);
+                    } else {
+                        uint8_t data_h = s_chan_in_byte(c_i2c_reg);
+                        uint8_t data_l = s_chan_in_byte(c_i2c_reg);
+                        hub_gain_stage(&gains, channel, U16_FROM_BYTES(data_h, data_l));
+                    }
+                }
+                break;
+            }
+        }
+        ma_frame_rx(&mic_frame.data[0][0], c_mic_array, MIC_ARRAY_A_MIC_COUNT, MIC_ARRAY_CONFIG_SAMPLES_PER_FRAME);
+#if MIC_ARRAY_B_MIC_COUNT > 0
+        // Both mic arrays are clocked from the APP PLL so their frames arrive at the same rate
+        ma_frame_rx(&mic_frame.data[MIC_ARRAY_A_MIC_COUNT][0], c_mic_array_b, MIC_ARRAY_B_MIC_COUNT, MIC_ARRAY_CONFIG_SAMPLES_PER_FRAME);
+#endif
+#if HUB_PROFILE || MIC_AGGREGATOR_BENCH
+        uint32_t start_ticks = get_reference_time();
+#endif
 
-        // Apply gain
-        for(int ch = 0; ch < MIC_ARRAY_CONFIG_MIC_COUNT; ch++){
-            audio_frames[write_buffer_idx].data[ch][0] = scalar_gain(audio_frames[write_buffer_idx].data[ch][0], gains[ch]);
+        // Apply gain and reorder to sample major for TDM and USB
+        hub_gain_apply(&gains, &audio_frames[write_buffer_idx], &mic_frame);
+#if HUB_PROFILE
+        uint32_t gain_ticks = get_reference_time() - start_ticks;
+        if(gain_ticks > max_gain_ticks){
+            max_gain_ticks = gain_ticks;
         }
+#endif
 #if CONFIG_USB
-        xua_exchange(c_aud, &audio_frames[write_buffer_idx].data[0][0]);
+#if MIC_AGGREGATOR_BENCH
+        uint32_t usb_start_ticks = get_reference_time();
+#endif
+        // XUA_Buffer takes one sample period per exchange, its FIFO absorbs the burst
+        for(int s = 0; s < MIC_ARRAY_CONFIG_SAMPLES_PER_FRAME; s++){
+            xua_exchange(c_aud, &audio_frames[write_buffer_idx].data[s][0]);
+        }
+#if MIC_AGGREGATOR_BENCH
+        uint32_t usb_ticks = get_reference_time() - usb_start_ticks;
+        if(usb_ticks > bench_max_usb_ticks){
+            bench_max_usb_ticks = usb_ticks;
+        }
+#endif
 #endif
         *read_buffer_ptr = &audio_frames[write_buffer_idx];  // update read buffer for TDM
 
@@ -79,31 +151,43 @@ void hub(chanend_t c_mic_array, chanend_t c_i2c_reg, chanend_t c_aud, audio_fram
             write_buffer_idx = 0;
         }
 
-        // Handle any control updates from the host
-        // Non-blocking channel read on c_i2c_reg
-        SELECT_RES(
-            CASE_THEN(c_i2c_reg, i2c_register_write),
-            DEFAULT_THEN(drop_through)
-        )
-        {
-            i2c_register_write:
-            {
-                uint8_t channel = s_chan_in_byte(c_i2c_reg);
-                uint8_t data_h = s_chan_in_byte(c_i2c_reg);
-                uint8_t data_l = s_chan_in_byte(c_i2c_reg);
-
-                int32_t gain = U16_FROM_BYTES(data_h, data_l);
-                gains[channel] = gain;
-            }
-            break;
-
-            drop_through:
-            {
-                // Do nothing & fall-through
-            }
-            break;
+        // With 1 sample per frame there are currently around 1600 ticks (16us) of slack at the end of this loop in TDM mode.
+        // The loop overhead is paid once per frame so larger frames leave more slack per sample.
+#if HUB_PROFILE
+        uint32_t busy_ticks = get_reference_time() - start_ticks;
+        if(busy_ticks > max_busy_ticks){
+            max_busy_ticks = busy_ticks;
         }
-        // There are currently around 1600 ticks (16us) of slack at the end of this loop in TDM mode
+        if(++profile_frames == frames_per_second){
+            const uint32_t frame_period_ticks = (XS1_TIMER_HZ / MIC_ARRAY_CONFIG_OUT_SAMPLE_RATE) * MIC_ARRAY_CONFIG_SAMPLES_PER_FRAME;
+            printf("hub: samples_per_frame=%d max_busy_ticks=%lu frame_period_ticks=%lu slack_ticks=%ld\n",
+                   MIC_ARRAY_CONFIG_SAMPLES_PER_FRAME, max_busy_ticks, frame_period_ticks, (int32_t)(frame_period_ticks - max_busy_ticks));
+            // The gain stage alone, for comparing the vector and scalar (HUB_VECTOR_GAIN 0) builds
+            printf("hub_gain: %s max_gain_ticks=%lu per_sample_ticks=%lu gain_slack_ticks=%ld\n",
+                   HUB_VECTOR_GAIN ? "vector" : "scalar", max_gain_ticks, max_gain_ticks / MIC_ARRAY_CONFIG_SAMPLES_PER_FRAME,
+                   (int32_t)(frame_period_ticks - max_gain_ticks));
+            profile_frames = 0;
+            max_busy_ticks = 0;
+            max_gain_ticks = 0;
+        }
+#endif
+#if MIC_AGGREGATOR_BENCH
+        // The pattern check is not included in the busy time. The frame just published is only read by the outputs.
+        bench_timing_update(&bench_hub, start_ticks, get_reference_time() - start_ticks, bench_period_ticks);
+        const audio_frame_t *published = *read_buffer_ptr;
+        for(int s = 0; s < MIC_ARRAY_CONFIG_SAMPLES_PER_FRAME; s++){
+            bench_check_frame(&bench_in, &published->data[s][0], 0, MIC_ARRAY_CONFIG_MIC_COUNT);
+        }
+        if(bench_hub.frames == bench_frames_per_second){
+            printf("bench_hub: frames=%lu max_busy_ticks=%lu min_slack_ticks=%ld interval_ticks=%lu..%lu missed=%lu usb_max_ticks=%lu errors=%lu repeats=%lu skips=%lu\n",
+                   bench_hub.frames, bench_hub.max_busy_ticks, (int32_t)(bench_period_ticks - bench_hub.max_busy_ticks),
+                   bench_hub.min_interval_ticks, bench_hub.max_interval_ticks, bench_hub.missed, bench_max_usb_ticks,
+                   bench_in.errors, bench_in.repeats, bench_in.skips);
+            bench_timing_reset(&bench_hub);
+            bench_check_reset(&bench_in);
+            bench_max_usb_ticks = 0;
+        }
+#endif
     }
 }
 
@@ -113,8 +197,12 @@ void hub(chanend_t c_mic_array, chanend_t c_i2c_reg, chanend_t c_aud, audio_fram
 
 void main_tile_0(chanend_t c_cross_tile[2]){
     PAR_JOBS(
+#if MIC_AGGREGATOR_BENCH
+        PJOB(bench_source, (c_cross_tile[0], 0, MIC_ARRAY_A_MIC_COUNT))
+#else
         PJOB(pdm_mic_16, (c_cross_tile[0])), // Note spawns MIC_ARRAY_NUM_DECIMATOR_TASKS threads
         PJOB(pdm_mic_16_front_end, ())
+#endif
 #if CONFIG_TDM
         ,PJOB(i2c_control, (c_cross_tile[1]))
 #endif
@@ -133,11 +221,20 @@ void main_tile_1(chanend_t c_cross_tile[2]){
     device_pll_init();
 
     channel_t c_aud = chan_alloc();
+    channel_t c_mic_array_b = chan_alloc();
 
     PAR_JOBS(
-        PJOB(hub, (c_cross_tile[0], c_cross_tile[1], c_aud.end_b, read_buffer_ptr)),
+        PJOB(hub, (c_cross_tile[0], c_mic_array_b.end_b, c_cross_tile[1], c_aud.end_b, read_buffer_ptr)),
+#if MIC_ARRAY_B_MIC_COUNT > 0 && MIC_AGGREGATOR_BENCH
+        PJOB(bench_source, (c_mic_array_b.end_a, MIC_ARRAY_A_MIC_COUNT, MIC_ARRAY_B_MIC_COUNT)),
+#elif MIC_ARRAY_B_MIC_COUNT > 0
+        PJOB(pdm_mic_b, (c_mic_array_b.end_a)), // Note spawns MIC_ARRAY_NUM_DECIMATOR_TASKS threads
+#endif
 #if CONFIG_TDM
-        PJOB(tdm16_slave, (read_buffer_ptr)),
+        PJOB(tdm16_slave, (read_buffer_ptr, 0)),
+#if TDM_SLAVE_NUM_LANES > 1
+        PJOB(tdm16_slave, (read_buffer_ptr, 1)),
+#endif
         PJOB(tdm16_master_simple, ()),
         PJOB(tdm_master_monitor, ()) // Temp monitor for checking reception of TDM frames. Separate task so non-intrusive
 #else
@@ -8,8 +8,14 @@
 
 #define NUM_AUDIO_BUFFERS   3
 
-typedef struct audio_frame_t{
+// Frame as received from the mic array, channel major
+typedef struct mic_frame_t{
     int32_t data[MIC_ARRAY_CONFIG_MIC_COUNT][MIC_ARRAY_CONFIG_SAMPLES_PER_FRAME];
+} mic_frame_t;
+
+// Frame after the hub, sample major so all channels of one sample period are contiguous for TDM and USB
+typedef struct audio_frame_t{
+    int32_t data[MIC_ARRAY_CONFIG_SAMPLES_PER_FRAME][MIC_ARRAY_CONFIG_MIC_COUNT];
 } audio_frame_t;
 
 // Macro to adjust input pad timing for the round trip delay. Supports 0 (default) to 5 core clock cycles.
@@ -0,0 +1,85 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#include <stdint.h>
+
+#include "bench.h"
+
+void bench_timing_init(bench_timing_t *bt)
+{
+    bench_timing_reset(bt);
+    bt->last_ticks = 0;
+    bt->started = 0;
+}
+
+void bench_timing_reset(bench_timing_t *bt)
+{
+    bt->frames = 0;
+    bt->max_busy_ticks = 0;
+    bt->min_interval_ticks = UINT32_MAX;
+    bt->max_interval_ticks = 0;
+    bt->missed = 0;
+}
+
+void bench_timing_update(bench_timing_t *bt, uint32_t start_ticks, uint32_t busy_ticks, uint32_t period_ticks)
+{
+    if(bt->started){
+        uint32_t interval = start_ticks - bt->last_ticks;
+        bt->min_interval_ticks = (interval < bt->min_interval_ticks) ? interval : bt->min_interval_ticks;
+        bt->max_interval_ticks = (interval > bt->max_interval_ticks) ? interval : bt->max_interval_ticks;
+    }
+    bt->last_ticks = start_ticks;
+    bt->started = 1;
+
+    bt->max_busy_ticks = (busy_ticks > bt->max_busy_ticks) ? busy_ticks : bt->max_busy_ticks;
+    if(busy_ticks > period_ticks){
+        bt->missed++;
+    }
+    bt->frames++;
+}
+
+void bench_check_init(bench_check_t *bc)
+{
+    bench_check_reset(bc);
+    bc->last_seq = -1;
+    bc->frame_seq = 0;
+    bc->frame_errors = 0;
+}
+
+void bench_check_reset(bench_check_t *bc)
+{
+    bc->frames = 0;
+    bc->errors = 0;
+    bc->repeats = 0;
+    bc->skips = 0;
+}
+
+void bench_check_end_frame(bench_check_t *bc)
+{
+    // Output is zero until the first frame has passed through, ignore anything before the pattern is seen
+    if(bc->last_seq < 0){
+        if(bc->frame_errors == 0){
+            bc->last_seq = bc->frame_seq;
+        }
+        return;
+    }
+
+    bc->frames++;
+    bc->errors += bc->frame_errors;
+
+    int32_t diff = (bc->frame_seq - bc->last_seq) & BENCH_SEQ_MASK;
+    if(diff == 0){
+        bc->repeats++;
+    } else if(diff != 1){
+        bc->skips++;
+    }
+    bc->last_seq = bc->frame_seq;
+}
+
+void bench_check_frame(bench_check_t *bc, const int32_t *samples, unsigned first_ch, unsigned num_ch)
+{
+    for(unsigned i = 0; i < num_ch; i++){
+        bench_check_sample(bc, i, first_ch + i, samples[i]);
+    }
+    bench_check_end_frame(bc);
+}
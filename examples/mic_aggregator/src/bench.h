@@ -0,0 +1,71 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#pragma once
+
+#include <stdint.h>
+#include "app_config.h"
+
+// In the benchmark build the mic arrays are replaced by generators of a known pattern, locked to the mic clock.
+// Each sample carries its sample period count and mic channel so the hub and outputs can detect dropped,
+// repeated or misrouted samples. The pattern survives unity gain, which may round by 1.
+#define BENCH_SEQ_MASK                  0x7fff
+#define BENCH_SAMPLE(seq, ch)           ((int32_t)((((seq) & BENCH_SEQ_MASK) << 16) | ((ch) << 8)))
+#define BENCH_SAMPLE_SEQ(samp)          ((((samp) + 0x80) >> 16) & BENCH_SEQ_MASK)
+#define BENCH_SAMPLE_CH(samp)           ((((samp) + 0x80) >> 8) & 0xff)
+
+// Timing of a periodic task, in reference timer ticks
+typedef struct bench_timing_t{
+    uint32_t frames;
+    uint32_t max_busy_ticks;            // Longest processing time of a frame
+    uint32_t min_interval_ticks;        // Shortest and longest time between frames
+    uint32_t max_interval_ticks;
+    uint32_t missed;                    // Frames that took longer than the frame period
+    uint32_t last_ticks;                // Time of the previous frame
+    int started;                        // Set once last_ticks is valid
+} bench_timing_t;
+
+// Checks the pattern of one sample period of consecutive channels
+typedef struct bench_check_t{
+    uint32_t frames;
+    uint32_t errors;                    // Samples with the wrong channel or sample period
+    uint32_t repeats;                   // Sample periods that repeated the previous one
+    uint32_t skips;                     // Sample periods that skipped one or more
+    int32_t last_seq;                   // Sample period of the previous frame, -1 until the pattern is first seen
+    int32_t frame_seq;                  // Sample period of the current frame
+    uint32_t frame_errors;
+} bench_check_t;
+
+void bench_timing_init(bench_timing_t *bt);
+
+// Clear the statistics. Intervals are still measured from the last frame before the reset
+void bench_timing_reset(bench_timing_t *bt);
+
+// Record a frame that started at start_ticks and took busy_ticks to process
+void bench_timing_update(bench_timing_t *bt, uint32_t start_ticks, uint32_t busy_ticks, uint32_t period_ticks);
+
+void bench_check_init(bench_check_t *bc);
+
+// Clear the counts. The check stays in sync with the pattern across a reset
+void bench_check_reset(bench_check_t *bc);
+
+// Check one sample of a frame. Samples must be passed in slot order, starting with slot 0
+static inline void bench_check_sample(bench_check_t *bc, unsigned slot, unsigned ch, int32_t samp)
+{
+    int32_t seq = BENCH_SAMPLE_SEQ(samp);
+    if(slot == 0){
+        bc->frame_seq = seq;
+        bc->frame_errors = 0;
+    } else if(seq != bc->frame_seq){
+        bc->frame_errors++;
+    }
+    if(BENCH_SAMPLE_CH(samp) != ch){
+        bc->frame_errors++;
+    }
+}
+
+// Finish the frame checked with bench_check_sample()
+void bench_check_end_frame(bench_check_t *bc);
+
+// Check a whole frame of num_ch channels starting at mic first_ch
+void bench_check_frame(bench_check_t *bc, const int32_t *samples, unsigned first_ch, unsigned num_ch);
@@ -0,0 +1,80 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#include <stdio.h>
+
+#include <xcore/port.h>
+#include <xcore/clock.h>
+#include <xcore/hwtimer.h>
+
+#include "app_config.h"
+#include "bench.h"
+#include "bench_source.h"
+#include "mic_array.h"
+
+#if MIC_AGGREGATOR_BENCH
+
+// MCLK cycles per frame of the mic array
+#define BENCH_MCLK_PER_FRAME    ((MIC_ARRAY_CONFIG_MCLK_FREQ / MIC_ARRAY_CONFIG_OUT_SAMPLE_RATE) * MIC_ARRAY_CONFIG_SAMPLES_PER_FRAME)
+
+void bench_source(chanend_t c_frames_out, unsigned first_ch, unsigned num_ch) {
+    printf("bench_source: mics %u to %u\n", first_ch, first_ch + num_ch - 1);
+
+    // Pace the frames with the mic array MCLK so they are locked to the TDM and USB clocks, like the mic array.
+    // The PDM clock pin is not otherwise used and toggles once per frame.
+    port_t p_mclk = (first_ch == 0) ? MIC_ARRAY_CONFIG_PORT_MCLK : MIC_ARRAY_B_PORT_MCLK;
+    port_t p_tick = (first_ch == 0) ? MIC_ARRAY_CONFIG_PORT_PDM_CLK : MIC_ARRAY_B_PORT_PDM_CLK;
+    xclock_t clk = (first_ch == 0) ? MIC_ARRAY_CLK1 : MIC_ARRAY_B_CLK1;
+
+    port_enable(p_mclk);
+    clock_enable(clk);
+    clock_set_source_port(clk, p_mclk);
+    clock_set_divide(clk, 0);
+    port_enable(p_tick);
+    port_set_clock(p_tick, clk);
+    clock_start(clk);
+
+    int32_t frame[MIC_ARRAY_A_MIC_COUNT][MIC_ARRAY_CONFIG_SAMPLES_PER_FRAME];
+    uint32_t seq = 0;
+    uint32_t level = 0;
+    uint32_t late = 0;
+    uint32_t frames = 0;
+    const uint32_t period_ticks = (XS1_TIMER_HZ / MIC_ARRAY_CONFIG_OUT_SAMPLE_RATE) * MIC_ARRAY_CONFIG_SAMPLES_PER_FRAME;
+
+    port_out(p_tick, level);
+    uint16_t tick_time = port_get_trigger_time(p_tick);
+    uint32_t tick_ticks = get_reference_time();
+
+    while(1){
+        for(int ch = 0; ch < num_ch; ch++){
+            for(int s = 0; s < MIC_ARRAY_CONFIG_SAMPLES_PER_FRAME; s++){
+                frame[ch][s] = BENCH_SAMPLE(seq + s, first_ch + ch);
+            }
+        }
+        seq += MIC_ARRAY_CONFIG_SAMPLES_PER_FRAME;
+
+        // Wait for the frame period to end, then pass the frame on as the mic array would
+        tick_time += BENCH_MCLK_PER_FRAME;
+        level ^= 1;
+        port_out_at_time(p_tick, tick_time, level);
+        uint32_t now = get_reference_time();
+        ma_frame_tx(c_frames_out, &frame[0][0], num_ch, MIC_ARRAY_CONFIG_SAMPLES_PER_FRAME);
+
+        // If the hub blocked the frame for longer than a frame period the next tick time has passed. Count it and
+        // restart the timing from now, rather than waiting for the port timer to wrap.
+        if(get_reference_time() - now > period_ticks || now - tick_ticks > 2 * period_ticks){
+            late++;
+            port_out(p_tick, level);
+            tick_time = port_get_trigger_time(p_tick);
+        }
+        tick_ticks = now;
+
+        if(++frames == MIC_ARRAY_CONFIG_OUT_SAMPLE_RATE / MIC_ARRAY_CONFIG_SAMPLES_PER_FRAME){
+            printf("bench_source: first_mic=%u frames=%lu late=%lu\n", first_ch, frames, late);
+            frames = 0;
+            late = 0;
+        }
+    }
+}
+
+#endif
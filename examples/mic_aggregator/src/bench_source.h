@@ -0,0 +1,12 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#pragma once
+
+#include <xcore/parallel.h>
+#include <xcore/channel.h>
+
+// Replaces a mic array in the benchmark build. Sends frames of the pattern in bench.h for num_ch mics
+// starting at first_ch, paced by the MCLK of the mic array it replaces.
+DECLARE_JOB(bench_source, (chanend_t, unsigned, unsigned));
+void bench_source(chanend_t c_frames_out, unsigned first_ch, unsigned num_ch);
@@ -0,0 +1,48 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+// Model of the time taken by a decimator task to produce one output sample for each of its channels.
+// All costs are in 100 MHz reference timer ticks on a 75 MHz thread, which is the worst case with all 8
+// threads of a tile busy. The macros only use integer arithmetic so they can be evaluated by the preprocessor.
+// The constants are estimates, not fits to measured times. test/mic_aggregator_headroom times the decimator tasks
+// chosen by this model and fails if any task takes longer than the model or than MIC_ARRAY_DECIMATOR_MAX_LOAD of
+// the sample period. The constants are also read by python/decimator_cost_model.py to evaluate configurations on
+// the host.
+
+#pragma once
+
+#define DECIMATOR_COST_REF_CLOCK_HZ         100000000
+
+#define DECIMATOR_COST_TASK_TICKS           150     // Per task: spawning and joining the task and the stage 2 output
+#define DECIMATOR_COST_STAGE1_TICKS         56      // Per channel: one stage 1 output from 32 PDM samples
+#define DECIMATOR_COST_STAGE2_TICKS         20      // Per channel: fixed cost of one stage 2 output
+#define DECIMATOR_COST_STAGE2_TAPS_PER_TICK_X4  3   // Per channel: stage 2 cost is 3/4 of a tick per tap
+
+#define DECIMATOR_COST_MAX_TASKS            4       // Largest task count considered
+
+#define DECIMATOR_COST_CEIL_DIV(n, d)       (((n) + (d) - 1) / (d))
+
+// Ticks for one channel to produce one output sample
+#define DECIMATOR_COST_CHANNEL_TICKS(stg2_dec_factor, stg2_taps)                \
+            ((stg2_dec_factor) * DECIMATOR_COST_STAGE1_TICKS +                  \
+             DECIMATOR_COST_STAGE2_TICKS +                                      \
+             ((stg2_taps) * DECIMATOR_COST_STAGE2_TAPS_PER_TICK_X4) / 4)
+
+// Ticks for a task decimating `channels` channels to produce one output sample
+#define DECIMATOR_COST_TASK_TICKS_FOR(channels, stg2_dec_factor, stg2_taps)     \
+            (DECIMATOR_COST_TASK_TICKS + (channels) * DECIMATOR_COST_CHANNEL_TICKS(stg2_dec_factor, stg2_taps))
+
+// Load of the busiest of `tasks` tasks sharing `mics` channels, as a percentage of the output sample period
+#define DECIMATOR_COST_LOAD_PERCENT(mics, tasks, stg2_dec_factor, stg2_taps, sample_rate)              \
+            ((100 * DECIMATOR_COST_TASK_TICKS_FOR(DECIMATOR_COST_CEIL_DIV(mics, tasks), stg2_dec_factor, stg2_taps)) \
+             / (DECIMATOR_COST_REF_CLOCK_HZ / (sample_rate)))
+
+#define DECIMATOR_COST_FITS(mics, tasks, stg2_dec_factor, stg2_taps, sample_rate, max_load_percent)    \
+            (DECIMATOR_COST_LOAD_PERCENT(mics, tasks, stg2_dec_factor, stg2_taps, sample_rate) <= (max_load_percent))
+
+// Smallest task count, up to DECIMATOR_COST_MAX_TASKS, that keeps every task at or below max_load_percent
+#define DECIMATOR_COST_MIN_TASKS(mics, stg2_dec_factor, stg2_taps, sample_rate, max_load_percent)      \
+            (DECIMATOR_COST_FITS(mics, 1, stg2_dec_factor, stg2_taps, sample_rate, max_load_percent) ? 1 : \
+             DECIMATOR_COST_FITS(mics, 2, stg2_dec_factor, stg2_taps, sample_rate, max_load_percent) ? 2 : \
+             DECIMATOR_COST_FITS(mics, 3, stg2_dec_factor, stg2_taps, sample_rate, max_load_percent) ? 3 : \
+             DECIMATOR_COST_MAX_TASKS)
@@ -0,0 +1,119 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#include <string.h>
+#include <limits.h>
+#include <xclib.h>
+
+#include "xmath/xmath.h"
+#include "hub_gain.h"
+
+/*
+ * The gains are applied to each sample period of all channels with the VPU.
+ * vect_s32_mul() only produces the upper bits of the product, so the gains are
+ * first shifted down by exp bits and the product is shifted back up with
+ * saturation. exp is the smallest value that keeps every gain in the current
+ * ramp below 2^exp, which keeps the lost precision below 2^(exp - 1).
+ */
+
+static int gain_exp(const hub_gain_t *hg)
+{
+    int32_t max_gain = 0;
+    for(int ch = 0; ch < MIC_ARRAY_CONFIG_MIC_COUNT; ch++){
+        max_gain = (hg->gain[ch] > max_gain) ? hg->gain[ch] : max_gain;
+        max_gain = (hg->target[ch] > max_gain) ? hg->target[ch] : max_gain;
+    }
+    int bits = 32 - clz(max_gain);
+    return (bits > HUB_GAIN_FRAC_BITS) ? bits - HUB_GAIN_FRAC_BITS : 0;
+}
+
+void hub_gain_init(hub_gain_t *hg, uint16_t gain)
+{
+    for(int ch = 0; ch < MIC_ARRAY_CONFIG_MIC_COUNT; ch++){
+        hg->gain[ch] = (int32_t)gain << HUB_GAIN_FRAC_BITS;
+        hg->target[ch] = hg->gain[ch];
+        hg->step[ch] = 0;
+    }
+    hg->staged_mask = 0;
+    hg->ramp_remaining = 0;
+    hg->exp = gain_exp(hg);
+}
+
+void hub_gain_set(hub_gain_t *hg, unsigned ch, uint16_t gain)
+{
+    hub_gain_stage(hg, ch, gain);
+    hub_gain_commit(hg);
+}
+
+void hub_gain_stage(hub_gain_t *hg, unsigned ch, uint16_t gain)
+{
+    if(ch < MIC_ARRAY_CONFIG_MIC_COUNT){
+        hg->staged[ch] = (int32_t)gain << HUB_GAIN_FRAC_BITS;
+        hg->staged_mask |= 1u << ch;
+    }
+}
+
+void hub_gain_commit(hub_gain_t *hg)
+{
+    if(hg->staged_mask == 0){
+        return;
+    }
+
+    for(int i = 0; i < MIC_ARRAY_CONFIG_MIC_COUNT; i++){
+        if(hg->staged_mask & (1u << i)){
+            hg->target[i] = hg->staged[i];
+        }
+        hg->step[i] = (hg->target[i] - hg->gain[i]) / HUB_GAIN_RAMP_SAMPLES;
+    }
+    hg->staged_mask = 0;
+    hg->ramp_remaining = HUB_GAIN_RAMP_SAMPLES;
+    hg->exp = gain_exp(hg);
+}
+
+#if HUB_VECTOR_GAIN
+
+void hub_gain_apply(hub_gain_t *hg, audio_frame_t *out, const mic_frame_t *in)
+{
+    // Reorder to sample major so each sample period is one vector of channels
+    for(int ch = 0; ch < MIC_ARRAY_CONFIG_MIC_COUNT; ch++){
+        for(int s = 0; s < MIC_ARRAY_CONFIG_SAMPLES_PER_FRAME; s++){
+            out->data[s][ch] = in->data[ch][s];
+        }
+    }
+
+    for(int s = 0; s < MIC_ARRAY_CONFIG_SAMPLES_PER_FRAME; s++){
+        if(hg->ramp_remaining){
+            vect_s32_add(hg->gain, hg->gain, hg->step, MIC_ARRAY_CONFIG_MIC_COUNT, 0, 0);
+            if(--hg->ramp_remaining == 0){
+                // Land exactly on the target and drop back to the smallest exponent for it
+                memcpy(hg->gain, hg->target, sizeof(hg->gain));
+                hg->exp = gain_exp(hg);
+            }
+        }
+        vect_s32_mul(out->data[s], out->data[s], hg->gain, MIC_ARRAY_CONFIG_MIC_COUNT, 0, hg->exp - HUB_GAIN_FRAC_BITS);
+        vect_s32_shl(out->data[s], out->data[s], MIC_ARRAY_CONFIG_MIC_COUNT, hg->exp);
+    }
+}
+
+#else
+
+// Original per sample scalar gain, kept for profiling comparisons. Gain changes are applied without a ramp.
+static inline int32_t scalar_gain(int32_t samp, int32_t gain){
+    int64_t accum = (int64_t)samp * (int32_t)gain;
+    accum = accum > INT_MAX ? INT_MAX : accum;
+    accum = accum < INT_MIN ? INT_MIN : accum;
+
+    return (int32_t)accum;
+}
+
+void hub_gain_apply(hub_gain_t *hg, audio_frame_t *out, const mic_frame_t *in)
+{
+    for(int ch = 0; ch < MIC_ARRAY_CONFIG_MIC_COUNT; ch++){
+        int32_t gain = hg->target[ch] >> HUB_GAIN_FRAC_BITS;
+        for(int s = 0; s < MIC_ARRAY_CONFIG_SAMPLES_PER_FRAME; s++){
+            out->data[s][ch] = scalar_gain(in->data[ch][s], gain);
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,36 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#pragma once
+
+#include <stdint.h>
+#include "app_main.h"
+
+// Gains are held with 15 fractional bits so ramps can pass between the integer gains set over I2C
+#define HUB_GAIN_FRAC_BITS      15
+
+typedef struct hub_gain_t{
+    int32_t gain[MIC_ARRAY_CONFIG_MIC_COUNT];       // Current gain of each channel
+    int32_t target[MIC_ARRAY_CONFIG_MIC_COUNT];     // Gain each channel is ramping to
+    int32_t step[MIC_ARRAY_CONFIG_MIC_COUNT];       // Change in gain per sample period during a ramp
+    int32_t staged[MIC_ARRAY_CONFIG_MIC_COUNT];     // Gains waiting for hub_gain_commit()
+    uint32_t staged_mask;                           // Bit per channel with a staged gain
+    unsigned ramp_remaining;                        // Sample periods left in the current ramp
+    int exp;                                        // All gains during the ramp are below 2^exp
+} hub_gain_t;
+
+// Set all channels to the same gain without a ramp
+void hub_gain_init(hub_gain_t *hg, uint16_t gain);
+
+// Ramp a channel to a new gain over HUB_GAIN_RAMP_SAMPLES sample periods. Any other channels still
+// ramping restart their ramp from their current gain.
+void hub_gain_set(hub_gain_t *hg, unsigned ch, uint16_t gain);
+
+// Hold a new gain for a channel until the next hub_gain_commit()
+void hub_gain_stage(hub_gain_t *hg, unsigned ch, uint16_t gain);
+
+// Start ramping all channels with a staged gain together, as hub_gain_set()
+void hub_gain_commit(hub_gain_t *hg);
+
+// Apply the gains to a frame from the mic array, writing a sample major frame. Saturates.
+void hub_gain_apply(hub_gain_t *hg, audio_frame_t *out, const mic_frame_t *in);
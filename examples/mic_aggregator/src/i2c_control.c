@@ -8,28 +8,11 @@
 
 #include "app_config.h"
 #include "app_main.h"
-#include "i2c.h"
-
-// 16 pairs of 8b registers. MSB first LSB last (Little endian)
-// Initial gain = 1
-uint8_t i2c_slave_registers[I2C_CONTROL_NUM_REGISTERS] = {
-        UPPER_BYTE_FROM_U16(MIC_GAIN_INIT), UPPER_BYTE_FROM_U16(MIC_GAIN_INIT), // Ch 0
-        UPPER_BYTE_FROM_U16(MIC_GAIN_INIT), UPPER_BYTE_FROM_U16(MIC_GAIN_INIT),
-        UPPER_BYTE_FROM_U16(MIC_GAIN_INIT), UPPER_BYTE_FROM_U16(MIC_GAIN_INIT),
-        UPPER_BYTE_FROM_U16(MIC_GAIN_INIT), UPPER_BYTE_FROM_U16(MIC_GAIN_INIT),
-        UPPER_BYTE_FROM_U16(MIC_GAIN_INIT), UPPER_BYTE_FROM_U16(MIC_GAIN_INIT),
-        UPPER_BYTE_FROM_U16(MIC_GAIN_INIT), UPPER_BYTE_FROM_U16(MIC_GAIN_INIT),
-        UPPER_BYTE_FROM_U16(MIC_GAIN_INIT), UPPER_BYTE_FROM_U16(MIC_GAIN_INIT),
-        UPPER_BYTE_FROM_U16(MIC_GAIN_INIT), UPPER_BYTE_FROM_U16(MIC_GAIN_INIT), // Ch 7
-        UPPER_BYTE_FROM_U16(MIC_GAIN_INIT), UPPER_BYTE_FROM_U16(MIC_GAIN_INIT), // Ch 8
-        UPPER_BYTE_FROM_U16(MIC_GAIN_INIT), UPPER_BYTE_FROM_U16(MIC_GAIN_INIT),
-        UPPER_BYTE_FROM_U16(MIC_GAIN_INIT), UPPER_BYTE_FROM_U16(MIC_GAIN_INIT),
-        UPPER_BYTE_FROM_U16(MIC_GAIN_INIT), UPPER_BYTE_FROM_U16(MIC_GAIN_INIT),
-        UPPER_BYTE_FROM_U16(MIC_GAIN_INIT), UPPER_BYTE_FROM_U16(MIC_GAIN_INIT),
-        UPPER_BYTE_FROM_U16(MIC_GAIN_INIT), UPPER_BYTE_FROM_U16(MIC_GAIN_INIT),
-        UPPER_BYTE_FROM_U16(MIC_GAIN_INIT), UPPER_BYTE_FROM_U16(MIC_GAIN_INIT),
-        UPPER_BYTE_FROM_U16(MIC_GAIN_INIT), UPPER_BYTE_FROM_U16(MIC_GAIN_INIT) // Ch 15
-    };
+#include "i2c_control.h"
+
+// One pair of 8b registers per mic. MSB first LSB last (Little endian), followed by the commit
+// and auto commit registers. Initialised by i2c_control()
+uint8_t i2c_slave_registers[I2C_CONTROL_NUM_REGISTERS];
 
 // This variable is set to -1 if no current register has been selected.
 // If the I2C master does a write transaction to select the register then
@@ -38,6 +21,25 @@ uint8_t i2c_slave_registers[I2C_CONTROL_NUM_REGISTERS] = {
 int current_regnum = -1;
 int changed_regnum = -1;
 
+// Set when a gain has been forwarded to the hub but not yet committed
+bool gains_staged = false;
+
+// Every message fits in the 8 bytes of channel buffering, so the callbacks do not wait for the hub as long as
+// it reads each message before the next two arrive. The hub reads them while it waits for a mic frame.
+static void send_gain_to_hub(chanend_t c_i2c_reg, uint8_t channel) {
+    s_chan_out_byte(c_i2c_reg, channel);
+    s_chan_out_byte(c_i2c_reg, i2c_slave_registers[channel << 1]);
+    s_chan_out_byte(c_i2c_reg, i2c_slave_registers[(channel << 1) + 1]);
+    gains_staged = true;
+}
+
+static void commit_gains(chanend_t c_i2c_reg) {
+    // The gains are already staged in the hub, so a commit is a single byte
+    if (gains_staged) {
+        s_chan_out_byte(c_i2c_reg, I2C_CONTROL_MSG_COMMIT);
+        gains_staged = false;
+    }
+}
 
 I2C_CALLBACK_ATTR
 i2c_slave_ack_t i2c_ack_read_req(void *app_data) {
@@ -66,9 +68,11 @@ uint8_t i2c_master_req_data(void *app_data) {
 
     uint8_t data = 0;
 
-    if (current_regnum != -1) {
+    // Auto-increment so a burst read returns consecutive registers
+    if (current_regnum != -1 && current_regnum < I2C_CONTROL_NUM_REGISTERS) {
         data = i2c_slave_registers[current_regnum];
         // printf("REGFILE: reg[%d] -> %x\n", current_regnum, data);
+        current_regnum++;
     } else {
         data = 0;
     }
@@ -81,29 +85,29 @@ i2c_slave_ack_t i2c_master_sent_data(void *app_data, uint8_t data) {
     i2c_slave_ack_t response = I2C_SLAVE_NACK;
 
     // The master is trying to write, which will either select a register
-    // or write to a previously selected register
+    // or write to a previously selected register. Writes auto-increment so
+    // a burst can update several gains in one transaction
     if (current_regnum != -1) {
-        i2c_slave_registers[current_regnum] = data;
-        // printf("REGFILE: reg[%d] <- %x\n", current_regnum, data);
-
-        // Inform the user application that the register has changed
-        changed_regnum = current_regnum;
+        if (current_regnum >= I2C_CONTROL_NUM_REGISTERS) {
+            return I2C_SLAVE_NACK;
+        }
 
-        // Forward command to hub on the other tile
-        // Note that, even on the same tile, we have 8 bytes of channel buffering
-        // so this will never block if mic_array and therefore the hub is looping
         chanend_t c_i2c_reg = *(chanend_t*)app_data;
+        changed_regnum = current_regnum;
+        current_regnum++;
 
-        bool is_lower_byte = changed_regnum & 0x1;
-        unsigned channel = changed_regnum >> 1; // Two bytes of gain per channel
-        uint8_t data_h = i2c_slave_registers[channel << 1]; 
-        uint8_t data_l = i2c_slave_registers[(channel << 1) + 1]; 
+        if (changed_regnum == I2C_CONTROL_REG_COMMIT) {
+            commit_gains(c_i2c_reg);
+        } else if (changed_regnum == I2C_CONTROL_REG_AUTO_COMMIT) {
+            i2c_slave_registers[changed_regnum] = (data != 0);
+        } else {
+            i2c_slave_registers[changed_regnum] = data;
+            // printf("REGFILE: reg[%d] <- %x\n", changed_regnum, data);
 
-        // Only update when lower byte is written
-        if(is_lower_byte){
-            s_chan_out_byte(c_i2c_reg, channel);
-            s_chan_out_byte(c_i2c_reg, data_h);
-            s_chan_out_byte(c_i2c_reg, data_l);
+            // Only stage the gain when the lower byte is written. The hub applies it on commit
+            if (changed_regnum & 0x1) {
+                send_gain_to_hub(c_i2c_reg, changed_regnum >> 1); // Two bytes of gain per channel
+            }
         }
 
         response = I2C_SLAVE_ACK;
@@ -127,6 +131,11 @@ void i2c_stop_bit(void *app_data) {
     // The I2C transaction has completed, clear the regnum
 
     current_regnum = -1;
+
+    // Apply all gains written in the transaction together
+    if (i2c_slave_registers[I2C_CONTROL_REG_AUTO_COMMIT]) {
+        commit_gains(*(chanend_t*)app_data);
+    }
 }
 
 I2C_CALLBACK_ATTR
@@ -135,10 +144,16 @@ int i2c_shutdown(void *app_data) {
 }
 
 
-DECLARE_JOB(i2c_control, (chanend_t));
 void i2c_control(chanend_t c_i2c_reg) {
     printf("i2c_control\n");
 
+    for(int ch = 0; ch < MIC_ARRAY_CONFIG_MIC_COUNT; ch++){
+        i2c_slave_registers[ch << 1] = UPPER_BYTE_FROM_U16(MIC_GAIN_INIT);
+        i2c_slave_registers[(ch << 1) + 1] = LOWER_BYTE_FROM_U16(MIC_GAIN_INIT);
+    }
+    i2c_slave_registers[I2C_CONTROL_REG_COMMIT] = 0;
+    i2c_slave_registers[I2C_CONTROL_REG_AUTO_COMMIT] = 1;
+
     port_t p_scl = I2C_CONTROL_SLAVE_SCL;
     port_t p_sda = I2C_CONTROL_SLAVE_SDA;
 
@@ -7,6 +7,17 @@
 #include <xcore/channel.h>
 
 #include "i2c.h"
+#include "app_config.h"
+
+// Register map. Each gain is 16b, MSB at the even register and LSB at the odd register.
+// Reads and writes auto-increment so several registers can be accessed in one transaction.
+#define I2C_CONTROL_REG_GAIN                0                                   // Staged gain of mic 0, up to 2 * MIC_ARRAY_CONFIG_MIC_COUNT - 1
+#define I2C_CONTROL_REG_COMMIT              (MIC_ARRAY_CONFIG_MIC_COUNT * 2)    // Write any value to apply all staged gains together
+#define I2C_CONTROL_REG_AUTO_COMMIT         (I2C_CONTROL_REG_COMMIT + 1)        // 1 (default): apply staged gains at the end of each write transaction
+
+// Messages to the hub. A gain is staged with three bytes: the channel, then the MSB and LSB of the gain.
+// A commit is the single byte below, after which the hub applies all staged gains together.
+#define I2C_CONTROL_MSG_COMMIT              0xff
 
 
 DECLARE_JOB(i2c_control, (chanend_t));
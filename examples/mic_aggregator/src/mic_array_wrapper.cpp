@@ -4,6 +4,7 @@
 #include <stdint.h>
 #include <xcore/channel_streaming.h>
 #include <xcore/interrupt.h>
+#include <xcore/hwtimer.h>
 
 #include "app_config.h"
 #include "app_mic_array.hpp"
@@ -37,9 +38,6 @@
 #define MIC_ARRAY_CONFIG_MCLK_DIVIDER           ((MIC_ARRAY_CONFIG_MCLK_FREQ)       \
                                                 /(MIC_ARRAY_CONFIG_PDM_FREQ))
 
-#define MIC_ARRAY_CONFIG_OUT_SAMPLE_RATE        ((MIC_ARRAY_CONFIG_PDM_FREQ)      \
-                                                /(STAGE2_DEC_FACTOR))
-
 ////// Any Additional correctness checks
 
 
@@ -52,7 +50,14 @@ pdm_rx_resources_t pdm_res = PDM_RX_RESOURCES_DDR(
                                 MIC_ARRAY_CONFIG_CLOCK_BLOCK_A,
                                 MIC_ARRAY_CONFIG_CLOCK_BLOCK_B);
 
-constexpr int mic_count = MIC_ARRAY_CONFIG_MIC_COUNT;
+#if MIC_ARRAY_B_MIC_COUNT > 0
+pdm_rx_resources_t pdm_res_b = PDM_RX_RESOURCES_DDR(
+                                MIC_ARRAY_B_PORT_MCLK,
+                                MIC_ARRAY_B_PORT_PDM_CLK,
+                                MIC_ARRAY_B_PORT_PDM_DATA,
+                                MIC_ARRAY_B_CLK1,
+                                MIC_ARRAY_B_CLK2);
+#endif
 
 static const uint32_t WORD_ALIGNED stage1_coef_custom[128] = STAGE_1_48K_COEFFS;
 static const int32_t WORD_ALIGNED stage2_coef_custom[MIC_ARRAY_STAGE_2_NUM_TAPS] = STAGE_2_48K_COEFFS;
@@ -72,10 +77,44 @@ constexpr const right_shift_t* stage_2_shift() {
     return &stage2_shift_custom;
 }
 
+// Par decimator that measures the time taken by its slowest task for each output sample and prints the
+// worst case once per second
+template <unsigned mic_count, unsigned s2_dec_factor, unsigned s2_tap_count>
+class ProfiledDecimator : public par_mic_array::MyTwoStageDecimator<mic_count, s2_dec_factor, s2_tap_count>
+{
+  uint32_t max_ticks = 0;
+  uint32_t samples = 0;
+
+public:
+  void ProcessBlock(int32_t sample_out[mic_count], uint32_t pdm_block[mic_count * s2_dec_factor])
+  {
+    uint32_t start = get_reference_time();
+    par_mic_array::MyTwoStageDecimator<mic_count, s2_dec_factor, s2_tap_count>::ProcessBlock(sample_out, pdm_block);
+    uint32_t ticks = get_reference_time() - start;
+
+    if(ticks > max_ticks){
+      max_ticks = ticks;
+    }
+    if(++samples == MIC_ARRAY_CONFIG_OUT_SAMPLE_RATE){
+      const uint32_t budget_ticks = XS1_TIMER_HZ / MIC_ARRAY_CONFIG_OUT_SAMPLE_RATE;
+      printf("decimator: mics=%u tasks=%d max_ticks=%lu budget_ticks=%lu load=%lu%% model_load=%d%%\n",
+             mic_count, MIC_ARRAY_NUM_DECIMATOR_TASKS, max_ticks, budget_ticks, (100 * max_ticks) / budget_ticks,
+             DECIMATOR_COST_LOAD_PERCENT(mic_count, MIC_ARRAY_NUM_DECIMATOR_TASKS, s2_dec_factor, s2_tap_count,
+                                         MIC_ARRAY_CONFIG_OUT_SAMPLE_RATE));
+      max_ticks = 0;
+      samples = 0;
+    }
+  }
+};
+
+template <unsigned mic_count>
+using TDecimator = typename std::conditional<MIC_ARRAY_DECIMATOR_PROFILE,
+                          ProfiledDecimator<mic_count, decimation_factor, stage_2_tap_count>,
+                          par_mic_array::MyTwoStageDecimator<mic_count, decimation_factor, stage_2_tap_count>>::type;
+
+template <unsigned mic_count>
 using TMicArray = mic_array::MicArray<mic_count,
-                          par_mic_array::MyTwoStageDecimator<mic_count, 
-                                                       decimation_factor, 
-                                                       stage_2_tap_count>,
+                          TDecimator<mic_count>,
                           mic_array::StandardPdmRxService<mic_count,
                                                           mic_count,
                                                           decimation_factor>, 
@@ -88,7 +127,12 @@ using TMicArray = mic_array::MicArray<mic_count,
                                                         MIC_ARRAY_CONFIG_SAMPLES_PER_FRAME, 
                                                         mic_array::ChannelFrameTransmitter>>;
 
-TMicArray mics;
+TMicArray<MIC_ARRAY_A_MIC_COUNT> mics;
+
+#if MIC_ARRAY_B_MIC_COUNT > 0
+// Second mic array on tile 1 for mics MIC_ARRAY_A_MIC_COUNT and up
+TMicArray<MIC_ARRAY_B_MIC_COUNT> mics_b;
+#endif
 
 MA_C_API
 void app_mic_array_init()
@@ -105,13 +149,16 @@ void app_mic_array_init()
   printf("- MIC_ARRAY_CONFIG_MCLK_FREQ: " XSTR(MIC_ARRAY_CONFIG_MCLK_FREQ) "\n");
   printf("- MIC_ARRAY_CONFIG_PDM_FREQ: " XSTR(MIC_ARRAY_CONFIG_PDM_FREQ) "\n");
   printf("- MIC_ARRAY_CONFIG_MIC_COUNT: " XSTR(MIC_ARRAY_CONFIG_MIC_COUNT) "\n");
+  printf("- MIC_ARRAY_A_MIC_COUNT: %d\n", MIC_ARRAY_A_MIC_COUNT);
+  printf("- MIC_ARRAY_B_MIC_COUNT: %d\n", MIC_ARRAY_B_MIC_COUNT);
   printf("- MIC_ARRAY_CONFIG_USE_DDR: " XSTR(MIC_ARRAY_CONFIG_USE_DDR) "\n");
   printf("- MIC_ARRAY_CONFIG_PORT_MCLK: " XSTR(MIC_ARRAY_CONFIG_PORT_MCLK) "\n");
   printf("- MIC_ARRAY_CONFIG_PORT_PDM_CLK: " XSTR(MIC_ARRAY_CONFIG_PORT_PDM_CLK) "\n");
   printf("- MIC_ARRAY_CONFIG_MCLK_DIVIDER: " XSTR(MIC_ARRAY_CONFIG_MCLK_DIVIDER) "\n");
   printf("- MIC_ARRAY_CONFIG_PORT_PDM_DATA: " XSTR(MIC_ARRAY_CONFIG_PORT_PDM_DATA) "\n");
   printf("- MIC_ARRAY_CONFIG_SAMPLES_PER_FRAME: " XSTR(MIC_ARRAY_CONFIG_SAMPLES_PER_FRAME) "\n");
-  printf("- MIC_ARRAY_NUM_DECIMATOR_TASKS: " XSTR(MIC_ARRAY_NUM_DECIMATOR_TASKS) "\n");
+  printf("- MIC_ARRAY_NUM_DECIMATOR_TASKS: %d\n", MIC_ARRAY_NUM_DECIMATOR_TASKS);
+  printf("- MIC_ARRAY_DECIMATOR_LOAD: %d%% (modelled worst case per task)\n", MIC_ARRAY_DECIMATOR_LOAD);
   printf("- MIC_ARRAY_PDM_RX_OWN_THREAD: " XSTR(MIC_ARRAY_PDM_RX_OWN_THREAD) "\n");
   
   if(!MIC_ARRAY_PDM_RX_OWN_THREAD)
@@ -151,3 +198,28 @@ void app_mic_array_assertion_enable()
 {
   mics.PdmRx.AssertOnDroppedBlock(true);
 }
+
+#if MIC_ARRAY_B_MIC_COUNT > 0
+MA_C_API
+void app_mic_array_b_init()
+{
+  mic_array_resources_configure(&pdm_res_b, MIC_ARRAY_CONFIG_MCLK_DIVIDER);
+
+  mics_b.Decimator.Init(stage_1_filter(), stage_2_filter(), *stage_2_shift());
+  mics_b.PdmRx.Init(pdm_res_b.p_pdm_mics);
+  mics_b.PdmRx.AssertOnDroppedBlock(true);
+
+  mic_array_pdm_clock_start(&pdm_res_b);
+}
+
+MA_C_API
+void app_mic_array_b_task(chanend_t c_frames_out)
+{
+  mics_b.OutputHandler.FrameTx.SetChannel(c_frames_out);
+
+  // There is no spare thread on tile 1 so PDM rx always runs in an ISR
+  mics_b.PdmRx.InstallISR();
+  mics_b.PdmRx.UnmaskISR();
+  mics_b.ThreadEntry();
+}
+#endif
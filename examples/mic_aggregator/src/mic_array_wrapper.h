@@ -34,4 +34,12 @@ void app_mic_array_assertion_disable( void );
 MA_C_API
 void app_pdm_rx_task( void );
 
+#if MIC_ARRAY_B_MIC_COUNT > 0
+MA_C_API
+void app_mic_array_b_init( void );
+
+MA_C_API
+void app_mic_array_b_task( chanend_t c_frames_out );
+#endif
+
 C_API_END
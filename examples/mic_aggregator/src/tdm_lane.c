@@ -0,0 +1,41 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#include <string.h>
+
+#include "tdm_lane.h"
+
+void tdm_lane_init(tdm_slave_lane_t *lane, audio_frame_t **read_buffer_ptr, unsigned lane_idx)
+{
+    lane->read_buffer_ptr = read_buffer_ptr;
+    lane->read_buffer = NULL;
+    lane->sample_idx = 0;
+    lane->first_ch = lane_idx * TDM_SLAVE_LANE_CHANS;
+    lane->num_ch = MIC_ARRAY_CONFIG_MIC_COUNT - lane->first_ch;
+    if(lane->num_ch > TDM_SLAVE_LANE_CHANS){
+        lane->num_ch = TDM_SLAVE_LANE_CHANS;
+    }
+}
+
+void tdm_lane_send(tdm_slave_lane_t *lane, size_t n, int32_t *send_data)
+{
+    // Pick up the latest frame from the hub at the start of each frame period and play it out one sample per TDM frame.
+    // Holding on to a copy of the pointer also means the hub moving on halfway through a frame is not an issue.
+    if(lane->sample_idx == 0){
+        lane->read_buffer = *lane->read_buffer_ptr;
+    }
+
+    if(lane->read_buffer != NULL){
+        memcpy(send_data, &lane->read_buffer->data[lane->sample_idx][lane->first_ch], lane->num_ch * sizeof(*send_data)); // Samples of one period are contiguous
+        if(lane->num_ch < n){
+            memset(&send_data[lane->num_ch], 0, (n - lane->num_ch) * sizeof(*send_data));
+        }
+    } else {
+        memset(send_data, 0, n * sizeof(*send_data));
+    }
+
+    lane->sample_idx++;
+    if(lane->sample_idx == MIC_ARRAY_CONFIG_SAMPLES_PER_FRAME){
+        lane->sample_idx = 0;
+    }
+}
@@ -0,0 +1,23 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "app_main.h"           // audio_frame_t
+
+// State of one TDM16 output lane
+typedef struct tdm_slave_lane_t{
+    audio_frame_t **read_buffer_ptr;    // Latest frame from the hub
+    audio_frame_t *read_buffer;         // Frame currently being played out
+    unsigned sample_idx;                // Sample period of read_buffer sent in the next TDM frame
+    unsigned first_ch;                  // First mic channel sent on this lane
+    unsigned num_ch;                    // Number of mic channels sent on this lane, the remaining slots are zero
+} tdm_slave_lane_t;
+
+// Set up a lane to send TDM_SLAVE_LANE_CHANS mic channels starting at lane_idx * TDM_SLAVE_LANE_CHANS
+void tdm_lane_init(tdm_slave_lane_t *lane, audio_frame_t **read_buffer_ptr, unsigned lane_idx);
+
+// Fill the n slots of the next TDM frame from the latest frame of the hub
+void tdm_lane_send(tdm_slave_lane_t *lane, size_t n, int32_t *send_data);
@@ -9,10 +9,18 @@
 
 #include "app_config.h"
 #include "app_main.h"
+#include "bench.h"
 
 // Global for now to allow the monitor to function
 int32_t rx_data[16] = {0};
 
+#if MIC_AGGREGATOR_BENCH
+// Checks of the frames received from the first TDM lane, also read by the monitor
+bench_check_t bench_tdm;
+bench_timing_t bench_tdm_timing;
+volatile int bench_tdm_timing_reset_req = 0;    // Set by the monitor, the master resets the timing at its next frame
+#endif
+
 
 void tdm16_master_simple(void) {
     printf("tdm16_master_simple\n");
@@ -51,6 +59,11 @@ void tdm16_master_simple(void) {
     port_set_trigger_time(p_data_in_master, 32 + 1 + offset);
     set_pad_delay(p_data_in_master, 5); // 4,5 work. 6 not settable. 0..3 Do not work.
 
+#if MIC_AGGREGATOR_BENCH
+    bench_check_init(&bench_tdm);
+    bench_timing_init(&bench_tdm_timing);
+#endif
+
     clock_start(tdm_master_clk);
 
     while(1){
@@ -61,10 +74,23 @@ void tdm16_master_simple(void) {
                 // xscope_int(i - 1, rx_data[i - 1]);
             }
             rx_data[i] = bitrev(port_in(p_data_in_master));
+#if MIC_AGGREGATOR_BENCH
+            // There is only time to check each slot as it arrives, not the whole frame at the end
+            bench_check_sample(&bench_tdm, i, i, rx_data[i]);
+#endif
         }
 
         port_out(p_fsynch_master, fsynch_bit_pattern);
         rx_data[15] = bitrev(port_in(p_data_in_master));
+#if MIC_AGGREGATOR_BENCH
+        bench_check_sample(&bench_tdm, 15, 15, rx_data[15]);
+        bench_check_end_frame(&bench_tdm);
+        if(bench_tdm_timing_reset_req){
+            bench_timing_reset(&bench_tdm_timing);
+            bench_tdm_timing_reset_req = 0;
+        }
+        bench_timing_update(&bench_tdm_timing, get_reference_time(), 0, 0);
+#endif
     }
 }
 
@@ -73,6 +99,13 @@ void tdm_master_monitor(void) {
 
     hwtimer_t tmr = hwtimer_alloc();
 
+#if MIC_AGGREGATOR_BENCH
+    // The master task owns the counts so print the change over each second rather than resetting them.
+    // The interval range is snapshotted and the master asked to reset it, so each report covers one second.
+    bench_check_t last = {0};
+    int periods = 0;           // 100ms monitor periods since the last report
+#endif
+
     while(1){
         hwtimer_delay(tmr, XS1_TIMER_KHZ * 100);
         printf("tdm_rx: %ld %ld %ld %ld %ld %ld %ld %ld %ld %ld %ld %ld %ld %ld %ld %ld\n",
@@ -81,6 +114,18 @@ void tdm_master_monitor(void) {
           rx_data[8], rx_data[9], rx_data[10], rx_data[11],
           rx_data[12], rx_data[13], rx_data[14], rx_data[15]
           );
+#if MIC_AGGREGATOR_BENCH
+        if(++periods == 10){
+            bench_check_t now = bench_tdm;
+            bench_timing_t timing = bench_tdm_timing;
+            bench_tdm_timing_reset_req = 1;
+            printf("bench_tdm: frames=%lu errors=%lu repeats=%lu skips=%lu interval_ticks=%lu..%lu\n",
+                   now.frames - last.frames, now.errors - last.errors, now.repeats - last.repeats, now.skips - last.skips,
+                   timing.min_interval_ticks, timing.max_interval_ticks);
+            last = now;
+            periods = 0;
+        }
+#endif
     }
 }
 
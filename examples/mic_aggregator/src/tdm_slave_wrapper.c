@@ -2,7 +2,6 @@
 // This Software is subject to the terms of the XMOS Public Licence: Version 1.
 
 #include <stdio.h>
-#include <string.h>
 
 #include "app_main.h"
 #include "tdm_slave_wrapper.h"
@@ -35,17 +34,7 @@ void tdm_post_port_init(void *ctx)
 I2S_CALLBACK_ATTR
 void i2s_send(void *app_data, size_t n, int32_t *send_data)
 {
-    audio_frame_t **read_buffer_ptr = (audio_frame_t **)app_data;
-    audio_frame_t *read_buffer = *read_buffer_ptr; // Make copy just in case mics move on buffer halfway through frame
-
-    if(read_buffer != NULL){
-        // for(int ch = 0; ch < 16; ch++){
-        //     send_data[ch] = read_buffer->data[ch][0];
-        // }
-        memcpy(send_data, &read_buffer->data[0][0], 16 * sizeof(*send_data)); // We can do this because samples are contiguous in memory for framesize == 1
-    } else {
-        memset(send_data, 0, 16 * sizeof(*send_data));
-    }
+    tdm_lane_send((tdm_slave_lane_t *)app_data, n, send_data);
 }
 
 I2S_CALLBACK_ATTR
@@ -55,8 +44,12 @@ i2s_restart_t i2s_restart_check(void *app_data)
 }
 
 
-void tdm16_slave(audio_frame_t **read_buffer_ptr) {
-    printf("tdm16_slave\n");
+void tdm16_slave(audio_frame_t **read_buffer_ptr, unsigned lane_idx) {
+    printf("tdm16_slave lane %u\n", lane_idx);
+
+    // Each lane plays out TDM_SLAVE_LANE_CHANS consecutive mic channels
+    tdm_slave_lane_t lane;
+    tdm_lane_init(&lane, read_buffer_ptr, lane_idx);
 
     i2s_tdm_ctx_t ctx;
     i2s_callback_group_t i_i2s = {
@@ -64,14 +57,14 @@ void tdm16_slave(audio_frame_t **read_buffer_ptr) {
             .restart_check = (i2s_restart_check_t) i2s_restart_check,
             .receive = NULL,
             .send = (i2s_send_t) i2s_send,
-            .app_data = (void*)read_buffer_ptr,
+            .app_data = (void*)&lane,
     };
 
-    port_t p_bclk = TDM_SLAVEPORT_BCLK;
-    port_t p_fsync = TDM_SLAVEPORT_FSYNCH;
-    port_t p_dout = TDM_SLAVEPORT_OUT;
+    port_t p_bclk = (lane_idx == 0) ? TDM_SLAVEPORT_BCLK : TDM_SLAVE_B_PORT_BCLK;
+    port_t p_fsync = (lane_idx == 0) ? TDM_SLAVEPORT_FSYNCH : TDM_SLAVE_B_PORT_FSYNCH;
+    port_t p_dout = (lane_idx == 0) ? TDM_SLAVEPORT_OUT : TDM_SLAVE_B_PORT_OUT;
 
-    xclock_t bclk = TDM_SLAVEPORT_CLK_BLK;
+    xclock_t bclk = (lane_idx == 0) ? TDM_SLAVEPORT_CLK_BLK : TDM_SLAVE_B_PORT_CLK_BLK;
 
     i2s_tdm_slave_tx_16_init(
         &ctx,
@@ -85,4 +78,4 @@ void tdm16_slave(audio_frame_t **read_buffer_ptr) {
         tdm_post_port_init);
 
     i2s_tdm_slave_tx_16_thread(&ctx);
-}
\ No newline at end of file
+}
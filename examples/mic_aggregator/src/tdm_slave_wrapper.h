@@ -4,8 +4,9 @@
 #pragma once
 
 #include "app_main.h"           // audio_frame_t
+#include "tdm_lane.h"
 #include "i2s_tdm_slave.h"
 
 
-DECLARE_JOB(tdm16_slave, (audio_frame_t **));
-void tdm16_slave(audio_frame_t **read_buffer);
\ No newline at end of file
+DECLARE_JOB(tdm16_slave, (audio_frame_t **, unsigned));
+void tdm16_slave(audio_frame_t **read_buffer, unsigned lane_idx);
\ No newline at end of file
@@ -6,8 +6,10 @@
 #ifndef _XUA_CONF_H_ 
 #define _XUA_CONF_H_
 
+#include "app_config.h"
+
 #define NUM_USB_CHAN_OUT 0
-#define NUM_USB_CHAN_IN 16
+#define NUM_USB_CHAN_IN MIC_ARRAY_CONFIG_MIC_COUNT
 #define I2S_CHANS_DAC 0
 #define I2S_CHANS_ADC 0
 #define MCLK_441 (512 * 44100)
@@ -0,0 +1,80 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <stdint.h>
+#include <string.h>
+
+#include <xcore/assert.h>
+
+#include "asr_history.h"
+
+void asr_history_init(asr_history_t *history, asr_sample_t *buf, uint32_t bricks, size_t brick_len)
+{
+    xassert(history);
+    xassert(buf || (bricks == 0));
+
+    memset(history, 0, sizeof(asr_history_t));
+    history->buf = buf;
+    history->bricks = bricks;
+    history->brick_len = brick_len;
+}
+
+void asr_history_push(asr_history_t *history, const asr_sample_t *brick)
+{
+    if (history->bricks == 0) {
+        return;
+    }
+    memcpy(&history->buf[history->next * history->brick_len], brick, history->brick_len * sizeof(asr_sample_t));
+    history->next = (history->next + 1) % history->bricks;
+    if (history->count < history->bricks) {
+        history->count++;
+    }
+}
+
+void asr_history_clear(asr_history_t *history)
+{
+    history->count = 0;
+}
+
+uint32_t asr_history_bricks_after(const asr_history_t *history, const asr_result_t *result, uint32_t index)
+{
+    uint32_t bricks;
+
+    if (result->end_index == -1) {
+        return 0;
+    }
+    bricks = (index - (uint32_t) result->end_index) / history->brick_len;
+    return (bricks < history->count) ? bricks : history->count;
+}
+
+asr_error_t asr_history_refeed(asr_history_t *history, asr_port_t ctx, uint32_t max_bricks, int32_t skip_id,
+                               uint32_t *fed, bool *found)
+{
+    asr_error_t asr_error = ASR_OK;
+    asr_result_t asr_result;
+    uint32_t count = (history->count < max_bricks) ? history->count : max_bricks;
+    uint32_t n = 0;
+
+    *found = false;
+    if (count > 0) {
+        // Oldest brick first
+        uint32_t index = (history->next + history->bricks - count) % history->bricks;
+
+        while (n < count) {
+            n++;
+            asr_error = asr_process(ctx, &history->buf[index * history->brick_len], history->brick_len);
+            if (asr_error != ASR_OK) {
+                break;
+            }
+            if ((asr_get_result(ctx, &asr_result) == ASR_OK) && (asr_result.id != 0) && (asr_result.id != skip_id)) {
+                *found = true;
+                break;
+            }
+            index = (index + 1) % history->bricks;
+        }
+    }
+    history->count = 0;
+    if (fed) {
+        *fed = n;
+    }
+    return asr_error;
+}
@@ -0,0 +1,90 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#ifndef XCORE_VOICE_ASR_HISTORY_H
+#define XCORE_VOICE_ASR_HISTORY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "asr.h"
+
+/**
+ * \addtogroup asr_history_api asr_history_api
+ *
+ * Ring of the most recent bricks, which can be fed to an ASR port again.
+ * @{
+ */
+
+/**
+ * History state. Initialize with asr_history_init().
+ */
+typedef struct asr_history_struct
+{
+    asr_sample_t *buf;      ///< bricks * brick_len samples
+    uint32_t    bricks;     ///< Capacity, in bricks
+    size_t      brick_len;  ///< Samples per brick
+    uint32_t    count;      ///< Bricks held
+    uint32_t    next;       ///< Index of the next brick to store
+} asr_history_t;
+
+/**
+ * Initialize an empty history.
+ *
+ * \param history    A pointer to the history state.
+ * \param buf        Buffer of bricks * brick_len samples. May be NULL if bricks is 0.
+ * \param bricks     Number of bricks held.
+ * \param brick_len  Samples per brick, as passed to asr_process.
+ */
+void asr_history_init(asr_history_t *history, asr_sample_t *buf, uint32_t bricks, size_t brick_len);
+
+/**
+ * Store a brick, replacing the oldest if the history is full.
+ *
+ * \param history    A pointer to the history state.
+ * \param brick      brick_len samples.
+ */
+void asr_history_push(asr_history_t *history, const asr_sample_t *brick);
+
+/**
+ * Empty the history.
+ *
+ * \param history    A pointer to the history state.
+ */
+void asr_history_clear(asr_history_t *history);
+
+/**
+ * Get the number of bricks held that follow the end of an utterance. The
+ * bricks held must be the last ones passed to asr_process, so that the
+ * newest is the one that produced the result.
+ *
+ * \param history    A pointer to the history state.
+ * \param result     The result, with end_index counted in samples passed to asr_process.
+ * \param index      Number of samples passed to asr_process so far, modulo 2^32.
+ *
+ * \returns The number of bricks held after end_index, or 0 if end_index is -1, which ports use for no end index.
+ */
+uint32_t asr_history_bricks_after(const asr_history_t *history, const asr_result_t *result, uint32_t index);
+
+/**
+ * Feed up to the newest max_bricks bricks held, oldest first, to asr_process.
+ * Stops after the first brick that returns an error or produces a result
+ * other than skip_id, so the result can be read with asr_get_result. A
+ * skip_id result, such as the wake up phrase found again, is passed over and
+ * feeding continues. The history is emptied.
+ *
+ * \param history    A pointer to the history state.
+ * \param ctx        The ASR port context.
+ * \param max_bricks Maximum number of bricks to feed.
+ * \param skip_id    Result id to pass over, or 0 to stop at any result.
+ * \param fed        Set to the number of bricks passed to asr_process. May be NULL.
+ * \param found      Set to true if a brick produced a result other than skip_id.
+ *
+ * \returns The error code from the last call to asr_process, or ASR_OK if it was not called.
+ */
+asr_error_t asr_history_refeed(asr_history_t *history, asr_port_t ctx, uint32_t max_bricks, int32_t skip_id,
+                               uint32_t *fed, bool *found);
+
+/**@}*/
+
+#endif // XCORE_VOICE_ASR_HISTORY_H
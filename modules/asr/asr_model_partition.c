@@ -0,0 +1,74 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <stdint.h>
+#include <string.h>
+
+#include <xcore/assert.h>
+
+#include "asr.h"
+#include "asr_model_partition.h"
+
+#if ASR_MODEL_PARTITION_CHECK_CRC
+#define CRC_READ_BYTES  (256)
+
+// CRC32 as written by model_pack.py (binascii.crc32), a nibble at a time
+static uint32_t model_crc32(devmem_manager_t *devmem, const uint8_t *model, size_t size)
+{
+    static const uint32_t table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+    uint8_t buf[CRC_READ_BYTES];
+    uint32_t crc = 0xFFFFFFFF;
+
+    for (size_t pos = 0; pos < size; pos += CRC_READ_BYTES) {
+        size_t n = (size - pos < CRC_READ_BYTES) ? size - pos : CRC_READ_BYTES;
+        devmem_read_ext(devmem, buf, model + pos, n);
+        for (size_t i = 0; i < n; i++) {
+            crc ^= buf[i];
+            crc = (crc >> 4) ^ table[crc & 0xF];
+            crc = (crc >> 4) ^ table[crc & 0xF];
+        }
+    }
+    return ~crc;
+}
+#endif
+
+void *asr_model_partition_find(devmem_manager_t *devmem, const void *partition, const char *name, size_t *size)
+{
+    asr_model_partition_header_t header;
+    asr_model_partition_entry_t entry;
+    const uint8_t *image = partition;
+
+    xassert(devmem);
+    xassert(name);
+
+    devmem_read_ext(devmem, &header, image, sizeof(header));
+    if ((header.magic != ASR_MODEL_PARTITION_MAGIC) || (header.version != ASR_MODEL_PARTITION_VERSION)) {
+        asr_printf("Model partition at 0x%x is not valid\n", (unsigned) (uintptr_t) partition);
+        return NULL;
+    }
+
+    for (int i = 0; i < header.entry_count; i++) {
+        devmem_read_ext(devmem, &entry, image + sizeof(header) + i * sizeof(entry), sizeof(entry));
+        entry.name[ASR_MODEL_PARTITION_NAME_LEN - 1] = '\0';
+        if (strcmp(entry.name, name) == 0) {
+            if ((entry.offset + entry.size > header.image_size) || (entry.offset % sizeof(uint32_t) != 0)) {
+                break;
+            }
+#if ASR_MODEL_PARTITION_CHECK_CRC
+            if (model_crc32(devmem, image + entry.offset, entry.size) != entry.crc32) {
+                asr_printf("Model %s in partition at 0x%x fails its CRC32 check\n", name, (unsigned) (uintptr_t) partition);
+                return NULL;
+            }
+#endif
+            if (size) {
+                *size = entry.size;
+            }
+            return (void *) (image + entry.offset);
+        }
+    }
+
+    asr_printf("Model %s not found in partition at 0x%x\n", name, (unsigned) (uintptr_t) partition);
+    return NULL;
+}
@@ -0,0 +1,74 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#ifndef XCORE_VOICE_ASR_MODEL_PARTITION_H
+#define XCORE_VOICE_ASR_MODEL_PARTITION_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "device_memory.h"
+
+/**
+ * \addtogroup asr_model_partition_api asr_model_partition_api
+ *
+ * Finds ASR models in a model partition image, as written by
+ * tools/model_pack/model_pack.py.
+ *
+ * The image starts with a header and a directory of models. Each model starts
+ * on an alignment boundary, so reads of the model start on a flash page and
+ * the most frequently read model, packed first, is contiguous with the
+ * directory.
+ * @{
+ */
+
+#define ASR_MODEL_PARTITION_MAGIC       (0x4C444D58)    // "XMDL"
+#define ASR_MODEL_PARTITION_VERSION     (1)
+#define ASR_MODEL_PARTITION_NAME_LEN    (20)
+
+/**
+ * Set to 1 to check the CRC32 of a model when it is found. The whole model is
+ * read from flash, so this is a debug option.
+ */
+#ifndef ASR_MODEL_PARTITION_CHECK_CRC
+#define ASR_MODEL_PARTITION_CHECK_CRC   (0)
+#endif
+
+/**
+ * Model partition image header.
+ */
+typedef struct asr_model_partition_header_struct
+{
+    uint32_t    magic;          ///< ASR_MODEL_PARTITION_MAGIC
+    uint16_t    version;        ///< ASR_MODEL_PARTITION_VERSION
+    uint16_t    entry_count;    ///< Number of directory entries following the header
+    uint32_t    alignment;      ///< Alignment of each model, in bytes
+    uint32_t    image_size;     ///< Size of the image, in bytes
+} asr_model_partition_header_t;
+
+/**
+ * Model partition directory entry.
+ */
+typedef struct asr_model_partition_entry_struct
+{
+    char        name[ASR_MODEL_PARTITION_NAME_LEN]; ///< Null terminated model name
+    uint32_t    offset;         ///< Offset of the model from the start of the image
+    uint32_t    size;           ///< Size of the model, in bytes
+    uint32_t    crc32;          ///< CRC32 of the model
+} asr_model_partition_entry_t;
+
+/**
+ * Find a model in a model partition image.
+ *
+ * \param devmem     A pointer to the device memory context, used to read the image.
+ * \param partition  The word-aligned address of the image, in the SwMem range for flash.
+ * \param name       Name of the model, as given to model_pack.py.
+ * \param size       Set to the size of the model in bytes if found. May be NULL.
+ *
+ * \returns          The address of the model, or NULL if the image is not valid, the model was not found or,
+ *                   with ASR_MODEL_PARTITION_CHECK_CRC, the model does not match its CRC32.
+ */
+void *asr_model_partition_find(devmem_manager_t *devmem, const void *partition, const char *name, size_t *size);
+
+/**@}*/
+
+#endif // XCORE_VOICE_ASR_MODEL_PARTITION_H
@@ -0,0 +1,83 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <stdint.h>
+#include <string.h>
+
+#include <xcore/assert.h>
+
+#include "asr_vnr_gate.h"
+
+void asr_vnr_gate_init(asr_vnr_gate_t *gate, float threshold, uint32_t hangover_bricks,
+                       uint32_t lookback_bricks, asr_sample_t *lookback, size_t brick_len)
+{
+    xassert(gate);
+
+    memset(gate, 0, sizeof(asr_vnr_gate_t));
+    gate->threshold = threshold;
+    gate->hangover_bricks = hangover_bricks;
+    gate->brick_len = brick_len;
+    asr_history_init(&gate->lookback, lookback, lookback_bricks, brick_len);
+}
+
+asr_error_t asr_vnr_gate_process(asr_vnr_gate_t *gate, asr_port_t ctx, asr_sample_t *audio_buf, size_t buf_len,
+                                 float vnr_pred, bool *processed, asr_result_t *lookback_result,
+                                 bool *lookback_found)
+{
+    xassert(gate);
+    xassert(buf_len == gate->brick_len);
+
+    gate->bricks++;
+    *processed = false;
+    *lookback_found = false;
+
+    if (vnr_pred >= gate->threshold) {
+        gate->hangover_left = gate->hangover_bricks;
+        if (!gate->open) {
+            uint32_t fed;
+            bool found;
+
+            gate->open = true;
+            gate->opens++;
+            asr_error_t asr_error = asr_history_refeed(&gate->lookback, ctx, gate->lookback.bricks, 0, &fed, &found);
+            gate->bricks_processed += fed;
+            if (asr_error != ASR_OK) {
+                return asr_error;
+            }
+            // Read the replay's result before the brick is processed, which would replace it
+            if (found && (asr_get_result(ctx, lookback_result) == ASR_OK)) {
+                *lookback_found = true;
+            }
+        }
+    } else if (gate->open) {
+        if (gate->hangover_left > 0) {
+            gate->hangover_left--;
+        } else {
+            // Start the next utterance from a clean search rather than continuing the last one across the gap
+            gate->open = false;
+            asr_reset(ctx);
+        }
+    }
+
+    if (!gate->open) {
+        asr_history_push(&gate->lookback, audio_buf);
+        return ASR_OK;
+    }
+
+    *processed = true;
+    gate->bricks_processed++;
+    return asr_process(ctx, audio_buf, buf_len);
+}
+
+void asr_vnr_gate_print_stats(asr_vnr_gate_t *gate, const char *name)
+{
+    xassert(gate);
+
+    if (gate->bricks > 0) {
+        asr_printf("%s VNR gate: processed %u of %u bricks (%u%%), opened %u times\n", name,
+                   (unsigned) gate->bricks_processed, (unsigned) gate->bricks,
+                   (unsigned) ((100ull * gate->bricks_processed) / gate->bricks), (unsigned) gate->opens);
+    }
+    gate->bricks = 0;
+    gate->bricks_processed = 0;
+    gate->opens = 0;
+}
@@ -0,0 +1,96 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#ifndef XCORE_VOICE_ASR_VNR_GATE_H
+#define XCORE_VOICE_ASR_VNR_GATE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "asr.h"
+#include "asr_history.h"
+
+/**
+ * \addtogroup asr_vnr_gate_api asr_vnr_gate_api
+ *
+ * Skips ASR processing of bricks that the audio pipeline's voice to noise
+ * ratio (VNR) estimator classifies as non-speech.
+ *
+ * The gate opens on the first brick with a VNR estimate at or above the
+ * threshold. Before that brick is processed, the bricks kept in the lookback
+ * buffer are replayed, so an onset the estimator was late to detect is not
+ * clipped. The gate stays open for a hangover period after the last speech
+ * brick. When it closes the ASR port is reset, so a search isn't continued
+ * across the gap.
+ * @{
+ */
+
+/**
+ * Gate state. Initialize with asr_vnr_gate_init().
+ */
+typedef struct asr_vnr_gate_struct
+{
+    float       threshold;          ///< VNR estimate at or above which a brick is speech
+    uint32_t    hangover_bricks;    ///< Bricks processed after the last speech brick
+    size_t      brick_len;          ///< Samples per brick
+    asr_history_t lookback;         ///< Skipped bricks, replayed when the gate opens
+
+    bool        open;
+    uint32_t    hangover_left;
+
+    uint32_t    bricks;             ///< Bricks passed to asr_vnr_gate_process
+    uint32_t    bricks_processed;   ///< Bricks passed to asr_process, including replayed bricks
+    uint32_t    opens;              ///< Number of times the gate opened
+} asr_vnr_gate_t;
+
+/**
+ * Initialize a gate. The gate starts closed.
+ *
+ * \param gate              A pointer to the gate state.
+ * \param threshold         VNR estimate, from 0 to 1, at or above which a brick is speech.
+ * \param hangover_bricks   Number of bricks to keep processing after the last speech brick.
+ * \param lookback_bricks   Number of non-speech bricks to replay when the gate opens.
+ * \param lookback          Buffer of lookback_bricks * brick_len samples. May be NULL if lookback_bricks is 0.
+ * \param brick_len         Samples per brick, as passed to asr_process.
+ */
+void asr_vnr_gate_init(asr_vnr_gate_t *gate, float threshold, uint32_t hangover_bricks,
+                       uint32_t lookback_bricks, asr_sample_t *lookback, size_t brick_len);
+
+/**
+ * Process one brick through the gate. Calls asr_process for the brick if the
+ * gate is open, after replaying the lookback bricks if the gate has just opened.
+ *
+ * If a replayed brick produces a result, the result is read into
+ * lookback_result and the remaining lookback bricks are dropped. The current
+ * brick is still processed, so its result is reported separately and can be
+ * read with asr_get_result as usual.
+ *
+ * \param gate             A pointer to the gate state.
+ * \param ctx              The ASR port context.
+ * \param audio_buf        A pointer to the 16-bit PCM samples of the brick.
+ * \param buf_len          The number of PCM samples, must equal the brick_len given to asr_vnr_gate_init.
+ * \param vnr_pred         VNR estimate of the brick, from 0 to 1.
+ * \param processed        Set to true if asr_process was called for the brick, and so asr_get_result has a new
+ *                         result.
+ * \param lookback_result  Set to the result of the lookback replay, if lookback_found is set.
+ * \param lookback_found   Set to true if a replayed lookback brick produced a result.
+ *
+ * \returns The error code from the last call to asr_process, or ASR_OK if it was not called. If the replay
+ *          fails, its error is returned and the brick is not processed.
+ */
+asr_error_t asr_vnr_gate_process(asr_vnr_gate_t *gate, asr_port_t ctx, asr_sample_t *audio_buf, size_t buf_len,
+                                 float vnr_pred, bool *processed, asr_result_t *lookback_result,
+                                 bool *lookback_found);
+
+/**
+ * Print the share of bricks that were processed and the number of times the gate opened,
+ * then clear the counters.
+ *
+ * \param gate       A pointer to the gate state.
+ * \param name       Name of the gate, printed with the statistics.
+ */
+void asr_vnr_gate_print_stats(asr_vnr_gate_t *gate, const char *name);
+
+/**@}*/
+
+#endif // XCORE_VOICE_ASR_VNR_GATE_H
@@ -21,10 +21,47 @@ typedef struct sensory_asr_struct
     int32_t word_id;
     appStruct_T app;
 
+    devmem_manager_t *devmem;
+    size_t spp_size;                        // Bytes allocated for the Sensory persistent memory
+    struct sensory_asr_struct *next;        // Next instance on this tile
 } sensory_asr_t;
 
+// Instances on this tile. Instances are created and released from a single thread.
+static sensory_asr_t *sensory_asr_list = NULL;
+
+// libTHFMicro's devMemCpy callback has no context argument, so all instances on a tile
+// read flash through the devmem manager of the oldest instance.
 static devmem_manager_t *devmem_ctx = NULL;
-static sensory_asr_t sensory_asr; 
+
+static size_t sensory_asr_memory(sensory_asr_t *sensory_asr)
+{
+    return sizeof(sensory_asr_t) + sensory_asr->spp_size + AUDIO_BUFFER_LEN * sizeof(s16);
+}
+
+static void sensory_asr_free(sensory_asr_t *sensory_asr)
+{
+    appStruct_T *app = &(sensory_asr->app);
+    t2siStruct *t = &(app->_t);
+
+    if (t->spp) {
+        devmem_free(sensory_asr->devmem, (void *) t->spp);
+        t->spp = 0;
+    }
+    if (app->audioBufferStart) {
+        devmem_free(sensory_asr->devmem, (void *) app->audioBufferStart);
+        app->audioBufferStart = 0;
+    }
+    devmem_free(sensory_asr->devmem, (void *) sensory_asr);
+}
+
+static asr_port_t sensory_asr_init_failed(sensory_asr_t *sensory_asr)
+{
+    sensory_asr_free(sensory_asr);
+    if (sensory_asr_list == NULL) {
+        devmem_ctx = NULL;
+    }
+    return NULL;
+}
 
 /**
  * Wrapper for devmem_read_ext called by libTHFMicro.
@@ -49,19 +86,35 @@ static BOOL xcore_is_flash(const void * ptr)
 asr_port_t asr_init(int32_t *model, int32_t *grammar, devmem_manager_t *devmem)
 {
     errors_t error;
-    appStruct_T *app = &(sensory_asr.app);
-    t2siStruct *t = &(app->_t);
     unsigned int sppSize;
-    sensory_asr.brick_count = 0;
-    devmem_ctx = devmem;
-
-    memset((void *) app, 0, sizeof(appStruct_T)); // Most app parameters can be zero
+    sensory_asr_t *shared = NULL;
 
     if (xcore_is_flash(grammar)) {
         asr_printf("ERROR: Search part (-search.BIN file) should be in SRAM.\n");
         return NULL;
     }
 
+    if (devmem_ctx == NULL) {
+        devmem_ctx = devmem;
+    }
+    // The flash reads of every instance go through devmem_ctx
+    xassert(devmem->read_ext == devmem_ctx->read_ext);
+
+    sensory_asr_t *sensory_asr = devmem_malloc(devmem, sizeof(sensory_asr_t));
+    if (sensory_asr == NULL)
+    {
+        asr_printf("ERROR: No memory left for ASR instance\n");
+        if (sensory_asr_list == NULL) {
+            devmem_ctx = NULL;
+        }
+        return NULL;
+    }
+    memset((void *) sensory_asr, 0, sizeof(sensory_asr_t)); // Most app parameters can be zero
+    sensory_asr->devmem = devmem;
+
+    appStruct_T *app = &(sensory_asr->app);
+    t2siStruct *t = &(app->_t);
+
     // Some parameters
     t->maxResults = SENSORY_ASR_MAX_RESULTS ? SENSORY_ASR_MAX_RESULTS : MAX_RESULTS;
     t->maxTokens = SENSORY_ASR_MAX_TOKENS ? SENSORY_ASR_MAX_TOKENS : MAX_TOKENS;
@@ -75,44 +128,55 @@ asr_port_t asr_init(int32_t *model, int32_t *grammar, devmem_manager_t *devmem)
     app->audioBufferLen = AUDIO_BUFFER_LEN;
     // if not using malloc for the audio buffer, just point audioBufferStart to the statically
     // allocated audio buffer:
-    app->audioBufferStart = devmem_malloc(devmem_ctx, AUDIO_BUFFER_LEN * sizeof(s16));
+    app->audioBufferStart = devmem_malloc(devmem, AUDIO_BUFFER_LEN * sizeof(s16));
     if (app->audioBufferStart == NULL)
     {
         asr_printf("ERROR: Audio buffer out of memory\n");
-        return NULL;
+        return sensory_asr_init_failed(sensory_asr);
     }
 
 #if (SENSORY_ASR_SDET_TYPE == SDET_LPSD)
     SensoryLPSDInit(app);
 #endif
 
+    // The net and grammar are only read by the recognizer, so instances using the same model point at the same data
     t->net = (intptr_t) model;
     t->gram = (intptr_t) grammar;
+    for (shared = sensory_asr_list; shared != NULL; shared = shared->next) {
+        if (shared->app._t.net == t->net) {
+            break;
+        }
+    }
 
     error = SensoryAlloc(app, &sppSize);  // Find size needed
     if (error) {
         asr_printf("ERROR: SensoryAlloc failed with error 0x%x\n", error);
-        return NULL;
+        return sensory_asr_init_failed(sensory_asr);
     }
     asr_printf("Sensory SPP size=%u (bytes)\n", sppSize);
 
     // Allocate a single block of memory for all dynamic persistent data
-    t->spp = (void *)devmem_malloc(devmem_ctx, sppSize);
+    t->spp = (void *)devmem_malloc(devmem, sppSize);
     if (t->spp == NULL)
     {
         asr_printf("ERROR: No memory left for SPP\n");
-        return NULL;
+        return sensory_asr_init_failed(sensory_asr);
     }
+    sensory_asr->spp_size = sppSize;
 
     // initialize
     error = SensoryProcessInit(app);
     if (error) {
         asr_printf("ERROR: SensoryProcessInit failed with error 0x%x\n", error);
-        return NULL;
+        return sensory_asr_init_failed(sensory_asr);
     }
 
-    asr_printf("SensoryProcessInit succeeded\n");
-    return (asr_port_t) &sensory_asr;
+    sensory_asr->next = sensory_asr_list;
+    sensory_asr_list = sensory_asr;
+
+    asr_printf("SensoryProcessInit succeeded, instance memory=%u (bytes)%s\n",
+               (unsigned) sensory_asr_memory(sensory_asr), shared ? ", model shared" : "");
+    return (asr_port_t) sensory_asr;
 }
 
 #pragma stackfunction 250
@@ -215,7 +279,10 @@ asr_error_t asr_get_attributes(asr_port_t *ctx, asr_attributes_t *attributes)
     xassert(ctx);
     xassert(attributes);
 
+    sensory_asr_t *sensory_asr = (sensory_asr_t *) ctx;
+
     attributes->samples_per_brick = FRAME_LEN;
+    attributes->required_memory = sensory_asr_memory(sensory_asr);
 
     infoStruct_T info;
     errors_t err = SensoryInfo(&info); 
@@ -242,16 +309,25 @@ asr_error_t asr_release(asr_port_t *ctx)
     xassert(ctx);
 
     sensory_asr_t *sensory_asr = (sensory_asr_t *) ctx;
-    appStruct_T *app = &(sensory_asr->app);
-    t2siStruct *t = &(app->_t);
+    sensory_asr_t **p = &sensory_asr_list;
 
-    if (t->spp) {
-        devmem_free(devmem_ctx, (void *) t-> spp);
-        t->spp = 0;
+    while (*p != NULL && *p != sensory_asr) {
+        p = &((*p)->next);
     }
-    if (app->audioBufferStart) {
-        devmem_free(devmem_ctx, (void *) app->audioBufferStart);
-        app->audioBufferStart = 0;
+    xassert(*p == sensory_asr);
+    *p = sensory_asr->next;
+
+    sensory_asr_free(sensory_asr);
+
+    if (sensory_asr_list == NULL) {
+        devmem_ctx = NULL;
+    } else {
+        // The oldest remaining instance is at the end of the list
+        sensory_asr_t *oldest = sensory_asr_list;
+        while (oldest->next != NULL) {
+            oldest = oldest->next;
+        }
+        devmem_ctx = oldest->devmem;
     }
 
     ctx = NULL;
@@ -0,0 +1,201 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "audio_frame_utils.h"
+
+/*
+ * Each channel is processed in its own loop so that the gain is loaded once
+ * per block and the unity gain case can skip the multiply. The inner loops
+ * are unrolled by 4, which lets the compiler pipeline the loads, multiplies
+ * and stores on xcore and vectorize them on the host.
+ */
+
+static inline int32_t gain_scale(const uint32_t gain, const int32_t samp)
+{
+    int64_t result = (int64_t)samp * (int64_t)gain;
+    return (int32_t)(result >> AUDIO_FRAME_GAIN_FRAC_BITS);
+}
+
+static inline uint32_t channel_gain(const uint32_t *gains, size_t ch)
+{
+    return (gains == NULL) ? AUDIO_FRAME_GAIN_UNITY : gains[ch];
+}
+
+static void strided_gain_s32(int32_t *dst, size_t dst_step,
+                             const int32_t *src, size_t src_step,
+                             size_t frame_count, uint32_t gain)
+{
+    size_t i = 0;
+
+    if (gain == AUDIO_FRAME_GAIN_UNITY) {
+        for (; i + 4 <= frame_count; i += 4) {
+            dst[(i + 0) * dst_step] = src[(i + 0) * src_step];
+            dst[(i + 1) * dst_step] = src[(i + 1) * src_step];
+            dst[(i + 2) * dst_step] = src[(i + 2) * src_step];
+            dst[(i + 3) * dst_step] = src[(i + 3) * src_step];
+        }
+        for (; i < frame_count; i++) {
+            dst[i * dst_step] = src[i * src_step];
+        }
+    } else {
+        for (; i + 4 <= frame_count; i += 4) {
+            dst[(i + 0) * dst_step] = gain_scale(gain, src[(i + 0) * src_step]);
+            dst[(i + 1) * dst_step] = gain_scale(gain, src[(i + 1) * src_step]);
+            dst[(i + 2) * dst_step] = gain_scale(gain, src[(i + 2) * src_step]);
+            dst[(i + 3) * dst_step] = gain_scale(gain, src[(i + 3) * src_step]);
+        }
+        for (; i < frame_count; i++) {
+            dst[i * dst_step] = gain_scale(gain, src[i * src_step]);
+        }
+    }
+}
+
+static void strided_gain_s16_to_s32(int32_t *dst, size_t dst_step,
+                                    const int16_t *src, size_t src_step,
+                                    size_t frame_count, uint32_t gain)
+{
+    size_t i = 0;
+
+    if (gain == AUDIO_FRAME_GAIN_UNITY) {
+        for (; i + 4 <= frame_count; i += 4) {
+            dst[(i + 0) * dst_step] = (int32_t)src[(i + 0) * src_step] << 16;
+            dst[(i + 1) * dst_step] = (int32_t)src[(i + 1) * src_step] << 16;
+            dst[(i + 2) * dst_step] = (int32_t)src[(i + 2) * src_step] << 16;
+            dst[(i + 3) * dst_step] = (int32_t)src[(i + 3) * src_step] << 16;
+        }
+        for (; i < frame_count; i++) {
+            dst[i * dst_step] = (int32_t)src[i * src_step] << 16;
+        }
+    } else {
+        for (; i + 4 <= frame_count; i += 4) {
+            dst[(i + 0) * dst_step] = gain_scale(gain, (int32_t)src[(i + 0) * src_step] << 16);
+            dst[(i + 1) * dst_step] = gain_scale(gain, (int32_t)src[(i + 1) * src_step] << 16);
+            dst[(i + 2) * dst_step] = gain_scale(gain, (int32_t)src[(i + 2) * src_step] << 16);
+            dst[(i + 3) * dst_step] = gain_scale(gain, (int32_t)src[(i + 3) * src_step] << 16);
+        }
+        for (; i < frame_count; i++) {
+            dst[i * dst_step] = gain_scale(gain, (int32_t)src[i * src_step] << 16);
+        }
+    }
+}
+
+static void strided_gain_s32_to_s16(int16_t *dst, size_t dst_step,
+                                    const int32_t *src, size_t src_step,
+                                    size_t frame_count, uint32_t gain)
+{
+    size_t i = 0;
+
+    if (gain == AUDIO_FRAME_GAIN_UNITY) {
+        for (; i + 4 <= frame_count; i += 4) {
+            dst[(i + 0) * dst_step] = src[(i + 0) * src_step] >> 16;
+            dst[(i + 1) * dst_step] = src[(i + 1) * src_step] >> 16;
+            dst[(i + 2) * dst_step] = src[(i + 2) * src_step] >> 16;
+            dst[(i + 3) * dst_step] = src[(i + 3) * src_step] >> 16;
+        }
+        for (; i < frame_count; i++) {
+            dst[i * dst_step] = src[i * src_step] >> 16;
+        }
+    } else {
+        for (; i + 4 <= frame_count; i += 4) {
+            dst[(i + 0) * dst_step] = gain_scale(gain, src[(i + 0) * src_step]) >> 16;
+            dst[(i + 1) * dst_step] = gain_scale(gain, src[(i + 1) * src_step]) >> 16;
+            dst[(i + 2) * dst_step] = gain_scale(gain, src[(i + 2) * src_step]) >> 16;
+            dst[(i + 3) * dst_step] = gain_scale(gain, src[(i + 3) * src_step]) >> 16;
+        }
+        for (; i < frame_count; i++) {
+            dst[i * dst_step] = gain_scale(gain, src[i * src_step]) >> 16;
+        }
+    }
+}
+
+/* Lets pairs of 16 bit samples be stored as one word */
+typedef uint32_t __attribute__((may_alias)) packed_s16_pair_t;
+
+void audio_frame_s32_to_s16(int16_t *dst, const int32_t *src, size_t frame_count)
+{
+    size_t i = 0;
+
+    if (((uintptr_t)dst & 0x3) && (frame_count > 0)) {
+        dst[0] = src[0] >> 16;
+        i = 1;
+    }
+
+    // Little endian, so the earlier sample is the low half of the word
+    packed_s16_pair_t *dst_pairs = (packed_s16_pair_t *)&dst[i];
+    for (; i + 4 <= frame_count; i += 4) {
+        *dst_pairs++ = ((uint32_t)src[i + 0] >> 16) | ((uint32_t)src[i + 1] & 0xffff0000);
+        *dst_pairs++ = ((uint32_t)src[i + 2] >> 16) | ((uint32_t)src[i + 3] & 0xffff0000);
+    }
+    for (; i < frame_count; i++) {
+        dst[i] = src[i] >> 16;
+    }
+}
+
+void audio_frame_deinterleave_s16(int32_t *dst, size_t dst_stride,
+                                  const int16_t *src, size_t src_chans,
+                                  size_t num_chans, size_t frame_count,
+                                  const uint32_t *gains)
+{
+    for (size_t ch = 0; ch < num_chans; ch++) {
+        strided_gain_s16_to_s32(&dst[ch * dst_stride], 1, &src[ch], src_chans,
+                                frame_count, channel_gain(gains, ch));
+    }
+}
+
+void audio_frame_deinterleave_s32(int32_t *dst, size_t dst_stride,
+                                  const int32_t *src, size_t src_chans,
+                                  size_t num_chans, size_t frame_count,
+                                  const uint32_t *gains)
+{
+    for (size_t ch = 0; ch < num_chans; ch++) {
+        strided_gain_s32(&dst[ch * dst_stride], 1, &src[ch], src_chans,
+                         frame_count, channel_gain(gains, ch));
+    }
+}
+
+void audio_frame_interleave_s16(int16_t *dst, size_t dst_chans,
+                                const int32_t *src, size_t src_stride,
+                                size_t num_chans, size_t frame_count,
+                                const uint32_t *gains)
+{
+    for (size_t ch = 0; ch < num_chans; ch++) {
+        strided_gain_s32_to_s16(&dst[ch], dst_chans, &src[ch * src_stride], 1,
+                                frame_count, channel_gain(gains, ch));
+    }
+}
+
+void audio_frame_interleave_s32(int32_t *dst, size_t dst_chans,
+                                const int32_t *src, size_t src_stride,
+                                size_t num_chans, size_t frame_count,
+                                const uint32_t *gains)
+{
+    for (size_t ch = 0; ch < num_chans; ch++) {
+        strided_gain_s32(&dst[ch], dst_chans, &src[ch * src_stride], 1,
+                         frame_count, channel_gain(gains, ch));
+    }
+}
+
+void audio_frame_gain_interleaved_s16(int16_t *dst, size_t dst_chans,
+                                      const int32_t *src, size_t src_chans,
+                                      size_t num_chans, size_t frame_count,
+                                      const uint32_t *gains)
+{
+    for (size_t ch = 0; ch < num_chans; ch++) {
+        strided_gain_s32_to_s16(&dst[ch], dst_chans, &src[ch], src_chans,
+                                frame_count, channel_gain(gains, ch));
+    }
+}
+
+void audio_frame_gain_interleaved_s32(int32_t *dst, size_t dst_chans,
+                                      const int32_t *src, size_t src_chans,
+                                      size_t num_chans, size_t frame_count,
+                                      const uint32_t *gains)
+{
+    for (size_t ch = 0; ch < num_chans; ch++) {
+        strided_gain_s32(&dst[ch], dst_chans, &src[ch], src_chans,
+                         frame_count, channel_gain(gains, ch));
+    }
+}
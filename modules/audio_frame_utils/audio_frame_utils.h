@@ -0,0 +1,116 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#ifndef AUDIO_FRAME_UTILS_H_
+#define AUDIO_FRAME_UTILS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/*
+ * Block gain and (de)interleave functions for moving audio between USB
+ * packets, which hold interleaved 16 or 32 bit samples, and the 32 bit
+ * channel buffers used by the audio pipelines and the ASRC.
+ *
+ * Gains are unsigned with AUDIO_FRAME_GAIN_FRAC_BITS fractional bits. A gain
+ * is applied as (int32_t)(((int64_t)samp * gain) >> AUDIO_FRAME_GAIN_FRAC_BITS),
+ * so the results are bit exact with a per sample scalar implementation.
+ * Channels with unity gain are copied without multiplying. The gains array
+ * may be NULL, in which case all channels have unity gain.
+ *
+ * 16 bit samples are converted to and from the upper 16 bits of the 32 bit
+ * samples. On the way to 16 bits the gain is applied before the conversion.
+ */
+
+#define AUDIO_FRAME_GAIN_FRAC_BITS  29
+#define AUDIO_FRAME_GAIN_UNITY      ((uint32_t)1 << AUDIO_FRAME_GAIN_FRAC_BITS)
+
+/**
+ * Deinterleave and apply gain.
+ *
+ * \param dst           Channel buffers, channel ch starts at dst[ch * dst_stride]
+ * \param dst_stride    Distance in samples between the start of two channel buffers
+ * \param src           Interleaved samples
+ * \param src_chans     Number of interleaved channels in src
+ * \param num_chans     Number of channels to deinterleave, at most src_chans
+ * \param frame_count   Number of samples per channel
+ * \param gains         Per channel gains, or NULL for unity gain
+ */
+void audio_frame_deinterleave_s16(int32_t *dst, size_t dst_stride,
+                                  const int16_t *src, size_t src_chans,
+                                  size_t num_chans, size_t frame_count,
+                                  const uint32_t *gains);
+
+void audio_frame_deinterleave_s32(int32_t *dst, size_t dst_stride,
+                                  const int32_t *src, size_t src_chans,
+                                  size_t num_chans, size_t frame_count,
+                                  const uint32_t *gains);
+
+/**
+ * Apply gain and interleave.
+ *
+ * Channels of dst at or above num_chans are not written.
+ *
+ * \param dst           Interleaved samples
+ * \param dst_chans     Number of interleaved channels in dst
+ * \param src           Channel buffers, channel ch starts at src[ch * src_stride]
+ * \param src_stride    Distance in samples between the start of two channel buffers
+ * \param num_chans     Number of channels to interleave, at most dst_chans
+ * \param frame_count   Number of samples per channel
+ * \param gains         Per channel gains, or NULL for unity gain
+ */
+void audio_frame_interleave_s16(int16_t *dst, size_t dst_chans,
+                                const int32_t *src, size_t src_stride,
+                                size_t num_chans, size_t frame_count,
+                                const uint32_t *gains);
+
+void audio_frame_interleave_s32(int32_t *dst, size_t dst_chans,
+                                const int32_t *src, size_t src_stride,
+                                size_t num_chans, size_t frame_count,
+                                const uint32_t *gains);
+
+/**
+ * Apply gain to interleaved samples, converting to the USB sample width.
+ *
+ * Channels of dst at or above num_chans are not written.
+ *
+ * \param dst           Interleaved samples
+ * \param dst_chans     Number of interleaved channels in dst
+ * \param src           Interleaved samples
+ * \param src_chans     Number of interleaved channels in src
+ * \param num_chans     Number of channels to copy, at most dst_chans and src_chans
+ * \param frame_count   Number of samples per channel
+ * \param gains         Per channel gains, or NULL for unity gain
+ */
+void audio_frame_gain_interleaved_s16(int16_t *dst, size_t dst_chans,
+                                      const int32_t *src, size_t src_chans,
+                                      size_t num_chans, size_t frame_count,
+                                      const uint32_t *gains);
+
+void audio_frame_gain_interleaved_s32(int32_t *dst, size_t dst_chans,
+                                      const int32_t *src, size_t src_chans,
+                                      size_t num_chans, size_t frame_count,
+                                      const uint32_t *gains);
+
+/**
+ * Convert a single channel block to 16 bit samples, with no gain, for the
+ * ASR. Bit exact with (int16_t)(src[i] >> 16).
+ *
+ * Two samples are packed into each word store when dst is word aligned, so
+ * align dst for the fastest conversion.
+ *
+ * \param dst           16 bit samples
+ * \param src           32 bit samples
+ * \param frame_count   Number of samples
+ */
+void audio_frame_s32_to_s16(int16_t *dst, const int32_t *src, size_t frame_count);
+
+#ifdef __cplusplus
+ }
+#endif
+
+#endif /* AUDIO_FRAME_UTILS_H_ */
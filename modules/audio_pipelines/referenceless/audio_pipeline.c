@@ -91,6 +91,7 @@ static int audio_pipeline_output_i(frame_data_t *frame_data,
     if (trace_data) {
         assert(trace_data == output_app_data);
         trace_data->input_vnr_pred = float_s32_to_float(frame_data->input_vnr_pred);
+        trace_data->output_vnr_pred = float_s32_to_float(frame_data->output_vnr_pred);
         trace_data->control_flag = (int)frame_data->control_flag;
     }
 
@@ -10,8 +10,11 @@
 #define AUDIO_PIPELINE_DONT_FREE_FRAME 0
 #define AUDIO_PIPELINE_FREE_FRAME      1
 
+/* Per frame data from the pipeline. If output_app_data is a trace_data_t it is
+ * filled in before audio_pipeline_output() is called for the frame. */
 typedef struct {
     float input_vnr_pred;
+    float output_vnr_pred;
     int control_flag;
 } trace_data_t;
 
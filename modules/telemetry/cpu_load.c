@@ -0,0 +1,189 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <stdbool.h>
+#include <stdint.h>
+#include <platform.h>
+#include <xcore/hwtimer.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "rtos_interrupt.h"
+
+#include "cpu_load.h"
+
+#define LOAD_FULL   (10000)
+
+typedef struct {
+    /*
+     * Written only by the core itself, with interrupts masked. seq is odd
+     * while an update is in progress so that other cores can read a
+     * consistent idle time.
+     */
+    volatile uint32_t seq;
+    volatile uint32_t idle_ticks;
+    volatile uint32_t idle_start;
+    volatile bool idle;
+
+    /* Only used by cpu_load_update() */
+    uint32_t window_idle_ticks;
+
+    volatile cpu_load_t load;
+} core_t;
+
+static core_t cores[configNUM_CORES];
+static TaskHandle_t volatile idle_tasks[configNUM_CORES];
+static uint32_t window_ticks;
+static uint32_t window_start;
+
+static bool is_idle_task(TaskHandle_t task)
+{
+    for (int i = 0; i < configNUM_CORES; i++) {
+        if (idle_tasks[i] == task) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void idle_start(core_t *core, uint32_t now)
+{
+    core->seq++;
+    core->idle_start = now;
+    core->idle = true;
+    core->seq++;
+}
+
+static void idle_stop(core_t *core, uint32_t now)
+{
+    core->seq++;
+    core->idle_ticks += now - core->idle_start;
+    core->idle = false;
+    core->seq++;
+}
+
+/* Idle time of a core up to now, including the idle period in progress */
+static uint32_t idle_ticks_get(const core_t *core, uint32_t now)
+{
+    uint32_t seq;
+    uint32_t ticks;
+
+    do {
+        seq = core->seq;
+        ticks = core->idle_ticks;
+        if (core->idle) {
+            ticks += now - core->idle_start;
+        }
+    } while ((seq & 1) || seq != core->seq);
+
+    return ticks;
+}
+
+void cpu_load_init(unsigned window_ms)
+{
+    uint32_t now = get_reference_time();
+
+    configASSERT(window_ms > 0 && window_ms <= 40000);
+
+    for (int i = 0; i < configNUM_CORES; i++) {
+        cores[i].window_idle_ticks = idle_ticks_get(&cores[i], now);
+    }
+    window_start = now;
+    window_ticks = window_ms * XS1_TIMER_KHZ;
+}
+
+void cpu_load_update(void)
+{
+    uint32_t now = get_reference_time();
+    uint32_t elapsed = now - window_start;
+
+    if (window_ticks == 0 || elapsed < window_ticks) {
+        return;
+    }
+
+    for (int i = 0; i < configNUM_CORES; i++) {
+        core_t *core = &cores[i];
+        uint32_t idle_ticks = idle_ticks_get(core, now);
+        uint32_t idle = idle_ticks - core->window_idle_ticks;
+        cpu_load_t load = core->load;
+
+        if (idle > elapsed) {
+            idle = elapsed;
+        }
+        load.load = LOAD_FULL - (uint16_t) (((uint64_t) idle * LOAD_FULL) / elapsed);
+        if (load.load > load.peak) {
+            load.peak = load.load;
+        }
+        core->load = load;
+        core->window_idle_ticks = idle_ticks;
+    }
+    window_start = now;
+}
+
+size_t cpu_load_get(cpu_load_t *load, size_t count)
+{
+    if (window_ticks == 0) {
+        return 0;
+    }
+    if (count > configNUM_CORES) {
+        count = configNUM_CORES;
+    }
+    for (size_t i = 0; i < count; i++) {
+        load[i] = cores[i].load;
+    }
+    return count;
+}
+
+void cpu_load_peak_reset(void)
+{
+    for (int i = 0; i < configNUM_CORES; i++) {
+        cores[i].load.peak = cores[i].load.load;
+    }
+}
+
+void cpu_load_idle_hook(void)
+{
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    core_t *core;
+    uint32_t mask;
+
+    if (!is_idle_task(task)) {
+        /* First run of this idle task, from here on task switches track it */
+        taskENTER_CRITICAL();
+        for (int i = 0; i < configNUM_CORES; i++) {
+            if (idle_tasks[i] == NULL) {
+                idle_tasks[i] = task;
+                break;
+            }
+        }
+        taskEXIT_CRITICAL();
+    }
+
+    mask = rtos_interrupt_mask_all();
+    core = &cores[portGET_CORE_ID()];
+    if (!core->idle) {
+        idle_start(core, get_reference_time());
+    }
+    rtos_interrupt_mask_set(mask);
+}
+
+void cpu_load_task_switched_in(void)
+{
+    uint32_t mask = rtos_interrupt_mask_all();
+    core_t *core = &cores[portGET_CORE_ID()];
+
+    if (!core->idle && is_idle_task(xTaskGetCurrentTaskHandle())) {
+        idle_start(core, get_reference_time());
+    }
+    rtos_interrupt_mask_set(mask);
+}
+
+void cpu_load_task_switched_out(void)
+{
+    uint32_t mask = rtos_interrupt_mask_all();
+    core_t *core = &cores[portGET_CORE_ID()];
+
+    if (core->idle) {
+        idle_stop(core, get_reference_time());
+    }
+    rtos_interrupt_mask_set(mask);
+}
@@ -0,0 +1,84 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#ifndef XCORE_VOICE_CPU_LOAD_H
+#define XCORE_VOICE_CPU_LOAD_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * \addtogroup cpu_load_api cpu_load_api
+ *
+ * Measures the load of each RTOS core on one tile from the time its idle
+ * task runs, over a fixed window, and keeps the peak load of each core.
+ *
+ * The idle tasks are found from the minimal idle hook, which must call
+ * cpu_load_idle_hook(). The kernel's task switch trace macros must call
+ * cpu_load_task_switched_in() and cpu_load_task_switched_out(), for example
+ * from FreeRTOSConfig.h:
+ *
+ *     #define traceTASK_SWITCHED_IN()     cpu_load_task_switched_in()
+ *     #define traceTASK_SWITCHED_OUT()    cpu_load_task_switched_out()
+ *
+ * Time spent in ISRs while a core's idle task is running counts as idle.
+ * A core held by a task that only waits for interrupts, such as one that
+ * keeps other tasks off an interrupt core, reads as fully loaded.
+ *
+ * This header is included from FreeRTOSConfig.h, so must not include
+ * FreeRTOS headers.
+ * @{
+ */
+
+/** Load of one core. Loads are in hundredths of a percent. */
+typedef struct {
+    uint16_t load;      ///< Load over the last complete window
+    uint16_t peak;      ///< Highest window load since cpu_load_init() or cpu_load_peak_reset()
+} cpu_load_t;
+
+/**
+ * Start measuring. Call once, before cpu_load_update().
+ *
+ * \param window_ms  Length of each measurement window in milliseconds.
+ *                   At most 40000.
+ */
+void cpu_load_init(unsigned window_ms);
+
+/**
+ * Close the current window if it has run for window_ms, updating the load
+ * and peak of each core. Call at least every window_ms from one task.
+ */
+void cpu_load_update(void);
+
+/**
+ * Get the load of each core.
+ *
+ * \param load   Array for the load of each core, in core order.
+ * \param count  Length of load.
+ *
+ * \returns      Number of entries written, or 0 before cpu_load_init().
+ */
+size_t cpu_load_get(cpu_load_t *load, size_t count);
+
+/**
+ * Reset the peak load of each core.
+ */
+void cpu_load_peak_reset(void);
+
+/**
+ * Call from vApplicationMinimalIdleHook(), before it waits for an event.
+ */
+void cpu_load_idle_hook(void);
+
+/**
+ * Call from traceTASK_SWITCHED_IN().
+ */
+void cpu_load_task_switched_in(void);
+
+/**
+ * Call from traceTASK_SWITCHED_OUT().
+ */
+void cpu_load_task_switched_out(void);
+
+/**@}*/
+
+#endif // XCORE_VOICE_CPU_LOAD_H
@@ -0,0 +1,205 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <stdint.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "stream_buffer.h"
+#include "rtos_printf.h"
+
+#include "cpu_load.h"
+#include "telemetry.h"
+
+typedef struct {
+    char name[TELEMETRY_NAME_LEN];
+    telemetry_object_type_t type;
+    void *handle;
+    uint32_t capacity;
+    uint32_t peak;
+} object_t;
+
+static object_t objects[TELEMETRY_MAX_OBJECTS];
+static size_t object_count;
+static volatile bool publish_requested;
+
+#if configUSE_TRACE_FACILITY
+static TaskStatus_t task_status[TELEMETRY_MAX_TASKS];
+#endif
+static uint8_t record[TELEMETRY_RECORD_MAX_BYTES] __attribute__((aligned(4)));
+
+static void object_register(const char *name, telemetry_object_type_t type, void *handle, uint32_t capacity)
+{
+    object_t *object;
+
+    taskENTER_CRITICAL();
+    if (object_count >= TELEMETRY_MAX_OBJECTS) {
+        taskEXIT_CRITICAL();
+        return;
+    }
+    object = &objects[object_count];
+    strncpy(object->name, name, TELEMETRY_NAME_LEN);
+    object->type = type;
+    object->handle = handle;
+    object->capacity = capacity;
+    object->peak = 0;
+    object_count++;
+    taskEXIT_CRITICAL();
+}
+
+void telemetry_queue_register(const char *name, QueueHandle_t queue)
+{
+    configASSERT(queue);
+    object_register(name, TELEMETRY_OBJECT_QUEUE, queue,
+                    uxQueueMessagesWaiting(queue) + uxQueueSpacesAvailable(queue));
+}
+
+void telemetry_stream_buffer_register(const char *name, StreamBufferHandle_t stream_buffer)
+{
+    configASSERT(stream_buffer);
+    object_register(name, TELEMETRY_OBJECT_STREAM_BUFFER, stream_buffer,
+                    xStreamBufferBytesAvailable(stream_buffer) + xStreamBufferSpacesAvailable(stream_buffer));
+}
+
+void telemetry_sample(void)
+{
+    for (size_t i = 0; i < object_count; i++) {
+        object_t *object = &objects[i];
+        uint32_t level;
+
+        if (object->type == TELEMETRY_OBJECT_QUEUE) {
+            level = uxQueueMessagesWaiting(object->handle);
+        } else {
+            level = xStreamBufferBytesAvailable(object->handle);
+        }
+        if (level > object->peak) {
+            object->peak = level;
+        }
+    }
+}
+
+size_t telemetry_record_get(uint8_t *buf, size_t size)
+{
+    telemetry_header_t header;
+    uint32_t run_time_total = 0;
+    UBaseType_t task_count = 0;
+    UBaseType_t task_total = 0;
+    cpu_load_t load[configNUM_CORES];
+    size_t core_count;
+    size_t len;
+
+#if configUSE_TRACE_FACILITY
+    task_count = uxTaskGetSystemState(task_status, TELEMETRY_MAX_TASKS, &run_time_total);
+    /* No tasks are returned when they do not all fit */
+    task_total = (task_count > 0) ? task_count : uxTaskGetNumberOfTasks();
+#endif
+    core_count = cpu_load_get(load, configNUM_CORES);
+    len = sizeof(header) +
+          task_count * sizeof(telemetry_task_t) +
+          object_count * sizeof(telemetry_object_t) +
+          core_count * sizeof(telemetry_core_t);
+    if (size < len) {
+        return 0;
+    }
+
+    memset(&header, 0, sizeof(header));
+    header.magic = TELEMETRY_MAGIC;
+    header.version = TELEMETRY_VERSION;
+    header.tile = THIS_XCORE_TILE;
+    header.task_count = task_count;
+    header.task_total = task_total;
+    header.object_count = object_count;
+    header.core_count = core_count;
+    header.uptime_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    header.heap_size = configTOTAL_HEAP_SIZE;
+    header.heap_free = xPortGetFreeHeapSize();
+    header.heap_min_free = xPortGetMinimumEverFreeHeapSize();
+    header.run_time_total = run_time_total;
+    memcpy(buf, &header, sizeof(header));
+    buf += sizeof(header);
+
+#if configUSE_TRACE_FACILITY
+    for (UBaseType_t i = 0; i < task_count; i++) {
+        telemetry_task_t task;
+
+        memset(&task, 0, sizeof(task));
+        strncpy(task.name, task_status[i].pcTaskName, TELEMETRY_NAME_LEN);
+        task.stack_min_free = task_status[i].usStackHighWaterMark * sizeof(StackType_t);
+#if configGENERATE_RUN_TIME_STATS
+        task.run_time = task_status[i].ulRunTimeCounter;
+#endif
+        task.priority = task_status[i].uxCurrentPriority;
+        task.state = task_status[i].eCurrentState;
+        task.number = task_status[i].xTaskNumber;
+        memcpy(buf, &task, sizeof(task));
+        buf += sizeof(task);
+    }
+#endif
+
+    for (size_t i = 0; i < object_count; i++) {
+        telemetry_object_t object;
+
+        memset(&object, 0, sizeof(object));
+        memcpy(object.name, objects[i].name, TELEMETRY_NAME_LEN);
+        object.type = objects[i].type;
+        object.capacity = objects[i].capacity;
+        object.peak = objects[i].peak;
+        memcpy(buf, &object, sizeof(object));
+        buf += sizeof(object);
+    }
+
+    for (size_t i = 0; i < core_count; i++) {
+        telemetry_core_t core;
+
+        core.load = load[i].load;
+        core.peak = load[i].peak;
+        memcpy(buf, &core, sizeof(core));
+        buf += sizeof(core);
+    }
+
+    return len;
+}
+
+void telemetry_publish(void)
+{
+    static const char hex[] = "0123456789abcdef";
+    char line[2 * TELEMETRY_LINE_BYTES + 1];
+    size_t len = telemetry_record_get(record, sizeof(record));
+
+    for (size_t offset = 0; offset < len; offset += TELEMETRY_LINE_BYTES) {
+        size_t n = (len - offset < TELEMETRY_LINE_BYTES) ? len - offset : TELEMETRY_LINE_BYTES;
+
+        for (size_t i = 0; i < n; i++) {
+            line[2 * i] = hex[record[offset + i] >> 4];
+            line[2 * i + 1] = hex[record[offset + i] & 0xF];
+        }
+        line[2 * n] = '\0';
+        rtos_printf("TLM %d %u %u %s\n", THIS_XCORE_TILE, (unsigned) offset, (unsigned) len, line);
+    }
+}
+
+void telemetry_publish_request(void)
+{
+    publish_requested = true;
+}
+
+void telemetry_run(unsigned sample_ms, unsigned publish_ms)
+{
+    TickType_t last_wake = xTaskGetTickCount();
+    TickType_t last_publish = last_wake;
+
+    configASSERT(sample_ms > 0);
+
+    for (;;) {
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(sample_ms));
+        telemetry_sample();
+        cpu_load_update();
+        if (publish_requested ||
+            ((publish_ms > 0) && (last_wake - last_publish >= pdMS_TO_TICKS(publish_ms)))) {
+            publish_requested = false;
+            last_publish = last_wake;
+            telemetry_publish();
+        }
+    }
+}
@@ -0,0 +1,187 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#ifndef XCORE_VOICE_TELEMETRY_H
+#define XCORE_VOICE_TELEMETRY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "FreeRTOS.h"
+#include "queue.h"
+#include "stream_buffer.h"
+
+/**
+ * \addtogroup telemetry_api telemetry_api
+ *
+ * Gathers heap, task and buffer usage on one tile and publishes it as a
+ * compact binary record, so heap and stack sizes can be set from the usage
+ * seen in the field.
+ *
+ * Each record holds the heap size, free and minimum ever free heap, and for
+ * each task its minimum ever free stack and run time. It also holds the peak
+ * occupancy of each registered queue and stream buffer, and the load of each
+ * core once cpu_load_init() has been called. The per-task data needs
+ * configUSE_TRACE_FACILITY, and the run times need
+ * configGENERATE_RUN_TIME_STATS. If the tile has more than
+ * TELEMETRY_MAX_TASKS tasks, the record holds no tasks and its task_total
+ * gives the number needed.
+ *
+ * Queue and stream buffer occupancy is sampled by telemetry_sample(), every
+ * sample_ms under telemetry_run(), so a peak shorter than the sample period
+ * can be missed.
+ *
+ * Records are published as lines of hex on the debug print channel, which
+ * tools/telemetry/telemetry_decode.py decodes:
+ *
+ *     TLM <tile> <offset> <record size> <hex bytes>
+ * @{
+ */
+
+#define TELEMETRY_MAGIC         (0x4D4C4554)    // "TELM"
+#define TELEMETRY_VERSION       (3)
+#define TELEMETRY_NAME_LEN      (12)
+
+/** Maximum number of tasks in a record */
+#ifndef TELEMETRY_MAX_TASKS
+#define TELEMETRY_MAX_TASKS     (32)
+#endif
+
+/** Maximum number of registered queues and stream buffers */
+#ifndef TELEMETRY_MAX_OBJECTS
+#define TELEMETRY_MAX_OBJECTS   (8)
+#endif
+
+/** Record bytes printed per line */
+#ifndef TELEMETRY_LINE_BYTES
+#define TELEMETRY_LINE_BYTES    (64)
+#endif
+
+typedef enum {
+    TELEMETRY_OBJECT_QUEUE = 0,         ///< Occupancy in items
+    TELEMETRY_OBJECT_STREAM_BUFFER = 1, ///< Occupancy in bytes
+} telemetry_object_type_t;
+
+/**
+ * Record header. All fields are little endian.
+ */
+typedef struct {
+    uint32_t magic;             ///< TELEMETRY_MAGIC
+    uint8_t  version;           ///< TELEMETRY_VERSION
+    uint8_t  tile;
+    uint8_t  task_count;        ///< telemetry_task_t entries after the header
+    uint8_t  object_count;      ///< telemetry_object_t entries after the tasks
+    uint8_t  core_count;        ///< telemetry_core_t entries after the objects
+    uint8_t  task_total;        ///< Tasks on the tile, more than task_count if they did not fit
+    uint8_t  reserved[2];
+    uint32_t uptime_ms;
+    uint32_t heap_size;         ///< configTOTAL_HEAP_SIZE
+    uint32_t heap_free;
+    uint32_t heap_min_free;     ///< Minimum ever free heap
+    uint32_t run_time_total;    ///< Run time counter, the time base of each task's run time
+} telemetry_header_t;
+
+/**
+ * Task entry.
+ */
+typedef struct {
+    char     name[TELEMETRY_NAME_LEN];  ///< Truncated, null terminated if shorter
+    uint32_t stack_min_free;    ///< Minimum ever free stack, in bytes
+    uint32_t run_time;          ///< Run time counter of the task
+    uint8_t  priority;
+    uint8_t  state;             ///< eTaskState
+    uint16_t number;            ///< Task number
+} telemetry_task_t;
+
+/**
+ * Queue or stream buffer entry.
+ */
+typedef struct {
+    char     name[TELEMETRY_NAME_LEN];  ///< Truncated, null terminated if shorter
+    uint8_t  type;              ///< telemetry_object_type_t
+    uint8_t  reserved[3];
+    uint32_t capacity;          ///< In items or bytes
+    uint32_t peak;              ///< Highest occupancy seen by telemetry_sample(), in items or bytes
+} telemetry_object_t;
+
+/**
+ * Core entry, one per core in core order. See cpu_load.h.
+ */
+typedef struct {
+    uint16_t load;              ///< Load over the last window, in hundredths of a percent
+    uint16_t peak;              ///< Highest window load, in hundredths of a percent
+} telemetry_core_t;
+
+/**
+ * Largest record, in bytes.
+ */
+#define TELEMETRY_RECORD_MAX_BYTES \
+    (sizeof(telemetry_header_t) + \
+     TELEMETRY_MAX_TASKS * sizeof(telemetry_task_t) + \
+     TELEMETRY_MAX_OBJECTS * sizeof(telemetry_object_t) + \
+     configNUM_CORES * sizeof(telemetry_core_t))
+
+/**
+ * Register a queue whose peak occupancy is reported. Ignored once
+ * TELEMETRY_MAX_OBJECTS objects are registered.
+ *
+ * \param name   Name in the record, truncated to TELEMETRY_NAME_LEN bytes.
+ * \param queue  The queue.
+ */
+void telemetry_queue_register(const char *name, QueueHandle_t queue);
+
+/**
+ * Register a stream buffer whose peak occupancy is reported. Ignored once
+ * TELEMETRY_MAX_OBJECTS objects are registered.
+ *
+ * \param name           Name in the record, truncated to TELEMETRY_NAME_LEN bytes.
+ * \param stream_buffer  The stream buffer.
+ */
+void telemetry_stream_buffer_register(const char *name, StreamBufferHandle_t stream_buffer);
+
+/**
+ * Sample the occupancy of the registered queues and stream buffers, keeping
+ * the peak of each.
+ */
+void telemetry_sample(void);
+
+/**
+ * Build a record.
+ *
+ * Not reentrant. While telemetry_run() is running, use
+ * telemetry_publish_request() instead.
+ *
+ * \param buf   Buffer for the record, at least TELEMETRY_RECORD_MAX_BYTES.
+ * \param size  Size of buf.
+ *
+ * \returns     Size of the record in bytes, or 0 if buf is too small.
+ */
+size_t telemetry_record_get(uint8_t *buf, size_t size);
+
+/**
+ * Build a record and print it.
+ *
+ * Not reentrant. While telemetry_run() is running, use
+ * telemetry_publish_request() instead.
+ */
+void telemetry_publish(void);
+
+/**
+ * Ask telemetry_run() to publish a record at its next sample.
+ * May be called from any task on the same tile.
+ */
+void telemetry_publish_request(void);
+
+/**
+ * Sample the registered objects every sample_ms and publish a record every
+ * publish_ms, or only when requested if publish_ms is 0. Also updates the
+ * core loads if cpu_load_init() has been called. Does not return.
+ *
+ * \param sample_ms   Milliseconds between samples of the registered objects.
+ * \param publish_ms  Milliseconds between records, or 0 to publish only on request.
+ */
+void telemetry_run(unsigned sample_ms, unsigned publish_ms);
+
+/**@}*/
+
+#endif // XCORE_VOICE_TELEMETRY_H
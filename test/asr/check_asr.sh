@@ -96,6 +96,7 @@ for ((j = 0; j < ${#INPUT_ARRAY[@]}; j += 1)); do
     PIPELINE_OUTPUT_CSV="${OUTPUT_DIR}/${FILE_NAME}_pipeline.csv"
     ASR_OUTPUT_LOG="${OUTPUT_DIR}/${FILE_NAME}_asr.log"
     SCORING_OUTPUT_LOG="${OUTPUT_DIR}/${FILE_NAME}_scoring.log"
+    LATENCY_OUTPUT_LOG="${OUTPUT_DIR}/${FILE_NAME}_latency.log"
     
     TEMP_XSCOPE_FILEIO_INPUT_WAV="${OUTPUT_DIR}/input.wav"
     TEMP_XSCOPE_FILEIO_OUTPUT_WAV="${OUTPUT_DIR}/output.wav"
@@ -176,6 +177,9 @@ for ((j = 0; j < ${#INPUT_ARRAY[@]}; j += 1)); do
     # score label track
     python3 test/asr/score_label_track.py --label_track ${LABEL_TRACK} --truth_track ${TRUTH_TRACK} --log ${SCORING_OUTPUT_LOG}
 
+    # recognition latency
+    python3 test/asr/latency_stats.py --log ${ASR_OUTPUT_LOG} --out ${LATENCY_OUTPUT_LOG}
+
     # extract WER from scoring log
     WER=$(grep "WER:" ${SCORING_OUTPUT_LOG} | cut -d' ' -f 2)
     # log results
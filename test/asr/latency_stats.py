@@ -0,0 +1,58 @@
+#!/usr/bin/env python3
+# Copyright (c) 2023 XMOS LIMITED. This Software is subject to the terms of the
+# XMOS Public License: Version 1
+
+import argparse
+import sys
+
+from make_label_track import LINE_START, PIPELINE_BRICK_LENGTH_MS, PIPELINE_BRICK_LENGTH_SAMPLES, SENSORY_LUT, convert
+
+SAMPLES_TO_MS = PIPELINE_BRICK_LENGTH_MS / PIPELINE_BRICK_LENGTH_SAMPLES
+
+def load_events(log):
+    events = []
+    with open(log, "r") as fd:
+        for line in fd:
+            if line.startswith(LINE_START):
+                event = {}
+                for field in line[len(LINE_START):].strip().split(","):
+                    key_value = field.split("=")
+                    event[key_value[0].strip()] = convert(key_value[1])
+                events.append(event)
+    return events
+
+def percentile(values, p):
+    values = sorted(values)
+    return values[min(len(values) - 1, int(p * len(values) / 100))]
+
+def process(log, out, wakeword_id):
+    events = [e for e in load_events(log) if "detected" in e]
+
+    # Latency is from the end of the utterance, as the ASR reports it, to the brick the result came out of
+    groups = {"wakeword": [], "command": []}
+    for e in events:
+        latency_ms = (e["detected"] - e["end"]) * SAMPLES_TO_MS
+        groups["wakeword" if e["id"] == wakeword_id else "command"].append(latency_ms)
+
+    # Commands reported in the same brick as the wake up phrase came from re-fed audio
+    refed = sum(1 for a, b in zip(events, events[1:]) if a["id"] == wakeword_id and b["id"] != wakeword_id
+                and a["detected"] == b["detected"])
+
+    with open(out, "w") if out else sys.stdout as fd:
+        print(f"{'type':<10} {'count':>6} {'mean_ms':>8} {'p50_ms':>8} {'p90_ms':>8} {'max_ms':>8}", file=fd)
+        for name, values in groups.items():
+            if values:
+                print(f"{name:<10} {len(values):>6} {sum(values) / len(values):>8.1f} {percentile(values, 50):>8.1f} "
+                      f"{percentile(values, 90):>8.1f} {max(values):>8.1f}", file=fd)
+            else:
+                print(f"{name:<10} {0:>6}", file=fd)
+        print(f"Commands recognized from re-fed audio: {refed}", file=fd)
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser('ASR latency statistics')
+    parser.add_argument('--log', help='ASR test log file to parse')
+    parser.add_argument('--out', default=None, help='Output file, stdout if not given')
+    parser.add_argument('--wakeword_id', type=int, default=max(SENSORY_LUT), help='Result id of the wake up phrase')
+    args = parser.parse_args()
+
+    process(args.log, args.out, args.wakeword_id)
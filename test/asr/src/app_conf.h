@@ -19,6 +19,16 @@
 #define appconfASR_MISSING_METADATA_CORRECTION        (40 * appconfASR_BRICK_SIZE_SAMPLES)
 #endif
 
+/* Bricks fed to the ASR again after the wake up phrase is recognized, to
+ * measure the intent engine's appconfINTENT_WAKEWORD_REFEED_MS mode. 0 to disable */
+#ifndef appconfASR_WAKEWORD_REFEED_BRICKS
+#define appconfASR_WAKEWORD_REFEED_BRICKS       0
+#endif
+
+#ifndef appconfASR_WAKEWORD_ID
+#define appconfASR_WAKEWORD_ID                  17
+#endif
+
 #define appconfINPUT_FILENAME                   "input.wav\0"
 #define appconfOUTPUT_FILENAME                  "output.log\0"
 #define appconfINPUT_CHANNELS                   1
@@ -14,6 +14,7 @@
 
 #include "app_conf.h"
 #include "asr.h"
+#include "asr_history.h"
 #include "device_memory_impl.h"
 #include "platform/driver_instances.h"
 #include "wav_utils.h"
@@ -46,6 +47,54 @@ static asr_port_t asr_ctx;
 static devmem_manager_t devmem_ctx;
 static char log_buffer[1024];
 
+#if appconfASR_WAKEWORD_REFEED_BRICKS
+static asr_history_t history;
+static int16_t history_buf[appconfASR_WAKEWORD_REFEED_BRICKS * appconfASR_BRICK_SIZE_SAMPLES];
+#endif
+
+static void log_result(asr_result_t *asr_result, unsigned brick, size_t refed_samples)
+{
+    // Query or compute recognition event metadata
+    size_t start_index;
+    size_t end_index;
+    size_t duration;
+    // The sample at which the result was reported, to measure latency from the end of the utterance
+    size_t detected_index = (brick + 1) * appconfASR_BRICK_SIZE_SAMPLES;
+
+    // The port counts re-fed bricks too, so remove them from its indices
+    if (asr_result->start_index > 0) {
+        start_index = asr_result->start_index - refed_samples;
+    } else {
+        // No metadata so assume this brick - appconfASR_MISSING_START_METADATA_CORRECTION
+        start_index = (brick * appconfASR_BRICK_SIZE_SAMPLES) - appconfASR_MISSING_METADATA_CORRECTION;
+    }
+
+    if (asr_result->end_index > 0) {
+        end_index = asr_result->end_index - refed_samples;
+    } else {
+        // No metadata so assume start_index
+        end_index = start_index;
+    }
+
+    if (asr_result->duration > 0) {
+        duration = asr_result->duration;
+    } else {
+        // No metadata so assume no duration
+        duration = 0;
+    }
+
+    // Log result
+    sprintf(log_buffer, "RECOGNIZED: id=%d, start=%d, end=%d, duration=%d, detected=%d\n",
+        asr_result->id,
+        start_index,
+        end_index,
+        duration,
+        detected_index
+    );
+    rtos_printf(log_buffer);
+    xscope_fwrite(&outfile, (uint8_t *)&log_buffer[0], strlen(log_buffer));
+}
+
 #if ON_TILE(XSCOPE_HOST_IO_TILE)
 static SemaphoreHandle_t mutex_xscope_fileio;
 
@@ -130,6 +179,10 @@ void xscope_fileio_task(void *arg) {
     devmem_init(&devmem_ctx);
     asr_ctx = asr_init((void *) model, (void *) grammar, &devmem_ctx);
     asr_reset(asr_ctx);
+#if appconfASR_WAKEWORD_REFEED_BRICKS
+    asr_history_init(&history, history_buf, appconfASR_WAKEWORD_REFEED_BRICKS, appconfASR_BRICK_SIZE_SAMPLES);
+#endif
+    size_t refed_samples = 0;
 
     asr_error_t asr_error;
     asr_result_t asr_result;
@@ -163,6 +216,10 @@ void xscope_fileio_task(void *arg) {
             }
         }
 
+#if appconfASR_WAKEWORD_REFEED_BRICKS
+        asr_history_push(&history, in_buf_int_16);
+#endif
+
         // Send audio to ASR
         asr_error = asr_process(asr_ctx, in_buf_int_16, appconfASR_BRICK_SIZE_SAMPLES);
         if (asr_error != ASR_OK) continue; 
@@ -170,43 +227,27 @@ void xscope_fileio_task(void *arg) {
         asr_error = asr_get_result(asr_ctx, &asr_result);
         if (asr_error != ASR_OK) continue; 
 
-        // Query or compute recognition event metadata
-        size_t start_index;
-        size_t end_index;
-        size_t duration;
-        
         if (asr_result.id > 0) {
-            if (asr_result.start_index > 0) {
-                start_index = asr_result.start_index;
-            } else {
-                // No metadata so assume this brick - appconfASR_MISSING_START_METADATA_CORRECTION
-                start_index = (b * appconfASR_BRICK_SIZE_SAMPLES) - appconfASR_MISSING_METADATA_CORRECTION; 
-            }
-
-            if (asr_result.end_index > 0) {
-                end_index = asr_result.end_index;        
-            } else {
-                // No metadata so assume start_index
-                end_index = start_index; 
-            }
+            log_result(&asr_result, b, refed_samples);
+        }
 
-            if (asr_result.duration > 0) {
-                duration = asr_result.duration;        
-            } else {
-                // No metadata so assume no duration
-                duration = 0;        
+#if appconfASR_WAKEWORD_REFEED_BRICKS
+        if (asr_result.id == appconfASR_WAKEWORD_ID) {
+            // Re-feed the bricks after the end of the wake up phrase. The history ends with brick b, so re-fed
+            // brick i is a copy of brick b - refeed + 1 + i.
+            uint32_t refeed = asr_history_bricks_after(&history, &asr_result,
+                                                       ((b + 1) * appconfASR_BRICK_SIZE_SAMPLES) + refed_samples);
+            uint32_t fed;
+            bool found;
+
+            asr_error = asr_history_refeed(&history, asr_ctx, refeed, appconfASR_WAKEWORD_ID, &fed, &found);
+            if ((asr_error == ASR_OK) && found && (asr_get_result(asr_ctx, &asr_result) == ASR_OK)) {
+                log_result(&asr_result, b, refed_samples + (appconfASR_BRICK_SIZE_SAMPLES * refeed));
             }
-
-            // Log result
-            sprintf(log_buffer, "RECOGNIZED: id=%d, start=%d, end=%d, duration=%d\n", 
-                asr_result.id,
-                start_index,
-                end_index,
-                duration
-            );
-            rtos_printf(log_buffer);
-            xscope_fwrite(&outfile, (uint8_t *)&log_buffer[0], strlen(log_buffer));
+            // Count every re-fed brick towards later indices
+            refed_samples += appconfASR_BRICK_SIZE_SAMPLES * fed;
         }
+#endif
     }
 
 #if (appconfAPP_NOTIFY_FILEIO_DONE == 1)
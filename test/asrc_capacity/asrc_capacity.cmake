@@ -0,0 +1,37 @@
+#**********************
+# Gather Sources
+#**********************
+file(GLOB_RECURSE APP_SOURCES ${CMAKE_CURRENT_LIST_DIR}/src/*.c)
+list(APPEND APP_SOURCES ${SOLUTION_VOICE_ROOT_PATH}/examples/asrc_demo/src/asrc_utils.c)
+set(APP_INCLUDES
+    ${CMAKE_CURRENT_LIST_DIR}/src/
+    ${CMAKE_CURRENT_LIST_DIR}/src/stubs/
+    ${SOLUTION_VOICE_ROOT_PATH}/examples/asrc_demo/src/
+)
+
+#**********************
+# Flags
+#**********************
+set(APP_COMPILER_FLAGS
+    -Os
+    -g
+    -report
+    -fxscope
+    ${SOLUTION_VOICE_ROOT_PATH}/examples/asrc_demo/bsp_config/XK_VOICE_L71/XK_VOICE_L71.xn
+)
+
+set(APP_LINK_OPTIONS
+    -report
+    ${SOLUTION_VOICE_ROOT_PATH}/examples/asrc_demo/bsp_config/XK_VOICE_L71/XK_VOICE_L71.xn
+)
+
+#**********************
+# Tile Targets
+#**********************
+set(TARGET_NAME test_asrc_capacity)
+add_executable(${TARGET_NAME} EXCLUDE_FROM_ALL)
+target_sources(${TARGET_NAME} PUBLIC ${APP_SOURCES})
+target_include_directories(${TARGET_NAME} PUBLIC ${APP_INCLUDES})
+target_compile_options(${TARGET_NAME} PRIVATE ${APP_COMPILER_FLAGS})
+target_link_libraries(${TARGET_NAME} PUBLIC lib_src)
+target_link_options(${TARGET_NAME} PRIVATE ${APP_LINK_OPTIONS})
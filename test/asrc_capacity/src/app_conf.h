@@ -0,0 +1,37 @@
+// Copyright (c) 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public License: Version 1
+
+#ifndef APP_CONF_H
+#define APP_CONF_H
+
+/* Block lengths used by the ASRC demo, see examples/asrc_demo/src/asrc_utils.h */
+#define TEST_I2S_TO_USB_BLOCK_LENGTH    244
+#define TEST_USB_TO_I2S_BLOCK_LENGTH    96
+#define TEST_MAX_BLOCK_LENGTH           TEST_I2S_TO_USB_BLOCK_LENGTH
+#define TEST_USB_RATE                   48000
+
+/* Number of blocks processed per rate, the worst case is reported */
+#define TEST_NUM_BLOCKS                 8
+
+/*
+ * Channels processed by every pool. Pools are run with 1, 2 and
+ * TEST_NUM_CHANNELS workers. Each direction has a pool per worker count,
+ * so the worker threads of both, 2 * TEST_NUM_CHANNELS, and the main thread
+ * must fit in the 8 hardware threads of the tile.
+ */
+#define TEST_NUM_CHANNELS               3
+#define TEST_NUM_WORKER_COUNTS          3
+
+/*
+ * Threads waiting for a block are paused, so with at most 5 threads active
+ * each simulated thread runs at 1/5 of the
+ * 600 MHz core clock. With all 8 hardware threads busy each one runs at 1/8
+ * of the core clock.
+ */
+#define TEST_SIM_THREAD_MHZ             120
+#define TEST_LOADED_THREAD_MHZ          75
+
+/* Percentage of the block period the pool may spend in asrc_pool_process() */
+#define TEST_BLOCK_BUDGET_PERCENT       80
+
+#endif /* APP_CONF_H */
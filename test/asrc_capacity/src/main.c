@@ -0,0 +1,111 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+/* System headers */
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <xs1.h>
+#include <xcore/hwtimer.h>
+
+/* App headers */
+#include "app_conf.h"
+#include "asrc_utils.h"
+
+#define TEST_PRINTF(fmt, ...)       printf((fmt), ##__VA_ARGS__)
+
+static uint32_t error_count = 0;
+
+static int32_t input_samples[TEST_NUM_CHANNELS][TEST_MAX_BLOCK_LENGTH];
+static int32_t output_samples[TEST_NUM_CHANNELS][TEST_MAX_BLOCK_LENGTH * 5];
+
+static const unsigned test_workers[TEST_NUM_WORKER_COUNTS] = {1, 2, TEST_NUM_CHANNELS};
+
+typedef struct {
+    const char *name;
+    unsigned block_length;
+    asrc_pool_t pool[TEST_NUM_WORKER_COUNTS];
+} direction_t;
+
+static direction_t i2s_to_usb = {"i2s_to_usb", TEST_I2S_TO_USB_BLOCK_LENGTH};
+static direction_t usb_to_i2s = {"usb_to_i2s", TEST_USB_TO_I2S_BLOCK_LENGTH};
+
+/*
+ * Returns the worst case reference timer ticks taken by asrc_pool_process() on
+ * TEST_NUM_CHANNELS channels, scaled from the simulated threads to a fully
+ * loaded tile.
+ */
+static uint32_t measure_pool_ticks(asrc_pool_t *pool, unsigned fs_in, unsigned fs_out, unsigned block_length)
+{
+    uint64_t fs_ratio = asrc_pool_init(pool, fs_in, fs_out);
+
+    uint32_t seed = 0x12345678;
+    uint32_t max_ticks = 0;
+
+    for (int block = 0; block < TEST_NUM_BLOCKS; block++) {
+        for (int ch = 0; ch < TEST_NUM_CHANNELS; ch++) {
+            for (int i = 0; i < block_length; i++) {
+                seed = (seed * 1664525) + 1013904223;
+                input_samples[ch][i] = (int32_t)seed >> 4;
+            }
+        }
+
+        uint32_t start = get_reference_time();
+        (void) asrc_pool_process(pool, &input_samples[0][0], TEST_MAX_BLOCK_LENGTH,
+                                 &output_samples[0][0], TEST_MAX_BLOCK_LENGTH * 5, fs_ratio);
+        uint32_t ticks = get_reference_time() - start;
+
+        if (ticks > max_ticks) {
+            max_ticks = ticks;
+        }
+    }
+
+    return ((uint64_t)max_ticks * TEST_SIM_THREAD_MHZ) / TEST_LOADED_THREAD_MHZ;
+}
+
+static void report_capacity(direction_t *dir, unsigned fs_in, unsigned fs_out, unsigned block_rate)
+{
+    uint32_t block_ticks = ((uint64_t)dir->block_length * XS1_TIMER_HZ) / block_rate;
+    uint32_t budget_ticks = ((uint64_t)block_ticks * TEST_BLOCK_BUDGET_PERCENT) / 100;
+    uint32_t pool_ticks = 0;
+
+    TEST_PRINTF("ASRC: %s fs_in=%u fs_out=%u channels=%d block_ticks=%lu budget_ticks=%lu",
+                dir->name, fs_in, fs_out, TEST_NUM_CHANNELS, block_ticks, budget_ticks);
+    for (int w = 0; w < TEST_NUM_WORKER_COUNTS; w++) {
+        pool_ticks = measure_pool_ticks(&dir->pool[w], fs_in, fs_out, dir->block_length);
+        TEST_PRINTF(" workers_%u=%lu", test_workers[w], pool_ticks);
+    }
+    TEST_PRINTF("\n");
+
+    // With a worker per channel, as the demo runs stereo with 2 workers, the block must fit the budget
+    if (pool_ticks > budget_ticks) {
+        TEST_PRINTF("  - FAIL: %s at %u Hz with a worker per channel took %lu ticks\n", dir->name, (fs_in == TEST_USB_RATE) ? fs_out : fs_in, pool_ticks);
+        error_count++;
+    }
+}
+
+int main(void)
+{
+    const unsigned i2s_rates[] = {48000, 96000, 192000};
+
+    // Each pool with N workers creates N - 1 worker threads, which run until the end of the test
+    for (int w = 0; w < TEST_NUM_WORKER_COUNTS; w++) {
+        asrc_pool_create(&i2s_to_usb.pool[w], TEST_NUM_CHANNELS, test_workers[w], i2s_to_usb.block_length, 0);
+        asrc_pool_create(&usb_to_i2s.pool[w], TEST_NUM_CHANNELS, test_workers[w], usb_to_i2s.block_length, 0);
+    }
+
+    for (int i = 0; i < sizeof(i2s_rates) / sizeof(i2s_rates[0]); i++) {
+        // I2S to USB blocks arrive at the I2S rate
+        report_capacity(&i2s_to_usb, i2s_rates[i], TEST_USB_RATE, i2s_rates[i]);
+        // USB to I2S blocks arrive at the USB rate
+        report_capacity(&usb_to_i2s, TEST_USB_RATE, i2s_rates[i], TEST_USB_RATE);
+    }
+
+    if (error_count == 0) {
+        TEST_PRINTF("\nTEST: PASS\n");
+    } else {
+        TEST_PRINTF("\nTEST: FAILED (Error Count = %ld)\n", error_count);
+    }
+
+    return 0;
+}
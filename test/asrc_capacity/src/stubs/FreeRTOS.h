@@ -0,0 +1,11 @@
+// Copyright (c) 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public License: Version 1
+
+#ifndef FREERTOS_H_
+#define FREERTOS_H_
+
+#include <assert.h>
+
+#define configASSERT(x) assert(x)
+
+#endif /* FREERTOS_H_ */
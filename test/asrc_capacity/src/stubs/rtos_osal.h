@@ -0,0 +1,79 @@
+// Copyright (c) 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public License: Version 1
+
+#ifndef RTOS_OSAL_H_
+#define RTOS_OSAL_H_
+
+/*
+ * Bare metal stand in for the RTOS OSAL. Each ASRC pool worker thread runs
+ * on its own hardware thread. A semaphore is a streaming channel holding a
+ * token per count, so a waiting thread is paused and does not take cycles
+ * from the workers. The lock keeps tokens from several threads apart.
+ */
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <xcore/channel_streaming.h>
+#include <xcore/lock.h>
+#include <xcore/thread.h>
+
+#define RTOS_OSAL_WAIT_FOREVER          (-1)
+#define RTOS_THREAD_STACK_SIZE(x)       (0)
+
+/* Stack of each worker thread, in words */
+#define RTOS_OSAL_STUB_STACK_WORDS      (1024)
+
+typedef int rtos_osal_status_t;
+typedef int rtos_osal_thread_t;
+typedef void (*rtos_osal_entry_function_t)(void *);
+
+typedef struct {
+    streaming_channel_t c;
+    lock_t lock;
+} rtos_osal_semaphore_t;
+
+#define RTOS_OSAL_SUCCESS               (0)
+
+static inline void *rtos_osal_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static inline rtos_osal_status_t rtos_osal_semaphore_create(rtos_osal_semaphore_t *semaphore, char *name, unsigned max_count, unsigned initial_count)
+{
+    /* Every count must fit in the channel buffer so a put never blocks */
+    assert(max_count <= 8);
+    semaphore->c = s_chan_alloc();
+    semaphore->lock = lock_alloc();
+    assert(semaphore->c.end_a != 0 && semaphore->lock != 0);
+    for (unsigned i = 0; i < initial_count; i++) {
+        s_chan_out_byte(semaphore->c.end_a, 0);
+    }
+    return RTOS_OSAL_SUCCESS;
+}
+
+static inline rtos_osal_status_t rtos_osal_semaphore_get(rtos_osal_semaphore_t *semaphore, unsigned timeout)
+{
+    (void) s_chan_in_byte(semaphore->c.end_b);
+    return RTOS_OSAL_SUCCESS;
+}
+
+static inline rtos_osal_status_t rtos_osal_semaphore_put(rtos_osal_semaphore_t *semaphore)
+{
+    lock_acquire(semaphore->lock);
+    s_chan_out_byte(semaphore->c.end_a, 0);
+    lock_release(semaphore->lock);
+    return RTOS_OSAL_SUCCESS;
+}
+
+static inline rtos_osal_status_t rtos_osal_thread_create(rtos_osal_thread_t *thread, char *name, rtos_osal_entry_function_t entry_function, void *entry_function_arg, size_t stack_size, unsigned int priority)
+{
+    /* The worker threads never return, so their stacks are never freed */
+    uint32_t *stack = malloc(RTOS_OSAL_STUB_STACK_WORDS * sizeof(uint32_t));
+    assert(stack != NULL);
+    run_async(entry_function, entry_function_arg, stack_base(stack, RTOS_OSAL_STUB_STACK_WORDS));
+    return RTOS_OSAL_SUCCESS;
+}
+
+#endif /* RTOS_OSAL_H_ */
@@ -0,0 +1,41 @@
+#!/usr/bin/env python3
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+import re
+
+test_results_filename = "testing/test.rpt"
+test_regex = r"^TEST:\s+(\w+)"
+capacity_regex = r"^ASRC:\s+(\w+)\s+fs_in=(\d+)\s+fs_out=(\d+)\s+channels=(\d+).*\sbudget_ticks=(\d+)\s+workers_1=(\d+)\s+workers_2=(\d+)\s+workers_\4=(\d+)"
+
+def test_results():
+    with open(test_results_filename, "r") as f:
+        cnt = 0
+        while 1:
+            line = f.readline()
+
+            if len(line) == 0:
+                assert cnt == 1
+                break
+
+            p = re.match(test_regex, line)
+
+            if p:
+                cnt += 1
+                assert p.group(1).find("PASS") != -1
+
+def test_capacity():
+    with open(test_results_filename, "r") as f:
+        results = [re.match(capacity_regex, line) for line in f]
+    results = [p for p in results if p]
+
+    # Both directions at 48, 96 and 192 kHz
+    assert len(results) == 6
+    for p in results:
+        budget = int(p.group(5))
+        ticks = [int(p.group(g)) for g in (6, 7, 8)]
+        print(f"{p.group(1)} {p.group(2)} -> {p.group(3)}: {p.group(4)} channels with 1, 2 and {p.group(4)} workers took {ticks} ticks, budget {budget}")
+        # Adding workers must cut the block time, and a worker per channel must fit
+        assert ticks[1] < ticks[0]
+        assert ticks[2] < ticks[1]
+        assert ticks[2] <= budget
@@ -0,0 +1,24 @@
+// Copyright (c) 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public License: Version 1
+
+#ifndef APP_CONF_H
+#define APP_CONF_H
+
+/* I2S to USB direction of the ASRC demo */
+#define TEST_BLOCK_LENGTH               244
+#define TEST_USB_RATE                   48000
+#define TEST_NUM_CHANNELS               2
+
+/* Blocks processed between rate switches */
+#define TEST_BLOCKS_PER_RATE            8
+
+/* Allow for rounding of the output sample count at each switch */
+#define TEST_MAX_DROPPED_PER_SWITCH     4
+
+/* A switch to a prepared bank must be at least this much faster than asrc_init() */
+#define TEST_MIN_INIT_SPEEDUP           10
+
+/* The first output block after a switch to a prepared bank must be at least this much sooner than with asrc_init() */
+#define TEST_MIN_SWITCH_SPEEDUP         2
+
+#endif /* APP_CONF_H */
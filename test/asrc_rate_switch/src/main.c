@@ -0,0 +1,163 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+/* System headers */
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <xs1.h>
+#include <xcore/hwtimer.h>
+
+/* App headers */
+#include "app_conf.h"
+#include "asrc_utils.h"
+
+#define TEST_PRINTF(fmt, ...)       printf((fmt), ##__VA_ARGS__)
+
+static uint32_t error_count = 0;
+
+static int32_t input_samples[TEST_NUM_CHANNELS][TEST_BLOCK_LENGTH];
+static int32_t output_samples[TEST_NUM_CHANNELS][TEST_BLOCK_LENGTH * 2];
+
+static asrc_pool_t fast_pool;
+static asrc_pool_t legacy_pool;
+
+typedef struct {
+    const char *name;
+    asrc_pool_t *pool;
+    int skip_block_after_init;      // The behaviour before rate banks were added
+    unsigned fs_in;
+    uint64_t nominal_fs_ratio;
+    uint32_t dropped;
+    uint32_t max_init_ticks;
+    uint32_t max_switch_ticks;      // Rate change to the first output block
+} rate_switch_sim_t;
+
+static void fill_input(uint32_t *seed)
+{
+    for (int ch = 0; ch < TEST_NUM_CHANNELS; ch++) {
+        for (int i = 0; i < TEST_BLOCK_LENGTH; i++) {
+            *seed = (*seed * 1664525) + 1013904223;
+            input_samples[ch][i] = (int32_t)*seed >> 4;
+        }
+    }
+}
+
+/*
+ * Runs blocks_per_rate blocks at fs_in and counts the output samples that
+ * are missing compared to an ideal resampler.
+ */
+static void run_segment(rate_switch_sim_t *sim, unsigned fs_in, unsigned blocks_per_rate, uint32_t *seed)
+{
+    int skip = 0;
+    int check_ramp = 0;
+    uint32_t switch_ticks = 0;
+
+    if (fs_in != sim->fs_in) {
+        uint32_t start = get_reference_time();
+        sim->nominal_fs_ratio = asrc_pool_init(sim->pool, fs_in, TEST_USB_RATE);
+        uint32_t ticks = get_reference_time() - start;
+
+        if (ticks > sim->max_init_ticks) {
+            sim->max_init_ticks = ticks;
+        }
+        sim->fs_in = fs_in;
+        skip = sim->skip_block_after_init;
+        check_ramp = 1;
+        switch_ticks = ticks;
+    }
+
+    // The first block at the new rate is available when the switch is made, each later one a block period after
+    const uint32_t block_period_ticks = ((uint64_t)TEST_BLOCK_LENGTH * XS1_TIMER_HZ) / fs_in;
+
+    uint32_t n_out = 0;
+    for (unsigned block = 0; block < blocks_per_rate; block++) {
+        fill_input(seed);
+
+        if (skip) {
+            skip = 0;
+            switch_ticks += block_period_ticks;
+            continue;
+        }
+
+        uint32_t start = get_reference_time();
+        unsigned n = asrc_pool_process(sim->pool, &input_samples[0][0], TEST_BLOCK_LENGTH,
+                                       &output_samples[0][0], TEST_BLOCK_LENGTH * 2, sim->nominal_fs_ratio);
+        uint32_t process_ticks = get_reference_time() - start;
+        n_out += n;
+
+        // The first output sample after a rate switch is fully muted
+        if (check_ramp) {
+            if (n == 0) {
+                switch_ticks += block_period_ticks;
+                continue;
+            }
+            check_ramp = 0;
+            switch_ticks += process_ticks;
+            if (switch_ticks > sim->max_switch_ticks) {
+                sim->max_switch_ticks = switch_ticks;
+            }
+            for (int ch = 0; ch < TEST_NUM_CHANNELS; ch++) {
+                if (output_samples[ch][0] != 0) {
+                    TEST_PRINTF("  - FAIL: %s output not muted after switch to %u Hz\n", sim->name, fs_in);
+                    error_count++;
+                }
+            }
+        }
+    }
+
+    uint32_t expected = ((uint64_t)blocks_per_rate * TEST_BLOCK_LENGTH * TEST_USB_RATE) / fs_in;
+    if (expected > n_out) {
+        sim->dropped += expected - n_out;
+    }
+}
+
+int main(void)
+{
+    const unsigned rates[] = {48000, 96000, 192000, 44100, 88200, 176400, 48000, 192000, 96000, 48000};
+    const unsigned num_switches = (sizeof(rates) / sizeof(rates[0])) - 1;
+
+    rate_switch_sim_t fast = {"fast", &fast_pool, 0};
+    rate_switch_sim_t legacy = {"legacy", &legacy_pool, 1};
+
+    asrc_pool_create(&fast_pool, TEST_NUM_CHANNELS, 1, TEST_BLOCK_LENGTH, 0);
+    for (int i = 0; i < ASRC_NUM_SUPPORTED_RATES; i++) {
+        asrc_pool_prepare(&fast_pool, asrc_supported_rates[i], TEST_USB_RATE);
+    }
+    asrc_pool_create(&legacy_pool, TEST_NUM_CHANNELS, 1, TEST_BLOCK_LENGTH, 0);
+
+    rate_switch_sim_t *sims[] = {&fast, &legacy};
+    for (int s = 0; s < sizeof(sims) / sizeof(sims[0]); s++) {
+        uint32_t seed = 0x12345678;
+        for (int i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+            run_segment(sims[s], rates[i], TEST_BLOCKS_PER_RATE, &seed);
+        }
+        TEST_PRINTF("ASRC: %s switches=%u dropped=%lu max_init_ticks=%lu max_switch_ticks=%lu\n", sims[s]->name, num_switches,
+                    sims[s]->dropped, sims[s]->max_init_ticks, sims[s]->max_switch_ticks);
+    }
+
+    if (fast.dropped > num_switches * TEST_MAX_DROPPED_PER_SWITCH) {
+        TEST_PRINTF("  - FAIL: dropped %lu samples over %u rate switches\n", fast.dropped, num_switches);
+        error_count++;
+    }
+
+    // Switching to a prepared bank must not call asrc_init()
+    if (fast.max_init_ticks * TEST_MIN_INIT_SPEEDUP > legacy.max_init_ticks) {
+        TEST_PRINTF("  - FAIL: rate switch took %lu ticks, asrc_init() took %lu ticks\n", fast.max_init_ticks, legacy.max_init_ticks);
+        error_count++;
+    }
+
+    // The skipped block alone costs the legacy pool a block period before its first output
+    if (fast.max_switch_ticks * TEST_MIN_SWITCH_SPEEDUP > legacy.max_switch_ticks) {
+        TEST_PRINTF("  - FAIL: first output %lu ticks after a prepared switch, %lu ticks after asrc_init()\n", fast.max_switch_ticks, legacy.max_switch_ticks);
+        error_count++;
+    }
+
+    if (error_count == 0) {
+        TEST_PRINTF("\nTEST: PASS\n");
+    } else {
+        TEST_PRINTF("\nTEST: FAILED (Error Count = %ld)\n", error_count);
+    }
+
+    return 0;
+}
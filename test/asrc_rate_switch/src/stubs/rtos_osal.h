@@ -0,0 +1,56 @@
+// Copyright (c) 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public License: Version 1
+
+#ifndef RTOS_OSAL_H_
+#define RTOS_OSAL_H_
+
+/*
+ * Single threaded stand in for the RTOS OSAL. The test runs the ASRC pool
+ * with one worker, so no worker threads are created and the semaphores are
+ * never waited on.
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+
+#define RTOS_OSAL_WAIT_FOREVER          (-1)
+#define RTOS_THREAD_STACK_SIZE(x)       (0)
+
+typedef int rtos_osal_status_t;
+typedef int rtos_osal_semaphore_t;
+typedef int rtos_osal_thread_t;
+typedef void (*rtos_osal_entry_function_t)(void *);
+
+#define RTOS_OSAL_SUCCESS               (0)
+
+static inline void *rtos_osal_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static inline rtos_osal_status_t rtos_osal_semaphore_create(rtos_osal_semaphore_t *semaphore, char *name, unsigned max_count, unsigned initial_count)
+{
+    *semaphore = initial_count;
+    return RTOS_OSAL_SUCCESS;
+}
+
+static inline rtos_osal_status_t rtos_osal_semaphore_get(rtos_osal_semaphore_t *semaphore, unsigned timeout)
+{
+    assert(*semaphore > 0);
+    (*semaphore)--;
+    return RTOS_OSAL_SUCCESS;
+}
+
+static inline rtos_osal_status_t rtos_osal_semaphore_put(rtos_osal_semaphore_t *semaphore)
+{
+    (*semaphore)++;
+    return RTOS_OSAL_SUCCESS;
+}
+
+static inline rtos_osal_status_t rtos_osal_thread_create(rtos_osal_thread_t *thread, char *name, rtos_osal_entry_function_t entry_function, void *entry_function_arg, size_t stack_size, unsigned int priority)
+{
+    assert(0);
+    return RTOS_OSAL_SUCCESS;
+}
+
+#endif /* RTOS_OSAL_H_ */
@@ -0,0 +1,44 @@
+#!/usr/bin/env python3
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+import re
+
+test_results_filename = "testing/test.rpt"
+test_regex = r"^TEST:\s+(\w+)"
+dropped_regex = r"^ASRC:\s+(\w+)\s+switches=(\d+)\s+dropped=(\d+)"
+switch_regex = r"^ASRC:\s+(\w+)\s.*max_switch_ticks=(\d+)"
+
+def test_results():
+    with open(test_results_filename, "r") as f:
+        cnt = 0
+        while 1:
+            line = f.readline()
+
+            if len(line) == 0:
+                assert cnt == 1
+                break
+
+            p = re.match(test_regex, line)
+
+            if p:
+                cnt += 1
+                assert p.group(1).find("PASS") != -1
+
+def test_dropped_samples():
+    with open(test_results_filename, "r") as f:
+        results = [re.match(dropped_regex, line) for line in f]
+    dropped = {p.group(1): int(p.group(3)) for p in results if p}
+
+    print(f"Dropped samples: {dropped}")
+    # Switching to prepared rates must drop far fewer samples than reinitialising
+    assert dropped["fast"] < dropped["legacy"]
+
+def test_switch_latency():
+    with open(test_results_filename, "r") as f:
+        results = [re.match(switch_regex, line) for line in f]
+    switch_ticks = {p.group(1): int(p.group(2)) for p in results if p}
+
+    print(f"Rate change to first output block (ticks): {switch_ticks}")
+    # The legacy pool waits a block period for the block after the skipped one
+    assert switch_ticks["fast"] < switch_ticks["legacy"]
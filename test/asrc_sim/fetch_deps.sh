@@ -0,0 +1,24 @@
+#!/bin/bash
+# Fetches the ASRC sim dependencies into _deps_cache, at the versions pinned in CMakeLists.txt, for building
+# with -DASRC_SIM_OFFLINE=ON on machines without network access. Copy the folder over with the sources.
+# From the test/asrc_sim directory, do
+# ./fetch_deps.sh [<deps dir>]
+set -e
+
+deps_dir=${1:-_deps_cache}
+mkdir -p $deps_dir
+
+fetch() {
+    name=$1; url=$2; ref=$3
+    if [ -d $deps_dir/$name ]; then
+        echo "$name already in $deps_dir"
+        return
+    fi
+    git clone $url $deps_dir/$name
+    git -C $deps_dir/$name checkout $ref
+    git -C $deps_dir/$name submodule update --init --recursive
+}
+
+fetch systemc https://github.com/accellera-official/systemc 2.3.4
+fetch NumCpp https://github.com/dpilger26/NumCpp Version_2.10.1
+fetch lib_src https://github.com/xmos/lib_src.git b5b90b0d41dcfc563ad6e879ff1c1592dd0d8034
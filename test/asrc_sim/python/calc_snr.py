@@ -6,13 +6,13 @@ import scipy.io.wavfile
 import argparse
 import os
 
-def rawFFT(data, sampling_rate, plot_fname, show_plot):
+def rawFFT(data, sampling_rate, plot_fname, show_plot, skip_secs=15*60):
     data_len = len(data)
     print(f"data_len = {data_len}")
 
     fftLength = 128
 
-    skip = int(15*60*sampling_rate) # Skip 15mins from the beginning
+    skip = int(skip_secs*sampling_rate) # Skip the start, 15 mins by default
     Data = np.fft.rfft(data[skip + fftLength:skip + 2*fftLength])
     Data1 = np.abs(Data)
     m = np.argmax(Data1)
@@ -54,6 +54,7 @@ def get_args():
     parser.add_argument("sampling_rate", type=int, help="sampling rate for the input file specified in the first argument")
     parser.add_argument("--plotfile", "-p", type=str, help="filename to save the FFT magnitude spectrum plot in", default="plot_spectrum.png")
     parser.add_argument("--show", "-s", action="store_true", help="Show the plot")
+    parser.add_argument("--skip-secs", type=float, help="Seconds skipped from the start of the file before the FFT", default=15*60)
     return parser.parse_args()
 
 # Usage python calc_snr.py <asrc_output.bin> <sampling rate>
@@ -69,6 +70,6 @@ if __name__ == "__main__":
         dt = np.fromfile(args.input_file, dtype=np.int32)
         scipy.io.wavfile.write("test.wav", args.sampling_rate, dt.T)
         data = np.array(dt/(np.iinfo(np.int32).max), dtype=np.double)
-        snr = rawFFT(data, args.sampling_rate, args.plotfile, args.show)
+        snr = rawFFT(data, args.sampling_rate, args.plotfile, args.show, args.skip_secs)
     else:
         assert False, f"Invalid input file {args.input_file}"
@@ -0,0 +1,45 @@
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+import argparse
+import re
+import sys
+
+def parse_lock_stats(log_fname):
+    with open(log_fname, "r") as f:
+        for line in f:
+            if line.startswith("LOCK_STATS:"):
+                return dict(re.findall(r"(\w+)=([^\s]+)", line))
+    return None
+
+def parse_arguments():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("p_log", help="stdout log of the proportional only controller run")
+    parser.add_argument("pi_log", help="stdout log of the PI controller run")
+    parser.add_argument("--mean-tolerance", type=float, default=0.5, help="Allowed increase in absolute mean offset, in samples")
+    args = parser.parse_args()
+    return args
+
+if __name__ == "__main__":
+    args = parse_arguments()
+    p = parse_lock_stats(args.p_log)
+    pi = parse_lock_stats(args.pi_log)
+    if p is None or pi is None:
+        print("LOCK_STATS line missing from the logs")
+        sys.exit(1)
+
+    for name, stats in (("P ", p), ("PI", pi)):
+        print(f"{name}: locked = {stats['locked']}, lock time = {float(stats['lock_time_s']):.1f}s, mean offset = {float(stats['mean']):.3f}, variance = {float(stats['variance']):.3f}")
+
+    failed = False
+    if int(pi["locked"]) == 0:
+        print("PI controller did not lock")
+        failed = True
+    elif int(p["locked"]) == 1 and float(pi["lock_time_s"]) > float(p["lock_time_s"]):
+        print("PI controller locks slower than P")
+        failed = True
+    if abs(float(pi["mean"])) > abs(float(p["mean"])) + args.mean_tolerance:
+        print("PI controller has a larger steady state offset than P")
+        failed = True
+
+    print("LOCK FAIL" if failed else "LOCK PASS")
+    sys.exit(1 if failed else 0)
@@ -0,0 +1,90 @@
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+import argparse
+import concurrent.futures
+import itertools
+import os
+import subprocess
+import sys
+
+import numpy as np
+
+from compare_lock_stats import parse_lock_stats
+
+SIM_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+
+def parse_levels(log_fname):
+    """Buffer level lines printed by the sim applications, as an array with one row per line"""
+    levels = []
+    with open(log_fname, "r") as f:
+        for line in f:
+            fields = line.strip().split(",")
+            if len(fields) == 2 and all(x.lstrip("-").isdigit() for x in fields):
+                levels.append([int(x) for x in fields])
+    return np.array(levels).reshape(-1, 2)
+
+def run(args, app, i2s_rate, ppm, ratio_error):
+    work_dir = os.path.join(args.out_dir, f"{app}_{i2s_rate}_ppm{ppm}_err{ratio_error}")
+    os.makedirs(work_dir, exist_ok=True)
+    cmd = [os.path.abspath(os.path.join(args.build_dir, app)), str(i2s_rate), "--ppm", str(ppm), "--mins", str(args.mins),
+           "--ratio-error", str(ratio_error)]
+    if args.timestamps:
+        cmd.append(os.path.abspath(args.timestamps))
+    log = os.path.join(work_dir, "log")
+    with open(log, "w") as f:
+        subprocess.run(cmd, cwd=work_dir, stdout=f, stderr=subprocess.STDOUT)
+    return parse_lock_stats(log), parse_levels(log)
+
+def compare(args, app, i2s_rate, ppm, ratio_error):
+    (ref_stats, ref_levels), (fast_stats, fast_levels) = [run(args, a, i2s_rate, ppm, ratio_error) for a in (app, "fast_" + app)]
+    row = {"app": app, "i2s_rate": i2s_rate, "ppm": ppm, "ratio_error": ratio_error}
+    if ref_stats is None or fast_stats is None or "locked" not in ref_stats or "locked" not in fast_stats:
+        row["result"] = "no LOCK_STATS"
+        return row
+
+    # Both print a buffer level line for the same ASRC blocks once the average is stable, so compare them line by line
+    n = min(len(ref_levels), len(fast_levels))
+    row["lines"] = f"{len(ref_levels)}/{len(fast_levels)}"
+    row["level_rms"] = float(np.sqrt(np.mean((ref_levels[:n] - fast_levels[:n]) ** 2))) if n else float("nan")
+    for k in ["lock_time_s", "mean", "min", "max"]:
+        row[k] = float(fast_stats[k]) - float(ref_stats[k])
+
+    failed = (ref_stats["locked"] != fast_stats["locked"]) or not (row["level_rms"] <= args.level_tolerance)
+    failed = failed or abs(row["lock_time_s"]) > args.lock_time_tolerance or abs(row["mean"]) > args.mean_tolerance
+    failed = failed or max(abs(row["min"]), abs(row["max"])) > args.excursion_tolerance
+    row["result"] = "FAIL" if failed else "PASS"
+    return row
+
+def parse_arguments():
+    parser = argparse.ArgumentParser(description="Compare the block level models in src/fast_model against the SystemC simulation")
+    parser.add_argument("--build-dir", default=os.path.join(SIM_DIR, "build"), help="Directory containing the sim applications and models")
+    parser.add_argument("--out-dir", default="_cross_validate", help="Directory for the logs of every run")
+    parser.add_argument("--apps", nargs="+", default=["usb_in_i2s_out", "i2s_in_usb_out"], help="SystemC applications to compare, the model is fast_<app>")
+    parser.add_argument("--rates", type=int, nargs="+", default=[44100, 48000, 192000], help="I2S rates")
+    parser.add_argument("--ppm", type=float, nargs="+", default=[10], help="USB drift, in ppm")
+    parser.add_argument("--ratio-error", type=float, nargs="+", default=[0, 2], help="Error in the rate ratio given to the ASRC, in ppm")
+    parser.add_argument("--mins", type=float, default=20, help="Simulated time per run, in minutes")
+    parser.add_argument("--timestamps", help="SOF timestamps file, for example log_sofs_1hr")
+    parser.add_argument("--level-tolerance", type=float, default=2, help="Allowed RMS difference of the buffer level lines, in samples")
+    parser.add_argument("--lock-time-tolerance", type=float, default=10, help="Allowed lock time difference, in seconds")
+    parser.add_argument("--mean-tolerance", type=float, default=0.5, help="Allowed difference of the mean buffer level error after lock, in samples")
+    parser.add_argument("--excursion-tolerance", type=float, default=4, help="Allowed difference of the buffer level excursions, in samples")
+    parser.add_argument("-j", "--jobs", type=int, default=os.cpu_count(), help="Comparisons run in parallel")
+    args = parser.parse_args()
+    return args
+
+if __name__ == "__main__":
+    args = parse_arguments()
+    cases = list(itertools.product(args.apps, args.rates, args.ppm, args.ratio_error))
+    os.makedirs(args.out_dir, exist_ok=True)
+
+    with concurrent.futures.ThreadPoolExecutor(max_workers=args.jobs) as pool:
+        rows = list(pool.map(lambda case: compare(args, *case), cases))
+
+    columns = ["app", "i2s_rate", "ppm", "ratio_error", "lines", "level_rms", "lock_time_s", "mean", "min", "max", "result"]
+    print("Differences, fast model - SystemC")
+    print(" ".join(f"{c:>14}" for c in columns))
+    for r in rows:
+        print(" ".join(f"{r[c]:>14.3f}" if isinstance(r.get(c), float) else f"{str(r.get(c, '-')):>14}" for c in columns))
+
+    sys.exit(0 if all(r["result"] == "PASS" for r in rows) else 1)
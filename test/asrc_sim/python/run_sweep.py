@@ -0,0 +1,116 @@
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+import argparse
+import concurrent.futures
+import csv
+import itertools
+import os
+import re
+import subprocess
+import sys
+
+from compare_lock_stats import parse_lock_stats
+
+SIM_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+CALC_SNR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "calc_snr.py")
+USB_RATE = 48000
+COLUMNS = ["app", "i2s_rate", "ppm", "ratio_error", "kp", "snr", "locked", "lock_time_s", "min", "max", "variance", "result"]
+
+def asrc_output_rate(app, i2s_rate):
+    return i2s_rate if "usb_in_i2s_out" in app else USB_RATE
+
+def run_case(args, app, i2s_rate, ppm, ratio_error, kp):
+    row = {"app": app, "i2s_rate": i2s_rate, "ppm": ppm, "ratio_error": ratio_error, "kp": kp if kp else "tuned"}
+    sim_app = os.path.abspath(os.path.join(args.build_dir, app))
+    if not os.path.isfile(sim_app):
+        row["result"] = "not built"
+        return row
+
+    name = f"{app}_{i2s_rate}_ppm{ppm}" + (f"_err{ratio_error}" if ratio_error else "") + (f"_kp{kp}" if kp else "")
+    work_dir = os.path.join(args.out_dir, name)
+    os.makedirs(work_dir, exist_ok=True)
+
+    # Each case runs in its own directory since the sim writes asrc_input.bin and asrc_output.bin to the working directory
+    cmd = [sim_app, str(i2s_rate), "--ppm", str(ppm), "--mins", str(args.mins)]
+    if kp:
+        cmd += ["--kp", str(kp)]
+    if ratio_error:
+        cmd += ["--ratio-error", str(ratio_error)]
+    if args.timestamps:
+        cmd.append(os.path.abspath(args.timestamps))
+    with open(os.path.join(work_dir, "log"), "w") as log:
+        sim = subprocess.run(cmd, cwd=work_dir, stdout=log, stderr=subprocess.STDOUT)
+
+    if sim.returncode != 0:
+        row["result"] = f"sim exit {sim.returncode}"
+        return row
+
+    # Measure the SNR towards the end of the run, after the controller has settled. The block level models
+    # in src/fast_model don't process audio so have no SNR.
+    row["snr"] = None
+    if os.path.isfile(os.path.join(work_dir, "asrc_output.bin")):
+        row["snr"] = calc_snr(args, app, i2s_rate, work_dir)
+        if row["snr"] is None:
+            row["result"] = "calc_snr failed"
+            return row
+
+    stats = parse_lock_stats(os.path.join(work_dir, "log"))
+    if stats is not None and "locked" in stats:
+        row.update({k: stats[k] for k in ["locked", "lock_time_s", "min", "max", "variance"]})
+
+    failed = (args.min_snr is not None and row["snr"] is not None and row["snr"] < args.min_snr) or row.get("locked") != "1"
+    row["result"] = "FAIL" if failed else "PASS"
+    return row
+
+def calc_snr(args, app, i2s_rate, work_dir):
+    snr = subprocess.run([sys.executable, CALC_SNR, "asrc_output.bin", str(asrc_output_rate(app, i2s_rate)),
+                          "-p", "plot_spectrum.png", "--skip-secs", str(args.mins * 60 * 3 / 4)],
+                         cwd=work_dir, capture_output=True, text=True)
+    m = re.search(r"SNR = ([-\w.]+)", snr.stdout)
+    return float(m.group(1)) if m else None
+
+def print_table(rows):
+    widths = {c: max(len(c), *(len(fmt(r.get(c))) for r in rows)) for c in COLUMNS}
+    print(" ".join(f"{c:>{widths[c]}}" for c in COLUMNS))
+    for r in rows:
+        print(" ".join(f"{fmt(r.get(c)):>{widths[c]}}" for c in COLUMNS))
+
+def fmt(value):
+    if value is None:
+        return "-"
+    if isinstance(value, float):
+        return f"{value:.1f}"
+    return str(value)
+
+def parse_arguments():
+    parser = argparse.ArgumentParser(description="Run the ASRC sim applications over a parameter sweep in parallel and summarise SNR, lock time and buffer excursions")
+    parser.add_argument("--build-dir", default=os.path.join(SIM_DIR, "build"), help="Directory containing the sim applications")
+    parser.add_argument("--out-dir", default="_sweep", help="Directory for the logs and ASRC output of every case")
+    parser.add_argument("--apps", nargs="+", default=["usb_in_i2s_out", "i2s_in_usb_out"], help="Sim applications to run")
+    parser.add_argument("--rates", type=int, nargs="+", default=[44100, 48000, 88200, 96000, 176400, 192000], help="I2S rates")
+    parser.add_argument("--ppm", type=float, nargs="+", default=[-100, 10, 100], help="USB drift, in ppm")
+    parser.add_argument("--ratio-error", type=float, nargs="+", default=[0], help="Error in the rate ratio given to the ASRC, in ppm")
+    parser.add_argument("--kp", type=float, nargs="+", default=[0], help="Buffer controller Kp, in the units of buffer_control.h. 0 uses the tuned gains")
+    parser.add_argument("--mins", type=float, default=4, help="Simulated time per case, in minutes")
+    parser.add_argument("--timestamps", help="SOF timestamps file, for example log_sofs_1hr")
+    parser.add_argument("--min-snr", type=float, help="Fail cases with a lower SNR")
+    parser.add_argument("-j", "--jobs", type=int, default=os.cpu_count(), help="Cases run in parallel")
+    args = parser.parse_args()
+    return args
+
+if __name__ == "__main__":
+    args = parse_arguments()
+    cases = list(itertools.product(args.apps, args.rates, args.ppm, args.ratio_error, args.kp))
+    print(f"Running {len(cases)} cases, {args.jobs} at a time")
+    os.makedirs(args.out_dir, exist_ok=True)
+
+    with concurrent.futures.ThreadPoolExecutor(max_workers=args.jobs) as pool:
+        rows = list(pool.map(lambda case: run_case(args, *case), cases))
+
+    print_table(rows)
+    with open(os.path.join(args.out_dir, "summary.csv"), "w", newline="") as f:
+        writer = csv.DictWriter(f, fieldnames=COLUMNS)
+        writer.writeheader()
+        writer.writerows(rows)
+
+    sys.exit(0 if all(r["result"] == "PASS" for r in rows) else 1)
@@ -4,10 +4,13 @@
 # From the test/asrc_sim directory, do
 # pip install -r ./requirements.txt
 # ./run.sh
+# Set ASRC_SIM_OFFLINE=1 to build from local copies of the dependencies, see README.txt
 
-cmake -S . -B ./build
+cmake -S . -B ./build ${ASRC_SIM_OFFLINE:+-DASRC_SIM_OFFLINE=ON}
 cmake --build build --target usb_in_i2s_out -j8
 cmake --build build --target i2s_in_usb_out -j8
+cmake --build build --target usb_in_i2s_out_p -j8
+cmake --build build --target i2s_in_usb_out_p -j8
 
 
 dir_name=_plots
@@ -61,4 +64,16 @@ else
     exit -1
 fi
 
+# Compare lock time, steady state offset and variance of the PI buffer controller against the proportional only one
+for app in usb_in_i2s_out i2s_in_usb_out; do
+    i2srate=48000
+    build/${app}_p $i2srate 2>&1 > log_p
+    build/$app $i2srate 2>&1 > log_pi
+    python python/compare_lock_stats.py log_p log_pi
+    if [ $? -ne 0 ]; then
+        echo "$app LOCK FAIL"
+        exit -1
+    fi
+done
+
 #python plot_csv.py log $dir_name/test_correct_$i.png 2
@@ -6,6 +6,7 @@
 #include "buffer.h"
 #include "ASRC_wrapper.h"
 #include "config.h"
+#include "lock_stats.h"
 
 SC_MODULE(ASRC)
 {
@@ -32,4 +33,5 @@ SC_MODULE(ASRC)
 
     public:
         void process();
+        LockStats m_lock_stats{2}; // Buffer level is considered locked within +-2 samples of the target
 };
@@ -10,6 +10,8 @@
 #include "asrc.h"
 #include "config.h"
 #include "helpers.h"
+#include "buffer_control.h"
+#include "pi_control.h"
 
 #define DEFAULT_NOMINAL_USB_RATE (48000) // Do not change!! Only 48000KHz USB supported
 #define DEFAULT_USB_DRIFT_PPM    (10)
@@ -23,12 +25,15 @@ int sc_main(int argc, char* argv[])
     app_config->nominal_usb_rate = DEFAULT_NOMINAL_USB_RATE;
     app_config->usb_drift_ppm = DEFAULT_USB_DRIFT_PPM;
     app_config->asrc_block_size = ASRC_BLOCK_SIZE;
+    app_config->sim_time_mins = DEFAULT_SIM_TIME_MINS;
+    app_config->kp = 0;
+    app_config->rate_ratio_error_ppm = 0;
     // Choose the frequency of the sine tone used as ASRC input such that there are an integer no. of periods in a 128 point FFT on the asrc output, which is at the USB rate
     app_config->asrc_input_sine_freq = 6000;
 
     if(argc < 2)
     {
-        printf("Usage:\ni2s_in_usb_out <i2s_rate> \nor\ni2s_in_usb_out <i2s_rate> <USB timestamps file>\nExiting\n");
+        printf("Usage:\ni2s_in_usb_out <i2s_rate> [<USB timestamps file>] [--ppm <USB drift>] [--mins <sim time>] [--kp <Kp>] [--ratio-error <ppm>]\nExiting\n");
         return -1;
     }
     app_config->nominal_i2s_rate = (double)(atoi(argv[1]));
@@ -37,10 +42,14 @@ int sc_main(int argc, char* argv[])
         return -1;
     }
 
-    if(argc == 3) // If SOF timestamps file is provided, parse the timestamps into a std::vector
+    // Optional SOF timestamps file and overrides of the drift, simulation time and controller Kp
+    if(parse_sim_options(argc, argv, app_config) != 0)
     {
-        printf("argv[2] = %s\n", argv[2]);
-        parse_sof_timestamps(argv[2], app_config);
+        return -1;
+    }
+    if(app_config->kp != 0)
+    {
+        pi_control_set_kp(app_config->kp);
     }
 
     app_config->actual_usb_rate = (double)app_config->nominal_usb_rate * (1 + app_config->usb_drift_ppm/1000000);
@@ -49,7 +58,7 @@ int sc_main(int argc, char* argv[])
     double i2s_asrc_input_block_period = ((app_config->asrc_block_size/app_config->nominal_i2s_rate))/(1/app_config->nominal_i2s_rate);
     printf("SOF period = %f\n", sof_period);
 
-    double actual_rate_ratio = app_config->nominal_i2s_rate / app_config->actual_usb_rate;
+    double actual_rate_ratio = app_config->nominal_i2s_rate / app_config->actual_usb_rate * (1 + app_config->rate_ratio_error_ppm/1000000);
 
     sc_clock usb_clk("usb_clk", sof_period, SC_US);
     sc_clock i2s_clk("i2s_clk", i2s_asrc_input_block_period, SC_US);
@@ -70,7 +79,9 @@ int sc_main(int argc, char* argv[])
 
 
     // Simulate for N seconds.
-    sc_start(DEFAULT_SIM_TIME_MINS*60*app_config->nominal_i2s_rate, SC_US);
+    sc_start(app_config->sim_time_mins*60*app_config->nominal_i2s_rate, SC_US);
+
+    asrc.m_lock_stats.print(BUFFER_CONTROL_ENABLE_INTEGRAL ? "pi" : "p");
 
     delete app_config->asrc_input_samples;
     delete app_config;
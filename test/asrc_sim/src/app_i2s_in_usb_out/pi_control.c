@@ -5,34 +5,32 @@
 #include <stdio.h>
 #include <string.h>
 #include "pi_control.h"
+#include "buffer_control.h"
 
+static double kp_override = 0;
 
-typedef int32_t sw_pll_q24_t; // Type for 8.24 signed fixed point
-#define SW_PLL_NUM_FRAC_BITS 24
-#define SW_PLL_Q24(val) ((sw_pll_q24_t)((float)val * (1 << SW_PLL_NUM_FRAC_BITS)))
-
+void pi_control_set_kp(double kp)
+{
+    kp_override = kp;
+}
 
-static inline sw_pll_q24_t get_Kp_for_usb_buffer_control(int32_t nominal_i2s_rate)
+// Gains from buffer_control.h, or the overridden Kp with Ki in the same ratio to Kp as the tuned gains
+static buffer_control_gains_t pi_control_get_gains(buffer_control_dir_t dir, int32_t nominal_i2s_rate)
 {
-    sw_pll_q24_t Kp = 0;
-    if(((int)nominal_i2s_rate == (int)44100) || ((int)nominal_i2s_rate == (int)48000))
-    {
-        Kp = SW_PLL_Q24(4.563402752); // 0.000000017 * (2**28)
-    }
-    else if(((int)nominal_i2s_rate == (int)88200) || ((int)nominal_i2s_rate == (int)96000))
-    {
-        Kp = SW_PLL_Q24(9.39524096); // 0.000000035 * (2**28)
-    }
-    else if(((int)nominal_i2s_rate == (int)176400) || ((int)nominal_i2s_rate == (int)192000))
+    buffer_control_gains_t gains = buffer_control_get_gains(dir, nominal_i2s_rate);
+    if(kp_override != 0)
     {
-        Kp = SW_PLL_Q24(18.79048192); // 0.00000007* (2**28)
+        gains.Kp = SW_PLL_Q24(kp_override);
+        gains.Ki = BUFFER_CONTROL_ENABLE_INTEGRAL ? BUFFER_CONTROL_KI(kp_override) : 0;
     }
-    return Kp;
+    return gains;
 }
 
 uint64_t calc_usb_buffer_based_correction(int32_t nominal_i2s_rate, buffer_calc_state_t *long_term_buf_state, buffer_calc_state_t *short_term_buf_state)
 {
-    sw_pll_q24_t Kp = get_Kp_for_usb_buffer_control(nominal_i2s_rate);
+    // Same controller as the USB buffer control in the ASRC demo usb_audio
+    static buffer_control_state_t buf_control;
+    static bool buf_control_running = false;
     int64_t max_allowed_correction = (int64_t)1500 << 32;
     int64_t total_error = 0;
 
@@ -52,17 +50,16 @@ uint64_t calc_usb_buffer_based_correction(int32_t nominal_i2s_rate, buffer_calc_
     }
     if(long_term_buf_state->flag_stable_avg == true)
     {
-        int64_t error_p = ((int64_t)Kp * (int64_t)(long_term_buf_state->avg_buffer_level - long_term_buf_state->stable_avg_level));
-
-        total_error = (int64_t)(error_p << 8);
-        if(total_error > max_allowed_correction)
+        if(!buf_control_running)
         {
-            total_error = max_allowed_correction;
-        }
-        else if(total_error < -(max_allowed_correction))
-        {
-            total_error = -(max_allowed_correction);
+            buffer_control_init(&buf_control, pi_control_get_gains(BUFFER_CONTROL_USB_BUF, nominal_i2s_rate), max_allowed_correction);
+            buf_control_running = true;
         }
+        total_error = buffer_control_update(&buf_control, long_term_buf_state->avg_buffer_level - long_term_buf_state->stable_avg_level);
+    }
+    else
+    {
+        buf_control_running = false;
     }
 
     return total_error;
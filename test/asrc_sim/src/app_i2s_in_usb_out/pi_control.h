@@ -12,6 +12,9 @@
 
 uint64_t calc_usb_buffer_based_correction(int32_t nominal_i2s_rate, buffer_calc_state_t *long_term_buf_state, buffer_calc_state_t *short_term_buf_state);
 
+// Override the tuned Kp, in the same units as the KP_ constants in buffer_control.h. 0 uses the tuned gains.
+void pi_control_set_kp(double kp);
+
 #ifdef __cplusplus
  }
 #endif
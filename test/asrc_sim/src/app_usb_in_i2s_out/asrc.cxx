@@ -73,6 +73,11 @@ void ASRC::process()
 
         if(buffer_writes_count == 16)
         {
+            if(buf_state.flag_stable_avg)
+            {
+                // sim time is in units of I2S sample periods, see main.cpp
+                m_lock_stats.update(sc_time_stamp().to_seconds() * 1e6 / m_config->nominal_i2s_rate, buf_state.avg_buffer_level - buf_state.stable_avg_level);
+            }
             int64_t error;
             if(m_config->usb_timestamps[0].size() != 0)
             {
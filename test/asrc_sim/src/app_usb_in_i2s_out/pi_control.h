@@ -13,6 +13,9 @@
 void calc_avg_i2s_send_buffer_level(int current_level, bool reset);
 uint64_t pi_control(int32_t nominal_i2s_rate, buffer_calc_state_t *buf_state);
 
+// Override the tuned Kp, in the same units as the KP_ constants in buffer_control.h. 0 uses the tuned gains.
+void pi_control_set_kp(double kp);
+
 #ifdef __cplusplus
  }
 #endif
@@ -0,0 +1,67 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// Collects the buffer level error seen by the buffer controller, to compare controllers.
+// The lock time is the time of the last update with the error outside +-lock_band.
+// Mean and variance are calculated over the updates after the lock time, or the
+// second half of the run if the controller never locks. min and max are the largest
+// excursions of the error over the whole run.
+class LockStats
+{
+    public:
+        LockStats(int lock_band) : m_lock_band(lock_band) {}
+
+        void update(double time_s, int error)
+        {
+            m_times.push_back(time_s);
+            m_errors.push_back(error);
+            if((m_errors.size() == 1) || (error < m_min_error))
+            {
+                m_min_error = error;
+            }
+            if((m_errors.size() == 1) || (error > m_max_error))
+            {
+                m_max_error = error;
+            }
+            if(std::abs(error) > m_lock_band)
+            {
+                m_last_unlocked = m_times.size();
+            }
+        }
+
+        void print(const char *controller)
+        {
+            size_t n = m_errors.size();
+            if(n == 0)
+            {
+                printf("LOCK_STATS: controller=%s no updates\n", controller);
+                return;
+            }
+            size_t start = (m_last_unlocked < n) ? m_last_unlocked : n / 2;
+            double sum = 0, sum_sq = 0;
+            for(size_t i = start; i < n; i++)
+            {
+                sum += m_errors[i];
+                sum_sq += (double)m_errors[i] * m_errors[i];
+            }
+            double mean = sum / (n - start);
+            double variance = (sum_sq / (n - start)) - (mean * mean);
+            double lock_time = (m_last_unlocked < n) ? m_times[m_last_unlocked] : m_times[n - 1];
+
+            printf("LOCK_STATS: controller=%s locked=%d lock_time_s=%f mean=%f variance=%f min=%d max=%d\n",
+                   controller, (m_last_unlocked < n) ? 1 : 0, lock_time, mean, variance, m_min_error, m_max_error);
+        }
+
+    private:
+        int m_lock_band;
+        size_t m_last_unlocked = 0;     // Index of the first update after the last one outside the lock band
+        int m_min_error = 0;
+        int m_max_error = 0;
+        std::vector<double> m_times;
+        std::vector<int> m_errors;
+};
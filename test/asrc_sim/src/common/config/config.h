@@ -2,6 +2,9 @@
 // This Software is subject to the terms of the XMOS Public Licence: Version 1.
 #pragma once
 
+#include <cstdint>
+#include <vector>
+
 typedef struct
 {
     /* data */
@@ -10,8 +13,11 @@ typedef struct
     double actual_usb_rate;
     double average_usb_rate_from_sofs;
     double usb_drift_ppm;
+    double rate_ratio_error_ppm;             // Error in the rate ratio the ASRC is given when not using SOF timestamps
     double asrc_input_sine_freq;
     int asrc_block_size;
+    double sim_time_mins;
+    double kp;                               // Buffer controller Kp override, 0 to use the tuned gains
     std::vector<uint32_t> usb_timestamps[2]; // 2 in case OUT and IN timestamps are present.
     int *asrc_input_samples;
 }config_t;
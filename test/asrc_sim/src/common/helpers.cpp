@@ -4,7 +4,7 @@
 #include <string>
 #include <sstream>
 #include <fstream>
-#include "systemc.h"
+#include <cstdio>
 #include "config.h"
 
 #include <cstdlib>
@@ -15,7 +15,6 @@
 
 void parse_sof_timestamps(const char *fname, config_t *app_config)
 {
-    ifstream myfile;
     std::ifstream infile(fname);
     std::string line;
 
@@ -63,3 +62,49 @@ int verify_i2s_rate(int i2s_rate)
     printf("nominal_i2s_rate = %d\n", (int)i2s_rate);
     return 0;
 }
+
+// Parses the arguments after <i2s_rate>: an optional SOF timestamps file and the --ppm, --mins, --kp and --ratio-error overrides
+int parse_sim_options(int argc, char* argv[], config_t *app_config)
+{
+    for(int i=2; i<argc; i++)
+    {
+        std::string arg(argv[i]);
+        if((arg == "--ppm") || (arg == "--mins") || (arg == "--kp") || (arg == "--ratio-error"))
+        {
+            if(i + 1 >= argc)
+            {
+                printf("ERROR: %s needs a value\n", argv[i]);
+                return -1;
+            }
+            double value = atof(argv[++i]);
+            if(arg == "--ppm")
+            {
+                app_config->usb_drift_ppm = value;
+            }
+            else if(arg == "--mins")
+            {
+                app_config->sim_time_mins = value;
+            }
+            else if(arg == "--ratio-error")
+            {
+                app_config->rate_ratio_error_ppm = value;
+            }
+            else
+            {
+                app_config->kp = value;
+            }
+        }
+        else if(arg.rfind("--", 0) == 0)
+        {
+            printf("ERROR: Unknown option %s\n", argv[i]);
+            return -1;
+        }
+        else // SOF timestamps file, parse the timestamps into a std::vector
+        {
+            printf("argv[%d] = %s\n", i, argv[i]);
+            parse_sof_timestamps(argv[i], app_config);
+        }
+    }
+    printf("usb_drift_ppm = %f, sim_time_mins = %f, kp = %f, rate_ratio_error_ppm = %f\n", app_config->usb_drift_ppm, app_config->sim_time_mins, app_config->kp, app_config->rate_ratio_error_ppm);
+    return 0;
+}
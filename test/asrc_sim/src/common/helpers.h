@@ -4,3 +4,4 @@
 
 void parse_sof_timestamps(const char *fname, config_t *app_config);
 int verify_i2s_rate(int i2s_rate);
+int parse_sim_options(int argc, char* argv[], config_t *app_config);
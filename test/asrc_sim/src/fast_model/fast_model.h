@@ -0,0 +1,112 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#pragma once
+
+// Block level, discrete time models of the parts of the SystemC simulation that the buffer controller sees.
+// Time is in the same units as the SystemC simulation, I2S sample periods.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include "config.h"
+#include "usb_rate_calc.h"
+
+#define FAST_MODEL_FS_RATIO_FRAC_BITS   (28 + 32)
+#define FAST_MODEL_BUFFER_MAX_LEVEL     (240 * 4)  // Same limit as the SystemC Buffer
+#define FAST_MODEL_TIMER_TICK_RATE      (100e6)
+
+extern float_s32_t g_avg_usb_rate;
+
+// Number of samples the ASRC outputs for each input block. The ASRC outputs a sample every fs_ratio input samples,
+// so tracking the input position of the next output sample gives the output count of every block without filtering
+// any audio. The filter delay is not modelled, it only offsets the buffer level, which the controller removes.
+class AsrcModel
+{
+    public:
+        AsrcModel(uint32_t fs_in, uint32_t fs_out)
+        {
+            // fs_in / fs_out in the Q4.60 format returned by asrc_init(), with 28 significant fractional bits
+            m_nominal_fs_ratio = (((uint64_t)fs_in << 28) / fs_out) << 32;
+        }
+
+        uint64_t nominal_fs_ratio() const { return m_nominal_fs_ratio; }
+
+        unsigned process(unsigned n_in, uint64_t fs_ratio)
+        {
+            unsigned __int128 block_end = (unsigned __int128)n_in << FAST_MODEL_FS_RATIO_FRAC_BITS;
+            unsigned n_out = 0;
+            if(m_next_out < block_end)
+            {
+                n_out = (unsigned)((block_end - m_next_out + fs_ratio - 1) / fs_ratio);
+                m_next_out += (unsigned __int128)n_out * fs_ratio;
+            }
+            m_next_out -= block_end;
+            return n_out;
+        }
+
+    private:
+        uint64_t m_nominal_fs_ratio;
+        unsigned __int128 m_next_out = 0;   // Input position of the next output sample from the start of the next block
+};
+
+// Times of the USB SOFs, either every sof_period or from a logged SOF timestamps file, scheduled the same way as
+// the SystemC USB module. With a timestamps file every SOF also updates g_avg_usb_rate, as in usb.cxx.
+class SofSchedule
+{
+    public:
+        SofSchedule(config_t *config, double sof_period) : m_config(config), m_sof_period(sof_period) {}
+
+        double next_time() const { return m_next_time; }
+
+        bool finished() const { return m_done; }
+
+        // Set once the logged timestamps run out. The SystemC simulation stops at next_time() then.
+        bool stopped(double time) const { return m_done && (time >= m_next_time); }
+
+        void step()
+        {
+            std::vector<uint32_t> &ts = m_config->usb_timestamps[0];
+            if(ts.size() == 0)
+            {
+                m_count += 1;
+                m_next_time = m_count * m_sof_period;
+                return;
+            }
+
+            uint32_t timestamp = ts[m_index];
+            double wait_time;
+            if(m_prev_ts_valid)
+            {
+                g_avg_usb_rate = determine_USB_audio_rate(timestamp, ts[m_index + 1], 0, true);
+                wait_time = ((double)(uint32_t)(timestamp - m_prev_ts) / FAST_MODEL_TIMER_TICK_RATE) * m_config->nominal_i2s_rate;
+            }
+            else
+            {
+                wait_time = ((double)(100000) / FAST_MODEL_TIMER_TICK_RATE) * m_config->nominal_i2s_rate;  // 1 ms nominally
+            }
+            m_prev_ts = timestamp;
+            m_prev_ts_valid = true;
+            m_next_time += wait_time;
+            m_index += 2;
+            m_done = (m_index >= ts.size());
+        }
+
+    private:
+        config_t *m_config;
+        double m_sof_period;
+        double m_next_time = 0;
+        uint64_t m_count = 0;
+        size_t m_index = 0;
+        uint32_t m_prev_ts = 0;
+        bool m_prev_ts_valid = false;
+        bool m_done = false;
+};
+
+static inline void fast_model_check_buffer_level(int level)
+{
+    if((level >= FAST_MODEL_BUFFER_MAX_LEVEL) || (level <= -FAST_MODEL_BUFFER_MAX_LEVEL))
+    {
+        printf("ERROR: buffer level %d out of range\n", level);
+        exit(1);
+    }
+}
@@ -0,0 +1,130 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include "config.h"
+#include "helpers.h"
+#include "fast_model.h"
+#include "usb_rate_calc.h"
+#include "avg_buffer_level.h"
+#include "lock_stats.h"
+#include "buffer_control.h"
+#include "pi_control.h"
+
+// Same configuration as app_usb_in_i2s_out/main.cpp
+#define DEFAULT_NOMINAL_USB_RATE (48000)
+#define DEFAULT_USB_DRIFT_PPM    (10)
+#define DEFAULT_SIM_TIME_MINS    (20)
+#define ASRC_BLOCK_SIZE          (96)
+
+float_s32_t g_avg_usb_rate = {.mant=0, .exp=0};
+float_s32_t g_avg_i2s_rate;
+
+// Block level model of app_usb_in_i2s_out. USB -> ASRC -> buffer -> I2S, the ASRC runs every ASRC_BLOCK_SIZE / 48 SOFs
+// and I2S reads one sample every sample period.
+// Usage: fast_usb_in_i2s_out <i2s_rate> [<USB timestamps file>] [--ppm <USB drift>] [--mins <sim time>] [--kp <Kp>] [--ratio-error <ppm>]
+int main(int argc, char* argv[])
+{
+    config_t app_config = {};
+    app_config.nominal_usb_rate = DEFAULT_NOMINAL_USB_RATE;
+    app_config.usb_drift_ppm = DEFAULT_USB_DRIFT_PPM;
+    app_config.asrc_block_size = ASRC_BLOCK_SIZE;
+    app_config.sim_time_mins = DEFAULT_SIM_TIME_MINS;
+    app_config.kp = 0;
+    app_config.rate_ratio_error_ppm = 0;
+
+    if(argc < 2)
+    {
+        printf("Usage:\nfast_usb_in_i2s_out <i2s_rate> [<USB timestamps file>] [--ppm <USB drift>] [--mins <sim time>] [--kp <Kp>] [--ratio-error <ppm>]\nExiting\n");
+        return -1;
+    }
+    app_config.nominal_i2s_rate = (double)(atoi(argv[1]));
+    if(verify_i2s_rate(app_config.nominal_i2s_rate) != 0)
+    {
+        return -1;
+    }
+    if(parse_sim_options(argc, argv, &app_config) != 0)
+    {
+        return -1;
+    }
+    if(app_config.kp != 0)
+    {
+        pi_control_set_kp(app_config.kp);
+    }
+    bool use_timestamps = (app_config.usb_timestamps[0].size() != 0);
+
+    app_config.actual_usb_rate = (double)app_config.nominal_usb_rate * (1 + app_config.usb_drift_ppm/1000000);
+    double sof_period = (1e-3/(1/app_config.nominal_i2s_rate)) / (1 + app_config.usb_drift_ppm/1000000);
+    double end_time = app_config.sim_time_mins*60*app_config.nominal_i2s_rate;
+
+    AsrcModel asrc((uint32_t)app_config.nominal_usb_rate, (uint32_t)app_config.nominal_i2s_rate);
+    SofSchedule usb(&app_config, sof_period);
+    LockStats lock_stats(2);
+
+    uint64_t actual_rate_ratio = uint64_t((app_config.actual_usb_rate / app_config.nominal_i2s_rate) * (1 + app_config.rate_ratio_error_ppm/1000000) * ((uint64_t)1 << FAST_MODEL_FS_RATIO_FRAC_BITS));
+    uint64_t rate_ratio = use_timestamps ? asrc.nominal_fs_ratio() : actual_rate_ratio;
+    g_avg_i2s_rate = float_div((float_s32_t){(int32_t)app_config.nominal_i2s_rate, 0}, (float_s32_t){100000000, 0});
+
+    buffer_calc_state_t buf_state;
+    init_calc_buffer_level_state(&buf_state, 10, 8);
+
+    int64_t samples_written = 0;
+    uint32_t sofs_per_block = ASRC_BLOCK_SIZE / 48;
+    uint32_t sof_count = 0;
+    uint32_t buffer_writes_count = 0;
+
+    while(!usb.finished())
+    {
+        double time = usb.next_time();
+        if(time >= end_time)
+        {
+            break;
+        }
+        usb.step();
+
+        sof_count += 1;
+        if(sof_count < sofs_per_block)
+        {
+            continue;
+        }
+        sof_count = 0;
+
+        // I2S reads a sample at every integer time, including this one, before the ASRC runs
+        int64_t samples_read = (int64_t)floor(time) + 1;
+        fast_model_check_buffer_level(samples_written - samples_read);
+
+        samples_written += asrc.process(ASRC_BLOCK_SIZE, rate_ratio);
+        int buffer_level = samples_written - samples_read;
+        fast_model_check_buffer_level(buffer_level);
+
+        calc_avg_buffer_level(&buf_state, buffer_level, false);
+
+        buffer_writes_count += 1;
+        if(buffer_writes_count == 16)
+        {
+            if(buf_state.flag_stable_avg)
+            {
+                lock_stats.update(time / app_config.nominal_i2s_rate, buf_state.avg_buffer_level - buf_state.stable_avg_level);
+            }
+            int64_t error = pi_control(app_config.nominal_i2s_rate, &buf_state);
+            if(use_timestamps)
+            {
+                rate_ratio = float_div_u64_fixed_output_q_format(g_avg_usb_rate, g_avg_i2s_rate, FAST_MODEL_FS_RATIO_FRAC_BITS) + error;
+            }
+            else
+            {
+                rate_ratio = actual_rate_ratio + error;
+            }
+            buffer_writes_count = 0;
+
+            if(buf_state.flag_stable_avg)
+            {
+                printf("%d,%d\n", buffer_level, buf_state.avg_buffer_level);
+            }
+        }
+    }
+
+    lock_stats.print(BUFFER_CONTROL_ENABLE_INTEGRAL ? "pi" : "p");
+    return 0;
+}
@@ -0,0 +1,22 @@
+// Copyright (c) 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public License: Version 1
+
+#ifndef APP_CONF_H
+#define APP_CONF_H
+
+/* Largest block used by the ASRC demo and FFVA USB paths */
+#define TEST_MAX_FRAME_COUNT        488
+#define TEST_MAX_CHANNELS           6
+
+/* Block benchmarked, the ASRC demo USB to I2S direction */
+#define TEST_BENCH_FRAME_COUNT      96
+#define TEST_BENCH_CHANNELS         2
+#define TEST_BENCH_ITERATIONS       16
+
+/* Block benchmarked for the int32 to int16 conversion, one ASR brick */
+#define TEST_BENCH_ASR_BRICK_COUNT  240
+
+/* Gain used for the benchmark, -6 dB */
+#define TEST_BENCH_GAIN             0x10000000
+
+#endif /* APP_CONF_H */
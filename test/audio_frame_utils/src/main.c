@@ -0,0 +1,322 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+/* System headers */
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__XS3A__)
+#include <xcore/hwtimer.h>
+#define TICKS_UNIT "ticks"
+#define BENCH_CHECK_TIMING 1
+#else
+/* Host build, see README.md. Host timings are reported but not checked. */
+#include <time.h>
+#define TICKS_UNIT "ns"
+#define BENCH_CHECK_TIMING 0
+static uint32_t get_reference_time(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec);
+}
+#endif
+
+/* App headers */
+#include "app_conf.h"
+#include "audio_frame_utils.h"
+
+#define TEST_PRINTF(fmt, ...)       printf((fmt), ##__VA_ARGS__)
+
+#define SENTINEL_S16    ((int16_t)0x5a5a)
+#define SENTINEL_S32    ((int32_t)0x5a5a5a5a)
+
+static uint32_t error_count = 0;
+static uint32_t seed = 0x12345678;
+
+static int16_t usb_s16[2][TEST_MAX_FRAME_COUNT * TEST_MAX_CHANNELS];
+static int32_t usb_s32[2][TEST_MAX_FRAME_COUNT * TEST_MAX_CHANNELS];
+static int32_t chan_s32[2][TEST_MAX_CHANNELS * TEST_MAX_FRAME_COUNT];
+
+static uint32_t rand_u32(void)
+{
+    seed = (seed * 1664525) + 1013904223;
+    return seed;
+}
+
+/*
+ * Reference implementations, these are the per sample loops previously used
+ * in the ASRC demo and FFVA USB audio paths. They are not inlined so the
+ * benchmark compares like with like.
+ */
+#define REF_FUNCTION static __attribute__((noinline)) void
+static inline int32_t volume_scale(const uint32_t mul, const int32_t samp)
+{
+    int64_t result = (int64_t)samp * (int64_t)mul;
+    return (int32_t)(result >> AUDIO_FRAME_GAIN_FRAC_BITS);
+}
+
+static uint32_t ref_gain(const uint32_t *gains, size_t ch)
+{
+    return (gains == NULL) ? AUDIO_FRAME_GAIN_UNITY : gains[ch];
+}
+
+REF_FUNCTION ref_deinterleave_s16(int32_t *dst, size_t dst_stride, const int16_t *src, size_t src_chans,
+                                 size_t num_chans, size_t frame_count, const uint32_t *gains)
+{
+    for (int ch = 0; ch < num_chans; ch++) {
+        for (int i = 0; i < frame_count; i++) {
+            dst[ch * dst_stride + i] = src[i * src_chans + ch] << 16;
+            dst[ch * dst_stride + i] = volume_scale(ref_gain(gains, ch), dst[ch * dst_stride + i]);
+        }
+    }
+}
+
+REF_FUNCTION ref_deinterleave_s32(int32_t *dst, size_t dst_stride, const int32_t *src, size_t src_chans,
+                                 size_t num_chans, size_t frame_count, const uint32_t *gains)
+{
+    for (int ch = 0; ch < num_chans; ch++) {
+        for (int i = 0; i < frame_count; i++) {
+            dst[ch * dst_stride + i] = volume_scale(ref_gain(gains, ch), src[i * src_chans + ch]);
+        }
+    }
+}
+
+REF_FUNCTION ref_interleave_s16(int16_t *dst, size_t dst_chans, const int32_t *src, size_t src_stride,
+                               size_t num_chans, size_t frame_count, const uint32_t *gains)
+{
+    for (int i = 0; i < frame_count; i++) {
+        for (int ch = 0; ch < num_chans; ch++) {
+            dst[i * dst_chans + ch] = volume_scale(ref_gain(gains, ch), src[ch * src_stride + i]) >> 16;
+        }
+    }
+}
+
+REF_FUNCTION ref_interleave_s32(int32_t *dst, size_t dst_chans, const int32_t *src, size_t src_stride,
+                               size_t num_chans, size_t frame_count, const uint32_t *gains)
+{
+    for (int i = 0; i < frame_count; i++) {
+        for (int ch = 0; ch < num_chans; ch++) {
+            dst[i * dst_chans + ch] = volume_scale(ref_gain(gains, ch), src[ch * src_stride + i]);
+        }
+    }
+}
+
+REF_FUNCTION ref_gain_interleaved_s16(int16_t *dst, size_t dst_chans, const int32_t *src, size_t src_chans,
+                                     size_t num_chans, size_t frame_count, const uint32_t *gains)
+{
+    for (int i = 0; i < frame_count; i++) {
+        for (int ch = 0; ch < num_chans; ch++) {
+            dst[i * dst_chans + ch] = volume_scale(ref_gain(gains, ch), src[i * src_chans + ch]) >> 16;
+        }
+    }
+}
+
+REF_FUNCTION ref_gain_interleaved_s32(int32_t *dst, size_t dst_chans, const int32_t *src, size_t src_chans,
+                                     size_t num_chans, size_t frame_count, const uint32_t *gains)
+{
+    for (int i = 0; i < frame_count; i++) {
+        for (int ch = 0; ch < num_chans; ch++) {
+            dst[i * dst_chans + ch] = volume_scale(ref_gain(gains, ch), src[i * src_chans + ch]);
+        }
+    }
+}
+
+/* The int32 to int16 loop previously used by the FFD intent engine */
+REF_FUNCTION ref_s32_to_s16(int16_t *dst, const int32_t *src, size_t frame_count)
+{
+    for (int i = 0; i < frame_count; i++) {
+        dst[i] = src[i] >> 16;
+    }
+}
+
+static void fill_inputs(void)
+{
+    for (int i = 0; i < TEST_MAX_FRAME_COUNT * TEST_MAX_CHANNELS; i++) {
+        uint32_t r = rand_u32();
+        usb_s16[0][i] = (int16_t)r;
+        usb_s32[0][i] = (int32_t)r;
+        chan_s32[0][i] = (int32_t)(r ^ 0xa5a5a5a5);
+    }
+    /* Full scale values */
+    usb_s16[0][0] = INT16_MIN;
+    usb_s16[0][1] = INT16_MAX;
+    usb_s32[0][0] = INT32_MIN;
+    usb_s32[0][1] = INT32_MAX;
+    chan_s32[0][0] = INT32_MIN;
+    chan_s32[0][1] = INT32_MAX;
+}
+
+static void check_s16(const char *name, size_t num_chans, size_t frame_count, const int16_t *expected, const int16_t *actual)
+{
+    if (memcmp(expected, actual, sizeof(usb_s16[0])) != 0) {
+        TEST_PRINTF("  - FAIL: %s num_chans=%u frame_count=%u\n", name, (unsigned)num_chans, (unsigned)frame_count);
+        error_count++;
+    }
+}
+
+static void check_s32(const char *name, size_t num_chans, size_t frame_count, const int32_t *expected, const int32_t *actual)
+{
+    if (memcmp(expected, actual, sizeof(chan_s32[0])) != 0) {
+        TEST_PRINTF("  - FAIL: %s num_chans=%u frame_count=%u\n", name, (unsigned)num_chans, (unsigned)frame_count);
+        error_count++;
+    }
+}
+
+static void clear_outputs(void)
+{
+    for (int i = 0; i < TEST_MAX_FRAME_COUNT * TEST_MAX_CHANNELS; i++) {
+        usb_s16[0][i] = usb_s16[1][i] = SENTINEL_S16;
+        usb_s32[0][i] = usb_s32[1][i] = SENTINEL_S32;
+        chan_s32[0][i] = chan_s32[1][i] = SENTINEL_S32;
+    }
+}
+
+/*
+ * Compares each function against its reference for one shape. Outputs are
+ * filled with a sentinel first so writes outside the selected channels are
+ * also caught.
+ */
+static void test_bit_exact(size_t usb_chans, size_t num_chans, size_t frame_count, const uint32_t *gains)
+{
+    static int16_t in_s16[TEST_MAX_FRAME_COUNT * TEST_MAX_CHANNELS];
+    static int32_t in_s32[TEST_MAX_FRAME_COUNT * TEST_MAX_CHANNELS];
+    static int32_t in_chan[TEST_MAX_CHANNELS * TEST_MAX_FRAME_COUNT];
+
+    fill_inputs();
+    memcpy(in_s16, usb_s16[0], sizeof(in_s16));
+    memcpy(in_s32, usb_s32[0], sizeof(in_s32));
+    memcpy(in_chan, chan_s32[0], sizeof(in_chan));
+
+    clear_outputs();
+    ref_deinterleave_s16(chan_s32[0], TEST_MAX_FRAME_COUNT, in_s16, usb_chans, num_chans, frame_count, gains);
+    audio_frame_deinterleave_s16(chan_s32[1], TEST_MAX_FRAME_COUNT, in_s16, usb_chans, num_chans, frame_count, gains);
+    check_s32("deinterleave_s16", num_chans, frame_count, chan_s32[0], chan_s32[1]);
+
+    clear_outputs();
+    ref_deinterleave_s32(chan_s32[0], TEST_MAX_FRAME_COUNT, in_s32, usb_chans, num_chans, frame_count, gains);
+    audio_frame_deinterleave_s32(chan_s32[1], TEST_MAX_FRAME_COUNT, in_s32, usb_chans, num_chans, frame_count, gains);
+    check_s32("deinterleave_s32", num_chans, frame_count, chan_s32[0], chan_s32[1]);
+
+    clear_outputs();
+    ref_interleave_s16(usb_s16[0], usb_chans, in_chan, TEST_MAX_FRAME_COUNT, num_chans, frame_count, gains);
+    audio_frame_interleave_s16(usb_s16[1], usb_chans, in_chan, TEST_MAX_FRAME_COUNT, num_chans, frame_count, gains);
+    check_s16("interleave_s16", num_chans, frame_count, usb_s16[0], usb_s16[1]);
+
+    clear_outputs();
+    ref_interleave_s32(usb_s32[0], usb_chans, in_chan, TEST_MAX_FRAME_COUNT, num_chans, frame_count, gains);
+    audio_frame_interleave_s32(usb_s32[1], usb_chans, in_chan, TEST_MAX_FRAME_COUNT, num_chans, frame_count, gains);
+    check_s32("interleave_s32", num_chans, frame_count, usb_s32[0], usb_s32[1]);
+
+    clear_outputs();
+    ref_gain_interleaved_s16(usb_s16[0], usb_chans, in_s32, num_chans, num_chans, frame_count, gains);
+    audio_frame_gain_interleaved_s16(usb_s16[1], usb_chans, in_s32, num_chans, num_chans, frame_count, gains);
+    check_s16("gain_interleaved_s16", num_chans, frame_count, usb_s16[0], usb_s16[1]);
+
+    clear_outputs();
+    ref_gain_interleaved_s32(usb_s32[0], usb_chans, in_s32, num_chans, num_chans, frame_count, gains);
+    audio_frame_gain_interleaved_s32(usb_s32[1], usb_chans, in_s32, num_chans, num_chans, frame_count, gains);
+    check_s32("gain_interleaved_s32", num_chans, frame_count, usb_s32[0], usb_s32[1]);
+
+    /* Word aligned and unaligned destinations */
+    for (int offset = 0; offset < 2; offset++) {
+        clear_outputs();
+        ref_s32_to_s16(&usb_s16[0][offset], in_s32, frame_count);
+        audio_frame_s32_to_s16(&usb_s16[1][offset], in_s32, frame_count);
+        check_s16("s32_to_s16", 1, frame_count, usb_s16[0], usb_s16[1]);
+    }
+}
+
+#define BENCH(name, ref_call, opt_call) \
+    do { \
+        uint32_t ref_ticks = 0; \
+        uint32_t opt_ticks = 0; \
+        for (int iter = 0; iter < TEST_BENCH_ITERATIONS; iter++) { \
+            uint32_t start = get_reference_time(); \
+            ref_call; \
+            uint32_t mid = get_reference_time(); \
+            opt_call; \
+            uint32_t end = get_reference_time(); \
+            ref_ticks += mid - start; \
+            opt_ticks += end - mid; \
+        } \
+        TEST_PRINTF("BENCH: %s ref=%lu opt=%lu %s\n", (name), \
+                    (unsigned long)(ref_ticks / TEST_BENCH_ITERATIONS), \
+                    (unsigned long)(opt_ticks / TEST_BENCH_ITERATIONS), TICKS_UNIT); \
+        if (BENCH_CHECK_TIMING && (opt_ticks > ref_ticks)) { \
+            TEST_PRINTF("  - FAIL: %s slower than the scalar loops\n", (name)); \
+            error_count++; \
+        } \
+    } while (0)
+
+static void benchmark(const uint32_t *gains, const char *suffix)
+{
+    const size_t ch = TEST_BENCH_CHANNELS;
+    const size_t n = TEST_BENCH_FRAME_COUNT;
+    char name[48];
+
+    fill_inputs();
+
+    snprintf(name, sizeof(name), "deinterleave_s16%s", suffix);
+    BENCH(name,
+          ref_deinterleave_s16(chan_s32[1], n, usb_s16[0], ch, ch, n, gains),
+          audio_frame_deinterleave_s16(chan_s32[1], n, usb_s16[0], ch, ch, n, gains));
+
+    snprintf(name, sizeof(name), "interleave_s32%s", suffix);
+    BENCH(name,
+          ref_interleave_s32(usb_s32[1], ch, chan_s32[0], n, ch, n, gains),
+          audio_frame_interleave_s32(usb_s32[1], ch, chan_s32[0], n, ch, n, gains));
+
+    snprintf(name, sizeof(name), "gain_interleaved_s16%s", suffix);
+    BENCH(name,
+          ref_gain_interleaved_s16(usb_s16[1], ch, usb_s32[0], ch, ch, n, gains),
+          audio_frame_gain_interleaved_s16(usb_s16[1], ch, usb_s32[0], ch, ch, n, gains));
+}
+
+static void benchmark_asr_brick(void)
+{
+    const size_t n = TEST_BENCH_ASR_BRICK_COUNT;
+
+    fill_inputs();
+
+    BENCH("s32_to_s16",
+          ref_s32_to_s16(usb_s16[1], usb_s32[0], n),
+          audio_frame_s32_to_s16(usb_s16[1], usb_s32[0], n));
+}
+
+int main(void)
+{
+    const size_t frame_counts[] = {1, 3, 4, 5, 96, 240, 244, TEST_MAX_FRAME_COUNT};
+    uint32_t gains[TEST_MAX_CHANNELS];
+    uint32_t bench_gains[TEST_BENCH_CHANNELS];
+
+    for (size_t usb_chans = 1; usb_chans <= TEST_MAX_CHANNELS; usb_chans++) {
+        for (size_t num_chans = 1; num_chans <= usb_chans; num_chans++) {
+            for (int f = 0; f < sizeof(frame_counts) / sizeof(frame_counts[0]); f++) {
+                /* Unity, muted and random attenuations on different channels */
+                for (int ch = 0; ch < TEST_MAX_CHANNELS; ch++) {
+                    uint32_t r = rand_u32();
+                    gains[ch] = (ch % 3 == 0) ? AUDIO_FRAME_GAIN_UNITY : (ch % 3 == 1) ? 0 : (r % AUDIO_FRAME_GAIN_UNITY);
+                }
+                test_bit_exact(usb_chans, num_chans, frame_counts[f], NULL);
+                test_bit_exact(usb_chans, num_chans, frame_counts[f], gains);
+            }
+        }
+    }
+
+    benchmark(NULL, "");
+    for (int ch = 0; ch < TEST_BENCH_CHANNELS; ch++) {
+        bench_gains[ch] = TEST_BENCH_GAIN;
+    }
+    benchmark(bench_gains, "_gain");
+    benchmark_asr_brick();
+
+    if (error_count == 0) {
+        TEST_PRINTF("\nTEST: PASS\n");
+    } else {
+        TEST_PRINTF("\nTEST: FAILED (Error Count = %ld)\n", (long)error_count);
+    }
+
+    return 0;
+}
@@ -0,0 +1,36 @@
+#!/usr/bin/env python3
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+import re
+
+test_results_filename = "testing/test.rpt"
+test_regex = r"^TEST:\s+(\w+)"
+bench_regex = r"^BENCH:\s+(\w+)\s+ref=(\d+)\s+opt=(\d+)"
+
+def test_results():
+    with open(test_results_filename, "r") as f:
+        cnt = 0
+        while 1:
+            line = f.readline()
+
+            if len(line) == 0:
+                assert cnt == 1
+                break
+
+            p = re.match(test_regex, line)
+
+            if p:
+                cnt += 1
+                assert p.group(1).find("PASS") != -1
+
+def test_benchmark():
+    with open(test_results_filename, "r") as f:
+        results = [re.match(bench_regex, line) for line in f]
+    results = [p for p in results if p]
+
+    # 3 functions, with and without gain, and the ASR brick conversion
+    assert len(results) == 7
+    for p in results:
+        print(f"{p.group(1)}: {p.group(2)} -> {p.group(3)} ticks")
+        assert int(p.group(3)) <= int(p.group(2))
@@ -0,0 +1,377 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+/*
+ * Host simulation of a DFU download into the FFVA flash. Models the time the
+ * host takes to send each block and poll the status, the time the flash
+ * takes to read, erase and program a sector, and the USB task and DFU writer
+ * task on the device. Compares the original synchronous download callback
+ * with the buffered DFU writer, and checks the flash contents afterwards.
+ * The download can be abandoned part way, as on a USB reset.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dfu_writer.h"
+
+#define SECTOR_SIZE         4096
+#define MAX_BUFFERS         16
+
+typedef struct {
+    unsigned image_bytes;   /* Image size */
+    unsigned spare_sectors; /* Sectors in the region after the image */
+    double xfer_us;         /* Host sends one block */
+    double status_us;       /* One status request */
+    double copy_us;         /* Copy one block into a block buffer */
+    double read_us;         /* Read one sector */
+    double erase_us;        /* Erase one sector */
+    double program_us;      /* Program one sector */
+    unsigned poll_ms;       /* bwPollTimeout while the flash is busy */
+    unsigned buffers;       /* Block buffers */
+    bool erase_ahead;
+    unsigned abort_after;   /* Blocks sent before the download is abandoned, 0 to complete it */
+} sim_config_t;
+
+typedef struct {
+    uint8_t *mem;
+    double *now;            /* Clock of the task using the flash */
+} sim_flash_t;
+
+typedef struct {
+    double total_us;
+    double max_cb_us;
+    dfu_writer_stats_t stats;
+    bool contents_ok;
+} sim_result_t;
+
+static const sim_config_t *cfg;
+
+/* Bytes of the image written before the download completes or is abandoned */
+static unsigned download_bytes(void)
+{
+    if (cfg->abort_after != 0 && cfg->abort_after * SECTOR_SIZE < cfg->image_bytes) {
+        return cfg->abort_after * SECTOR_SIZE;
+    }
+    return cfg->image_bytes;
+}
+
+static void sim_read(void *ctx, uint8_t *data, unsigned addr, size_t len)
+{
+    sim_flash_t *flash = ctx;
+    memcpy(data, &flash->mem[addr], len);
+    *flash->now += cfg->read_us * len / SECTOR_SIZE;
+}
+
+static void sim_erase(void *ctx, unsigned addr, size_t len)
+{
+    sim_flash_t *flash = ctx;
+    memset(&flash->mem[addr], 0xFF, len);
+    *flash->now += cfg->erase_us * len / SECTOR_SIZE;
+}
+
+static void sim_write(void *ctx, const uint8_t *data, unsigned addr, size_t len)
+{
+    sim_flash_t *flash = ctx;
+    for (size_t i = 0; i < len; i++) {
+        flash->mem[addr + i] &= data[i];    /* Programming only clears bits */
+    }
+    *flash->now += cfg->program_us * len / SECTOR_SIZE;
+}
+
+/* Time the host next sees the result of a status request made at t, for a
+ * request the device finishes at finish. The USB task is busy in the callback
+ * until cb_end, and the host polls again after the poll timeout. */
+static double host_wait(double t, double cb_end, double finish, double poll_us)
+{
+    double p = ((t + poll_us) > cb_end ? (t + poll_us) : cb_end) + cfg->status_us;
+    while (p < finish) {
+        p += poll_us + cfg->status_us;
+    }
+    return p;
+}
+
+/* The original download callback: read back, erase and program each sector
+ * in the USB task */
+static void run_sync(sim_flash_t *flash, const uint8_t *image, unsigned base, sim_result_t *result)
+{
+    static uint8_t tmp_buf[SECTOR_SIZE];
+    double t = 0;
+
+    for (unsigned addr = 0; addr < download_bytes(); addr += SECTOR_SIZE) {
+        unsigned len = (cfg->image_bytes - addr < SECTOR_SIZE) ? cfg->image_bytes - addr : SECTOR_SIZE;
+
+        t += cfg->xfer_us + cfg->status_us;
+        double cb = t;
+        flash->now = &cb;
+        sim_read(flash, tmp_buf, base + addr, SECTOR_SIZE);
+        memcpy(tmp_buf, &image[addr], len);
+        sim_erase(flash, base + addr, SECTOR_SIZE);
+        sim_write(flash, tmp_buf, base + addr, SECTOR_SIZE);
+        if (cb - t > result->max_cb_us) {
+            result->max_cb_us = cb - t;
+        }
+        t = host_wait(t, cb, cb, 10000.0);
+        result->stats.sectors++;
+        result->stats.reads++;
+    }
+
+    /* Zero length download, then the manifest stage */
+    t += 2 * cfg->status_us;
+    result->total_us = t;
+}
+
+typedef struct {
+    unsigned addr;
+    unsigned offset;        /* Offset in the image */
+    unsigned len;
+    double arrival;
+    double done;
+    bool deferred;
+} sim_block_t;
+
+static dfu_writer_t writer;
+static double writer_now;
+static sim_block_t *blocks;
+static unsigned queued;     /* Blocks given to the writer task */
+static unsigned programmed; /* Blocks the writer task has programmed */
+
+/* Run the writer task until it has started every operation it would start
+ * before t_limit */
+static void writer_run(const uint8_t *image, double t_limit)
+{
+    for (;;) {
+        if (programmed < queued && blocks[programmed].arrival <= writer_now) {
+            sim_block_t *b = &blocks[programmed];
+            dfu_writer_program(&writer, b->addr, &image[b->offset], b->len);
+            b->done = writer_now;
+            programmed++;
+            continue;
+        }
+        double idle_until = (programmed < queued) ? blocks[programmed].arrival : t_limit;
+        if (writer_now >= idle_until) {
+            break;
+        }
+        if (!dfu_writer_erase_ahead(&writer)) {
+            writer_now = idle_until;
+            if (programmed == queued) {
+                break;
+            }
+        }
+    }
+}
+
+/* Run the writer task until it has programmed every block given to it */
+static void writer_drain(const uint8_t *image)
+{
+    if (programmed < queued) {
+        writer_run(image, blocks[queued - 1].arrival);
+    }
+}
+
+static void run_buffered(sim_flash_t *flash, const uint8_t *image, unsigned base, sim_result_t *result)
+{
+    static uint8_t spare[SECTOR_SIZE];
+    unsigned block_count = (download_bytes() + SECTOR_SIZE - 1) / SECTOR_SIZE;
+    dfu_writer_flash_t ops = { sim_read, sim_erase, sim_write, flash };
+    double poll_us = cfg->poll_ms * 1000.0;
+    double t = 0;
+
+    blocks = calloc(block_count, sizeof(sim_block_t));
+    queued = programmed = 0;
+    writer_now = 0;
+    flash->now = &writer_now;
+    dfu_writer_init(&writer, &ops, SECTOR_SIZE, spare, cfg->erase_ahead);
+    dfu_writer_start(&writer, base, base + cfg->image_bytes + cfg->spare_sectors * SECTOR_SIZE);
+
+    for (unsigned i = 0; i < block_count; i++) {
+        unsigned addr = i * SECTOR_SIZE;
+        sim_block_t *b = &blocks[i];
+
+        t += cfg->xfer_us + cfg->status_us;
+        writer_run(image, t);
+
+        unsigned in_use = 0;
+        for (unsigned j = 0; j < i; j++) {
+            if (!blocks[j].deferred && (j >= programmed || blocks[j].done > t)) {
+                in_use++;
+            }
+        }
+
+        b->addr = base + addr;
+        b->offset = addr;
+        b->len = (cfg->image_bytes - addr < SECTOR_SIZE) ? cfg->image_bytes - addr : SECTOR_SIZE;
+        b->deferred = (in_use >= cfg->buffers);
+        double cb = b->deferred ? 0 : cfg->copy_us;
+        b->arrival = t + cb;
+        queued++;
+        if (cb > result->max_cb_us) {
+            result->max_cb_us = cb;
+        }
+
+        if (b->deferred) {
+            writer_drain(image);
+            t = host_wait(t, t + cb, b->done, poll_us);
+        } else {
+            t = host_wait(t, t + cb, t + cb, 0);
+        }
+    }
+
+    if (download_bytes() < cfg->image_bytes) {
+        /* The host goes away. The writer task erases ahead while idle, then the reset finishes the image */
+        writer_run(image, t + cfg->erase_us);
+        writer_drain(image);
+        if (writer_now < t) {
+            writer_now = t;
+        }
+        dfu_writer_finish(&writer);
+        result->total_us = t;
+        result->stats = writer.stats;
+        free(blocks);
+        return;
+    }
+
+    /* Zero length download, then the manifest stage waits for the writer task */
+    t += cfg->status_us;
+    writer_drain(image);
+    if (writer_now < t) {
+        writer_now = t;
+    }
+    dfu_writer_finish(&writer);
+    t = host_wait(t, t, writer_now, poll_us);
+
+    result->total_us = t;
+    result->stats = writer.stats;
+    free(blocks);
+}
+
+static void run(bool buffered, const uint8_t *image, const uint8_t *old, size_t flash_size, unsigned base,
+                sim_result_t *result)
+{
+    sim_flash_t flash;
+
+    memset(result, 0, sizeof(*result));
+    flash.mem = malloc(flash_size);
+    memcpy(flash.mem, old, flash_size);
+
+    if (buffered) {
+        run_buffered(&flash, image, base, result);
+    } else {
+        run_sync(&flash, image, base, result);
+    }
+
+    unsigned written = download_bytes();
+    result->contents_ok =
+        memcmp(flash.mem, old, base) == 0 &&
+        memcmp(&flash.mem[base], image, written) == 0 &&
+        memcmp(&flash.mem[base + written], &old[base + written], flash_size - base - written) == 0;
+    free(flash.mem);
+}
+
+static void print_result(const char *name, const sim_result_t *r)
+{
+    printf("%-9s total %8.1f ms  longest callback %8.1f us  sectors %u  read back %u  erased ahead %u used %u restored %u  contents %s\n",
+           name, r->total_us / 1000, r->max_cb_us, (unsigned) r->stats.sectors, (unsigned) r->stats.reads,
+           (unsigned) r->stats.erase_aheads, (unsigned) r->stats.erase_ahead_hits, (unsigned) r->stats.restores,
+           r->contents_ok ? "OK" : "MISMATCH");
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  --image-bytes N    image size (default 1000000)\n"
+            "  --spare-sectors N  sectors in the region after the image (default 4)\n"
+            "  --xfer-us T        host sends one 4 KiB block (default 4000)\n"
+            "  --status-us T      one status request (default 1000)\n"
+            "  --copy-us T        copy one block into a buffer (default 20)\n"
+            "  --read-us T        read one sector (default 200)\n"
+            "  --erase-us T       erase one sector (default 45000)\n"
+            "  --program-us T     program one sector (default 11200)\n"
+            "  --poll-ms N        poll timeout while the flash is busy (default 10)\n"
+            "  --buffers N        block buffers (default 2)\n"
+            "  --no-erase-ahead   disable erase ahead\n"
+            "  --abort-after N    abandon the download after N blocks, as on a USB reset (default 0, complete it)\n", prog);
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    static sim_config_t config = {
+        .image_bytes = 1000000,
+        .spare_sectors = 4,
+        .xfer_us = 4000,
+        .status_us = 1000,
+        .copy_us = 20,
+        .read_us = 200,
+        .erase_us = 45000,
+        .program_us = 11200,
+        .poll_ms = 10,
+        .buffers = 2,
+        .erase_ahead = true,
+    };
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (strcmp(arg, "--no-erase-ahead") == 0) {
+            config.erase_ahead = false;
+            continue;
+        }
+        if (val == NULL) {
+            usage(argv[0]);
+        }
+        i++;
+        if (strcmp(arg, "--image-bytes") == 0)          config.image_bytes = strtoul(val, NULL, 0);
+        else if (strcmp(arg, "--spare-sectors") == 0)   config.spare_sectors = strtoul(val, NULL, 0);
+        else if (strcmp(arg, "--xfer-us") == 0)         config.xfer_us = atof(val);
+        else if (strcmp(arg, "--status-us") == 0)       config.status_us = atof(val);
+        else if (strcmp(arg, "--copy-us") == 0)         config.copy_us = atof(val);
+        else if (strcmp(arg, "--read-us") == 0)         config.read_us = atof(val);
+        else if (strcmp(arg, "--erase-us") == 0)        config.erase_us = atof(val);
+        else if (strcmp(arg, "--program-us") == 0)      config.program_us = atof(val);
+        else if (strcmp(arg, "--poll-ms") == 0)         config.poll_ms = strtoul(val, NULL, 0);
+        else if (strcmp(arg, "--buffers") == 0)         config.buffers = strtoul(val, NULL, 0);
+        else if (strcmp(arg, "--abort-after") == 0)     config.abort_after = strtoul(val, NULL, 0);
+        else usage(argv[0]);
+    }
+    if (config.image_bytes == 0 || config.buffers > MAX_BUFFERS) {
+        usage(argv[0]);
+    }
+    cfg = &config;
+
+    /* One sector before the region, the image, the spare sectors and one sector after the region */
+    unsigned base = SECTOR_SIZE;
+    size_t flash_size = base + (size_t) ((config.image_bytes + SECTOR_SIZE - 1) / SECTOR_SIZE + config.spare_sectors + 1) * SECTOR_SIZE;
+    uint8_t *old = malloc(flash_size);
+    uint8_t *image = malloc(config.image_bytes);
+    srand(1);
+    for (size_t i = 0; i < flash_size; i++) {
+        old[i] = rand();
+    }
+    for (size_t i = 0; i < config.image_bytes; i++) {
+        image[i] = rand();
+    }
+
+    sim_result_t sync, buffered;
+    run(false, image, old, flash_size, base, &sync);
+    run(true, image, old, flash_size, base, &buffered);
+
+    print_result("sync", &sync);
+    print_result("buffered", &buffered);
+    printf("speedup %.2fx\n", sync.total_us / buffered.total_us);
+
+    free(old);
+    free(image);
+    /* A complete download ends with a short block or at the end of the image, so nothing is erased past it */
+    bool erased_past_image = (download_bytes() == config.image_bytes) && (buffered.stats.restores != 0);
+    if (erased_past_image) {
+        printf("buffered erased past the end of the image\n");
+    }
+
+    return (sync.contents_ok && buffered.contents_ok && !erased_past_image) ? 0 : 1;
+}
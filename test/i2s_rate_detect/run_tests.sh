@@ -0,0 +1,25 @@
+#!/bin/bash
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+set -e
+
+REPO_ROOT=$(git rev-parse --show-toplevel)
+TEST_DIR=${REPO_ROOT}/test/i2s_rate_detect
+BUILD_DIR=${TEST_DIR}/build
+REPORT_DIR=testing
+REPORT=testing/test.rpt
+
+rm -rf "${REPORT_DIR}"
+mkdir testing
+
+echo "****************"
+echo "* Build        *"
+echo "****************"
+cmake -S "${TEST_DIR}" -B "${BUILD_DIR}"
+cmake --build "${BUILD_DIR}" -j8
+
+echo "****************"
+echo "* Run Tests    *"
+echo "****************"
+"${BUILD_DIR}/test_i2s_rate_detect" 2>&1 | tee -a "${REPORT}"
@@ -0,0 +1,267 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+// Feeds synthetic I2S frame timestamps with jitter, clock offsets, rate steps and glitches to the rate detector
+// of the ASRC demo I2S driver and measures the time to detect and the misclassification rate. The fixed window
+// detector the driver used before is run on the same timestamps for comparison.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "i2s_rate_detect.h"
+
+#define NUM_RATES           6
+#define TRIALS              20
+#define TRIAL_FRAMES        2048
+#define MAX_DETECT_FRAMES   64          // Required time to detect for jitter up to MAX_TESTED_JITTER
+#define MAX_STEP_FRAMES     128         // Required time to detect a rate step without a restart
+#define MAX_TESTED_JITTER   100
+#define START_TICKS         0xffff0000u // Timestamps wrap early in each trial
+
+static const uint32_t rates[NUM_RATES] = {44100, 48000, 88200, 96000, 176400, 192000};
+static const int jitters[] = {0, 10, 50, 100, 250};
+static const int ppms[] = {-200, 0, 200};
+
+static uint32_t rand_state;
+
+static double rand_uniform(void)
+{
+    rand_state = rand_state * 1664525 + 1013904223;
+    return (double)(rand_state >> 8) / (double)(1 << 24);
+}
+
+// Frame timestamp source with a clock offset in ppm and uniform jitter of +-jitter ticks on every timestamp
+typedef struct
+{
+    double time;
+    double period;
+    int jitter;
+}source_t;
+
+static void source_init(source_t *src, uint32_t rate, int ppm, int jitter)
+{
+    src->time = 0;
+    src->period = (double)I2S_RATE_DETECT_REF_CLOCK_HZ / (rate * (1.0 + ppm * 1e-6));
+    src->jitter = jitter;
+}
+
+static uint32_t source_next(source_t *src)
+{
+    src->time += src->period;
+    double j = src->jitter ? (2 * rand_uniform() - 1) * src->jitter : 0;
+    return START_TICKS + (uint32_t)(int64_t)llround(src->time + j);
+}
+
+// The detector used before, the average over 256 frames must be within 5 ticks of a nominal period
+typedef struct
+{
+    uint32_t frames;
+    uint32_t sum;
+    uint32_t prev;
+    uint32_t rate;
+    int failed;
+}legacy_t;
+
+static void legacy_update(legacy_t *lg, uint32_t timestamp)
+{
+    static const uint32_t ticks[NUM_RATES] = {2267, 2083, 1133, 1041, 566, 520};
+    if(lg->frames > 0 && lg->rate == 0 && !lg->failed)
+    {
+        lg->sum += timestamp - lg->prev;
+        if(lg->frames == 256)
+        {
+            uint32_t avg = lg->sum >> 8;
+            lg->failed = 1;     // The driver asserted when nothing matched
+            for(int i = 0; i < NUM_RATES; i++)
+            {
+                if(avg >= ticks[i] - 5 && avg <= ticks[i] + 5)
+                {
+                    lg->rate = rates[i];
+                    lg->failed = 0;
+                }
+            }
+        }
+    }
+    lg->prev = timestamp;
+    lg->frames += 1;
+}
+
+static int check_detect(void)
+{
+    int pass = 1;
+    for(unsigned j = 0; j < sizeof(jitters) / sizeof(jitters[0]); j++)
+    {
+        for(int r = 0; r < NUM_RATES; r++)
+        {
+            for(unsigned p = 0; p < sizeof(ppms) / sizeof(ppms[0]); p++)
+            {
+                uint32_t max_frames = 0;
+                uint32_t total_frames = 0;
+                uint32_t undetected = 0;
+                uint32_t misclassified = 0;
+                uint32_t legacy_frames = 0;
+                uint32_t legacy_failed = 0;
+
+                for(int t = 0; t < TRIALS; t++)
+                {
+                    i2s_rate_detect_t rd;
+                    legacy_t lg = {0};
+                    source_t src;
+                    rand_state = 1 + t;
+                    i2s_rate_detect_init(&rd);
+                    source_init(&src, rates[r], ppms[p], jitters[j]);
+
+                    uint32_t detect_frame = 0;
+                    uint32_t legacy_frame = 0;
+                    for(uint32_t f = 1; f <= TRIAL_FRAMES; f++)
+                    {
+                        uint32_t ts = source_next(&src);
+                        uint32_t rate = i2s_rate_detect_update(&rd, ts);
+                        legacy_update(&lg, ts);
+                        if(rate != 0 && rate != rates[r])
+                        {
+                            misclassified++;
+                        }
+                        if(rate == rates[r] && detect_frame == 0)
+                        {
+                            detect_frame = f;
+                        }
+                        if(lg.rate != 0 && legacy_frame == 0)
+                        {
+                            legacy_frame = f;
+                        }
+                    }
+                    if(detect_frame == 0)
+                    {
+                        undetected++;
+                        detect_frame = TRIAL_FRAMES;
+                    }
+                    max_frames = (detect_frame > max_frames) ? detect_frame : max_frames;
+                    total_frames += detect_frame;
+                    if(lg.failed || lg.rate != rates[r])
+                    {
+                        legacy_failed++;
+                    }
+                    legacy_frames = (legacy_frame > legacy_frames) ? legacy_frame : legacy_frames;
+                }
+
+                printf("DETECT: rate=%lu jitter=%d ppm=%d trials=%d max_frames=%lu mean_frames=%lu max_us=%lu undetected=%lu misclassified=%lu legacy_frames=%lu legacy_failed=%lu\n",
+                       (unsigned long)rates[r], jitters[j], ppms[p], TRIALS, (unsigned long)max_frames,
+                       (unsigned long)(total_frames / TRIALS), (unsigned long)(((uint64_t)max_frames * 1000000) / rates[r]),
+                       (unsigned long)undetected, (unsigned long)misclassified, (unsigned long)legacy_frames,
+                       (unsigned long)legacy_failed);
+
+                // Every trial detects the rate, no slower than the legacy detector, at every jitter level
+                pass &= (misclassified == 0 && undetected == 0 && legacy_failed == 0 && max_frames <= legacy_frames);
+                if(jitters[j] <= MAX_TESTED_JITTER)
+                {
+                    pass &= (max_frames <= MAX_DETECT_FRAMES);
+                }
+            }
+        }
+    }
+    return pass;
+}
+
+// Step between every pair of rates without restarting the detector, as when the source switches without the
+// I2S slave losing sync
+static int check_steps(void)
+{
+    int pass = 1;
+    const int jitter = 50;
+    for(int from = 0; from < NUM_RATES; from++)
+    {
+        for(int to = 0; to < NUM_RATES; to++)
+        {
+            if(from == to)
+            {
+                continue;
+            }
+            i2s_rate_detect_t rd;
+            source_t src;
+            rand_state = 1;
+            i2s_rate_detect_init(&rd);
+            source_init(&src, rates[from], 0, jitter);
+            for(int f = 0; f < TRIAL_FRAMES; f++)
+            {
+                i2s_rate_detect_update(&rd, source_next(&src));
+            }
+
+            double step_time = src.time;
+            source_init(&src, rates[to], 0, jitter);
+            src.time = step_time;
+            uint32_t detect_frame = 0;
+            uint32_t misclassified = 0;
+            for(uint32_t f = 1; f <= TRIAL_FRAMES; f++)
+            {
+                uint32_t rate = i2s_rate_detect_update(&rd, source_next(&src));
+                if(rate != rates[to] && rate != rates[from])
+                {
+                    misclassified++;
+                }
+                if(rate == rates[to] && detect_frame == 0)
+                {
+                    detect_frame = f;
+                }
+                if(detect_frame != 0 && rate != rates[to])
+                {
+                    misclassified++;
+                }
+            }
+            printf("STEP: from=%lu to=%lu jitter=%d frames=%lu misclassified=%lu\n", (unsigned long)rates[from],
+                   (unsigned long)rates[to], jitter, (unsigned long)detect_frame, (unsigned long)misclassified);
+            pass &= (detect_frame != 0 && detect_frame <= MAX_STEP_FRAMES && misclassified == 0);
+        }
+    }
+    return pass;
+}
+
+// A missed frame and a clock stop must not change the reported rate
+static int check_glitches(void)
+{
+    int pass = 1;
+    for(int r = 0; r < NUM_RATES; r++)
+    {
+        i2s_rate_detect_t rd;
+        source_t src;
+        rand_state = 1;
+        i2s_rate_detect_init(&rd);
+        source_init(&src, rates[r], 0, 50);
+
+        uint32_t changes = 0;
+        uint32_t prev_rate = 0;
+        for(int f = 0; f < TRIAL_FRAMES; f++)
+        {
+            if(f == 1024)
+            {
+                src.time += src.period;     // Missed frame
+            }
+            if(f == 1536)
+            {
+                src.time += 1000000;        // 10ms clock stop
+            }
+            uint32_t rate = i2s_rate_detect_update(&rd, source_next(&src));
+            if(prev_rate != 0 && rate != prev_rate)
+            {
+                changes++;
+            }
+            prev_rate = rate;
+        }
+        printf("GLITCH: rate=%lu changes=%lu glitches=%lu final=%lu\n", (unsigned long)rates[r], (unsigned long)changes,
+               (unsigned long)rd.glitches, (unsigned long)prev_rate);
+        pass &= (changes == 0 && prev_rate == rates[r] && rd.glitches >= 1);
+    }
+    return pass;
+}
+
+int main(void)
+{
+    int pass = 1;
+    pass &= check_detect();
+    pass &= check_steps();
+    pass &= check_glitches();
+    printf("TEST: %s\n", pass ? "PASS" : "FAIL");
+    return pass ? 0 : 1;
+}
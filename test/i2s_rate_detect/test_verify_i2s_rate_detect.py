@@ -0,0 +1,52 @@
+#!/usr/bin/env python3
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+import re
+
+test_results_filename = "testing/test.rpt"
+test_regex = r"^TEST:\s+(\w+)"
+detect_regex = r"^DETECT:\s+rate=(\d+)\s+jitter=(\d+)\s+ppm=(-?\d+)\s+trials=(\d+)\s+max_frames=(\d+)\s+mean_frames=(\d+)\s+max_us=(\d+)\s+undetected=(\d+)\s+misclassified=(\d+)\s+legacy_frames=(\d+)\s+legacy_failed=(\d+)"
+step_regex = r"^STEP:\s+from=(\d+)\s+to=(\d+)\s+jitter=(\d+)\s+frames=(\d+)\s+misclassified=(\d+)"
+glitch_regex = r"^GLITCH:\s+rate=(\d+)\s+changes=(\d+)\s+glitches=(\d+)\s+final=(\d+)"
+max_tested_jitter = 100
+
+def read_results(regex):
+    with open(test_results_filename, "r") as f:
+        results = [re.match(regex, line) for line in f]
+    return [p for p in results if p]
+
+def test_results():
+    results = read_results(test_regex)
+    assert len(results) == 1
+    assert results[0].group(1).find("PASS") != -1
+
+def test_detect():
+    results = read_results(detect_regex)
+    assert len(results) > 0
+    for p in results:
+        rate, jitter, ppm = int(p.group(1)), int(p.group(2)), int(p.group(3))
+        max_frames, legacy_frames = int(p.group(5)), int(p.group(10))
+        print(f"{rate} Hz, jitter {jitter}, {ppm} ppm: {max_frames} frames ({p.group(7)} us), legacy {legacy_frames} frames")
+        # At every jitter level the test runs, a wrong rate is never reported, every trial detects the rate and
+        # detection is no slower than the legacy detector
+        assert int(p.group(9)) == 0
+        assert int(p.group(8)) == 0
+        assert int(p.group(11)) == 0
+        assert max_frames <= legacy_frames
+        if jitter <= max_tested_jitter:
+            assert max_frames * 4 <= legacy_frames
+
+def test_steps():
+    results = read_results(step_regex)
+    assert len(results) == 30
+    for p in results:
+        assert int(p.group(4)) > 0
+        assert int(p.group(5)) == 0
+
+def test_glitches():
+    results = read_results(glitch_regex)
+    assert len(results) == 6
+    for p in results:
+        assert int(p.group(2)) == 0
+        assert p.group(1) == p.group(4)
@@ -0,0 +1,28 @@
+#!/bin/bash
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+set -e
+
+REPO_ROOT=$(git rev-parse --show-toplevel)
+TEST_DIR=${REPO_ROOT}/test/mic_aggregator_bench
+BUILD_DIR=${TEST_DIR}/build
+REPORT_DIR=testing
+REPORT=testing/test.rpt
+CONFIGS="spf1_mics16 spf8_mics16 spf1_mics32 spf8_mics32"
+
+rm -rf "${REPORT_DIR}"
+mkdir testing
+
+echo "****************"
+echo "* Build        *"
+echo "****************"
+cmake -S "${TEST_DIR}" -B "${BUILD_DIR}"
+cmake --build "${BUILD_DIR}" -j8
+
+echo "****************"
+echo "* Run Tests    *"
+echo "****************"
+for config in ${CONFIGS}; do
+    "${BUILD_DIR}/mic_aggregator_bench_sim_${config}" 2>&1 | tee -a "${REPORT}"
+done
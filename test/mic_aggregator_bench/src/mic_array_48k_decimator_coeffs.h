@@ -0,0 +1,10 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+// Host stand in for the lib_mic_array header included by the mic aggregator app_config.h.
+// Only the constants app_config.h uses for its configuration checks are provided.
+
+#pragma once
+
+#define MIC_ARRAY_CONFIG_STG2_DEC_FACTOR    2
+#define MIC_ARRAY_STAGE_2_NUM_TAPS          96
@@ -0,0 +1,194 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+// Discrete time model of the mic aggregator hub and TDM outputs in the benchmark build. The pattern generators,
+// the hub triple buffer and the TDM lanes are run against one timeline in MCLK cycles. The TDM lanes use the
+// playout logic of the app, tdm_lane.c, and the outputs are checked with the pattern checks of the app, bench.c.
+// The hub processing time, its jitter, the phase of the TDM frames and the TDM clock offset are parameters.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "app_main.h"
+#include "tdm_lane.h"
+#include "bench.h"
+
+#define SIM_MCLK_PER_SAMPLE     (MIC_ARRAY_CONFIG_MCLK_FREQ / MIC_ARRAY_CONFIG_OUT_SAMPLE_RATE)
+#define SIM_PPM_SCALE           1000000     // Times are held in millionths of an MCLK cycle so clock offsets in ppm are exact
+#define SIM_SAMPLE_PERIOD       ((int64_t)SIM_MCLK_PER_SAMPLE * SIM_PPM_SCALE)
+#define SIM_FRAME_PERIOD        (SIM_SAMPLE_PERIOD * MIC_ARRAY_CONFIG_SAMPLES_PER_FRAME)
+
+typedef struct sim_case_t{
+    const char *name;
+    int busy_percent;           // Hub processing time, percent of the frame period
+    int jitter_percent;         // Hub processing time varies by up to this much more
+    int phase_percent;          // Time of the first TDM frame after the first mic frame, percent of the frame period
+    int tdm_ppm;                // TDM clock offset from the mic clock, positive is faster
+    int seconds;
+} sim_case_t;
+
+typedef struct sim_result_t{
+    bench_timing_t hub;
+    bench_check_t lanes[TDM_SLAVE_NUM_LANES];
+    uint32_t gen_late;          // Frames the generator was blocked for more than a frame period and restarted its timing
+    int64_t min_slack;          // Time from the hub publishing a frame to a lane picking it up
+    int64_t max_slack;
+    uint32_t glitches;          // Lane frames with an error, repeat or skip
+} sim_result_t;
+
+static uint32_t sim_rand_state = 1;
+
+// Deterministic so the results are the same on every run
+static uint32_t sim_rand(void)
+{
+    sim_rand_state = sim_rand_state * 1664525 + 1013904223;
+    return sim_rand_state >> 8;
+}
+
+static uint32_t to_mclk(int64_t t)
+{
+    return (uint32_t)(t / SIM_PPM_SCALE);
+}
+
+static void sim_run(const sim_case_t *sc, sim_result_t *res)
+{
+    audio_frame_t audio_frames[NUM_AUDIO_BUFFERS];
+    audio_frame_t *read_buffer = NULL;
+    tdm_slave_lane_t lanes[TDM_SLAVE_NUM_LANES];
+    int32_t send_data[TDM_SLAVE_LANE_CHANS];
+
+    memset(audio_frames, 0, sizeof(audio_frames));
+    for(unsigned l = 0; l < TDM_SLAVE_NUM_LANES; l++){
+        tdm_lane_init(&lanes[l], &read_buffer, l);
+        bench_check_init(&res->lanes[l]);
+    }
+    bench_timing_init(&res->hub);
+    res->gen_late = 0;
+    res->min_slack = INT64_MAX;
+    res->max_slack = INT64_MIN;
+    sim_rand_state = 1;
+
+    const int64_t end = (int64_t)sc->seconds * MIC_ARRAY_CONFIG_MCLK_FREQ * SIM_PPM_SCALE;
+    const int64_t tdm_period = SIM_SAMPLE_PERIOD - (SIM_SAMPLE_PERIOD / SIM_PPM_SCALE) * sc->tdm_ppm;
+    const int64_t tdm_start = (SIM_FRAME_PERIOD * sc->phase_percent) / 100;
+
+    uint32_t seq = 0;               // Sample period of the next generated frame
+    int64_t gen_ready = 0;          // Time the next generated frame is sent
+    int64_t hub_free = 0;           // Time the hub is ready for the next frame
+    int64_t publish_time = -1;      // Time the frame being processed is published, -1 if none
+    int64_t last_publish = 0;
+    unsigned write_buffer_idx = 0;
+    int64_t tdm_next = tdm_start;
+
+    while(tdm_next < end){
+        int64_t hub_start = (gen_ready > hub_free) ? gen_ready : hub_free;
+
+        if(publish_time >= 0 && publish_time <= tdm_next && publish_time <= hub_start){
+            // Hub finishes the frame and passes it to the outputs
+            read_buffer = &audio_frames[write_buffer_idx];
+            last_publish = publish_time;
+            publish_time = -1;
+            if(++write_buffer_idx == NUM_AUDIO_BUFFERS){
+                write_buffer_idx = 0;
+            }
+        } else if(publish_time < 0 && hub_start <= tdm_next){
+            // Hub receives a frame. The buffer is written at the start of processing, the worst case for the outputs.
+            for(int s = 0; s < MIC_ARRAY_CONFIG_SAMPLES_PER_FRAME; s++){
+                for(int ch = 0; ch < MIC_ARRAY_CONFIG_MIC_COUNT; ch++){
+                    audio_frames[write_buffer_idx].data[s][ch] = BENCH_SAMPLE(seq + s, ch);
+                }
+            }
+            seq += MIC_ARRAY_CONFIG_SAMPLES_PER_FRAME;
+
+            int64_t busy = (SIM_FRAME_PERIOD * sc->busy_percent) / 100;
+            if(sc->jitter_percent){
+                busy += (int64_t)(sim_rand() % (sc->jitter_percent * 100)) * SIM_FRAME_PERIOD / 10000;
+            }
+            bench_timing_update(&res->hub, to_mclk(hub_start), to_mclk(busy), to_mclk(SIM_FRAME_PERIOD));
+            publish_time = hub_start + busy;
+            hub_free = publish_time;
+
+            // The generator is blocked until the hub takes the frame, as bench_source()
+            if(hub_start - gen_ready > SIM_FRAME_PERIOD){
+                res->gen_late++;
+                gen_ready = hub_start + SIM_FRAME_PERIOD;
+            } else {
+                gen_ready += SIM_FRAME_PERIOD;
+            }
+        } else {
+            // TDM frame on every lane
+            for(unsigned l = 0; l < TDM_SLAVE_NUM_LANES; l++){
+                if(lanes[l].sample_idx == 0 && read_buffer != NULL){
+                    int64_t slack = tdm_next - last_publish;
+                    res->min_slack = (slack < res->min_slack) ? slack : res->min_slack;
+                    res->max_slack = (slack > res->max_slack) ? slack : res->max_slack;
+                }
+                tdm_lane_send(&lanes[l], TDM_SLAVE_LANE_CHANS, send_data);
+                bench_check_frame(&res->lanes[l], send_data, lanes[l].first_ch, lanes[l].num_ch);
+            }
+            tdm_next += tdm_period;
+        }
+    }
+
+    res->glitches = 0;
+    for(unsigned l = 0; l < TDM_SLAVE_NUM_LANES; l++){
+        res->glitches += res->lanes[l].errors + res->lanes[l].repeats + res->lanes[l].skips;
+    }
+}
+
+static void sim_print(const sim_case_t *sc, const sim_result_t *res)
+{
+    printf("SIM: case=%s spf=%d mics=%d busy=%d%% jitter=%d%% phase=%d%% ppm=%d hub_frames=%u hub_max_busy=%u hub_missed=%u gen_late=%u slack=%u..%u",
+           sc->name, MIC_ARRAY_CONFIG_SAMPLES_PER_FRAME, MIC_ARRAY_CONFIG_MIC_COUNT, sc->busy_percent, sc->jitter_percent,
+           sc->phase_percent, sc->tdm_ppm, res->hub.frames, res->hub.max_busy_ticks, res->hub.missed, res->gen_late,
+           to_mclk(res->min_slack), to_mclk(res->max_slack));
+    for(unsigned l = 0; l < TDM_SLAVE_NUM_LANES; l++){
+        printf(" lane%u=%u/%u/%u/%u", l, res->lanes[l].frames, res->lanes[l].errors, res->lanes[l].repeats, res->lanes[l].skips);
+    }
+    printf("\n");
+}
+
+int main(int argc, char *argv[])
+{
+    sim_result_t res;
+
+    // Custom case: busy_percent jitter_percent phase_percent tdm_ppm seconds
+    if(argc == 6){
+        sim_case_t sc = {"custom", atoi(argv[1]), atoi(argv[2]), atoi(argv[3]), atoi(argv[4]), atoi(argv[5])};
+        sim_run(&sc, &res);
+        sim_print(&sc, &res);
+        return 0;
+    }
+
+    // The hub publishes between 50% and 80% of the frame period after each mic frame
+    const sim_case_t locked = {"locked", 50, 30, 90, 0, 2};
+    const sim_case_t early_read = {"early_read", 50, 30, 60, 0, 2};
+    const sim_case_t overload = {"overload", 110, 10, 90, 0, 2};
+    const sim_case_t drift = {"drift", 50, 30, 90, 100, 4};
+    int pass = 1;
+
+    // Locked clocks with the outputs reading after the hub has finished are glitch free
+    sim_run(&locked, &res);
+    sim_print(&locked, &res);
+    pass &= (res.hub.missed == 0 && res.glitches == 0 && res.lanes[0].frames > 0 && res.min_slack > 0);
+
+    // Outputs reading while the hub may still be processing see repeated frames
+    sim_run(&early_read, &res);
+    sim_print(&early_read, &res);
+    pass &= (res.hub.missed == 0 && res.glitches > 0);
+
+    // A hub that overruns the frame period misses deadlines and the outputs repeat frames
+    sim_run(&overload, &res);
+    sim_print(&overload, &res);
+    pass &= (res.hub.missed > 0 && res.gen_late > 0 && res.glitches > 0);
+
+    // Unlocked TDM clock slips frames as the read phase drifts through the hub processing time
+    sim_run(&drift, &res);
+    sim_print(&drift, &res);
+    pass &= (res.hub.missed == 0 && res.glitches > 0);
+
+    printf("TEST: %s\n", pass ? "PASS" : "FAIL");
+    return pass ? 0 : 1;
+}
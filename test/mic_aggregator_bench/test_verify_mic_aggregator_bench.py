@@ -0,0 +1,54 @@
+#!/usr/bin/env python3
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+import re
+
+test_results_filename = "testing/test.rpt"
+test_regex = r"^TEST:\s+(\w+)"
+sim_regex = r"^SIM:\s+case=(\w+)\s+spf=(\d+)\s+mics=(\d+).*hub_missed=(\d+)\s+gen_late=(\d+)\s+slack=(\d+)\.\.(\d+)((?:\s+lane\d+=\d+/\d+/\d+/\d+)+)"
+lane_regex = r"lane(\d+)=(\d+)/(\d+)/(\d+)/(\d+)"
+num_configs = 4
+
+def read_sim_results():
+    with open(test_results_filename, "r") as f:
+        results = [re.match(sim_regex, line) for line in f]
+    return [p for p in results if p]
+
+def glitches(p):
+    return sum(int(e) + int(r) + int(s) for _, _, e, r, s in re.findall(lane_regex, p.group(8)))
+
+def test_results():
+    with open(test_results_filename, "r") as f:
+        results = [re.match(test_regex, line) for line in f]
+    results = [p for p in results if p]
+
+    assert len(results) == num_configs
+    for p in results:
+        assert p.group(1).find("PASS") != -1
+
+def test_locked():
+    results = [p for p in read_sim_results() if p.group(1) == "locked"]
+
+    # Every lane carries its share of the mics without a glitch
+    assert len(results) == num_configs
+    for p in results:
+        lanes = re.findall(lane_regex, p.group(8))
+        print(f"spf={p.group(2)} mics={p.group(3)}: slack {p.group(6)}..{p.group(7)} MCLK cycles")
+        assert len(lanes) == -(-int(p.group(3)) // 16)
+        assert int(p.group(4)) == 0
+        assert glitches(p) == 0
+        assert int(p.group(6)) > 0
+
+def test_faults_detected():
+    results = [p for p in read_sim_results() if p.group(1) != "locked"]
+
+    # The checks see each of the modelled faults
+    assert len(results) == 3 * num_configs
+    for p in results:
+        print(f"{p.group(1)} spf={p.group(2)} mics={p.group(3)}: missed {p.group(4)}, glitches {glitches(p)}")
+        assert glitches(p) > 0
+        if p.group(1) == "overload":
+            assert int(p.group(4)) > 0
+        else:
+            assert int(p.group(4)) == 0
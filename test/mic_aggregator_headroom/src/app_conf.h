@@ -0,0 +1,26 @@
+// Copyright (c) 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public License: Version 1
+
+#ifndef APP_CONF_H
+#define APP_CONF_H
+
+/* Decimator configuration of the mic aggregator, see examples/mic_aggregator/src/app_config.h */
+#define TEST_OUTPUT_RATE                48000
+#define TEST_MAX_LOAD_PERCENT           80      /* MIC_ARRAY_DECIMATOR_MAX_LOAD */
+#define TEST_MAX_MICS_PER_ARRAY         16
+#define TEST_MAX_CHANNELS_PER_TASK      8
+
+/* Number of output samples decimated per channel count, the worst case is reported */
+#define TEST_NUM_BLOCKS                 16
+
+/*
+ * A single simulated thread runs at 1/5 of the 600 MHz core clock. With all
+ * 8 hardware threads busy each one runs at 1/8 of the core clock.
+ */
+#define TEST_SIM_THREAD_MHZ             120
+#define TEST_LOADED_THREAD_MHZ          75
+
+/* Every decimator task must leave at least the headroom the app's task count was chosen for */
+#define TEST_MIN_HEADROOM_PERCENT       (100 - TEST_MAX_LOAD_PERCENT)
+
+#endif /* APP_CONF_H */
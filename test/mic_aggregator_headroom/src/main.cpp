@@ -0,0 +1,153 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+/* System headers */
+#include <stdio.h>
+#include <stdint.h>
+#include <xcore/hwtimer.h>
+
+/* Library headers */
+#include "mic_array.h"
+#include "mic_array/cpp/Decimator.hpp"
+
+/* App headers */
+#include "app_conf.h"
+#include "mic_array_48k_decimator_coeffs.h"
+#include "decimator_cost.h"
+
+#define TEST_PRINTF(fmt, ...)       printf((fmt), ##__VA_ARGS__)
+
+#define REF_CLOCK_HZ                (100000000)
+
+static uint32_t error_count = 0;
+
+static const uint32_t WORD_ALIGNED stage1_coef[128] = STAGE_1_48K_COEFFS;
+static const int32_t WORD_ALIGNED stage2_coef[MIC_ARRAY_STAGE_2_NUM_TAPS] = STAGE_2_48K_COEFFS;
+
+static uint32_t pdm_block[TEST_MAX_CHANNELS_PER_TASK * MIC_ARRAY_CONFIG_STG2_DEC_FACTOR];
+static int32_t sample_out[TEST_MAX_CHANNELS_PER_TASK];
+
+/*
+ * Returns the worst case reference timer ticks taken by one decimator task to
+ * produce one output sample for each of its channels, scaled from the single
+ * simulated thread to a fully loaded tile.
+ */
+template <unsigned CHANNELS>
+static uint32_t measure_task_ticks()
+{
+    static mic_array::TwoStageDecimator<CHANNELS, MIC_ARRAY_CONFIG_STG2_DEC_FACTOR, MIC_ARRAY_STAGE_2_NUM_TAPS> decimator;
+    decimator.Init(stage1_coef, stage2_coef, MIC_ARRAY_CONFIG_STG2_RIGHT_SHIFT);
+
+    uint32_t seed = 0x12345678;
+    uint32_t max_ticks = 0;
+
+    for (int block = 0; block < TEST_NUM_BLOCKS; block++) {
+        for (int i = 0; i < CHANNELS * MIC_ARRAY_CONFIG_STG2_DEC_FACTOR; i++) {
+            seed = (seed * 1664525) + 1013904223;
+            pdm_block[i] = seed;
+        }
+
+        uint32_t start = get_reference_time();
+        decimator.ProcessBlock(sample_out, pdm_block);
+        uint32_t ticks = get_reference_time() - start;
+
+        if (ticks > max_ticks) {
+            max_ticks = ticks;
+        }
+    }
+
+    return ((uint64_t)max_ticks * TEST_SIM_THREAD_MHZ) / TEST_LOADED_THREAD_MHZ;
+}
+
+static uint32_t task_ticks(unsigned channels)
+{
+    switch (channels) {
+    case 1: return measure_task_ticks<1>();
+    case 2: return measure_task_ticks<2>();
+    case 3: return measure_task_ticks<3>();
+    case 4: return measure_task_ticks<4>();
+    case 5: return measure_task_ticks<5>();
+    case 6: return measure_task_ticks<6>();
+    case 7: return measure_task_ticks<7>();
+    default: return measure_task_ticks<8>();
+    }
+}
+
+/*
+ * The par decimator splits the mics of an array between its tasks, with the
+ * first tasks taking one extra channel when they don't divide evenly. The
+ * task count is chosen by the cost model in the same way as the app.
+ */
+static void report_array(unsigned mics, char array, unsigned array_mics, unsigned tasks, uint32_t sample_ticks)
+{
+    for (unsigned task = 0; task < tasks; task++) {
+        unsigned channels = array_mics / tasks;
+        if (task < array_mics % tasks) {
+            channels++;
+        }
+
+        uint32_t ticks = task_ticks(channels);
+        uint32_t model_ticks = DECIMATOR_COST_TASK_TICKS_FOR(channels, MIC_ARRAY_CONFIG_STG2_DEC_FACTOR, MIC_ARRAY_STAGE_2_NUM_TAPS);
+        int32_t headroom = 100 - (int32_t)((100 * ticks) / sample_ticks);
+        TEST_PRINTF("HEADROOM: mics=%u array=%c task=%u channels=%u ticks=%lu budget=%lu headroom=%ld%% model_ticks=%lu\n",
+                    mics, array, task, channels, ticks, sample_ticks, headroom, model_ticks);
+
+        if (headroom < TEST_MIN_HEADROOM_PERCENT) {
+            TEST_PRINTF("  - FAIL: %u mics, array %c task %u is over %d%% of the sample period\n", mics, array, task, TEST_MAX_LOAD_PERCENT);
+            error_count++;
+        }
+
+        // The task count is only as good as the model, which must not underestimate a task
+        if (ticks > model_ticks) {
+            TEST_PRINTF("  - FAIL: %u mics, array %c task %u took %lu ticks, the model allows %lu\n", mics, array, task, ticks, model_ticks);
+            error_count++;
+        }
+    }
+}
+
+/*
+ * Fits the per task and per channel costs of the model in decimator_cost.h
+ * to the measured task times.
+ */
+static void report_model(void)
+{
+    uint32_t ticks_1 = task_ticks(1);
+    uint32_t ticks_max = task_ticks(TEST_MAX_CHANNELS_PER_TASK);
+    uint32_t channel_ticks = (ticks_max - ticks_1) / (TEST_MAX_CHANNELS_PER_TASK - 1);
+    uint32_t overhead_ticks = (ticks_1 > channel_ticks) ? ticks_1 - channel_ticks : 0;
+
+    TEST_PRINTF("MODEL: measured task_ticks=%lu channel_ticks=%lu model task_ticks=%d channel_ticks=%d\n",
+                overhead_ticks, channel_ticks, DECIMATOR_COST_TASK_TICKS,
+                DECIMATOR_COST_CHANNEL_TICKS(MIC_ARRAY_CONFIG_STG2_DEC_FACTOR, MIC_ARRAY_STAGE_2_NUM_TAPS));
+}
+
+int main(void)
+{
+    const unsigned mic_counts[] = {16, 24, 32};
+    const uint32_t sample_ticks = REF_CLOCK_HZ / TEST_OUTPUT_RATE;
+
+    for (int i = 0; i < sizeof(mic_counts) / sizeof(mic_counts[0]); i++) {
+        // Mic array A on tile 0 takes the first 16 mics, mic array B on tile 1 the rest
+        unsigned mics_a = (mic_counts[i] > TEST_MAX_MICS_PER_ARRAY) ? TEST_MAX_MICS_PER_ARRAY : mic_counts[i];
+        unsigned mics_b = mic_counts[i] - mics_a;
+
+        // The app uses one task count for both arrays, chosen for the larger
+        unsigned tasks = DECIMATOR_COST_MIN_TASKS(mics_a, MIC_ARRAY_CONFIG_STG2_DEC_FACTOR, MIC_ARRAY_STAGE_2_NUM_TAPS,
+                                                  TEST_OUTPUT_RATE, TEST_MAX_LOAD_PERCENT);
+
+        report_array(mic_counts[i], 'A', mics_a, tasks, sample_ticks);
+        if (mics_b > 0) {
+            report_array(mic_counts[i], 'B', mics_b, tasks, sample_ticks);
+        }
+    }
+
+    report_model();
+
+    if (error_count == 0) {
+        TEST_PRINTF("\nTEST: PASS\n");
+    } else {
+        TEST_PRINTF("\nTEST: FAILED (Error Count = %ld)\n", error_count);
+    }
+
+    return 0;
+}
@@ -0,0 +1,52 @@
+#!/usr/bin/env python3
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+import re
+
+test_results_filename = "testing/test.rpt"
+test_regex = r"^TEST:\s+(\w+)"
+headroom_regex = r"^HEADROOM:\s+mics=(\d+)\s+array=(\w)\s+task=(\d+)\s+channels=(\d+)\s+ticks=(\d+)\s+budget=(\d+)\s+headroom=(-?\d+)%\s+model_ticks=(\d+)"
+model_regex = r"^MODEL:\s+measured task_ticks=(\d+)\s+channel_ticks=(\d+)\s+model task_ticks=(\d+)\s+channel_ticks=(\d+)"
+
+def test_results():
+    with open(test_results_filename, "r") as f:
+        cnt = 0
+        while 1:
+            line = f.readline()
+
+            if len(line) == 0:
+                assert cnt == 1
+                break
+
+            p = re.match(test_regex, line)
+
+            if p:
+                cnt += 1
+                assert p.group(1).find("PASS") != -1
+
+def test_headroom():
+    with open(test_results_filename, "r") as f:
+        results = [re.match(headroom_regex, line) for line in f]
+    results = [p for p in results if p]
+
+    # 1 mic array for 16 mics and 2 arrays for 24 and 32 mics, each with the task count chosen by the model
+    assert len(results) > 0
+    for mics in ("16", "24", "32"):
+        channels = sum(int(p.group(4)) for p in results if p.group(1) == mics)
+        assert channels == int(mics)
+    for p in results:
+        print(f"{p.group(1)} mics, array {p.group(2)} task {p.group(3)}: {p.group(4)} channels, {p.group(7)}% headroom, {p.group(5)} ticks (model {p.group(8)})")
+        # The app chose the task count for at most 80% load, and the model must not underestimate a task
+        assert int(p.group(7)) >= 20
+        assert int(p.group(5)) <= int(p.group(8))
+
+def test_model():
+    with open(test_results_filename, "r") as f:
+        results = [re.match(model_regex, line) for line in f]
+    results = [p for p in results if p]
+
+    # Informational, update decimator_cost.h if the fitted costs move
+    assert len(results) == 1
+    p = results[0]
+    print(f"measured: task {p.group(1)} + {p.group(2)} per channel, model: task {p.group(3)} + {p.group(4)} per channel")
@@ -1,4 +1,8 @@
 include(${CMAKE_CURRENT_LIST_DIR}/asr/asr.cmake)
+include(${CMAKE_CURRENT_LIST_DIR}/asrc_capacity/asrc_capacity.cmake)
+include(${CMAKE_CURRENT_LIST_DIR}/asrc_rate_switch/asrc_rate_switch.cmake)
+include(${CMAKE_CURRENT_LIST_DIR}/audio_frame_utils/audio_frame_utils.cmake)
 include(${CMAKE_CURRENT_LIST_DIR}/ffd_gpio/gpio.cmake)
 include(${CMAKE_CURRENT_LIST_DIR}/ffd_low_power_audio_buffer/low_power_audio_buffer.cmake)
+include(${CMAKE_CURRENT_LIST_DIR}/mic_aggregator_headroom/mic_aggregator_headroom.cmake)
 include(${CMAKE_CURRENT_LIST_DIR}/pipeline/pipeline.cmake)
@@ -0,0 +1,64 @@
+#!/bin/bash
+# Copyright (c) 2023, XMOS Ltd, All rights reserved
+set -e # exit on first error
+set -x # echo on
+
+# help text
+help()
+{
+   echo "XCORE-VOICE USB audio latency test"
+   echo
+   echo "Syntax: check_usb_audio_latency.sh [-h] firmware adapterID"
+   echo
+   echo "Options:"
+   echo "   h     Print this Help."
+}
+
+# flag arguments
+while getopts h option
+do
+    case "${option}" in
+        h) help
+           exit;;
+    esac
+done
+
+# assign vars
+FIRMWARE=${@:$OPTIND:1}
+DATA_PARTITION="dist/example_ffva_ua_adec_altarch_data_partition.bin"
+OUTPUT_DIR=test/usb_audio_latency/test_output
+if [ ! -z "${@:$OPTIND+1:1}" ]
+then
+    ADAPTER_ID="--adapter-id ${@:$OPTIND+1:1}"
+fi
+
+# discern repository root
+SLN_VOICE_ROOT=`git rev-parse --show-toplevel`
+
+# Create output folder
+mkdir -p ${OUTPUT_DIR}
+
+# flash the data partition
+xflash ${ADAPTER_ID} --quad-spi-clock 50MHz --factory ${FIRMWARE} --boot-partition-size 0x100000 --data ${DATA_PARTITION}
+
+# wait for device to reset (may not be necessary)
+sleep 3
+
+# call xrun (in background)
+xrun --xscope ${ADAPTER_ID} ${FIRMWARE} &
+XRUN_PID=$!
+
+# wait for app to load and enumerate on host
+sleep 15
+
+# play and record click track on a single duplex stream
+python ${SLN_VOICE_ROOT}/test/usb_audio_latency/measure_latency.py --rate 16000 --output_dir ${OUTPUT_DIR}
+
+# kill xrun, the device prints its USB buffer statistics when the interfaces close
+kill -INT ${XRUN_PID}
+
+echo "Arguments for pytest:"
+echo "  LOG="${OUTPUT_DIR}/results.csv
+
+# reset board for the next test
+xgdb -batch -ex "connect ${ADAPTER_ID} --reset-to-mode-pins" -ex detach
@@ -0,0 +1,15 @@
+# Copyright (c) 2023 XMOS LIMITED. This Software is subject to the terms of the
+# XMOS Public License: Version 1
+
+def pytest_addoption(parser):
+    parser.addoption("--log", action="store", default="results.csv")
+    parser.addoption("--max_latency_ms", action="store", type=float, default=30.0)
+
+def pytest_generate_tests(metafunc):
+    option_value = metafunc.config.option.log
+    if 'log' in metafunc.fixturenames and option_value is not None:
+        metafunc.parametrize("log", [option_value])
+
+    option_value = metafunc.config.option.max_latency_ms
+    if 'max_latency_ms' in metafunc.fixturenames and option_value is not None:
+        metafunc.parametrize("max_latency_ms", [option_value])
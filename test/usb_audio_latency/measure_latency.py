@@ -0,0 +1,93 @@
+#!/usr/bin/env python
+# Copyright (c) 2023 XMOS LIMITED. This Software is subject to the terms of the
+# XMOS Public License: Version 1
+
+import argparse
+import numpy as np
+import sounddevice as sd
+import soundfile as sf
+
+# XCORE-VOICE USB input channel order is: Ref L, Ref R, Mic 0, Mic 1
+# XCORE-VOICE USB output channel order is: ASR, Comms, Ref L, Ref R, Mic 0, Mic 1
+# Each entry is (path name, USB input channel, USB output channel)
+LOOPBACK_PATHS = [
+    ("usb_to_ref", 0, 2),
+    ("usb_to_mic", 2, 4),
+]
+TO_DEVICE_CHANNELS = 4
+FROM_DEVICE_CHANNELS = 6
+
+
+def make_click_track(sample_rate, duration, period):
+    """Returns a multichannel signal with a 1 ms tone burst every period seconds"""
+    burst_len = sample_rate // 1000
+    t = np.arange(burst_len) / sample_rate
+    burst = 0.5 * np.sin(2 * np.pi * 1000 * t) * np.hanning(burst_len)
+
+    signal = np.zeros((int(duration * sample_rate), TO_DEVICE_CHANNELS))
+    # leave the first period silent while the device buffers fill
+    for start in range(int(period * sample_rate), signal.shape[0] - burst_len, int(period * sample_rate)):
+        signal[start:start + burst_len, :] = burst[:, np.newaxis]
+    return signal
+
+
+def loopback(device, sample_rate, signal):
+    """Plays signal to and records from device on a single duplex stream"""
+    recording = np.zeros((signal.shape[0], FROM_DEVICE_CHANNELS))
+    position = [0]
+
+    def callback(indata, outdata, frames, time, status):
+        start = position[0]
+        count = min(frames, signal.shape[0] - start)
+        outdata[:count] = signal[start:start + count]
+        outdata[count:] = 0
+        recording[start:start + count] = indata[:count]
+        position[0] += count
+        if position[0] >= signal.shape[0]:
+            raise sd.CallbackStop
+
+    with sd.Stream(device=device,
+                   samplerate=sample_rate,
+                   channels=(FROM_DEVICE_CHANNELS, TO_DEVICE_CHANNELS),
+                   dtype="float32",
+                   callback=callback) as stream:
+        host_latency = stream.latency[0] + stream.latency[1]
+        while stream.active:
+            sd.sleep(100)
+
+    return recording, host_latency
+
+
+def measure_latency(stimulus, response, sample_rate, period):
+    """Returns the median delay in seconds of each click in response relative to stimulus"""
+    period_len = int(period * sample_rate)
+    delays = []
+    for start in range(period_len, stimulus.shape[0] - period_len, period_len):
+        x = stimulus[start - period_len // 2:start + period_len // 2]
+        y = response[start - period_len // 2:start + period_len + period_len // 2]
+        corr = np.correlate(y, x, mode="valid")
+        delays.append(np.argmax(np.abs(corr)) / sample_rate)
+    return float(np.median(delays))
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Measure XCORE-VOICE USB audio loopback latency")
+    parser.add_argument("--device", default="XCORE-VOICE", help="host audio device name")
+    parser.add_argument("--rate", type=int, default=16000, help="sample rate")
+    parser.add_argument("--duration", type=float, default=10, help="test duration in seconds")
+    parser.add_argument("--period", type=float, default=0.5, help="click period in seconds")
+    parser.add_argument("--output_dir", default=".", help="output directory")
+    args = parser.parse_args()
+
+    stimulus = make_click_track(args.rate, args.duration, args.period)
+    response, host_latency = loopback(args.device, args.rate, stimulus)
+
+    sf.write(f"{args.output_dir}/stimulus.wav", stimulus, args.rate)
+    sf.write(f"{args.output_dir}/response.wav", response, args.rate)
+
+    with open(f"{args.output_dir}/results.csv", "w") as f:
+        for name, in_ch, out_ch in LOOPBACK_PATHS:
+            latency = measure_latency(stimulus[:, in_ch], response[:, out_ch], args.rate, args.period)
+            device_latency_ms = 1000 * (latency - host_latency)
+            print(f"{name}: {device_latency_ms:.2f} ms (host stack {1000 * host_latency:.2f} ms removed)")
+            f.write(f"path={name}, latency_ms={device_latency_ms:.2f}\n")
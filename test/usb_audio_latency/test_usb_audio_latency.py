@@ -0,0 +1,16 @@
+# Copyright (c) 2023 XMOS LIMITED. This Software is subject to the terms of the
+# XMOS Public License: Version 1
+
+def test_latency(log, max_latency_ms):
+    errors = []
+    with open(log, 'r') as f:
+        for line in f.readlines():
+            # expected format:
+            # ['path=usb_to_ref', 'latency_ms=12.34']
+            values = [s.strip().split('=', 1)[-1] for s in line.split(',')]
+            path = values[0]
+            latency_ms = float(values[1])
+            if latency_ms > max_latency_ms:
+                errors.append(f"{path} latency {latency_ms} ms exceeds {max_latency_ms} ms")
+
+    assert not errors, "Test failed:\n{}".format("\n".join(errors))
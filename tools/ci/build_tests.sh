@@ -27,8 +27,13 @@ tests=(
     "test_asr_sensory   test_asr_sensory   test_asr_sensory   TEST_ASR=SENSORY   XK_VOICE_L71   xmos_cmake_toolchain/xs3a.cmake"
     "test_ffva_sample_rate_conv   example_ffva_ua_adec_altarch   example_ffva_ua_adec_altarch   DEBUG_FFVA_USB_MIC_INPUT_PIPELINE_BYPASS=1   XK_VOICE_L71   xmos_cmake_toolchain/xs3a.cmake"
     "test_ffva_verbose_output   example_ffva_ua_adec_altarch   example_ffva_ua_adec_altarch   DEBUG_FFVA_USB_VERBOSE_OUTPUT=1   XK_VOICE_L71   xmos_cmake_toolchain/xs3a.cmake"
+    "test_ffva_usb_low_latency   example_ffva_ua_adec_altarch   example_ffva_ua_adec_altarch   DEBUG_FFVA_USB_LOW_LATENCY=1   XK_VOICE_L71   xmos_cmake_toolchain/xs3a.cmake"
     "test_ffd_gpio   test_ffd_gpio   NONE   NONE   XCORE_AI_EXPLORER   xmos_cmake_toolchain/xs3a.cmake"
     "test_ffd_low_power_audio_buffer   test_ffd_low_power_audio_buffer   NONE   NONE   XK_VOICE_L71   xmos_cmake_toolchain/xs3a.cmake"
+    "test_asrc_capacity   test_asrc_capacity   NONE   NONE   XK_VOICE_L71   xmos_cmake_toolchain/xs3a.cmake"
+    "test_asrc_rate_switch   test_asrc_rate_switch   NONE   NONE   XK_VOICE_L71   xmos_cmake_toolchain/xs3a.cmake"
+    "test_audio_frame_utils   test_audio_frame_utils   NONE   NONE   XK_VOICE_L71   xmos_cmake_toolchain/xs3a.cmake"
+    "test_mic_aggregator_headroom   test_mic_aggregator_headroom   NONE   NONE   XK_VOICE_L71   xmos_cmake_toolchain/xs3a.cmake"
 )
 
 # perform builds
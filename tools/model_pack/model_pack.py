@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+"""
+Packs ASR model files into a flash model partition image, and lists the
+contents of an image. The layout matches modules/asr/asr_model_partition.h:
+
+    header      magic, version, entry count, alignment, image size
+    directory   one entry per model: name, offset, size, CRC32
+    models      each starting on an alignment boundary
+
+Models are placed in the order given, so list the most frequently read
+model first to keep the hot data together at the start of the partition.
+"""
+import argparse
+import binascii
+import struct
+import sys
+
+MAGIC = 0x4C444D58  # "XMDL"
+VERSION = 1
+HEADER = struct.Struct("<IHHII")
+ENTRY = struct.Struct("<20sIII")
+NAME_LEN = 20
+
+def nibble_swap(data):
+    return bytes(((b << 4) & 0xF0) | (b >> 4) for b in data)
+
+def align_up(value, alignment):
+    return (value + alignment - 1) // alignment * alignment
+
+def pack(models, alignment):
+    """models is a list of (name, bytes), returns the image"""
+    directory_end = HEADER.size + ENTRY.size * len(models)
+    offset = align_up(directory_end, alignment)
+    entries = []
+    for name, data in models:
+        entries.append((name, offset, len(data), binascii.crc32(data) & 0xFFFFFFFF))
+        offset = align_up(offset + len(data), alignment)
+
+    image = bytearray(offset)
+    HEADER.pack_into(image, 0, MAGIC, VERSION, len(models), alignment, offset)
+    for i, (name, entry_offset, size, crc) in enumerate(entries):
+        ENTRY.pack_into(image, HEADER.size + i * ENTRY.size, name.encode(), entry_offset, size, crc)
+    for (name, data), (_, entry_offset, size, _) in zip(models, entries):
+        image[entry_offset:entry_offset + size] = data
+    return bytes(image), entries
+
+def unpack(image):
+    magic, version, count, alignment, image_size = HEADER.unpack_from(image, 0)
+    swapped = False
+    if magic != MAGIC:
+        # Images for the raw QSPI transfer are stored nibble swapped
+        image = nibble_swap(image)
+        magic, version, count, alignment, image_size = HEADER.unpack_from(image, 0)
+        swapped = True
+    if magic != MAGIC or version != VERSION:
+        raise ValueError("Not a model partition image")
+    entries = []
+    for i in range(count):
+        name, offset, size, crc = ENTRY.unpack_from(image, HEADER.size + i * ENTRY.size)
+        entries.append((name.rstrip(b"\0").decode(), offset, size, crc))
+    return alignment, image_size, swapped, entries
+
+def parse_model_arg(arg):
+    name, sep, path = arg.partition("=")
+    if not sep or not name or not path:
+        raise argparse.ArgumentTypeError(f"expected NAME=FILE, got '{arg}'")
+    if len(name.encode()) >= NAME_LEN:
+        raise argparse.ArgumentTypeError(f"model name '{name}' is longer than {NAME_LEN - 1} bytes")
+    return name, path
+
+def parse_arguments():
+    parser = argparse.ArgumentParser(description="Pack ASR models into a flash model partition image")
+    parser.add_argument("--model", type=parse_model_arg, action="append", default=[], metavar="NAME=FILE",
+                        help="Model to pack, most frequently read first. May be repeated")
+    parser.add_argument("--align", type=int, default=256,
+                        help="Alignment of each model in bytes, a multiple of the QSPI read burst. Default 256")
+    parser.add_argument("--nibble-swap", action="store_true",
+                        help="Nibble swap the image, for the raw QSPI fast read transfer. Give unswapped model files")
+    parser.add_argument("--output", help="Image file to write")
+    parser.add_argument("--list", metavar="IMAGE", help="List the contents of an image and exit")
+    args = parser.parse_args()
+    if args.list is None and (not args.model or args.output is None):
+        parser.error("--model and --output are required to pack an image")
+    if args.align < 4 or args.align & (args.align - 1):
+        parser.error("--align must be a power of 2 and at least 4")
+    return args
+
+def print_entries(entries):
+    print(f"{'name':<20} {'offset':>10} {'size':>10} {'crc32':>10}")
+    for name, offset, size, crc in entries:
+        print(f"{name:<20} {offset:>#10x} {size:>10} {crc:>#10x}")
+
+if __name__ == "__main__":
+    args = parse_arguments()
+
+    if args.list:
+        with open(args.list, "rb") as f:
+            image = f.read()
+        alignment, image_size, swapped, entries = unpack(image)
+        print(f"{args.list}: {image_size} bytes, {alignment} byte alignment{', nibble swapped' if swapped else ''}")
+        print_entries(entries)
+        sys.exit(0)
+
+    names = [name for name, _ in args.model]
+    if len(set(names)) != len(names):
+        sys.exit("error: model names must be unique")
+    models = []
+    for name, path in args.model:
+        with open(path, "rb") as f:
+            models.append((name, f.read()))
+
+    image, entries = pack(models, args.align)
+    if args.nibble_swap:
+        image = nibble_swap(image)
+    with open(args.output, "wb") as f:
+        f.write(image)
+    print(f"{args.output}: {len(image)} bytes, {args.align} byte alignment")
+    print_entries(entries)
@@ -0,0 +1,152 @@
+#!/usr/bin/env python3
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+"""
+Decodes the telemetry records in a device log, as printed by the telemetry
+module in modules/telemetry, and summarizes the heap, stack and buffer
+headroom and the core loads seen over all records of each tile.
+
+Each record is printed as lines of:
+
+    TLM <tile> <offset> <record size> <hex bytes>
+"""
+import argparse
+import re
+import struct
+import sys
+
+MAGIC = 0x4D4C4554  # "TELM"
+VERSION = 3
+HEADER = struct.Struct("<IBBBBBB2xIIIII")
+TASK = struct.Struct("<12sIIBBH")
+OBJECT = struct.Struct("<12sB3xII")
+CORE = struct.Struct("<HH")
+LINE = re.compile(r"TLM (\d+) (\d+) (\d+) ([0-9a-f]+)")
+TASK_STATES = ["running", "ready", "blocked", "suspended", "deleted", "invalid"]
+OBJECT_TYPES = ["queue", "stream buffer"]
+
+def name_str(raw):
+    return raw.split(b"\0", 1)[0].decode(errors="replace")
+
+def decode(record):
+    magic, version, tile, task_count, object_count, core_count, task_total, \
+        uptime_ms, heap_size, heap_free, heap_min_free, run_time_total = HEADER.unpack_from(record, 0)
+    if magic != MAGIC or version != VERSION:
+        raise ValueError("not a telemetry record")
+    offset = HEADER.size
+    tasks = []
+    for _ in range(task_count):
+        name, stack_min_free, run_time, priority, state, number = TASK.unpack_from(record, offset)
+        tasks.append(dict(name=name_str(name), stack_min_free=stack_min_free, run_time=run_time,
+                          priority=priority, state=state, number=number))
+        offset += TASK.size
+    objects = []
+    for _ in range(object_count):
+        name, obj_type, capacity, peak = OBJECT.unpack_from(record, offset)
+        objects.append(dict(name=name_str(name), type=obj_type, capacity=capacity, peak=peak))
+        offset += OBJECT.size
+    cores = []
+    for _ in range(core_count):
+        load, peak = CORE.unpack_from(record, offset)
+        cores.append(dict(load=load / 100.0, peak=peak / 100.0))
+        offset += CORE.size
+    return dict(tile=tile, task_total=task_total, uptime_ms=uptime_ms, heap_size=heap_size, heap_free=heap_free,
+                heap_min_free=heap_min_free, run_time_total=run_time_total, tasks=tasks, objects=objects,
+                cores=cores)
+
+def read_records(lines):
+    """Yields each complete record in the log"""
+    partial = {}
+    for line in lines:
+        m = LINE.search(line)
+        if not m:
+            continue
+        tile, offset, size, data = int(m[1]), int(m[2]), int(m[3]), bytes.fromhex(m[4])
+        if offset == 0:
+            partial[tile] = bytearray()
+        buf = partial.get(tile)
+        if buf is None or len(buf) != offset:
+            # Missed the start of this record
+            partial.pop(tile, None)
+            continue
+        buf += data
+        if len(buf) >= size:
+            del partial[tile]
+            try:
+                yield decode(bytes(buf[:size]))
+            except (ValueError, struct.error) as e:
+                print(f"tile {tile}: bad record, {e}", file=sys.stderr)
+
+def print_record(r):
+    print(f"tile {r['tile']} at {r['uptime_ms'] / 1000:.1f} s: heap {r['heap_size']} bytes, "
+          f"{r['heap_free']} free, {r['heap_min_free']} minimum free")
+    if r["task_total"] > len(r["tasks"]):
+        print(f"  {r['task_total']} tasks do not fit, raise TELEMETRY_MAX_TASKS")
+    if r["tasks"]:
+        total = r["run_time_total"]
+        print(f"  {'task':<12} {'pri':>3} {'state':<9} {'stack free':>10} {'cpu %':>6}")
+        for t in sorted(r["tasks"], key=lambda t: t["number"]):
+            cpu = f"{100.0 * t['run_time'] / total:6.1f}" if total else "     -"
+            state = TASK_STATES[t["state"]] if t["state"] < len(TASK_STATES) else str(t["state"])
+            print(f"  {t['name']:<12} {t['priority']:>3} {state:<9} {t['stack_min_free']:>10} {cpu}")
+    for o in r["objects"]:
+        kind = OBJECT_TYPES[o["type"]] if o["type"] < len(OBJECT_TYPES) else str(o["type"])
+        print(f"  {kind} {o['name']}: peak {o['peak']} of {o['capacity']}")
+    for core, c in enumerate(r["cores"]):
+        print(f"  core {core}: load {c['load']:.1f}%, peak {c['peak']:.1f}%")
+
+def print_summary(records, heap_margin, stack_margin):
+    for tile in sorted({r["tile"] for r in records}):
+        tile_records = [r for r in records if r["tile"] == tile]
+        heap_size = tile_records[-1]["heap_size"]
+        heap_min_free = min(r["heap_min_free"] for r in tile_records)
+        print(f"tile {tile}: {len(tile_records)} records")
+        print(f"  heap: {heap_size - heap_min_free} of {heap_size} bytes used at most, "
+              f"configTOTAL_HEAP_SIZE could be {heap_size - heap_min_free + heap_margin} with a {heap_margin} byte margin")
+
+        task_total = max(r["task_total"] for r in tile_records)
+        if any(r["task_total"] > len(r["tasks"]) for r in tile_records):
+            print(f"  tasks: up to {task_total} tasks did not fit, raise TELEMETRY_MAX_TASKS")
+
+        stack_free = {}
+        for r in tile_records:
+            for t in r["tasks"]:
+                stack_free[t["name"]] = min(stack_free.get(t["name"], t["stack_min_free"]), t["stack_min_free"])
+        for name, free in sorted(stack_free.items()):
+            spare = free - stack_margin
+            note = f"could shrink by {spare}" if spare > 0 else "no more than the margin spare"
+            print(f"  stack {name}: {free} bytes never used, {note}")
+
+        peaks = {}
+        for r in tile_records:
+            for o in r["objects"]:
+                peak, capacity = peaks.get(o["name"], (0, o["capacity"]))
+                peaks[o["name"]] = (max(peak, o["peak"]), capacity)
+        for name, (peak, capacity) in sorted(peaks.items()):
+            print(f"  {name}: peak {peak} of {capacity}")
+
+        core_records = [r for r in tile_records if r["cores"]]
+        for core in range(len(core_records[-1]["cores"]) if core_records else 0):
+            loads = [r["cores"][core] for r in core_records if core < len(r["cores"])]
+            mean = sum(c["load"] for c in loads) / len(loads)
+            peak = max(c["peak"] for c in loads)
+            print(f"  core {core}: load {mean:.1f}% mean, {peak:.1f}% peak")
+
+def parse_arguments():
+    parser = argparse.ArgumentParser(description="Decode telemetry records from a device log")
+    parser.add_argument("log", nargs="?", help="Log file, or standard input if omitted")
+    parser.add_argument("--records", action="store_true", help="Print every record, not only the summary")
+    parser.add_argument("--heap-margin", type=int, default=4096, help="Heap bytes to keep spare. Default 4096")
+    parser.add_argument("--stack-margin", type=int, default=256, help="Stack bytes to keep spare per task. Default 256")
+    return parser.parse_args()
+
+if __name__ == "__main__":
+    args = parse_arguments()
+    with (open(args.log, errors="replace") if args.log else sys.stdin) as f:
+        records = list(read_records(f))
+    if not records:
+        sys.exit("No telemetry records found")
+    if args.records:
+        for r in records:
+            print_record(r)
+    print_summary(records, args.heap_margin, args.stack_margin)